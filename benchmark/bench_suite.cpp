@@ -0,0 +1,750 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/**
+ * The benchmark suite: micro-benchmarks of every interval operation, of the generator and simulator
+ * functions and of the scheduler, long runs of the t_next update, and macro-benchmarks simulating N
+ * generators for M hours with each engine.
+ * Prints one line per benchmark, or a JSON document when called with --json. Fails when the simulator
+ * throughput is below the target, which --simulator-target=<events/sec> overrides, 0 disables the check.
+ */
+#include "benchmark.h"
+
+#include <cadmium/iadevs/basic_models/counter.h>
+#include <cadmium/iadevs/basic_models/generator.h>
+#include <cadmium/iadevs/engine/coordinator.h>
+#include <cadmium/iadevs/engine/coupled_model_loader.h>
+#include <cadmium/iadevs/engine/ensemble.h>
+#include <cadmium/iadevs/engine/parallel_root_coordinator.h>
+#include <cadmium/iadevs/engine/scheduler.h>
+#include <cadmium/iadevs/engine/simulator.h>
+#include <cadmium/iadevs/engine/simulator_pool.h>
+#include <cadmium/iadevs/engine/static_coordinator.h>
+#include <cadmium/iadevs/utils/ia_time.h>
+
+#include <cfenv>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+namespace bench = cadmium::iadevs::benchmark;
+using cadmium::iadevs::interval_status;
+using generator = cadmium::iadevs::basic_models::generator;
+using counter = cadmium::iadevs::basic_models::counter;
+using coordinator_t = cadmium::iadevs::engine::coordinator<generator::time_t, generator::output_t>;
+
+constexpr std::size_t operations = 1 << 22;
+// Inputs are a power of two to index them with a mask, and small enough to stay in L1
+constexpr std::size_t inputs = 1 << 10;
+constexpr std::size_t mask = inputs - 1;
+constexpr int ms_per_hour = 3'600'000;
+// Runs of the t_next update and of the simulator, with events per run bounded to keep t_next in the int
+// millisecond range
+constexpr std::size_t update_runs = 20;
+constexpr std::size_t events_per_run = 1'000'000;
+// Target for optimized builds on a single core of our simulation nodes
+constexpr double default_simulator_target = 50'000'000.0;
+
+/**
+ * @return value read through a volatile, so computations using it are not folded at compile time
+ */
+template<typename T>
+T at_runtime(T value) {
+  volatile T copy = value;
+  return copy;
+}
+
+template<typename T>
+std::vector<cadmium::iadevs::interval<T>> random_intervals(std::mt19937 &rng) {
+  std::uniform_int_distribution<int> lower(-1'000'000, 1'000'000);
+  std::uniform_int_distribution<int> width(0, 1'000);
+  std::bernoulli_distribution closed;
+  std::vector<cadmium::iadevs::interval<T>> result(inputs);
+  for (auto &i : result) {
+    const int l = lower(rng);
+    const int w = width(rng);
+    // Half of the double endpoints are not integers, so their sums need rounding
+    const T fraction = std::is_floating_point_v<T> && closed(rng) ? T(0.1) : T(0);
+    i.set_bounded(T(l) + fraction, w == 0 || closed(rng), T(l + w) + fraction, w == 0 || closed(rng));
+  }
+  return result;
+}
+
+/**
+ * Measures a binary operation over pairs of inputs
+ */
+template<typename I, typename F>
+bench::result binary(const std::string &name, const std::vector<I> &a, const std::vector<I> &b, F op) {
+  return bench::measure(name, operations, [&] {
+    for (std::size_t k = 0; k < operations; ++k) {
+      bench::do_not_optimize(op(a[k & mask], b[(k * 7 + 1) & mask]));
+    }
+  });
+}
+
+/**
+ * Measures a unary operation over the inputs
+ */
+template<typename I, typename F>
+bench::result unary(const std::string &name, const std::vector<I> &a, F op) {
+  return bench::measure(name, operations, [&] {
+    for (std::size_t k = 0; k < operations; ++k) {
+      bench::do_not_optimize(op(a[k & mask]));
+    }
+  });
+}
+
+void interval_benchmarks(std::vector<bench::result> &results) {
+  using interval_t = cadmium::iadevs::interval<int>;
+  using interval_d = cadmium::iadevs::interval<double>;
+  std::mt19937 rng(19);
+  const auto a = random_intervals<int>(rng);
+  const auto b = random_intervals<int>(rng);
+  const auto da = random_intervals<double>(rng);
+  const auto db = random_intervals<double>(rng);
+
+  results.push_back(unary("interval<int>::set_bounded", a, [](const interval_t &i) {
+    interval_t r;
+    r.set_bounded(i.packed_lower_value(), true, i.packed_upper_value(), false);
+    return r;
+  }));
+  results.push_back(unary("interval<int>::get_lower_endpoint_value", a, [](const interval_t &i) {
+    return i.get_lower_endpoint_value();
+  }));
+  results.push_back(unary("interval<int>::try_get_width", a, [](const interval_t &i) {
+    int width = 0;
+    return i.try_get_width(width) == cadmium::iadevs::interval_status::ok ? width : -1;
+  }));
+  results.push_back(unary("interval<int>::try_bisect", a, [](const interval_t &i) {
+    interval_t low, high;
+    i.try_bisect(low, high);
+    return low.hull(high);
+  }));
+  results.push_back(unary("interval<int>::operator-()", a, [](const interval_t &i) { return -i; }));
+  results.push_back(binary("interval<int>::operator+", a, b, [](const interval_t &x, const interval_t &y) {
+    return x + y;
+  }));
+  results.push_back(binary("interval<int>::try_add", a, b, [](const interval_t &x, const interval_t &y) {
+    interval_t r;
+    x.try_add(y, r);
+    return r;
+  }));
+  results.push_back(binary("interval<int>::operator-", a, b, [](const interval_t &x, const interval_t &y) {
+    return x - y;
+  }));
+  results.push_back(binary("interval<int>::try_subtract", a, b, [](const interval_t &x, const interval_t &y) {
+    interval_t r;
+    x.try_subtract(y, r);
+    return r;
+  }));
+  results.push_back(binary("interval<int>::hull", a, b, [](const interval_t &x, const interval_t &y) {
+    return x.hull(y);
+  }));
+  results.push_back(binary("interval<int>::intersect", a, b, [](const interval_t &x, const interval_t &y) {
+    return x.intersect(y);
+  }));
+  results.push_back(binary("interval<int>::certainly_before", a, b, [](const interval_t &x, const interval_t &y) {
+    return x.certainly_before(y);
+  }));
+  results.push_back(binary("interval<int>::possibly_before", a, b, [](const interval_t &x, const interval_t &y) {
+    return x.possibly_before(y);
+  }));
+  results.push_back(binary("interval<int>::operator==", a, b, [](const interval_t &x, const interval_t &y) {
+    return x == y;
+  }));
+  results.push_back(binary("interval<double>::operator+", da, db, [](const interval_d &x, const interval_d &y) {
+    return x + y;
+  }));
+  results.push_back(binary("interval<double>::operator-", da, db, [](const interval_d &x, const interval_d &y) {
+    return x - y;
+  }));
+}
+
+void model_benchmarks(std::vector<bench::result> &results) {
+  std::mt19937 rng(23);
+  // Partial states within the output period, so the time advance is not empty
+  std::uniform_int_distribution<int> elapsed(0, 900);
+  std::vector<generator::state_t> states(inputs);
+  for (auto &s : states) {
+    const int l = elapsed(rng);
+    s.set_bounded(l, true, l + 90, true);
+  }
+  const auto times = random_intervals<int>(rng);
+
+  const generator g{};
+  results.push_back(unary("generator::bounded_time_advance_i", states, [&](const generator::state_t &s) {
+    return g.bounded_time_advance_i(s);
+  }));
+  cadmium::iadevs::engine::simulator<generator> sg{};
+  results.push_back(bench::measure("simulator<generator>::init", operations, [&] {
+    for (std::size_t k = 0; k < operations; ++k) {
+      bench::do_not_optimize(sg.init(states[k & mask], times[(k * 7 + 1) & mask]).t_next);
+    }
+  }));
+}
+
+/**
+ * Schedules every component, then finds the imminent ones and reschedules each of them one generator
+ * period later, as a coordinator does. Operations are schedule calls.
+ */
+std::size_t reschedule(std::size_t components, std::size_t rounds) {
+  using scheduler_t = cadmium::iadevs::engine::scheduler<generator::time_t>;
+  scheduler_t s;
+  s.reserve(components);
+  for (std::size_t id = 0; id < components; ++id) {
+    generator::time_t t{};
+    const int start = static_cast<int>(id % 1000);
+    t.set_bounded(start, true, start + 8, true);
+    s.schedule(id, t);
+  }
+  std::vector<scheduler_t::id_t> imminent;
+  std::size_t updates = components;
+  for (std::size_t round = 0; round < rounds; ++round) {
+    imminent.clear();
+    s.imminent(imminent);
+    for (auto id : imminent) {
+      s.schedule(id, s.get_t_next(id) + generator::output_period);
+    }
+    updates += imminent.size();
+  }
+  bench::do_not_optimize(updates);
+  return updates;
+}
+
+void scheduler_benchmarks(std::vector<bench::result> &results) {
+  constexpr std::size_t components = 100'000;
+  constexpr std::size_t rounds = 200;
+  results.push_back(bench::measure("scheduler imminent query and reschedule, 100k components",
+                                   reschedule(components, rounds), [] { reschedule(components, rounds); }));
+}
+
+/**
+ * Long runs of the generator t_next update done by the simulator, with the throwing interval operators
+ * and with the status returning ones
+ */
+void throwing_updates(const generator &g, const generator::state_t &s) {
+  for (std::size_t run = 0; run < update_runs; ++run) {
+    generator::time_t t_next{};
+    t_next.set_bounded(0, true, 0, true);
+    for (std::size_t event = 0; event < events_per_run; ++event) {
+      const generator::time_t t_last = t_next;
+      t_next = g.time_bound_add(t_last, g.bounded_time_advance_i(s));
+    }
+    bench::do_not_optimize(t_next);
+  }
+}
+
+void status_updates(const generator::state_t &s) {
+  for (std::size_t run = 0; run < update_runs; ++run) {
+    generator::time_t t_next{};
+    t_next.set_bounded(0, true, 0, true);
+    generator::time_t time_advance{};
+    for (std::size_t event = 0; event < events_per_run; ++event) {
+      const generator::time_t t_last = t_next;
+      if (generator::output_period.try_subtract(s, time_advance) != interval_status::ok
+          || t_last.try_add(time_advance, t_next) != interval_status::ok) [[unlikely]] {
+        std::abort();
+      }
+    }
+    bench::do_not_optimize(t_next);
+  }
+}
+
+/**
+ * The same update with a floating point period: outward rounded double intervals, endpoints rounded to
+ * nearest, which is not rigorous, and the processor rounding mode switched around each endpoint addition
+ */
+using double_time = cadmium::iadevs::interval<double>;
+
+void outward_updates(const double_time &period) {
+  for (std::size_t run = 0; run < update_runs; ++run) {
+    double_time t_next{};
+    t_next.set_bounded(0.0, true, 0.0, true);
+    for (std::size_t event = 0; event < events_per_run; ++event) {
+      t_next = t_next + period;
+    }
+    bench::do_not_optimize(t_next);
+  }
+}
+
+void nearest_updates(const double_time &period) {
+  for (std::size_t run = 0; run < update_runs; ++run) {
+    double lower = 0.0;
+    double upper = 0.0;
+    for (std::size_t event = 0; event < events_per_run; ++event) {
+      lower += period.packed_lower_value();
+      upper += period.packed_upper_value();
+    }
+    bench::do_not_optimize(lower);
+    bench::do_not_optimize(upper);
+  }
+}
+
+void fesetround_updates(const double_time &period) {
+  for (std::size_t run = 0; run < update_runs; ++run) {
+    volatile double lower = 0.0;
+    volatile double upper = 0.0;
+    for (std::size_t event = 0; event < events_per_run; ++event) {
+      std::fesetround(FE_DOWNWARD);
+      lower = lower + period.packed_lower_value();
+      std::fesetround(FE_UPWARD);
+      upper = upper + period.packed_upper_value();
+    }
+    std::fesetround(FE_TONEAREST);
+    bench::do_not_optimize(lower);
+    bench::do_not_optimize(upper);
+  }
+}
+
+void update_benchmarks(std::vector<bench::result> &results) {
+  constexpr std::size_t updates = update_runs * events_per_run;
+  const generator g{};
+  generator::state_t s{};
+  const int zero = at_runtime(0);
+  s.set_bounded(zero, true, zero, true);
+  results.push_back(bench::measure("generator t_next update, throwing operators", updates,
+                                   [&] { throwing_updates(g, s); }));
+  results.push_back(bench::measure("generator t_next update, status operators", updates,
+                                   [&] { status_updates(s); }));
+  double_time period{};
+  const double lower = at_runtime(0.997);
+  period.set_bounded(lower, true, lower + 0.008, true);
+  results.push_back(bench::measure("double t_next update, outward rounded interval", updates,
+                                   [&] { outward_updates(period); }));
+  results.push_back(bench::measure("double t_next update, endpoints rounded to nearest", updates,
+                                   [&] { nearest_updates(period); }));
+  results.push_back(bench::measure("double t_next update, rounding mode switched per addition", updates,
+                                   [&] { fesetround_updates(period); }));
+}
+
+/**
+ * Runs of the generator simulator over a million events each, operations are internal events
+ */
+std::size_t simulator_runs(cadmium::iadevs::engine::simulator<generator> &sg) {
+  generator::time_t limit{};
+  // Bounded by the t_next upper endpoint growth of 1005 ms per event
+  limit.set_bounded(1005 * static_cast<int>(events_per_run), true, 1005 * static_cast<int>(events_per_run), true);
+  std::size_t events = 0;
+  for (std::size_t run = 0; run < update_runs; ++run) {
+    sg.init(generator::state_t{0, true, 0, true}, generator::time_t{0, true, 0, true});
+    events += sg.run_until(limit);
+  }
+  bench::do_not_optimize(events);
+  return events;
+}
+
+/**
+ * Emits every second, as the generator does, with time_t intervals over value_t milliseconds
+ */
+template<typename value_t>
+struct second_ticker {
+  using state_t = cadmium::iadevs::interval<value_t>;
+  using time_t = cadmium::iadevs::interval<value_t>;
+  using output_t = cadmium::iadevs::interval<int>;
+  static constexpr time_t period{value_t{997}, true, value_t{1005}, true};
+  static constexpr state_t just_emitted{value_t{0}, true, value_t{0}, true};
+
+  constexpr time_t bounded_time_advance_i(const state_t &state) const {
+    return period - state;
+  }
+  constexpr state_t internal_transition_i(const state_t &) const {
+    return just_emitted;
+  }
+  constexpr output_t output_i(const state_t &) const {
+    return output_t{1, true, 2, true};
+  }
+  constexpr time_t time_bound_add(const time_t &t1, const time_t &t2) const {
+    return t1 + t2;
+  }
+};
+
+/**
+ * Simulates a year of events one second apart, beyond the range of the int time of the basic models,
+ * operations are internal events
+ */
+template<typename value_t>
+std::size_t year_run() {
+  constexpr std::int64_t year = 365LL * 24 * 60 * 60 * 1000;
+  using model_t = second_ticker<value_t>;
+  cadmium::iadevs::engine::simulator<model_t> simulator{};
+  simulator.init(model_t::just_emitted, model_t::just_emitted);
+  typename model_t::time_t limit{};
+  limit.set_bounded(value_t{year}, true, value_t{year}, true);
+  const std::size_t events = simulator.run_until(limit);
+  bench::do_not_optimize(simulator.get_sim_state());
+  return events;
+}
+
+/**
+ * Simulates a single generator for the hours given, operations are internal events
+ */
+template<typename simulator_t>
+std::size_t simulate(simulator_t &sg, int hours) {
+  generator::time_t limit{};
+  limit.set_bounded(hours * ms_per_hour, true, hours * ms_per_hour, true);
+  sg.init(generator::just_emitted, generator::time_t{0, true, 0, true});
+  const auto events = sg.run_until(limit);
+  bench::do_not_optimize(events);
+  return events;
+}
+
+/**
+ * Simulates uncoupled generators with the coordinator for the hours given, operations are component transitions
+ */
+std::size_t coordinate(std::size_t generators, int hours) {
+  coordinator_t c;
+  for (std::size_t k = 0; k < generators; ++k) {
+    c.add_component(generator{}, generator::just_emitted);
+  }
+  c.init(generator::time_t{0, true, 0, true});
+  const int limit = hours * ms_per_hour;
+  std::size_t transitions = 0;
+  while (!c.t_next().is_empty() && c.t_next().get_upper_endpoint_value() <= limit) {
+    transitions += c.step();
+  }
+  bench::do_not_optimize(transitions);
+  return transitions;
+}
+
+// Four generators with different phases reporting to a counter, declared as a type
+using counted_generators = cadmium::iadevs::engine::static_coupled<
+    cadmium::iadevs::engine::component_list<generator, generator, generator, generator,
+                                            cadmium::iadevs::basic_models::counter>,
+    cadmium::iadevs::engine::coupling_list<
+        cadmium::iadevs::engine::internal_coupling<0, 4>, cadmium::iadevs::engine::internal_coupling<1, 4>,
+        cadmium::iadevs::engine::internal_coupling<2, 4>, cadmium::iadevs::engine::internal_coupling<3, 4>>>;
+
+generator::state_t phase_of(int k) {
+  generator::state_t phase{};
+  phase.set_bounded(k * 100, true, k * 100, true);
+  return phase;
+}
+
+/**
+ * Simulates counted_generators with the static or the dynamic coordinator for the hours given,
+ * operations are component transitions
+ */
+std::size_t coordinate_static(int hours) {
+  using counter = cadmium::iadevs::basic_models::counter;
+  cadmium::iadevs::engine::static_coordinator<counted_generators> c;
+  c.init(generator::time_t{0, true, 0, true}, phase_of(0), phase_of(1), phase_of(2), phase_of(3),
+         counter::state_t{counter::no_time, counter::no_time});
+  const int limit = hours * ms_per_hour;
+  std::size_t transitions = 0;
+  while (!c.t_next().is_empty() && c.t_next().get_upper_endpoint_value() <= limit) {
+    transitions += c.step();
+  }
+  bench::do_not_optimize(transitions);
+  return transitions;
+}
+
+std::size_t coordinate_dynamic(int hours) {
+  using counter = cadmium::iadevs::basic_models::counter;
+  coordinator_t c;
+  std::vector<std::size_t> ids;
+  for (int k = 0; k < 4; ++k) {
+    ids.push_back(c.add_component(generator{}, phase_of(k)));
+  }
+  const auto n = c.add_component(counter{}, counter::state_t{counter::no_time, counter::no_time});
+  for (auto id : ids) {
+    c.add_coupling(id, n);
+  }
+  c.init(generator::time_t{0, true, 0, true});
+  const int limit = hours * ms_per_hour;
+  std::size_t transitions = 0;
+  while (!c.t_next().is_empty() && c.t_next().get_upper_endpoint_value() <= limit) {
+    transitions += c.step();
+  }
+  bench::do_not_optimize(transitions);
+  return transitions;
+}
+
+/**
+ * Simulates generators with different phases as independent runs of an ensemble for the hours given,
+ * operations are internal events
+ */
+std::size_t sweep(std::size_t runs, int hours, cadmium::iadevs::engine::thread_pool *pool) {
+  using ensemble_t = cadmium::iadevs::engine::ensemble<generator>;
+  std::vector<ensemble_t::initial_condition> initial(runs);
+  for (std::size_t k = 0; k < runs; ++k) {
+    const int phase = static_cast<int>(k % 997);
+    initial[k].state.set_bounded(phase, true, phase, true);
+    initial[k].time.set_bounded(0, true, 0, true);
+  }
+  ensemble_t e;
+  e.set_thread_pool(pool);
+  generator::time_t limit{};
+  limit.set_bounded(hours * ms_per_hour, true, hours * ms_per_hour, true);
+  const auto summary = e.run(std::span(initial), limit, cadmium::iadevs::engine::ensemble_summary<generator>{});
+  bench::do_not_optimize(summary.events);
+  return summary.events;
+}
+
+/**
+ * Simulates generators with different phases for the hours given, each with its own simulator or
+ * all of them in a simulator pool, operations are internal events
+ */
+std::size_t separate_simulators(std::size_t generators, int hours) {
+  std::vector<cadmium::iadevs::engine::simulator<generator>> simulators(generators);
+  for (std::size_t k = 0; k < generators; ++k) {
+    generator::state_t phase{};
+    phase.set_bounded(static_cast<int>(k % 997), true, static_cast<int>(k % 997), true);
+    simulators[k].init(phase, generator::time_t{0, true, 0, true});
+  }
+  generator::time_t limit{};
+  limit.set_bounded(hours * ms_per_hour, true, hours * ms_per_hour, true);
+  std::size_t events = 0;
+  for (auto &s : simulators) {
+    events += s.run_until(limit);
+  }
+  bench::do_not_optimize(events);
+  return events;
+}
+
+std::size_t pooled_simulators(std::size_t generators, int hours) {
+  cadmium::iadevs::engine::simulator_pool<generator> pool;
+  pool.reserve(generators);
+  for (std::size_t k = 0; k < generators; ++k) {
+    generator::state_t phase{};
+    phase.set_bounded(static_cast<int>(k % 997), true, static_cast<int>(k % 997), true);
+    pool.add(phase, generator::time_t{0, true, 0, true});
+  }
+  generator::time_t limit{};
+  limit.set_bounded(hours * ms_per_hour, true, hours * ms_per_hour, true);
+  const auto events = pool.run_until(limit);
+  bench::do_not_optimize(events);
+  return events;
+}
+
+/**
+ * JSON definition of stations of generators reporting to a counter, whose reports are counted by a total counter
+ */
+std::string stations_definition(std::size_t stations, std::size_t generators) {
+  std::string json = R"({"components": [)";
+  std::string couplings;
+  for (std::size_t s = 0; s < stations; ++s) {
+    const auto station = "s" + std::to_string(s);
+    json += R"({"name": ")" + station + R"(", "components": [)";
+    std::string station_couplings;
+    for (std::size_t g = 0; g < generators; ++g) {
+      const auto name = "g" + std::to_string(g);
+      json += R"({"name": ")" + name + R"(", "type": "generator"}, )";
+      station_couplings += R"({"from": ")" + name + R"(", "to": "n"}, )";
+    }
+    json += R"({"name": "n", "type": "counter"}], "couplings": [)" + station_couplings + R"({"from": "n"}]}, )";
+    couplings += R"({"from": ")" + station + R"(", "to": "total"}, )";
+  }
+  json += R"({"name": "total", "type": "counter"}], "couplings": [)" + couplings + R"({"from": "total"}]})";
+  return json;
+}
+
+/**
+ * Loads a coupled model definition into its flat form, operations are atomic components
+ */
+std::size_t load(const std::string &definition) {
+  const auto model = cadmium::iadevs::engine::coupled_model_loader::load(definition);
+  bench::do_not_optimize(model.size());
+  return model.size();
+}
+
+/**
+ * Simulates a wide coupled model, where thousands of generators fire together and feed a few counters,
+ * serially or on a thread pool, operations are component transitions
+ */
+std::size_t coordinate_wide(cadmium::iadevs::engine::thread_pool *pool) {
+  constexpr std::size_t generators = 20'000;
+  constexpr std::size_t counters = 100;
+  constexpr int limit = 100'000;
+  coordinator_t c;
+  for (std::size_t k = 0; k < counters; ++k) {
+    c.add_component(counter{}, counter::state_t{counter::no_time, counter::no_time});
+  }
+  for (std::size_t k = 0; k < generators; ++k) {
+    c.add_coupling(c.add_component(generator{}, generator::just_emitted), k % counters);
+  }
+  c.set_thread_pool(pool);
+  c.init(generator::time_t{0, true, 0, true});
+  std::size_t transitions = 0;
+  while (!c.t_next().is_empty() && c.t_next().get_upper_endpoint_value() <= limit) {
+    transitions += c.step();
+  }
+  bench::do_not_optimize(transitions);
+  return transitions;
+}
+
+/**
+ * Simulates partitions of generators feeding a local counter, the first generator of each also feeding the
+ * counter of the next partition, with the parallel root coordinator serially or on a thread pool.
+ * Operations are events.
+ */
+cadmium::iadevs::engine::window_stats partition(cadmium::iadevs::engine::thread_pool *pool) {
+  constexpr std::size_t partitions = 16;
+  constexpr std::size_t generators = 1'000;
+  constexpr generator::time_t limit{100'000, true, 100'000, true};
+  cadmium::iadevs::engine::parallel_root_coordinator<generator::time_t, generator::output_t> root;
+  std::vector<std::size_t> counters;
+  std::vector<std::size_t> first_generators;
+  for (std::size_t p = 0; p < partitions; ++p) {
+    root.add_partition();
+    counters.push_back(root.add_component(p, counter{}, counter::state_t{counter::no_time, counter::no_time}));
+    for (std::size_t k = 0; k < generators; ++k) {
+      // Phases spread the emissions, so partitions do not all meet at every imminent time
+      const int elapsed = static_cast<int>(k % 7) * 50;
+      generator::state_t phase{};
+      phase.set_bounded(elapsed, true, elapsed, true);
+      const auto id = root.add_component(p, generator{}, phase);
+      root.add_coupling(id, counters[p]);
+      if (k == 0) {
+        first_generators.push_back(id);
+      }
+    }
+  }
+  for (std::size_t p = 0; p + 1 < partitions; ++p) {
+    root.add_coupling(first_generators[p], counters[p + 1]);
+  }
+  root.set_thread_pool(pool);
+  root.init(generator::time_t{0, true, 0, true});
+  root.run_until(limit);
+  return root.stats();
+}
+
+/**
+ * @return events per second of the simulator event loop, to compare with the target
+ */
+double simulator_benchmark(std::vector<bench::result> &results) {
+  cadmium::iadevs::engine::simulator<generator> sg{};
+  results.push_back(bench::measure_events("simulator, 1 generator, " + std::to_string(update_runs) + " runs of "
+                                              + std::to_string(events_per_run) + " events",
+                                          simulator_runs(sg), [&] { simulator_runs(sg); }));
+  return 1e9 / results.back().ns_per_op;
+}
+
+void macro_benchmarks(std::vector<bench::result> &results) {
+  results.push_back(bench::measure_events("simulator, year of events, interval<int64_t>", year_run<std::int64_t>(),
+                                          [] { year_run<std::int64_t>(); }));
+  results.push_back(bench::measure_events("simulator, year of events, saturating time_interval<std::milli>",
+                                          year_run<cadmium::iadevs::sim_time<std::milli>>(),
+                                          [] { year_run<cadmium::iadevs::sim_time<std::milli>>(); }));
+  // The int millisecond time of the generator bounds simulations to 596 hours
+  constexpr int simulator_hours = 500;
+  const auto simulator_name = "simulator, 1 generator, " + std::to_string(simulator_hours) + " hours";
+  cadmium::iadevs::engine::simulator<generator> sg{};
+  results.push_back(bench::measure_events(simulator_name, simulate(sg, simulator_hours),
+                                          [&] { simulate(sg, simulator_hours); }));
+  // The cost of instrumentation, without it the simulator runs the same code as before it was instrumented
+  cadmium::iadevs::engine::simulator<generator, cadmium::iadevs::engine::counting_instrumentation> instrumented{};
+  results.push_back(bench::measure_events(simulator_name + ", instrumented", simulate(instrumented, simulator_hours),
+                                          [&] { simulate(instrumented, simulator_hours); }));
+  struct configuration {
+    std::size_t generators;
+    int hours;
+  };
+  for (const auto [generators, hours] : {configuration{10, 168}, configuration{1'000, 1}}) {
+    results.push_back(bench::measure_events("coordinator, " + std::to_string(generators) + " generators, "
+                                                + std::to_string(hours) + " hours",
+                                            coordinate(generators, hours), [=] { coordinate(generators, hours); }));
+  }
+  results.push_back(bench::measure_events("coordinator, 4 generators and a counter, 168 hours",
+                                          coordinate_dynamic(168), [] { coordinate_dynamic(168); }));
+  results.push_back(bench::measure_events("static_coordinator, 4 generators and a counter, 168 hours",
+                                          coordinate_static(168), [] { coordinate_static(168); }));
+  constexpr std::size_t pooled = 10'000;
+  results.push_back(bench::measure_events("simulators, " + std::to_string(pooled) + " generators, 1 hours",
+                                          separate_simulators(pooled, 1), [] { separate_simulators(pooled, 1); }));
+  results.push_back(bench::measure_events("simulator_pool, " + std::to_string(pooled) + " generators, 1 hours",
+                                          pooled_simulators(pooled, 1), [] { pooled_simulators(pooled, 1); }));
+  constexpr std::size_t runs = 10'000;
+  cadmium::iadevs::engine::thread_pool pool;
+  for (auto *p : {static_cast<cadmium::iadevs::engine::thread_pool *>(nullptr), &pool}) {
+    const auto threads = p ? std::to_string(p->size()) + " threads" : std::string("serial");
+    results.push_back(bench::measure_events("ensemble, " + std::to_string(runs) + " generators, 1 hours, " + threads,
+                                            sweep(runs, 1, p), [=] { sweep(runs, 1, p); }));
+  }
+  for (auto *p : {static_cast<cadmium::iadevs::engine::thread_pool *>(nullptr), &pool}) {
+    const auto threads = p ? std::to_string(p->size()) + " threads" : std::string("serial");
+    results.push_back(bench::measure_events("coordinator, 20000 generators firing together, 100 seconds, " + threads,
+                                            coordinate_wide(p), [=] { coordinate_wide(p); }));
+  }
+  for (auto *p : {static_cast<cadmium::iadevs::engine::thread_pool *>(nullptr), &pool}) {
+    const auto threads = p ? std::to_string(p->size()) + " threads" : std::string("serial");
+    const auto stats = partition(p);
+    auto r = bench::measure_events("parallel_root_coordinator, 16 chained partitions of 1000 generators, 100 seconds, "
+                                       + threads,
+                                   stats.events, [=] { partition(p); });
+    r.metrics = {{"windows", static_cast<double>(stats.windows)},
+                 {"imminent_steps", static_cast<double>(stats.imminent_steps)},
+                 {"mean_parallelism", stats.mean_parallelism()},
+                 {"max_active_partitions", static_cast<double>(stats.max_active_partitions)}};
+    results.push_back(std::move(r));
+  }
+  const auto definition = stations_definition(1'000, 999);
+  results.push_back(bench::measure("coupled_model_loader, 1000001 components, "
+                                       + std::to_string(definition.size() >> 20) + " MiB",
+                                   load(definition), [&] { load(definition); }));
+}
+}
+
+int main(int argc, char **argv) {
+  constexpr std::string_view target_option = "--simulator-target=";
+  bool json = false;
+  double target = default_simulator_target;
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view argument(argv[i]);
+    if (argument == "--json") {
+      json = true;
+    } else if (argument.starts_with(target_option)) {
+      target = std::atof(argv[i] + target_option.size());
+    } else {
+      std::cerr << "usage: " << argv[0] << " [--json] [" << target_option << "<events/sec>]" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  std::vector<bench::result> results;
+  interval_benchmarks(results);
+  model_benchmarks(results);
+  scheduler_benchmarks(results);
+  update_benchmarks(results);
+  const double events_per_sec = simulator_benchmark(results);
+  macro_benchmarks(results);
+  if (json) {
+    bench::report_json(results, std::cout);
+  } else {
+    for (const auto &r : results) {
+      bench::report(r);
+    }
+  }
+  if (events_per_sec < target) {
+    std::cerr << "simulator throughput " << events_per_sec << " events/sec is below the target of " << target
+              << " events/sec" << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,146 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+/**
+ * Minimal timing harness of the benchmark suite.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace cadmium::iadevs::benchmark {
+
+/**
+ * Prevents the compiler from discarding the computation of value
+ */
+template<typename T>
+inline void do_not_optimize(const T &value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/**
+ * Counts the calls to the global operator new of the process, defined in allocation_counter.cpp
+ * @return the number of allocations since the process started
+ */
+std::size_t allocation_count() noexcept;
+
+// Measured calls of a benchmark body, after the warm-up one
+constexpr std::size_t default_repetitions = 5;
+
+struct result {
+  std::string name;
+  std::size_t operations;
+  double ns_per_op;
+  double allocations_per_op;
+  // The operations are simulation events, reported as events/sec
+  bool events = false;
+  std::size_t repetitions = 1;
+  // Other figures of the run, reported by name
+  std::vector<std::pair<std::string, double>> metrics;
+};
+
+/**
+ * Runs body once to warm up and then repetitions times measured, reporting the median of the measured calls
+ * @param name the name to report
+ * @param operations how many operations a call to body performs
+ * @param body the code to measure
+ * @param repetitions the number of measured calls
+ */
+template<typename F>
+result measure(const std::string &name, std::size_t operations, F &&body,
+               std::size_t repetitions = default_repetitions) {
+  body();
+  std::vector<double> ns(std::max<std::size_t>(repetitions, 1));
+  std::vector<double> allocated(ns.size());
+  for (std::size_t k = 0; k < ns.size(); ++k) {
+    const auto allocations = allocation_count();
+    const auto start = std::chrono::steady_clock::now();
+    body();
+    const auto end = std::chrono::steady_clock::now();
+    allocated[k] = static_cast<double>(allocation_count() - allocations);
+    ns[k] = std::chrono::duration<double, std::nano>(end - start).count();
+  }
+  const auto median = [](std::vector<double> &samples) {
+    std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+    return samples[samples.size() / 2];
+  };
+  const auto ops = static_cast<double>(operations);
+  return result{name, operations, median(ns) / ops, median(allocated) / ops, false, ns.size(), {}};
+}
+
+/**
+ * Measures a body whose operations are simulation events
+ */
+template<typename F>
+result measure_events(const std::string &name, std::size_t events, F &&body,
+                      std::size_t repetitions = default_repetitions) {
+  auto r = measure(name, events, std::forward<F>(body), repetitions);
+  r.events = true;
+  return r;
+}
+
+inline void report(const result &r) {
+  std::cout << r.name << ": " << r.ns_per_op << " ns/op, " << r.allocations_per_op << " allocs/op over "
+            << r.operations << " operations, median of " << r.repetitions;
+  for (const auto &[metric, value] : r.metrics) {
+    std::cout << ", " << metric << ": " << value;
+  }
+  std::cout << std::endl;
+}
+
+/**
+ * Writes the results as a JSON document, one object per result under "benchmarks"
+ */
+inline void report_json(const std::vector<result> &results, std::ostream &out) {
+  out << "{\n  \"benchmarks\": [";
+  const char *separator = "\n";
+  for (const auto &r : results) {
+    out << separator << "    {\"name\": \"";
+    for (char c : r.name) {
+      if (c == '"' || c == '\\') {
+        out << '\\';
+      }
+      out << c;
+    }
+    out << "\", \"operations\": " << r.operations << ", \"repetitions\": " << r.repetitions
+        << ", \"ns_per_op\": " << r.ns_per_op << ", \"allocations_per_op\": " << r.allocations_per_op;
+    if (r.events) {
+      out << ", \"events_per_sec\": " << 1e9 / r.ns_per_op;
+    }
+    for (const auto &[metric, value] : r.metrics) {
+      out << ", \"" << metric << "\": " << value;
+    }
+    out << "}";
+    separator = ",\n";
+  }
+  out << "\n  ]\n}" << std::endl;
+}
+}
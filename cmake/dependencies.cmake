@@ -1,2 +1,3 @@
 find_package(SQLiteCpp CONFIG REQUIRED)
 find_package(cppzmq CONFIG REQUIRED)
+find_package(nlohmann_json CONFIG REQUIRED)
@@ -0,0 +1,30 @@
+# Generates and builds a simulation worker executable for an atomic model
+#   iadevs_add_simulator_worker(<target>
+#       MODEL_HEADER <header including the model>
+#       MODEL_TYPE <fully qualified model type>
+#       [CODEC_TYPE <codec for the model state, time, output and input types>])
+# The codec defaults to the interval codec, enough for models using intervals for all their types.
+function(iadevs_add_simulator_worker target)
+    cmake_parse_arguments(PARSE_ARGV 1 WORKER "" "MODEL_HEADER;MODEL_TYPE;CODEC_TYPE" "")
+    if (NOT WORKER_MODEL_HEADER OR NOT WORKER_MODEL_TYPE)
+        message(FATAL_ERROR "iadevs_add_simulator_worker requires MODEL_HEADER and MODEL_TYPE")
+    endif ()
+    if (NOT WORKER_CODEC_TYPE)
+        set(WORKER_CODEC_TYPE cadmium::iadevs::interval_codec)
+    endif ()
+    set(IADEVS_WORKER_MODEL_HEADER ${WORKER_MODEL_HEADER})
+    set(IADEVS_WORKER_MODEL_TYPE ${WORKER_MODEL_TYPE})
+    set(IADEVS_WORKER_CODEC_TYPE ${WORKER_CODEC_TYPE})
+    configure_file(
+            ${PROJECT_SOURCE_DIR}/resources/iadevs_simulator_worker.cpp.in
+            ${CMAKE_CURRENT_BINARY_DIR}/${target}.cpp
+            @ONLY
+    )
+    add_executable(${target} ${CMAKE_CURRENT_BINARY_DIR}/${target}.cpp)
+    target_link_libraries(
+            ${target}
+            PRIVATE
+            ia_devs_cd_lib
+            cppzmq
+    )
+endfunction()
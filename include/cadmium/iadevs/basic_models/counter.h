@@ -0,0 +1,135 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <cadmium/iadevs/utils/ia_interval.h>
+
+#include <cstddef>
+#include <functional>
+#include <span>
+
+namespace cadmium::iadevs::basic_models {
+/**
+ * This is a simple implementation of a UA Counter model.
+ * It counts the inputs received and reports the count every 1000 milliseconds.
+ * As the generator, its IA functions are deterministic and MAY be cached by the simulator.
+ */
+struct counter {
+  using count_t = cadmium::iadevs::interval<int>;
+  // The time is defined as a set of integers representing ms (no unit support yet)
+  using time_t = cadmium::iadevs::interval<int>;
+  // The state tracks the inputs counted and the time elapsed since the last report
+  struct state_t {
+    count_t count;
+    time_t elapsed;
+    constexpr bool operator==(const state_t &) const = default;
+  };
+  // Any value received is counted, the values themselves are ignored
+  using input_t = cadmium::iadevs::interval<int>;
+  // The output is the count reported
+  using output_t = count_t;
+  static constexpr time_t report_period{1000, true, 1000, true};
+  static constexpr time_t no_time{0, true, 0, true};
+
+  /**
+   * @param state is the interval of partial states for the time_advance calculation
+   * @return the time left until the next report
+   */
+  constexpr time_t bounded_time_advance_i(const state_t &state) const {
+    return report_period - state.elapsed;
+  }
+
+  /**
+   * After reporting, the count is kept and the elapsed time restarts from zero
+   */
+  constexpr state_t internal_transition_i(const state_t &state) const {
+    return state_t{state.count, no_time};
+  }
+
+  /**
+   * Adds the number of inputs received to the count
+   * @param state is the interval of partial states before the inputs arrived
+   * @param elapsed is the time elapsed since the last event
+   * @param inputs the bag of inputs received
+   * @return the interval of partial states after counting the inputs
+   */
+  constexpr state_t external_transition_i(const state_t &state, const time_t &elapsed,
+                                          std::span<const input_t> inputs) const {
+    const int received = static_cast<int>(inputs.size());
+    count_t increment{};
+    increment.set_bounded(received, true, received, true);
+    return state_t{state.count + increment, state.elapsed + elapsed};
+  }
+
+  /**
+   * Inputs received at the time of a report are counted after reporting
+   */
+  constexpr state_t confluent_transition_i(const state_t &state, std::span<const input_t> inputs) const {
+    return external_transition_i(internal_transition_i(state), no_time, inputs);
+  }
+
+  /**
+   * @return the interval of counts reported
+   */
+  constexpr output_t output_i(const state_t &state) const {
+    return state.count;
+  }
+
+  /**
+   * @return the interval of partial states containing both, counts and elapsed times are merged independently
+   */
+  constexpr state_t state_hull_i(const state_t &a, const state_t &b) const {
+    return state_t{a.count.hull(b.count), a.elapsed.hull(b.elapsed)};
+  }
+
+  /**
+   * @return whether some partial state is in both intervals of partial states
+   */
+  constexpr bool states_overlap_i(const state_t &a, const state_t &b) const {
+    return !a.count.intersect(b.count).is_empty() && !a.elapsed.intersect(b.elapsed).is_empty();
+  }
+
+  constexpr time_t time_bound_add(const time_t &t1, const time_t &t2) const {
+    return t1 + t2;
+  }
+
+  constexpr time_t time_bound_subtract(const time_t &t1, const time_t &t2) const {
+    return t1 - t2;
+  }
+};
+}
+
+/**
+ * Hash of counter states, to allow caching the counter functions
+ */
+template<>
+struct std::hash<cadmium::iadevs::basic_models::counter::state_t> {
+  std::size_t operator()(const cadmium::iadevs::basic_models::counter::state_t &s) const noexcept {
+    return cadmium::iadevs::detail::hash_combine(
+        std::hash<cadmium::iadevs::basic_models::counter::count_t>{}(s.count),
+        std::hash<cadmium::iadevs::basic_models::counter::time_t>{}(s.elapsed));
+  }
+};
@@ -26,8 +26,12 @@
 #pragma once
 
 #include <cadmium/iadevs/utils/ia_interval.h>
+#include <cadmium/iadevs/utils/ia_interval_codec.h>
 
-#include<string>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <vector>
 
 namespace cadmium::iadevs::basic_models {
 /**
@@ -39,13 +43,16 @@ namespace cadmium::iadevs::basic_models {
  * All IA functions have to return bounded results, including TA to be computable.
  */
 struct generator {
-  // The state is only tracks the time until next internal event is emitted
+  // The state only tracks the time elapsed since the last output was emitted
   using state_t = cadmium::iadevs::interval<int>;
   // The time is defined as a set of integers representing ms (no unit support yet)
   using time_t = cadmium::iadevs::interval<int>;
-  //At this point I'm only implementing what is required to make Simulator.init
-  //function work end to end.
-  //TODO: add everything else.
+  // The output is the value emitted, 1 or 2
+  using output_t = cadmium::iadevs::interval<int>;
+  // The time between outputs, validated at compile time
+  static constexpr time_t output_period{997, true, 1005, true};
+  static constexpr output_t output_values{1, true, 2, true};
+  static constexpr state_t just_emitted{0, true, 0, true};
   //Ref: UA-DEVS paper section 6.1
   //Function init(initstate q, R^+_I t)→ void
   //state =q_state
@@ -63,33 +70,66 @@ struct generator {
    * @param state is the interval of partial states for the time_advance calculation
    * @return
    */
-  time_t bounded_time_advance_i(const state_t &state) const {
-    time_t l{};
-    l.set_bounded(997, true, 1005, true);
-    return l - state;
+  constexpr time_t bounded_time_advance_i(const state_t &state) const {
+    return output_period - state;
+  }
+
+  /**
+   * After emitting, the time elapsed since the last output restarts from zero
+   * @param state is the interval of partial states before the internal event
+   * @return the interval of partial states after the internal event
+   */
+  constexpr state_t internal_transition_i(const state_t &) const {
+    return just_emitted;
+  }
+
+  /**
+   * @param state is the interval of partial states before the internal event
+   * @return the interval of values emitted
+   */
+  constexpr output_t output_i(const state_t &) const {
+    return output_values;
+  }
+
+  /**
+   * Every time advance after a transition is the full output period
+   * @return the interval whose lower endpoint bounds every time advance from below
+   */
+  constexpr time_t lookahead_i() const {
+    return output_period;
   }
 
   // The simulator needs to call this function to apply the proper bounded addition when
-  time_t time_bound_t_add_time_advance(const state_t &state, const time_t &t) const {
+  constexpr time_t time_bound_t_add_time_advance(const state_t &state, const time_t &t) const {
     return time_bound_add(t, bounded_time_advance_i(state));
   }
 
-  time_t time_bound_add(const time_t &t1, const time_t &t2) const {
+  constexpr time_t time_bound_add(const time_t &t1, const time_t &t2) const {
     return t1 + t2;
   }
 
-  time_t time_bound_t_subtract_time_advance(const time_t &t1, const time_t &t2) const {
+  constexpr time_t time_bound_subtract(const time_t &t1, const time_t &t2) const {
+    return t1 - t2;
+  }
+
+  constexpr time_t time_bound_t_subtract_time_advance(const time_t &t1, const time_t &t2) const {
     return t1 - t2;
   }
 
-  //serialize : to enable caching
-  std::string serialize_time_interval(const time_t &t) const {
-    return "[0,0]";
+  //serialize : to enable caching, the bytes can be used directly as a cache key
+  std::vector<std::byte> serialize_time_interval(const time_t &t) const {
+    std::vector<std::byte> bytes;
+    interval_codec::encode(t, bytes);
+    return bytes;
   }
 
   //deserialize : to enable cache read
-  time_t deserialize_time_interval(const std::string &t) const {
-    return time_t{};
+  time_t deserialize_time_interval(std::span<const std::byte> bytes) const {
+    time_t t;
+    if (!interval_codec::decode(bytes, t)) {
+      throw std::invalid_argument("The bytes are not an encoded time interval");
+    }
+    return t;
   }
 };
 }
@@ -25,12 +25,101 @@
 
 #pragma once
 #include<concepts>
+#include<cstddef>
+#include<span>
+#include<vector>
 
 namespace cadmium::iadevs {
 
+/**
+ * An IA-DEVS atomic model type: it has no external inputs unless it also
+ * satisfies has_external_transition.
+ */
+template<typename T>
+concept is_atomic = requires(T a, typename T::state_t s, typename T::time_t t) {
+  typename T::output_t;
+  { a.bounded_time_advance_i(s) } -> std::convertible_to<typename T::time_t>;
+  { a.internal_transition_i(s) } -> std::convertible_to<typename T::state_t>;
+  { a.output_i(s) } -> std::convertible_to<typename T::output_t>;
+  { a.time_bound_add(t, t) } -> std::convertible_to<typename T::time_t>;
+};
+
+/**
+ * An IA-DEVS atomic model type receiving bags of inputs.
+ * Both the external and the confluent transitions are required.
+ */
+template<typename T>
+concept has_external_transition = is_atomic<T>
+    && requires(T a, typename T::state_t s, typename T::time_t t, std::span<const typename T::input_t> x) {
+  { a.external_transition_i(s, t, x) } -> std::convertible_to<typename T::state_t>;
+  { a.confluent_transition_i(s, x) } -> std::convertible_to<typename T::state_t>;
+  { a.time_bound_subtract(t, t) } -> std::convertible_to<typename T::time_t>;
+};
+
+/**
+ * An IA-DEVS atomic model declaring a lookahead: after any transition its time advance is never
+ * smaller than the lower endpoint of lookahead_i, so it cannot produce an output sooner than that.
+ */
+template<typename T>
+concept has_lookahead = is_atomic<T> && requires(const T a) {
+  { a.lookahead_i() } -> std::convertible_to<typename T::time_t>;
+};
+
+/**
+ * An IA-DEVS atomic model able to over-approximate two intervals of partial states by a single one.
+ * state_hull_i returns an interval of partial states containing both, and states_overlap_i tells
+ * whether two intervals of partial states share some partial state.
+ */
+template<typename T>
+concept has_state_hull = is_atomic<T> && requires(const T a, const typename T::state_t s) {
+  { a.state_hull_i(s, s) } -> std::convertible_to<typename T::state_t>;
+  { a.states_overlap_i(s, s) } -> std::convertible_to<bool>;
+};
+
+/**
+ * An IA-DEVS atomic model whose states can be merged: either it declares state_hull_i, or its
+ * states are intervals themselves, merged by their hull.
+ */
+template<typename T>
+concept is_mergeable = has_state_hull<T> || (is_atomic<T> && requires(const typename T::state_t s) {
+  { s.hull(s) } -> std::convertible_to<typename T::state_t>;
+  { s.intersect(s).is_empty() } -> std::convertible_to<bool>;
+});
+
+/**
+ * Batch versions of the IA functions of an atomic model, called by the engine with the states of
+ * many instances of the model at once, eg. by simulator_pool. Each writes the result for every state
+ * into the output span of the same size, and must match calling the scalar version on each state.
+ * Models declaring them can vectorize their numeric code, the engine falls back to a loop over the
+ * scalar version for the functions a model does not declare.
+ */
+template<typename T>
+concept has_batch_time_advance = is_atomic<T>
+    && requires(const T a, std::span<const typename T::state_t> s, std::span<typename T::time_t> t) {
+  a.bounded_time_advance_i(s, t);
+};
+
+template<typename T>
+concept has_batch_internal_transition = is_atomic<T>
+    && requires(const T a, std::span<const typename T::state_t> s, std::span<typename T::state_t> next) {
+  a.internal_transition_i(s, next);
+};
+
 template<typename T>
-concept is_atomic = requires(T a, typename T::state_t t) {
-  { a.bounded_time_advance_i(t) } -> std::convertible_to<typename T::time_t>;
+concept has_batch_output = is_atomic<T>
+    && requires(const T a, std::span<const typename T::state_t> s, std::span<typename T::output_t> o) {
+  a.output_i(s, o);
+};
+
+/**
+ * Serialization of the values exchanged with caches and workers.
+ * A codec encodes equal values into equal bytes, eg. interval_codec for intervals.
+ */
+template<typename codec_t, typename value_t>
+concept is_codec_for = requires(const value_t &v, value_t &out, std::vector<std::byte> &bytes,
+                                std::span<const std::byte> view) {
+  { codec_t::encode(v, bytes) };
+  { codec_t::decode(view, out) } -> std::convertible_to<bool>;
 };
 
-}
\ No newline at end of file
+}
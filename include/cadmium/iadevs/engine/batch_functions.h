@@ -0,0 +1,86 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <cadmium/iadevs/concepts.h>
+
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+
+namespace cadmium::iadevs::engine {
+
+/**
+ * Calls the IA functions of a model on many states at once, through the batch version when the
+ * model declares it, see has_batch_time_advance, and through the scalar version for each state
+ * otherwise.
+ * @throw std::invalid_argument if the output span does not have the size of the states span
+ */
+template<typename model_t> requires cadmium::iadevs::is_atomic<model_t>
+void batch_time_advance(const model_t &model, std::span<const typename model_t::state_t> states,
+                        std::span<typename model_t::time_t> advances) {
+  if (states.size() != advances.size()) {
+    throw std::invalid_argument("Batch spans have different sizes");
+  }
+  if constexpr (cadmium::iadevs::has_batch_time_advance<model_t>) {
+    model.bounded_time_advance_i(states, advances);
+  } else {
+    for (std::size_t k = 0; k < states.size(); ++k) {
+      advances[k] = model.bounded_time_advance_i(states[k]);
+    }
+  }
+}
+
+template<typename model_t> requires cadmium::iadevs::is_atomic<model_t>
+void batch_internal_transition(const model_t &model, std::span<const typename model_t::state_t> states,
+                               std::span<typename model_t::state_t> next_states) {
+  if (states.size() != next_states.size()) {
+    throw std::invalid_argument("Batch spans have different sizes");
+  }
+  if constexpr (cadmium::iadevs::has_batch_internal_transition<model_t>) {
+    model.internal_transition_i(states, next_states);
+  } else {
+    for (std::size_t k = 0; k < states.size(); ++k) {
+      next_states[k] = model.internal_transition_i(states[k]);
+    }
+  }
+}
+
+template<typename model_t> requires cadmium::iadevs::is_atomic<model_t>
+void batch_output(const model_t &model, std::span<const typename model_t::state_t> states,
+                  std::span<typename model_t::output_t> outputs) {
+  if (states.size() != outputs.size()) {
+    throw std::invalid_argument("Batch spans have different sizes");
+  }
+  if constexpr (cadmium::iadevs::has_batch_output<model_t>) {
+    model.output_i(states, outputs);
+  } else {
+    for (std::size_t k = 0; k < states.size(); ++k) {
+      outputs[k] = model.output_i(states[k]);
+    }
+  }
+}
+}
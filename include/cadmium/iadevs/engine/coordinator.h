@@ -0,0 +1,462 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <cadmium/iadevs/concepts.h>
+#include <cadmium/iadevs/engine/coupling_graph.h>
+#include <cadmium/iadevs/engine/scheduler.h>
+#include <cadmium/iadevs/engine/simulator.h>
+#include <cadmium/iadevs/engine/thread_pool.h>
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace cadmium::iadevs::engine {
+
+/**
+ * A component of a coupled model as seen by its coordinator.
+ * Components of different model types exchange a single message type, and share the time type.
+ * @tparam time_t the time interval type
+ * @tparam message_t the type of the values exchanged through couplings
+ */
+template<typename time_t, typename message_t>
+struct component {
+  virtual ~component() = default;
+
+  virtual void init(const time_t &time) = 0;
+  [[nodiscard]] virtual const time_t &t_next() const = 0;
+  [[nodiscard]] virtual const time_t &t_last() const = 0;
+  [[nodiscard]] virtual bool accepts_inputs() const = 0;
+
+  /**
+   * Computes the output for the next internal event
+   * @return the output, valid until the next call to output
+   */
+  virtual const message_t &output() = 0;
+  virtual void internal_transition() = 0;
+  virtual void external_transition(const time_t &time, std::span<const message_t> inputs) = 0;
+  virtual void confluent_transition(std::span<const message_t> inputs) = 0;
+};
+
+/**
+ * Component simulating an atomic model with its own simulator
+ * @tparam model_t an atomic IA model, with output_t and input_t matching message_t
+ * @tparam message_t the type of the values exchanged through couplings
+ * @tparam instrumentation_t the policy recording the calls to the model
+ */
+template<typename model_t, typename message_t, typename instrumentation_t = no_instrumentation>
+requires cadmium::iadevs::is_atomic<model_t> && std::same_as<typename model_t::output_t, message_t>
+struct atomic_component final : component<typename model_t::time_t, message_t> {
+  using time_t = typename model_t::time_t;
+  using state_t = typename model_t::state_t;
+
+  atomic_component(model_t model, state_t initial_state)
+      : _simulator(std::move(model)), _initial_state(std::move(initial_state)) {}
+
+  void init(const time_t &time) override {
+    _simulator.init(_initial_state, time);
+  }
+
+  [[nodiscard]] const time_t &t_next() const override {
+    return _simulator.get_sim_state().t_next;
+  }
+
+  [[nodiscard]] const time_t &t_last() const override {
+    return _simulator.get_sim_state().t_last;
+  }
+
+  [[nodiscard]] bool accepts_inputs() const override {
+    return cadmium::iadevs::has_external_transition<model_t>;
+  }
+
+  const message_t &output() override {
+    return _simulator.output();
+  }
+
+  void internal_transition() override {
+    _simulator.internal_transition();
+  }
+
+  void external_transition(const time_t &time, std::span<const message_t> inputs) override {
+    if constexpr (cadmium::iadevs::has_external_transition<model_t>) {
+      _simulator.external_transition(time, inputs);
+    } else {
+      throw std::logic_error("The model does not receive inputs");
+    }
+  }
+
+  void confluent_transition(std::span<const message_t> inputs) override {
+    if constexpr (cadmium::iadevs::has_external_transition<model_t>) {
+      _simulator.confluent_transition(inputs);
+    } else {
+      throw std::logic_error("The model does not receive inputs");
+    }
+  }
+
+  [[nodiscard]] const simulator<model_t, instrumentation_t> &get_simulator() const {
+    return _simulator;
+  }
+
+private:
+  simulator<model_t, instrumentation_t> _simulator;
+  state_t _initial_state;
+};
+
+/**
+ * A value leaving a coupled model through an output coupling
+ */
+template<typename time_t, typename message_t>
+struct coupled_output {
+  // The component emitting the value
+  std::size_t from;
+  // The time of the event the value was emitted at
+  time_t time;
+  message_t value;
+};
+
+/**
+ * Coordinator of a coupled model of atomic components
+ * Imminent components fire together at the next event time of the coupled model, the
+ * intersection of their t_next, which is never empty as all of them reach the earliest
+ * upper endpoint. All of them compute their output, outputs are routed through the couplings,
+ * and then imminent components apply their internal or confluent transition while receivers
+ * apply the external one.
+ * Inputs of the coupled model are injected with their time, and take part in the step they
+ * are imminent in as if they were the output of a component.
+ * With a thread pool set, the outputs and the transitions of a step run in parallel. Each
+ * component keeps its own output and inbox, and routing walks the imminent components in
+ * id order, so results are identical to the serial run for any number of threads.
+ * @tparam time_t the time interval type
+ * @tparam message_t the type of the values exchanged through couplings
+ * @tparam instrumentation_t the policy recording the calls to the models of the atomic components
+ */
+template<typename time_t, typename message_t, typename instrumentation_t = no_instrumentation>
+struct coordinator {
+  using component_t = component<time_t, message_t>;
+  using output_t = coupled_output<time_t, message_t>;
+
+  /**
+   * Adds an atomic component simulating model
+   * @param model the model instance
+   * @param initial_state the state the component starts in on init
+   * @return the id of the component
+   */
+  template<typename model_t>
+  std::size_t add_component(model_t model, typename model_t::state_t initial_state) {
+    _components.push_back(std::make_unique<atomic_component<model_t, message_t, instrumentation_t>>(
+        std::move(model), std::move(initial_state)));
+    return _components.size() - 1;
+  }
+
+  /**
+   * Couples the output of a component to the input of another
+   * @throw std::out_of_range if any component does not exist
+   * @throw std::invalid_argument if the destination does not receive inputs
+   */
+  void add_coupling(std::size_t from, std::size_t to) {
+    if (from >= _components.size() || to >= _components.size()) {
+      throw std::out_of_range("Coupling refers to a component that does not exist");
+    }
+    if (!_components[to]->accepts_inputs()) {
+      throw std::invalid_argument("Coupling to a component that does not receive inputs");
+    }
+    _couplings.push_back(coupling{from, to});
+  }
+
+  /**
+   * Couples the output of a component to the output of the coupled model,
+   * its values are collected in outputs()
+   * @throw std::out_of_range if the component does not exist
+   */
+  void add_output_coupling(std::size_t from) {
+    if (from >= _components.size()) {
+      throw std::out_of_range("Coupling refers to a component that does not exist");
+    }
+    _output_couplings.push_back(from);
+  }
+
+  /**
+   * Runs steps on the given pool, nullptr runs them on the calling thread.
+   * The pool must outlive the coordinator or be replaced before.
+   */
+  void set_thread_pool(thread_pool *pool) noexcept {
+    _pool = pool;
+  }
+
+  /**
+   * Initializes every component and builds the routing tables, components and couplings
+   * cannot be added afterwards.
+   * @param time the initial time
+   */
+  void init(const time_t &time) {
+    _graph = coupling_graph(_components.size(), _couplings);
+    _inboxes.assign(_components.size(), {});
+    _is_imminent.assign(_components.size(), 0);
+    _is_output.assign(_components.size(), 0);
+    for (auto from : _output_couplings) {
+      _is_output[from] = 1;
+    }
+    _inputs.clear();
+    _free_inputs.clear();
+    _outputs.clear();
+    _scheduler = scheduler<time_t>{};
+    _scheduler.reserve(_components.size());
+    for (std::size_t id = 0; id < _components.size(); ++id) {
+      _components[id]->init(time);
+      _scheduler.schedule(id, _components[id]->t_next());
+    }
+  }
+
+  /**
+   * Schedules an input of the coupled model, received by a component at the given time
+   * @param to the component receiving the value
+   * @param time the time the value is received, not certainly before the last event executed
+   * @param value the value received
+   * @throw std::invalid_argument if the component does not receive inputs
+   */
+  void inject(std::size_t to, const time_t &time, message_t value) {
+    if (!_components.at(to)->accepts_inputs()) {
+      throw std::invalid_argument("Input to a component that does not receive inputs");
+    }
+    std::size_t slot = _inputs.size();
+    if (_free_inputs.empty()) {
+      _inputs.push_back(pending_input{to, std::move(value)});
+    } else {
+      slot = _free_inputs.back();
+      _free_inputs.pop_back();
+      _inputs[slot] = pending_input{to, std::move(value)};
+    }
+    // Pending inputs are scheduled after the component ids
+    _scheduler.schedule(_components.size() + slot, time);
+  }
+
+  /**
+   * @return the time the next event happens in, empty if all components are passive
+   * and no input is pending
+   */
+  [[nodiscard]] time_t t_next() const noexcept {
+    return _scheduler.t_next();
+  }
+
+  /**
+   * Values emitted through output couplings since the last clear, in emission order.
+   * The caller is expected to clear them after reading.
+   */
+  [[nodiscard]] std::vector<output_t> &outputs() noexcept {
+    return _outputs;
+  }
+
+  /**
+   * Executes the next event of the coupled model
+   * @return the number of components that changed state
+   */
+  std::size_t step() {
+    return end_step(begin_step(_scheduler.t_next()));
+  }
+
+  /**
+   * First phase of an event, run by itself when the coupled model is a partition of a larger one whose
+   * components fire together: selects the components imminent with respect to the earliest t_next among
+   * all of them, computes their outputs and routes them through the couplings. Values emitted through
+   * output couplings are collected in outputs(), and values from other partitions are received next.
+   * @param earliest a time whose upper endpoint is the smallest among the t_next of every component
+   * taking part, the time of any partition with the smallest one
+   * @return the intersection of the t_next of the imminent components and pending inputs, empty if
+   * none is imminent
+   */
+  time_t begin_step(const time_t &earliest) {
+    _imminent.clear();
+    _scheduler.imminent(_imminent, earliest);
+    std::sort(_imminent.begin(), _imminent.end());
+    time_t time{};
+    if (!_imminent.empty()) {
+      time = _scheduler.get_t_next(_imminent.front());
+      for (auto id : _imminent) {
+        time = time.intersect(_scheduler.get_t_next(id));
+      }
+    }
+    // Component ids sort before pending inputs
+    _imminent_components = static_cast<std::size_t>(
+        std::lower_bound(_imminent.begin(), _imminent.end(), _components.size()) - _imminent.begin());
+    _output_values.resize(_imminent_components);
+    for_each(_imminent_components, [this](std::size_t k) {
+      _output_values[k] = &_components[_imminent[k]]->output();
+    });
+
+    _active.assign(_imminent.begin(), _imminent.begin() + _imminent_components);
+    for (std::size_t k = 0; k < _imminent_components; ++k) {
+      _is_imminent[_imminent[k]] = 1;
+    }
+    _step_outputs = _outputs.size();
+    for (std::size_t k = 0; k < _imminent_components; ++k) {
+      const auto from = _imminent[k];
+      for (auto to : _graph.destinations(from)) {
+        deliver(to, *_output_values[k]);
+      }
+      if (_is_output[from]) {
+        _outputs.push_back(output_t{from, time, *_output_values[k]});
+      }
+    }
+    for (std::size_t k = _imminent_components; k < _imminent.size(); ++k) {
+      const std::size_t slot = _imminent[k] - _components.size();
+      deliver(_inputs[slot].to, std::move(_inputs[slot].value));
+      _scheduler.remove(_imminent[k]);
+      _free_inputs.push_back(slot);
+    }
+    return time;
+  }
+
+  /**
+   * Receives a value from another partition in the event begun by begin_step, after the values
+   * routed inside the coupled model
+   * @param to the component receiving the value
+   * @param value the value received
+   * @throw std::invalid_argument if the component does not receive inputs
+   */
+  void receive(std::size_t to, message_t value) {
+    if (!_components.at(to)->accepts_inputs()) {
+      throw std::invalid_argument("Input to a component that does not receive inputs");
+    }
+    deliver(to, std::move(value));
+  }
+
+  /**
+   * Last phase of an event: imminent components apply their internal or confluent transition while
+   * receivers apply the external one. Values emitted in the event and still in outputs() get its time.
+   * @param time the time of the event, the intersection of the times begin_step returned for every
+   * partition taking part
+   * @return the number of components that changed state
+   */
+  std::size_t end_step(const time_t &time) {
+    for (std::size_t k = _step_outputs; k < _outputs.size(); ++k) {
+      _outputs[k].time = time;
+    }
+    const std::size_t components = _imminent_components;
+    for_each(_active.size(), [this, components, &time](std::size_t k) {
+      const auto id = _active[k];
+      auto &c = *_components[id];
+      if (k >= components) {
+        c.external_transition(time, _inboxes[id]);
+      } else if (_inboxes[id].empty()) {
+        c.internal_transition();
+      } else {
+        c.confluent_transition(_inboxes[id]);
+      }
+    });
+    for (auto id : _active) {
+      _scheduler.schedule(id, _components[id]->t_next());
+      _inboxes[id].clear();
+      _is_imminent[id] = 0;
+    }
+    return _active.size();
+  }
+
+  /**
+   * Executes events while the next event time is certainly not after time,
+   * this is, while its upper endpoint is not greater than the time lower endpoint.
+   * @param time the time to simulate up to
+   * @return the number of events executed
+   */
+  std::size_t run_until(const time_t &time) {
+    std::size_t events = 0;
+    while (!_scheduler.empty() && detail::is_certainly_not_after(_scheduler.t_next(), time)) {
+      step();
+      ++events;
+    }
+    return events;
+  }
+
+  [[nodiscard]] std::size_t size() const noexcept {
+    return _components.size();
+  }
+
+  [[nodiscard]] const component_t &get_component(std::size_t id) const {
+    return *_components.at(id);
+  }
+
+  /**
+   * @return the simulator of an atomic component
+   * @throw std::bad_cast if the component does not simulate a model_t
+   */
+  template<typename model_t>
+  [[nodiscard]] const simulator<model_t, instrumentation_t> &get_simulator(std::size_t id) const {
+    return dynamic_cast<const atomic_component<model_t, message_t, instrumentation_t> &>(*_components.at(id))
+        .get_simulator();
+  }
+
+private:
+  struct pending_input {
+    std::size_t to;
+    message_t value;
+  };
+
+  std::vector<std::unique_ptr<component_t>> _components;
+  std::vector<coupling> _couplings;
+  std::vector<std::size_t> _output_couplings;
+  coupling_graph _graph;
+  scheduler<time_t> _scheduler;
+  thread_pool *_pool = nullptr;
+  std::vector<pending_input> _inputs;
+  std::vector<std::size_t> _free_inputs;
+  std::vector<output_t> _outputs;
+  // Per step storage, kept across steps to avoid allocations
+  std::vector<std::vector<message_t>> _inboxes;
+  std::vector<std::uint8_t> _is_imminent;
+  std::vector<std::uint8_t> _is_output;
+  std::vector<std::size_t> _imminent;
+  std::vector<const message_t *> _output_values;
+  std::vector<std::size_t> _active;
+  // Imminent components of the current step, and its first value in outputs()
+  std::size_t _imminent_components = 0;
+  std::size_t _step_outputs = 0;
+
+  template<typename value_t>
+  void deliver(std::size_t to, value_t &&value) {
+    if (_inboxes[to].empty() && !_is_imminent[to]) {
+      _active.push_back(to);
+    }
+    _inboxes[to].push_back(std::forward<value_t>(value));
+  }
+
+  template<typename F>
+  void for_each(std::size_t count, F &&body) {
+    if (_pool) {
+      _pool->parallel_for(count, std::forward<F>(body));
+    } else {
+      for (std::size_t k = 0; k < count; ++k) {
+        body(k);
+      }
+    }
+  }
+};
+}
@@ -0,0 +1,417 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <cadmium/iadevs/engine/coupling_graph.h>
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace cadmium::iadevs::engine {
+
+/**
+ * A coupled model flattened into its atomic components, ready to be simulated.
+ * Components are numbered depth first and described by contiguous arrays: their full names,
+ * the names of their coupled models and their own joined by '.', and the index of their type.
+ * Couplings through nested coupled models are resolved into couplings between atomic components,
+ * kept in compressed sparse row form so routing an output walks its destinations only.
+ */
+struct flat_coupled_model {
+  [[nodiscard]] std::size_t size() const noexcept {
+    return _types.size();
+  }
+
+  /**
+   * @return the full name of the component, valid while the model is alive
+   */
+  [[nodiscard]] std::string_view name(std::size_t id) const noexcept {
+    return std::string_view(_names).substr(_name_offsets[id], _name_offsets[id + 1] - _name_offsets[id]);
+  }
+
+  /**
+   * @return the index of the atomic model type of the component in type_names
+   */
+  [[nodiscard]] std::size_t type(std::size_t id) const noexcept {
+    return _types[id];
+  }
+
+  /**
+   * The atomic model types used, in order of first use
+   */
+  [[nodiscard]] std::span<const std::string> type_names() const noexcept {
+    return _type_names;
+  }
+
+  [[nodiscard]] const coupling_graph &graph() const noexcept {
+    return _graph;
+  }
+
+  /**
+   * The components receiving the inputs of the model, through its input couplings
+   */
+  [[nodiscard]] std::span<const std::size_t> inputs() const noexcept {
+    return _inputs;
+  }
+
+  /**
+   * The components whose outputs leave the model, through its output couplings
+   */
+  [[nodiscard]] std::span<const std::size_t> outputs() const noexcept {
+    return _outputs;
+  }
+
+private:
+  friend struct coupled_model_loader;
+
+  std::string _names;
+  std::vector<std::size_t> _name_offsets{0};
+  std::vector<std::uint32_t> _types;
+  std::vector<std::string> _type_names;
+  coupling_graph _graph;
+  std::vector<std::size_t> _inputs;
+  std::vector<std::size_t> _outputs;
+};
+
+/**
+ * Loads coupled models defined in JSON, validating the definition and flattening it.
+ * A coupled model is an object with its "components" array and an optional "couplings" array,
+ * and a "name" for nested ones. Components are atomic models, with a "name" and a "type",
+ * or nested coupled models. Couplings are objects with the names of the components they go
+ * "from" and "to" in the same coupled model: without "from" it is an input coupling of the
+ * coupled model, and without "to" an output coupling.
+ * Atomic models have a single input and output in this engine, so couplings have no ports,
+ * and Z-functions are the identity.
+ * <pre>
+ * {"components": [
+ *   {"name": "station", "components": [{"name": "g", "type": "generator"}, {"name": "n", "type": "counter"}],
+ *    "couplings": [{"from": "g", "to": "n"}, {"from": "n"}]},
+ *   {"name": "total", "type": "counter"}],
+ *  "couplings": [{"from": "station", "to": "total"}]}
+ * </pre>
+ */
+struct coupled_model_loader {
+  /**
+   * @param json the JSON definition of the coupled model
+   * @return the model flattened
+   * @throw std::invalid_argument if the text is not valid JSON or does not define a valid coupled model:
+   * unknown members, missing or mistyped members, empty, duplicate or dotted component names,
+   * couplings to unknown components or to their own source, or duplicate couplings
+   */
+  static flat_coupled_model load(const std::string &json) {
+    nlohmann::json root;
+    try {
+      root = nlohmann::json::parse(json);
+    } catch (const nlohmann::json::parse_error &e) {
+      throw std::invalid_argument(std::string("Invalid JSON: ") + e.what());
+    }
+    coupled_model_loader loader;
+    if (!root.is_object()) {
+      throw std::invalid_argument("The coupled model must be an object");
+    }
+    check_members(root, {"name", "components", "couplings"}, "the definition", {}, {});
+    loader._model._types.reserve(count_atomics(root));
+    loader._model._name_offsets.reserve(loader._model._types.capacity() + 1);
+    std::string path;
+    const auto endpoints = loader.load_coupled(root, path);
+    auto &model = loader._model;
+    model._inputs.assign(loader._targets.begin() + endpoints.targets_begin, loader._targets.end());
+    model._outputs.assign(loader._sources.begin() + endpoints.sources_begin, loader._sources.end());
+    model._graph = coupling_graph(model._types.size(), loader._couplings);
+    return std::move(loader._model);
+  }
+
+private:
+  // Where the sources and targets of a component start in the shared endpoint stacks
+  struct endpoints_t {
+    std::size_t sources_begin;
+    std::size_t sources_end;
+    std::size_t targets_begin;
+    std::size_t targets_end;
+  };
+
+  using names_t = std::vector<std::pair<std::string_view, std::size_t>>;
+  using kind_t = nlohmann::json::value_t;
+
+  flat_coupled_model _model;
+  std::vector<coupling> _couplings;
+  std::unordered_map<std::string_view, std::uint32_t> _type_ids;
+  // Atomic components producing the outputs and receiving the inputs of the components being loaded
+  std::vector<std::size_t> _sources;
+  std::vector<std::size_t> _targets;
+
+  // Messages are built on failure only, checks run for every component
+  static void check_kind(const nlohmann::json &value, kind_t kind, const char *what, const std::string &path) {
+    if (value.type() != kind) {
+      const char *expected = kind == kind_t::array ? " must be an array" : " must be objects";
+      throw std::invalid_argument(what + describe(path) + expected);
+    }
+  }
+
+  static void check_members(const nlohmann::json &value, std::initializer_list<std::string_view> allowed,
+                            const char *what, std::string_view name, const std::string &path) {
+    for (const auto &[key, member] : value.items()) {
+      bool known = false;
+      for (auto allowed_key : allowed) {
+        known = known || key == allowed_key;
+      }
+      if (!known) {
+        const auto named = name.empty() ? std::string() : " '" + std::string(name) + "'";
+        throw std::invalid_argument("Unknown member '" + key + "' in " + what + named + " of " + describe(path));
+      }
+    }
+  }
+
+  static std::string describe(const std::string &path) {
+    return path.empty() ? std::string("the root model") : "'" + path.substr(0, path.size() - 1) + "'";
+  }
+
+  /**
+   * @return the member of an object with the key given, nullptr if it has none
+   */
+  static const nlohmann::json *member(const nlohmann::json &object, std::string_view key) {
+    const auto it = object.find(key);
+    return it == object.end() ? nullptr : &*it;
+  }
+
+  static std::string_view as_string(const nlohmann::json &value) {
+    return value.get_ref<const std::string &>();
+  }
+
+  // Upper bound of the atomic components, the components of every coupled model, to size the arrays once
+  static std::size_t count_atomics(const nlohmann::json &coupled) {
+    std::size_t count = 0;
+    if (const auto components = member(coupled, "components"); components && components->is_array()) {
+      for (const auto &component : *components) {
+        const bool nested = component.is_object() && member(component, "components");
+        count += nested ? count_atomics(component) : 1;
+      }
+    }
+    return count;
+  }
+
+  /**
+   * Loads the components of a coupled model and resolves its couplings.
+   * Its sources and targets are left on top of the endpoint stacks.
+   * @param path the names of the coupled models down to this one, each followed by '.'
+   */
+  endpoints_t load_coupled(const nlohmann::json &coupled, std::string &path) {
+    const auto components = member(coupled, "components");
+    if (!components || !components->is_array()) {
+      throw std::invalid_argument("Missing components array in " + describe(path));
+    }
+    // The endpoints of the components are stacked from here, and replaced by those of the model at the end
+    const auto sources_begin = _sources.size();
+    const auto targets_begin = _targets.size();
+    // Names are sorted to look components up, node based maps would allocate for each component
+    names_t index_of;
+    index_of.reserve(components->size());
+    std::vector<endpoints_t> children;
+    children.reserve(components->size());
+    for (const auto &component : *components) {
+      check_kind(component, kind_t::object, "Components of ", path);
+      const auto name = component_name(component, path);
+      index_of.emplace_back(name, children.size());
+      children.push_back(load_component(component, name, path));
+    }
+    std::sort(index_of.begin(), index_of.end());
+    const auto duplicate = std::adjacent_find(index_of.begin(), index_of.end(),
+                                              [](const auto &a, const auto &b) { return a.first == b.first; });
+    if (duplicate != index_of.end()) {
+      throw std::invalid_argument("Duplicate component '" + std::string(duplicate->first) + "' in " + describe(path));
+    }
+
+    std::vector<std::size_t> own_sources;
+    std::vector<std::size_t> own_targets;
+    const auto couplings = member(coupled, "couplings");
+    if (couplings) {
+      check_kind(*couplings, kind_t::array, "Couplings of ", path);
+      // Input and output couplings of the model are keyed with the component count as the missing side
+      std::vector<std::uint64_t> seen;
+      seen.reserve(couplings->size());
+      const auto outside = children.size();
+      for (const auto &c : *couplings) {
+        check_kind(c, kind_t::object, "Couplings of ", path);
+        check_members(c, {"from", "to"}, "a coupling", {}, path);
+        const auto from = coupling_end(c, "from", index_of, path);
+        const auto to = coupling_end(c, "to", index_of, path);
+        const std::size_t f = from.value_or(outside);
+        const std::size_t t = to.value_or(outside);
+        if (f == outside && t == outside) {
+          throw std::invalid_argument("Coupling of " + describe(path) + " has neither from nor to");
+        }
+        if (f == t) {
+          throw std::invalid_argument("Coupling of " + describe(path) + " from a component to itself");
+        }
+        seen.push_back(static_cast<std::uint64_t>(f) * (outside + 1) + t);
+        if (t == outside) {
+          const auto &source = children[f];
+          own_sources.insert(own_sources.end(), _sources.begin() + source.sources_begin,
+                             _sources.begin() + source.sources_end);
+        } else if (f == outside) {
+          const auto &target = children[t];
+          own_targets.insert(own_targets.end(), _targets.begin() + target.targets_begin,
+                             _targets.begin() + target.targets_end);
+        } else {
+          const auto &source = children[f];
+          const auto &target = children[t];
+          for (auto s = source.sources_begin; s < source.sources_end; ++s) {
+            for (auto d = target.targets_begin; d < target.targets_end; ++d) {
+              _couplings.push_back(coupling{_sources[s], _targets[d]});
+            }
+          }
+        }
+      }
+      std::sort(seen.begin(), seen.end());
+      if (std::adjacent_find(seen.begin(), seen.end()) != seen.end()) {
+        throw std::invalid_argument("Duplicate coupling in " + describe(path));
+      }
+    }
+    _sources.resize(sources_begin);
+    _targets.resize(targets_begin);
+    _sources.insert(_sources.end(), own_sources.begin(), own_sources.end());
+    _targets.insert(_targets.end(), own_targets.begin(), own_targets.end());
+    return endpoints_t{sources_begin, _sources.size(), targets_begin, _targets.size()};
+  }
+
+  endpoints_t load_component(const nlohmann::json &component, std::string_view name, std::string &path) {
+    const auto type = member(component, "type");
+    if (member(component, "components")) {
+      if (type) {
+        throw std::invalid_argument("Component '" + std::string(name) + "' in " + describe(path)
+                                    + " has both a type and components");
+      }
+      check_members(component, {"name", "components", "couplings"}, "component", name, path);
+      const auto length = path.size();
+      path.append(name).push_back('.');
+      const auto endpoints = load_coupled(component, path);
+      path.resize(length);
+      return endpoints;
+    }
+    if (!type || !type->is_string() || as_string(*type).empty()) {
+      throw std::invalid_argument("Component '" + std::string(name) + "' in " + describe(path)
+                                  + " has neither a type nor components");
+    }
+    check_members(component, {"name", "type"}, "component", name, path);
+    const auto id = _model._types.size();
+    // Looked up before inserting, as emplace allocates its node even for types already known
+    auto it = _type_ids.find(as_string(*type));
+    if (it == _type_ids.end()) {
+      it = _type_ids.emplace(as_string(*type), static_cast<std::uint32_t>(_model._type_names.size())).first;
+      _model._type_names.emplace_back(as_string(*type));
+    }
+    _model._types.push_back(it->second);
+    _model._names.append(path).append(name);
+    _model._name_offsets.push_back(_model._names.size());
+    _sources.push_back(id);
+    _targets.push_back(id);
+    return endpoints_t{_sources.size() - 1, _sources.size(), _targets.size() - 1, _targets.size()};
+  }
+
+  static std::string_view component_name(const nlohmann::json &component, const std::string &path) {
+    const auto name = member(component, "name");
+    if (!name || !name->is_string()) {
+      throw std::invalid_argument("Component without a name in " + describe(path));
+    }
+    const auto value = as_string(*name);
+    if (value.empty() || value.find('.') != std::string_view::npos) {
+      throw std::invalid_argument("Invalid component name '" + std::string(value) + "' in " + describe(path)
+                                  + ", names are not empty and have no '.'");
+    }
+    return value;
+  }
+
+  static std::optional<std::size_t> coupling_end(const nlohmann::json &c, std::string_view key,
+                                                 const names_t &index_of, const std::string &path) {
+    const auto end = member(c, key);
+    if (!end) {
+      return std::nullopt;
+    }
+    if (!end->is_string()) {
+      throw std::invalid_argument("Coupling ends of " + describe(path) + " must be component names");
+    }
+    const auto name = as_string(*end);
+    const auto it = std::lower_bound(index_of.begin(), index_of.end(), name,
+                                     [](const auto &entry, std::string_view wanted) { return entry.first < wanted; });
+    if (it == index_of.end() || it->first != name) {
+      throw std::invalid_argument("Coupling of " + describe(path) + " refers to unknown component '"
+                                  + std::string(name) + "'");
+    }
+    return it->second;
+  }
+};
+
+/**
+ * Adds the components and couplings of a flat model to a coordinator.
+ * The component with flat id k gets the id base + k, where base is the size of the coordinator before.
+ * @param c the coordinator, not initialized yet
+ * @param model the flat model
+ * @param factories maps each atomic model type name to a function called as factory(c, name) that adds
+ * exactly one component for the component with the full name given, looked up once per type
+ * @return base
+ * @throw std::invalid_argument if a type has no factory or a factory does not add a single component
+ */
+template<typename coordinator_t, typename factories_t>
+std::size_t populate(coordinator_t &c, const flat_coupled_model &model, const factories_t &factories) {
+  const std::size_t base = c.size();
+  std::vector<const typename factories_t::mapped_type *> factory_of;
+  factory_of.reserve(model.type_names().size());
+  for (const auto &type : model.type_names()) {
+    const auto it = factories.find(type);
+    if (it == factories.end()) {
+      throw std::invalid_argument("No factory for atomic model type '" + type + "'");
+    }
+    factory_of.push_back(&it->second);
+  }
+  for (std::size_t id = 0; id < model.size(); ++id) {
+    (*factory_of[model.type(id)])(c, model.name(id));
+    if (c.size() != base + id + 1) {
+      throw std::invalid_argument("The factory of '" + model.type_names()[model.type(id)]
+                                  + "' must add a single component");
+    }
+  }
+  for (std::size_t from = 0; from < model.size(); ++from) {
+    for (auto to : model.graph().destinations(from)) {
+      c.add_coupling(base + from, base + to);
+    }
+  }
+  for (auto from : model.outputs()) {
+    c.add_output_coupling(base + from);
+  }
+  return base;
+}
+}
@@ -0,0 +1,91 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace cadmium::iadevs::engine {
+
+/**
+ * A coupling from the output of a component to the input of another, by component ids
+ */
+struct coupling {
+  std::size_t from;
+  std::size_t to;
+  constexpr bool operator==(const coupling &) const = default;
+};
+
+/**
+ * Couplings of a coupled model in compressed sparse row form: the destinations of each
+ * component are contiguous, so routing the outputs of a component walks a single array.
+ * Destinations keep the order the couplings were given in.
+ */
+struct coupling_graph {
+  coupling_graph() = default;
+
+  /**
+   * @param components the number of components, ids go from 0 to components - 1
+   * @param couplings the couplings between components
+   * @throw std::out_of_range if a coupling refers to a component id out of range
+   */
+  coupling_graph(std::size_t components, std::span<const coupling> couplings)
+      : _offsets(components + 1, 0), _destinations(couplings.size()) {
+    for (const auto &c : couplings) {
+      if (c.from >= components || c.to >= components) {
+        throw std::out_of_range("Coupling refers to a component that does not exist");
+      }
+      ++_offsets[c.from + 1];
+    }
+    for (std::size_t id = 0; id < components; ++id) {
+      _offsets[id + 1] += _offsets[id];
+    }
+    std::vector<std::size_t> next(_offsets.begin(), _offsets.end() - 1);
+    for (const auto &c : couplings) {
+      _destinations[next[c.from]++] = c.to;
+    }
+  }
+
+  [[nodiscard]] std::size_t components() const noexcept {
+    return _offsets.empty() ? 0 : _offsets.size() - 1;
+  }
+
+  /**
+   * @param from a component id
+   * @return the ids of the components receiving the outputs of from
+   */
+  [[nodiscard]] std::span<const std::size_t> destinations(std::size_t from) const noexcept {
+    return {_destinations.data() + _offsets[from], _destinations.data() + _offsets[from + 1]};
+  }
+
+private:
+  std::vector<std::size_t> _offsets;
+  std::vector<std::size_t> _destinations;
+};
+}
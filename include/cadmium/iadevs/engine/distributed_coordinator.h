@@ -0,0 +1,810 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <cadmium/iadevs/concepts.h>
+#include <cadmium/iadevs/engine/coordinator.h>
+#include <cadmium/iadevs/engine/coupling_graph.h>
+#include <cadmium/iadevs/engine/lookahead_window.h>
+#include <cadmium/iadevs/engine/worker_protocol.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace cadmium::iadevs::engine {
+
+/**
+ * Operations a partition worker serves, first byte of each request frame
+ */
+enum class partition_op : std::uint8_t {
+  // Payload: time. Response: horizon
+  init = 1,
+  // A lookahead window. Payload: window of the partition, limit, input count (u32), inputs. Response: events (u32), horizon, output count (u32), outputs. Inputs are destination id (u32),
+  // time and value, outputs are source id (u32), time and value.
+  round = 2,
+  // Payload: component id (u32). Response: state
+  get_state = 3,
+  // Stops serving once the batch is answered. Response: empty
+  shutdown = 4,
+  // First phase of an imminent step. Payload: earliest next event time, input count (u32), inputs as in
+  // round. Response: time of the imminent components, output count (u32), outputs as source id (u32) and value.
+  begin_step = 5,
+  // Last phase of an imminent step. Payload: time of the step, input count (u32), inputs as destination id
+  // (u32) and value. Response: components changed (u32), horizon.
+  end_step = 6,
+};
+
+/**
+ * Encoding of the requests and responses of a partition worker, with the frame layouts of
+ * worker_batch. Component ids are the global ones, a horizon is encoded as its three intervals,
+ * and the round limit as a degenerate interval.
+ * @tparam time_t the time interval type
+ * @tparam message_t the type of the values exchanged through couplings
+ * @tparam codec_t serialization for time_t and message_t
+ */
+template<typename time_t, typename message_t, typename codec_t> requires cadmium::iadevs::is_codec_for<codec_t, time_t>
+    && cadmium::iadevs::is_codec_for<codec_t, message_t>
+struct partition_protocol {
+  static void add_init(worker_batch &batch, const time_t &time) {
+    batch.append_u8(static_cast<std::uint8_t>(partition_op::init));
+    append(batch, time);
+    batch.end_frame();
+  }
+
+  /**
+   * Starts a window request, the inputs are appended next and end_frame closes it
+   * @param window the window of the partition, see round_plan::windows
+   */
+  static void begin_round(worker_batch &batch, const round_plan<time_t> &plan, const time_t &window,
+                          std::uint32_t inputs) {
+    batch.append_u8(static_cast<std::uint8_t>(partition_op::round));
+    append(batch, window);
+    append(batch, time_t::from_packed(plan.limit, plan.limit, interval_flags::lower_closed | interval_flags::upper_closed));
+    batch.append_u32(inputs);
+  }
+
+  /**
+   * Starts a begin_step request, the inputs are appended next and end_frame closes it
+   */
+  static void begin_begin_step(worker_batch &batch, const time_t &earliest, std::uint32_t inputs) {
+    batch.append_u8(static_cast<std::uint8_t>(partition_op::begin_step));
+    append(batch, earliest);
+    batch.append_u32(inputs);
+  }
+
+  /**
+   * Starts an end_step request, the inputs are appended next and end_frame closes it
+   */
+  static void begin_end_step(worker_batch &batch, const time_t &time, std::uint32_t inputs) {
+    batch.append_u8(static_cast<std::uint8_t>(partition_op::end_step));
+    append(batch, time);
+    batch.append_u32(inputs);
+  }
+
+  static void add_get_state(worker_batch &batch, std::uint32_t id) {
+    batch.append_u8(static_cast<std::uint8_t>(partition_op::get_state));
+    batch.append_u32(id);
+    batch.end_frame();
+  }
+
+  static void add_shutdown(worker_batch &batch) {
+    batch.append_u8(static_cast<std::uint8_t>(partition_op::shutdown));
+    batch.end_frame();
+  }
+
+  static void append_horizon(worker_batch &batch, const partition_horizon<time_t> &horizon) {
+    append(batch, horizon.t_next);
+    append(batch, horizon.boundary_next);
+    append(batch, horizon.lookahead);
+  }
+
+  static bool read_horizon(worker_frame_reader &reader, partition_horizon<time_t> &horizon) {
+    return read(reader, horizon.t_next) && read(reader, horizon.boundary_next) && read(reader, horizon.lookahead);
+  }
+
+  static worker_status read_status(worker_frame_reader &reader) {
+    std::uint8_t status = 0;
+    if (!reader.read_u8(status) || status > static_cast<std::uint8_t>(worker_status::model_error)) {
+      return worker_status::malformed_request;
+    }
+    return static_cast<worker_status>(status);
+  }
+
+  template<typename value_t>
+  static void append(worker_batch &batch, const value_t &value) {
+    thread_local std::vector<std::byte> scratch;
+    codec_t::encode(value, scratch);
+    batch.append_value(scratch);
+  }
+
+  template<typename value_t>
+  static bool read(worker_frame_reader &reader, value_t &value) {
+    std::span<const std::byte> bytes;
+    return reader.read_value(bytes) && codec_t::decode(bytes, value);
+  }
+};
+
+/**
+ * Simulates a partition of a coupled model for a distributed_coordinator, usually in its own process
+ * served with serve_worker.
+ * The whole flattened model is described to every worker and to the coordinator with the same
+ * calls to add_component and add_coupling, so all of them agree on the global component ids, and
+ * each worker keeps only the components placed in its partition. Values leaving the partition are
+ * reported with their source id, values entering it are injected with their destination id.
+ * @tparam time_t the time interval type
+ * @tparam message_t the type of the values exchanged through couplings
+ * @tparam codec_t serialization for time_t, message_t and, to serve get_state, the model states
+ */
+template<typename time_t, typename message_t, typename codec_t>
+struct partition_worker {
+  using protocol_t = partition_protocol<time_t, message_t, codec_t>;
+  using coordinator_t = coordinator<time_t, message_t>;
+
+  /**
+   * @param partition the partition this worker simulates
+   */
+  explicit partition_worker(std::size_t partition) noexcept: _partition(partition) {}
+
+  /**
+   * Describes a component of the model, instantiated only if placed in this partition
+   * @return the global id of the component
+   */
+  template<typename model_t>
+  std::size_t add_component(std::size_t partition, model_t model, typename model_t::state_t initial_state) {
+    placement p{partition, 0, lookahead_of(model), false, false};
+    if (partition == _partition) {
+      p.local = _coordinator.add_component(std::move(model), std::move(initial_state));
+      _global_ids.push_back(_components.size());
+      _state_encoders.push_back(&encode_state<model_t>);
+    }
+    _components.push_back(p);
+    return _components.size() - 1;
+  }
+
+  /**
+   * Describes a coupling of the model, couplings between other partitions are only counted
+   * @throw std::out_of_range if any component does not exist
+   * @throw std::invalid_argument if the destination is in this partition and does not receive inputs
+   */
+  void add_coupling(std::size_t from, std::size_t to) {
+    auto &source = _components.at(from);
+    auto &destination = _components.at(to);
+    const bool local_source = source.partition == _partition;
+    const bool local_destination = destination.partition == _partition;
+    if (local_source && local_destination) {
+      _coordinator.add_coupling(source.local, destination.local);
+    } else if (local_source) {
+      if (!source.is_boundary) {
+        source.is_boundary = true;
+        _coordinator.add_output_coupling(source.local);
+      }
+    } else if (local_destination && !_coordinator.get_component(destination.local).accepts_inputs()) {
+      throw std::invalid_argument("Coupling to a component that does not receive inputs");
+    }
+    destination.has_inputs = true;
+  }
+
+  /**
+   * Answers a request, appending its response frame
+   * @param request the request frame
+   * @param responses the batch receiving the response frame
+   * @return the status of the response
+   */
+  worker_status handle(std::span<const std::byte> request, worker_batch &responses) {
+    worker_frame_reader reader(request);
+    std::uint8_t op = 0;
+    worker_status status = worker_status::malformed_request;
+    const std::size_t response_start = responses.offsets().back();
+    responses.append_u8(0);
+    if (reader.read_u8(op)) {
+      try {
+        status = dispatch(op, reader, responses);
+      } catch (...) {
+        status = worker_status::model_error;
+      }
+    }
+    if (status != worker_status::ok) {
+      responses.truncate_frame(response_start + 1);
+    }
+    responses.set_byte(response_start, static_cast<std::uint8_t>(status));
+    responses.end_frame();
+    return status;
+  }
+
+  /**
+   * @return true once a shutdown request was answered
+   */
+  [[nodiscard]] bool stopping() const noexcept {
+    return _stopping;
+  }
+
+  [[nodiscard]] std::size_t partition() const noexcept {
+    return _partition;
+  }
+
+  [[nodiscard]] const coordinator_t &get_coordinator() const noexcept {
+    return _coordinator;
+  }
+
+private:
+  struct placement {
+    std::size_t partition;
+    std::size_t local;
+    typename round_plan<time_t>::value_t lookahead;
+    bool has_inputs;
+    bool is_boundary;
+  };
+
+  struct received_input {
+    std::size_t local;
+    time_t time;
+    message_t value;
+  };
+
+  using state_encoder = bool (*)(const coordinator_t &, std::size_t, worker_batch &);
+
+  std::size_t _partition;
+  coordinator_t _coordinator;
+  std::vector<placement> _components;
+  // Global id and state encoder of each local component
+  std::vector<std::size_t> _global_ids;
+  std::vector<state_encoder> _state_encoders;
+  std::vector<boundary_component<time_t>> _boundary;
+  std::vector<received_input> _received;
+  bool _initialized = false;
+  bool _stopping = false;
+  // Between a begin_step and its end_step
+  bool _in_step = false;
+
+  template<typename model_t>
+  static bool encode_state(const coordinator_t &c, std::size_t local, worker_batch &responses) {
+    if constexpr (cadmium::iadevs::is_codec_for<codec_t, typename model_t::state_t>) {
+      protocol_t::append(responses, c.template get_simulator<model_t>(local).get_sim_state().state);
+      return true;
+    } else {
+      return false;
+    }
+  }
+
+  worker_status dispatch(std::uint8_t op, worker_frame_reader &reader, worker_batch &responses) {
+    switch (static_cast<partition_op>(op)) {
+      case partition_op::init: {
+        time_t time{};
+        if (!protocol_t::read(reader, time) || !reader.at_end()) {
+          return worker_status::malformed_request;
+        }
+        _boundary.clear();
+        for (const auto &c : _components) {
+          if (c.partition == _partition && c.is_boundary) {
+            _boundary.push_back(boundary_component<time_t>{c.local, c.lookahead, c.has_inputs});
+          }
+        }
+        _coordinator.init(time);
+        _initialized = true;
+        _in_step = false;
+        protocol_t::append_horizon(responses, horizon());
+        return worker_status::ok;
+      }
+      case partition_op::round:
+        return _initialized ? round(reader, responses) : worker_status::unknown_instance;
+      case partition_op::begin_step:
+        return _initialized ? begin_step(reader, responses) : worker_status::unknown_instance;
+      case partition_op::end_step:
+        return _initialized ? end_step(reader, responses) : worker_status::unknown_instance;
+      case partition_op::get_state: {
+        std::uint32_t id = 0;
+        if (!reader.read_u32(id) || !reader.at_end() || !is_local(id)) {
+          return worker_status::malformed_request;
+        }
+        if (!_initialized) {
+          return worker_status::unknown_instance;
+        }
+        const auto local = _components[id].local;
+        return _state_encoders[local](_coordinator, local, responses) ? worker_status::ok : worker_status::model_error;
+      }
+      case partition_op::shutdown:
+        _stopping = true;
+        return worker_status::ok;
+      default:
+        return worker_status::unknown_operation;
+    }
+  }
+
+  worker_status round(worker_frame_reader &reader, worker_batch &responses) {
+    round_plan<time_t> plan;
+    plan.kind = round_kind::window;
+    time_t window{};
+    time_t limit{};
+    if (_in_step || !protocol_t::read(reader, window) || !protocol_t::read(reader, limit)
+        || limit.try_get_lower_endpoint_value(plan.limit) != interval_status::ok || !read_inputs(reader, true)) {
+      return worker_status::malformed_request;
+    }
+    for (auto &input : _received) {
+      _coordinator.inject(input.local, input.time, std::move(input.value));
+    }
+    const auto events = plan.execute(_coordinator, window);
+    responses.append_u32(static_cast<std::uint32_t>(events));
+    protocol_t::append_horizon(responses, horizon());
+    auto &outputs = _coordinator.outputs();
+    responses.append_u32(static_cast<std::uint32_t>(outputs.size()));
+    for (const auto &o : outputs) {
+      responses.append_u32(static_cast<std::uint32_t>(_global_ids[o.from]));
+      protocol_t::append(responses, o.time);
+      protocol_t::append(responses, o.value);
+    }
+    outputs.clear();
+    return worker_status::ok;
+  }
+
+  worker_status begin_step(worker_frame_reader &reader, worker_batch &responses) {
+    time_t earliest{};
+    if (_in_step || !protocol_t::read(reader, earliest) || !read_inputs(reader, true)) {
+      return worker_status::malformed_request;
+    }
+    for (auto &input : _received) {
+      _coordinator.inject(input.local, input.time, std::move(input.value));
+    }
+    const auto time = _coordinator.begin_step(earliest);
+    _in_step = true;
+    protocol_t::append(responses, time);
+    auto &outputs = _coordinator.outputs();
+    responses.append_u32(static_cast<std::uint32_t>(outputs.size()));
+    for (const auto &o : outputs) {
+      responses.append_u32(static_cast<std::uint32_t>(_global_ids[o.from]));
+      protocol_t::append(responses, o.value);
+    }
+    outputs.clear();
+    return worker_status::ok;
+  }
+
+  worker_status end_step(worker_frame_reader &reader, worker_batch &responses) {
+    time_t time{};
+    if (!_in_step || !protocol_t::read(reader, time) || !read_inputs(reader, false)) {
+      return worker_status::malformed_request;
+    }
+    for (auto &input : _received) {
+      _coordinator.receive(input.local, std::move(input.value));
+    }
+    _in_step = false;
+    responses.append_u32(static_cast<std::uint32_t>(_coordinator.end_step(time)));
+    protocol_t::append_horizon(responses, horizon());
+    return worker_status::ok;
+  }
+
+  // Decodes the inputs ending a request, with their time if timed. Decoded first, a malformed request
+  // leaves the partition untouched.
+  bool read_inputs(worker_frame_reader &reader, bool timed) {
+    std::uint32_t inputs = 0;
+    if (!reader.read_u32(inputs)) {
+      return false;
+    }
+    _received.clear();
+    for (std::uint32_t k = 0; k < inputs; ++k) {
+      std::uint32_t to = 0;
+      received_input input{};
+      if (!reader.read_u32(to) || !is_local(to) || (timed && !protocol_t::read(reader, input.time))
+          || !protocol_t::read(reader, input.value)) {
+        return false;
+      }
+      input.local = _components[to].local;
+      if (!_coordinator.get_component(input.local).accepts_inputs()) {
+        return false;
+      }
+      _received.push_back(std::move(input));
+    }
+    return reader.at_end();
+  }
+
+  [[nodiscard]] bool is_local(std::uint32_t id) const noexcept {
+    return id < _components.size() && _components[id].partition == _partition;
+  }
+
+  [[nodiscard]] partition_horizon<time_t> horizon() const {
+    return horizon_of(_coordinator, std::span<const boundary_component<time_t>>(_boundary));
+  }
+};
+
+/**
+ * Root coordinator of a coupled model split in partitions simulated by partition workers,
+ * possibly in other processes or hosts.
+ * Rounds are planned as in parallel_root_coordinator, from the horizon each partition reports
+ * after its previous round: lookahead windows, where each partition is bounded only by the interval
+ * lower endpoints of the next events of the partitions coupled into it, or imminent steps when no
+ * event is safe.
+ * A window is a single request per partition taking part in it, carrying its window and every value
+ * routed to the partition in the previous round, and its response carries every value the partition
+ * emitted towards others. An imminent step is two requests per partition with imminent components
+ * or coupled from one: begin_step reports the time of its imminent components and the values they
+ * emit, and end_step delivers the values routed to it in the same event, at the intersection of those
+ * times. Requests are sent to all partitions taking part before waiting for any response, so
+ * partitions execute their rounds concurrently. Values are routed in partition and emission order,
+ * so results are the ones of a parallel_root_coordinator.
+ * Values are forwarded as received, without decoding them.
+ * @tparam time_t the time interval type
+ * @tparam message_t the type of the values exchanged through couplings
+ * @tparam codec_t serialization for time_t, message_t and the states read with get_state
+ * @tparam client_t the connection to a worker: send(worker_batch &) sends a batch of requests, and
+ * receive(responses_t &) receives the responses of the oldest batch, eg. worker_client
+ */
+template<typename time_t, typename message_t, typename codec_t, typename client_t>
+struct distributed_coordinator {
+  using protocol_t = partition_protocol<time_t, message_t, codec_t>;
+  using responses_t = typename client_t::responses_t;
+  using window_record_t = window_record<time_t>;
+
+  /**
+   * @param client the connection to the worker simulating the new partition
+   * @return the id of the new partition
+   */
+  std::size_t add_partition(client_t client) {
+    _clients.push_back(std::move(client));
+    return _clients.size() - 1;
+  }
+
+  /**
+   * Describes a component of the model, simulated by the worker of its partition
+   * @return the global id of the component
+   * @throw std::out_of_range if the partition does not exist
+   */
+  template<typename model_t>
+  std::size_t add_component(std::size_t partition, const model_t &, const typename model_t::state_t &) {
+    if (partition >= _clients.size()) {
+      throw std::out_of_range("Component placed in a partition that does not exist");
+    }
+    _partition_of.push_back(partition);
+    return _partition_of.size() - 1;
+  }
+
+  /**
+   * Describes a coupling of the model, only couplings across partitions are routed here
+   * @throw std::out_of_range if any component does not exist
+   */
+  void add_coupling(std::size_t from, std::size_t to) {
+    if (from >= _partition_of.size() || to >= _partition_of.size()) {
+      throw std::out_of_range("Coupling refers to a component that does not exist");
+    }
+    if (_partition_of[from] != _partition_of[to]) {
+      _cross_couplings.push_back(coupling{from, to});
+    }
+  }
+
+  /**
+   * Initializes every partition, components and couplings cannot be added afterwards
+   * @param time the initial time
+   * @throw std::runtime_error if a worker fails or answers with a malformed response
+   */
+  void init(const time_t &time) {
+    const std::size_t partitions = _clients.size();
+    _cross = coupling_graph(_partition_of.size(), _cross_couplings);
+    _sources = sources_of(partitions, std::span<const coupling>(_cross_couplings),
+                          [this](std::size_t id) { return _partition_of[id]; });
+    _targets.assign(partitions, {});
+    for (std::size_t p = 0; p < partitions; ++p) {
+      for (auto q : _sources[p]) {
+        _targets[q].push_back(p);
+      }
+    }
+    _horizons.assign(partitions, partition_horizon<time_t>{});
+    _arrivals.assign(partitions, time_t{});
+    _pending.assign(partitions, worker_batch{});
+    _step_inputs.assign(partitions, worker_batch{});
+    _events.assign(partitions, 0);
+    _sent.assign(partitions, 0);
+    _stats = window_stats{};
+    _windows.clear();
+    for (auto &client : _clients) {
+      protocol_t::add_init(_request, time);
+      client.send(_request);
+    }
+    for (std::size_t p = 0; p < partitions; ++p) {
+      _clients[p].receive(_responses);
+      auto reader = response_reader("init");
+      if (!protocol_t::read_horizon(reader, _horizons[p]) || !reader.at_end()) {
+        throw std::runtime_error("Malformed init response from a partition worker");
+      }
+    }
+  }
+
+  /**
+   * Executes rounds while some partition has an event certainly not after time,
+   * this is, with an upper endpoint not greater than the time lower endpoint.
+   * @param time the time to simulate up to
+   * @return the number of events executed
+   * @throw std::runtime_error if a worker fails or answers with a malformed response
+   */
+  std::size_t run_until(const time_t &time) {
+    std::size_t events = 0;
+    while (true) {
+      _plan.next(_horizons, _sources, time);
+      if (_plan.kind == round_kind::none) {
+        break;
+      }
+      const bool imminent_step = _plan.kind == round_kind::imminent_step;
+      if (imminent_step) {
+        step_imminent(_plan.span);
+      } else {
+        run_window();
+      }
+      // An imminent step is a single event of the coupled model
+      std::size_t round_events = imminent_step ? 1 : 0;
+      std::size_t active = 0;
+      for (std::size_t p = 0; p < _clients.size(); ++p) {
+        round_events += imminent_step ? 0 : _events[p];
+        active += _events[p] != 0;
+        _horizons[p].t_next = detail::earliest_of(_horizons[p].t_next, _arrivals[p]);
+        _arrivals[p] = time_t{};
+      }
+      _windows.push_back(window_record_t{_plan.span, imminent_step, round_events, active});
+      _stats.record(imminent_step, round_events, active);
+      events += round_events;
+    }
+    return events;
+  }
+
+  /**
+   * @return the time the next event happens in: from the smallest lower endpoint to the smallest
+   * upper endpoint among partitions, empty if all of them are passive
+   */
+  [[nodiscard]] time_t t_next() const noexcept {
+    time_t next{};
+    for (const auto &h : _horizons) {
+      next = detail::earliest_of(next, h.t_next);
+    }
+    return next;
+  }
+
+  /**
+   * Reads the state of a component from the worker simulating it
+   * @throw std::out_of_range if the component does not exist
+   * @throw std::runtime_error if the worker cannot encode it
+   */
+  template<typename model_t> requires cadmium::iadevs::is_codec_for<codec_t, typename model_t::state_t>
+  [[nodiscard]] typename model_t::state_t get_state(std::size_t id) {
+    auto &client = _clients[_partition_of.at(id)];
+    protocol_t::add_get_state(_request, static_cast<std::uint32_t>(id));
+    client.send(_request);
+    client.receive(_responses);
+    auto reader = response_reader("get_state");
+    typename model_t::state_t state{};
+    if (!protocol_t::read(reader, state) || !reader.at_end()) {
+      throw std::runtime_error("Malformed get_state response from a partition worker");
+    }
+    return state;
+  }
+
+  /**
+   * Stops every worker, once they answered
+   */
+  void shutdown() {
+    for (auto &client : _clients) {
+      protocol_t::add_shutdown(_request);
+      client.send(_request);
+    }
+    for (auto &client : _clients) {
+      client.receive(_responses);
+    }
+  }
+
+  [[nodiscard]] const window_stats &stats() const noexcept {
+    return _stats;
+  }
+
+  /**
+   * @return the record of every round executed since init
+   */
+  [[nodiscard]] const std::vector<window_record_t> &windows() const noexcept {
+    return _windows;
+  }
+
+  [[nodiscard]] std::size_t size() const noexcept {
+    return _partition_of.size();
+  }
+
+  [[nodiscard]] std::size_t partitions() const noexcept {
+    return _clients.size();
+  }
+
+private:
+  std::vector<client_t> _clients;
+  std::vector<std::size_t> _partition_of;
+  std::vector<coupling> _cross_couplings;
+  coupling_graph _cross;
+  // For each partition, the partitions coupled into it, and the ones it is coupled into
+  std::vector<std::vector<std::size_t>> _sources;
+  std::vector<std::vector<std::size_t>> _targets;
+  std::vector<partition_horizon<time_t>> _horizons;
+  round_plan<time_t> _plan;
+  // Earliest value routed to each partition in the current round
+  std::vector<time_t> _arrivals;
+  // Values routed to each partition for its next round, a frame per value
+  std::vector<worker_batch> _pending;
+  // Values routed to each partition in the current imminent step, a frame per value
+  std::vector<worker_batch> _step_inputs;
+  std::vector<std::size_t> _events;
+  std::vector<std::uint8_t> _sent;
+  worker_batch _request;
+  responses_t _responses;
+  window_stats _stats;
+  std::vector<window_record_t> _windows;
+
+  // Reader past the status of the single response received, which must be ok
+  worker_frame_reader response_reader(const char *request) {
+    if (_responses.size() != 1) {
+      throw std::runtime_error(std::string("Unexpected response to ") + request + " from a partition worker");
+    }
+    worker_frame_reader reader(_responses.frame(0));
+    if (protocol_t::read_status(reader) != worker_status::ok) {
+      throw std::runtime_error(std::string("Partition worker failed to answer ") + request);
+    }
+    return reader;
+  }
+
+  void run_window() {
+    for (std::size_t p = 0; p < _clients.size(); ++p) {
+      const auto &window = _plan.windows[p];
+      _events[p] = 0;
+      _sent[p] = _plan.admits(_horizons[p].t_next, window) || _pending[p].size() != 0;
+      if (_sent[p]) {
+        protocol_t::begin_round(_request, _plan, window, static_cast<std::uint32_t>(_pending[p].size()));
+        send_pending(p);
+      }
+    }
+    for (std::size_t p = 0; p < _clients.size(); ++p) {
+      if (_sent[p]) {
+        _clients[p].receive(_responses);
+        receive_round(p);
+      }
+    }
+  }
+
+  // Fires the components imminent across all partitions: every partition with imminent components or coupled
+  // from one reports the time of its imminent components and the values they emit, and then receives the values
+  // routed to it with the time of the step. The other partitions have nothing to do in the step.
+  void step_imminent(const time_t &earliest) {
+    std::fill(_sent.begin(), _sent.end(), 0);
+    for (std::size_t p = 0; p < _clients.size(); ++p) {
+      _events[p] = 0;
+      if (!_horizons[p].t_next.is_empty() && !earliest.certainly_before(_horizons[p].t_next)) {
+        _sent[p] = 1;
+        for (auto q : _targets[p]) {
+          _sent[q] = 1;
+        }
+      }
+    }
+    for (std::size_t p = 0; p < _clients.size(); ++p) {
+      if (_sent[p]) {
+        protocol_t::begin_begin_step(_request, earliest, static_cast<std::uint32_t>(_pending[p].size()));
+        send_pending(p);
+      }
+    }
+    time_t time{};
+    for (std::size_t p = 0; p < _clients.size(); ++p) {
+      if (!_sent[p]) {
+        continue;
+      }
+      _clients[p].receive(_responses);
+      auto reader = response_reader("begin_step");
+      time_t imminent{};
+      std::uint32_t outputs = 0;
+      if (!protocol_t::read(reader, imminent) || !reader.read_u32(outputs)) {
+        throw std::runtime_error("Malformed begin_step response from a partition worker");
+      }
+      if (!imminent.is_empty()) {
+        time = time.is_empty() ? imminent : time.intersect(imminent);
+      }
+      for (std::uint32_t k = 0; k < outputs; ++k) {
+        std::uint32_t from = 0;
+        std::span<const std::byte> value_bytes;
+        if (!reader.read_u32(from) || from >= _partition_of.size() || !reader.read_value(value_bytes)) {
+          throw std::runtime_error("Malformed begin_step response from a partition worker");
+        }
+        for (auto to : _cross.destinations(from)) {
+          auto &inputs = _step_inputs[_partition_of[to]];
+          inputs.append_u32(static_cast<std::uint32_t>(to));
+          inputs.append_value(value_bytes);
+          inputs.end_frame();
+        }
+      }
+      if (!reader.at_end()) {
+        throw std::runtime_error("Malformed begin_step response from a partition worker");
+      }
+    }
+    for (std::size_t p = 0; p < _clients.size(); ++p) {
+      if (!_sent[p]) {
+        continue;
+      }
+      auto &inputs = _step_inputs[p];
+      protocol_t::begin_end_step(_request, time, static_cast<std::uint32_t>(inputs.size()));
+      for (std::size_t k = 0; k < inputs.size(); ++k) {
+        _request.append_bytes(inputs.frame(k));
+      }
+      _request.end_frame();
+      inputs.clear();
+      _clients[p].send(_request);
+    }
+    for (std::size_t p = 0; p < _clients.size(); ++p) {
+      if (!_sent[p]) {
+        continue;
+      }
+      _clients[p].receive(_responses);
+      auto reader = response_reader("end_step");
+      std::uint32_t changed = 0;
+      if (!reader.read_u32(changed) || !protocol_t::read_horizon(reader, _horizons[p]) || !reader.at_end()) {
+        throw std::runtime_error("Malformed end_step response from a partition worker");
+      }
+      _events[p] = changed;
+    }
+  }
+
+  // Appends the values routed to a partition to its request, and sends it
+  void send_pending(std::size_t p) {
+    for (std::size_t k = 0; k < _pending[p].size(); ++k) {
+      _request.append_bytes(_pending[p].frame(k));
+    }
+    _request.end_frame();
+    _pending[p].clear();
+    _clients[p].send(_request);
+  }
+
+  void receive_round(std::size_t p) {
+    auto reader = response_reader("round");
+    std::uint32_t events = 0;
+    std::uint32_t outputs = 0;
+    if (!reader.read_u32(events) || !protocol_t::read_horizon(reader, _horizons[p]) || !reader.read_u32(outputs)) {
+      throw std::runtime_error("Malformed round response from a partition worker");
+    }
+    _events[p] = events;
+    for (std::uint32_t k = 0; k < outputs; ++k) {
+      std::uint32_t from = 0;
+      std::span<const std::byte> time_bytes;
+      std::span<const std::byte> value_bytes;
+      time_t time{};
+      if (!reader.read_u32(from) || from >= _partition_of.size() || !reader.read_value(time_bytes)
+          || !codec_t::decode(time_bytes, time) || !reader.read_value(value_bytes)) {
+        throw std::runtime_error("Malformed round response from a partition worker");
+      }
+      for (auto to : _cross.destinations(from)) {
+        const auto destination = _partition_of[to];
+        auto &pending = _pending[destination];
+        pending.append_u32(static_cast<std::uint32_t>(to));
+        pending.append_value(time_bytes);
+        pending.append_value(value_bytes);
+        pending.end_frame();
+        _arrivals[destination] = detail::earliest_of(_arrivals[destination], time);
+      }
+    }
+    if (!reader.at_end()) {
+      throw std::runtime_error("Malformed round response from a partition worker");
+    }
+  }
+};
+}
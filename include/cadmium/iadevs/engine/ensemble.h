@@ -0,0 +1,285 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <cadmium/iadevs/concepts.h>
+#include <cadmium/iadevs/engine/simulator.h>
+#include <cadmium/iadevs/engine/thread_pool.h>
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace cadmium::iadevs::engine {
+
+/**
+ * The outcome of one simulation of an ensemble
+ */
+template<typename model_t>
+struct ensemble_result {
+  // The position of the run in the initial conditions or models of the ensemble
+  std::size_t index;
+  sim_state_triplet<typename model_t::state_t, typename model_t::time_t> sim_state;
+  std::size_t events;
+};
+
+/**
+ * A reduction of the results of an ensemble. Results are added one by one to partial reductions,
+ * each starting as a copy of the reduction given to the ensemble, and partials are merged in run order.
+ */
+template<typename reduction_t, typename model_t>
+concept is_ensemble_reduction = std::copyable<reduction_t>
+    && requires(reduction_t r, const reduction_t &other, const ensemble_result<model_t> &result) {
+  r.add(result);
+  r.merge(other);
+};
+
+/**
+ * Counts the runs and events of an ensemble, and keeps the hull of the final states and of t_next,
+ * whose endpoints are the earliest and latest next event times of all runs.
+ * The hulls are meaningful once a run was added.
+ * @tparam model_t an atomic IA model whose states can be merged
+ */
+template<typename model_t> requires cadmium::iadevs::is_mergeable<model_t>
+struct ensemble_summary {
+  using state_t = typename model_t::state_t;
+  using time_t = typename model_t::time_t;
+
+  std::size_t runs = 0;
+  std::size_t events = 0;
+  state_t state_hull{};
+  time_t t_next_hull{};
+
+  /**
+   * @param model the model merging states, for models defining state_hull_i
+   */
+  explicit ensemble_summary(model_t model = {}) : _model(std::move(model)) {}
+
+  void add(const ensemble_result<model_t> &result) {
+    add(result.sim_state.state, result.sim_state.t_next, 1, result.events);
+  }
+
+  void merge(const ensemble_summary &that) {
+    if (that.runs != 0) {
+      add(that.state_hull, that.t_next_hull, that.runs, that.events);
+    }
+  }
+
+private:
+  model_t _model;
+
+  void add(const state_t &state, const time_t &t_next, std::size_t more_runs, std::size_t more_events) {
+    if (runs == 0) {
+      state_hull = state;
+      t_next_hull = t_next;
+    } else {
+      state_hull = detail::state_hull(_model, state_hull, state);
+      t_next_hull = t_next_hull.hull(t_next);
+    }
+    runs += more_runs;
+    events += more_events;
+  }
+};
+
+/**
+ * Histogram of a value computed from each result of an ensemble, over equal width bins in [low, high).
+ * Values below low are counted as underflow, and values not below high, including NaN, as overflow.
+ * @tparam projection_t a function from an ensemble_result to a double
+ */
+template<typename projection_t>
+struct ensemble_histogram {
+  /**
+   * @throw std::invalid_argument if there are no bins or the range is empty
+   */
+  ensemble_histogram(double low, double high, std::size_t bins, projection_t projection)
+      : _low(low), _high(high), _bins(bins, 0), _projection(std::move(projection)) {
+    if (bins == 0 || !(low < high)) {
+      throw std::invalid_argument("The histogram needs bins over a non empty range");
+    }
+  }
+
+  template<typename model_t>
+  void add(const ensemble_result<model_t> &result) {
+    const double value = _projection(result);
+    if (value < _low) {
+      ++_underflow;
+    } else if (!(value < _high)) {
+      ++_overflow;
+    } else {
+      // Rounding may place values right below high past the last bin
+      const auto bin = static_cast<std::size_t>((value - _low) / (_high - _low) * static_cast<double>(_bins.size()));
+      ++_bins[std::min(bin, _bins.size() - 1)];
+    }
+  }
+
+  void merge(const ensemble_histogram &that) {
+    for (std::size_t k = 0; k < _bins.size(); ++k) {
+      _bins[k] += that._bins[k];
+    }
+    _underflow += that._underflow;
+    _overflow += that._overflow;
+  }
+
+  [[nodiscard]] const std::vector<std::size_t> &bins() const noexcept {
+    return _bins;
+  }
+
+  [[nodiscard]] std::size_t underflow() const noexcept {
+    return _underflow;
+  }
+
+  [[nodiscard]] std::size_t overflow() const noexcept {
+    return _overflow;
+  }
+
+  /**
+   * @return the lower bound of a bin
+   */
+  [[nodiscard]] double bin_low(std::size_t bin) const noexcept {
+    return _low + (_high - _low) * static_cast<double>(bin) / static_cast<double>(_bins.size());
+  }
+
+private:
+  double _low;
+  double _high;
+  std::vector<std::size_t> _bins;
+  std::size_t _underflow = 0;
+  std::size_t _overflow = 0;
+  projection_t _projection;
+};
+
+/**
+ * Runs many independent simulations of an atomic model, from different initial conditions or
+ * with different model instances, and reduces their results.
+ * Runs are split in up to max_blocks consecutive blocks, whatever the number of threads. Each block
+ * reuses a single simulator for its runs and adds their results to its own partial reduction, and
+ * partials are merged in block order, so results are identical to the serial run for any number
+ * of threads, even for reductions that are not associative.
+ * @tparam model_t an atomic IA model
+ */
+template<typename model_t> requires cadmium::iadevs::is_atomic<model_t>
+struct ensemble {
+  using simulator_t = simulator<model_t>;
+  using state_t = typename model_t::state_t;
+  using time_t = typename model_t::time_t;
+  using result_t = ensemble_result<model_t>;
+
+  // Enough blocks to balance uneven runs over the threads of a node
+  static constexpr std::size_t max_blocks = 256;
+
+  /**
+   * The initial state and time of a run
+   */
+  struct initial_condition {
+    state_t state;
+    time_t time;
+  };
+
+  ensemble() = default;
+
+  /**
+   * @param model the model instance simulated from every initial condition
+   */
+  explicit ensemble(model_t model) : _model(std::move(model)) {}
+
+  /**
+   * Runs simulations on the given pool, nullptr runs them on the calling thread.
+   * The pool must outlive the ensemble or be replaced before.
+   */
+  void set_thread_pool(thread_pool *pool) noexcept {
+    _pool = pool;
+  }
+
+  /**
+   * Simulates the model from each initial condition
+   * @param initial_conditions the initial state and time of each run
+   * @param until the time every run is simulated up to, as in simulator::run_until
+   * @param reduction an empty reduction, the starting point of every partial reduction
+   * @return the reduction of every result
+   */
+  template<typename reduction_t> requires is_ensemble_reduction<reduction_t, model_t>
+  reduction_t run(std::span<const initial_condition> initial_conditions, const time_t &until,
+                  reduction_t reduction) const {
+    return reduce(initial_conditions.size(), std::move(reduction), [&](simulator_t &sim, std::size_t index) {
+      const auto &initial = initial_conditions[index];
+      sim.init(initial.state, initial.time);
+      const auto events = sim.run_until(until);
+      return result_t{index, sim.get_sim_state(), events};
+    });
+  }
+
+  /**
+   * Simulates each model instance, eg. one per value of a parameter, from the same initial condition
+   * @param models the model instance of each run
+   * @param state the initial state of every run
+   * @param time the initial time of every run
+   * @param until the time every run is simulated up to, as in simulator::run_until
+   * @param reduction an empty reduction, the starting point of every partial reduction
+   * @return the reduction of every result
+   */
+  template<typename reduction_t> requires is_ensemble_reduction<reduction_t, model_t>
+  reduction_t sweep(std::span<const model_t> models, const state_t &state, const time_t &time, const time_t &until,
+                    reduction_t reduction) const {
+    return reduce(models.size(), std::move(reduction), [&](simulator_t &sim, std::size_t index) {
+      sim = simulator_t(models[index]);
+      sim.init(state, time);
+      const auto events = sim.run_until(until);
+      return result_t{index, sim.get_sim_state(), events};
+    });
+  }
+
+private:
+  model_t _model{};
+  thread_pool *_pool = nullptr;
+
+  template<typename reduction_t, typename F>
+  reduction_t reduce(std::size_t runs, reduction_t reduction, F &&simulate) const {
+    const std::size_t blocks = std::min(runs, max_blocks);
+    std::vector<reduction_t> partials(blocks, reduction);
+    auto block = [&](std::size_t b) {
+      simulator_t sim(_model);
+      for (std::size_t index = runs * b / blocks; index < runs * (b + 1) / blocks; ++index) {
+        partials[b].add(simulate(sim, index));
+      }
+    };
+    if (_pool) {
+      _pool->parallel_for(blocks, block);
+    } else {
+      for (std::size_t b = 0; b < blocks; ++b) {
+        block(b);
+      }
+    }
+    for (const auto &partial : partials) {
+      reduction.merge(partial);
+    }
+    return reduction;
+  }
+};
+}
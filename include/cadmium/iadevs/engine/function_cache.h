@@ -0,0 +1,218 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+/**
+ * In-memory memoization of the IA functions of atomic models.
+ * Models declare their IA functions deterministic, so the simulator MAY cache them.
+ * Caches are opt-in, bounded in size, and can be shared by simulators running on
+ * different threads as long as they simulate model instances with the same parameters.
+ */
+#include <cadmium/iadevs/concepts.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace cadmium::iadevs::engine {
+
+/**
+ * Counters of a cache since it was created
+ */
+struct cache_stats {
+  std::uint64_t hits = 0;
+  std::uint64_t misses = 0;
+  std::uint64_t evictions = 0;
+};
+
+/**
+ * A thread-safe key value cache split in independently locked shards.
+ * Each shard keeps its entries in least recently used order and evicts the oldest
+ * entry when it is full. Evicted nodes are reused, so a full cache does not allocate
+ * list nodes on insertion.
+ * @tparam key_t the function input, hashable and equality comparable
+ * @tparam value_t the function result
+ */
+template<typename key_t, typename value_t, typename hash_t = std::hash<key_t>>
+struct sharded_lru_cache {
+  /**
+   * @param capacity the maximum number of entries kept, split evenly between shards
+   * @param shards the number of independently locked shards
+   */
+  explicit sharded_lru_cache(std::size_t capacity, std::size_t shards = 16)
+      : _shards(std::max<std::size_t>(shards, 1)) {
+    const std::size_t per_shard = std::max<std::size_t>(1, (capacity + _shards.size() - 1) / _shards.size());
+    for (auto &s : _shards) {
+      s = std::make_unique<shard>(per_shard);
+    }
+  }
+
+  /**
+   * Looks up key and, if found, marks it as the most recently used
+   * @param key the function input
+   * @param value receives the cached result, untouched on a miss
+   * @return true on a hit
+   */
+  bool find(const key_t &key, value_t &value) {
+    const std::size_t h = hash_t{}(key);
+    shard &s = shard_for(h);
+    std::lock_guard lock(s.mutex);
+    auto it = s.index.find(key);
+    if (it == s.index.end()) {
+      s.misses.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    s.entries.splice(s.entries.begin(), s.entries, it->second);
+    value = it->second->second;
+    s.hits.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  /**
+   * Stores the result for key as the most recently used entry, evicting the least recently used if full
+   * @param key the function input
+   * @param value the function result
+   */
+  void insert(const key_t &key, const value_t &value) {
+    const std::size_t h = hash_t{}(key);
+    shard &s = shard_for(h);
+    std::lock_guard lock(s.mutex);
+    auto it = s.index.find(key);
+    if (it != s.index.end()) {
+      it->second->second = value;
+      s.entries.splice(s.entries.begin(), s.entries, it->second);
+      return;
+    }
+    if (s.entries.size() == s.capacity) {
+      // Recycle the least recently used node as the new entry
+      auto last = std::prev(s.entries.end());
+      s.index.erase(last->first);
+      last->first = key;
+      last->second = value;
+      s.entries.splice(s.entries.begin(), s.entries, last);
+      s.evictions.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      s.entries.emplace_front(key, value);
+    }
+    s.index.emplace(key, s.entries.begin());
+  }
+
+  /**
+   * @return the number of entries cached
+   */
+  [[nodiscard]] std::size_t size() const {
+    std::size_t total = 0;
+    for (const auto &s : _shards) {
+      std::lock_guard lock(s->mutex);
+      total += s->entries.size();
+    }
+    return total;
+  }
+
+  [[nodiscard]] cache_stats stats() const {
+    cache_stats total{};
+    for (const auto &s : _shards) {
+      total.hits += s->hits.load(std::memory_order_relaxed);
+      total.misses += s->misses.load(std::memory_order_relaxed);
+      total.evictions += s->evictions.load(std::memory_order_relaxed);
+    }
+    return total;
+  }
+
+private:
+  struct shard {
+    explicit shard(std::size_t capacity) : capacity(capacity) {
+      index.reserve(capacity);
+    }
+    const std::size_t capacity;
+    mutable std::mutex mutex;
+    std::list<std::pair<key_t, value_t>> entries;
+    std::unordered_map<key_t, typename std::list<std::pair<key_t, value_t>>::iterator, hash_t> index;
+    std::atomic<std::uint64_t> hits{0};
+    std::atomic<std::uint64_t> misses{0};
+    std::atomic<std::uint64_t> evictions{0};
+  };
+  std::vector<std::unique_ptr<shard>> _shards;
+
+  shard &shard_for(std::size_t h) {
+    // The high bits are mixed in, the unordered_map inside the shard uses the low ones
+    return *_shards[((h >> (sizeof(std::size_t) * 4)) ^ h) % _shards.size()];
+  }
+};
+
+/**
+ * Models whose state_t can be used as a cache key
+ */
+template<typename model_t>
+concept is_cacheable = cadmium::iadevs::is_atomic<model_t>
+    && std::equality_comparable<typename model_t::state_t>
+    && requires(const typename model_t::state_t &s) {
+  { std::hash<typename model_t::state_t>{}(s) } -> std::convertible_to<std::size_t>;
+};
+
+/**
+ * Caches for the IA functions of a model type depending on the state only:
+ * time advance, internal transition and output.
+ * External and confluent transitions also depend on the inputs and are not cached.
+ * @tparam model_t an atomic IA model with a hashable state_t
+ */
+template<typename model_t> requires is_cacheable<model_t>
+struct model_function_cache {
+  using state_t = typename model_t::state_t;
+
+  /**
+   * @param capacity the maximum number of entries kept for each function
+   * @param shards the number of independently locked shards of each function cache
+   */
+  explicit model_function_cache(std::size_t capacity, std::size_t shards = 16)
+      : time_advance(capacity, shards), internal_transition(capacity, shards), output(capacity, shards) {}
+
+  sharded_lru_cache<state_t, typename model_t::time_t> time_advance;
+  sharded_lru_cache<state_t, state_t> internal_transition;
+  sharded_lru_cache<state_t, typename model_t::output_t> output;
+};
+
+/**
+ * Returns the cached result of a model function, computing and caching it on a miss
+ */
+template<typename key_t, typename value_t, typename hash_t, typename function_t>
+value_t cached_call(sharded_lru_cache<key_t, value_t, hash_t> &cache, const key_t &key, function_t &&function) {
+  value_t value{};
+  if (!cache.find(key, value)) {
+    value = function(key);
+    cache.insert(key, value);
+  }
+  return value;
+}
+}
@@ -0,0 +1,467 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <cadmium/iadevs/utils/ia_interval.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace cadmium::iadevs::engine {
+
+/**
+ * The phases of a simulation instrumented, one per IA function called by the simulator
+ */
+enum class phase : std::uint8_t {
+  time_advance,
+  output,
+  internal_transition,
+  external_transition,
+  confluent_transition
+};
+
+inline constexpr std::size_t phase_count = 5;
+inline constexpr std::array<std::string_view, phase_count> phase_names{
+    "time_advance", "output", "internal_transition", "external_transition", "confluent_transition"};
+
+/**
+ * Instrumentation policy recording nothing, the default of simulators and coordinators.
+ * Its probe is empty and every call is a constexpr no-op, so instrumented code compiles
+ * to the same code as before it was instrumented.
+ */
+struct no_instrumentation {
+  static constexpr bool enabled = false;
+
+  struct probe {
+    constexpr void cache_result(bool) const noexcept {}
+  };
+
+  template<typename model_t>
+  static constexpr probe start(phase) noexcept {
+    return probe{};
+  }
+
+  template<typename model_t, typename time_t>
+  static constexpr void record_t_next(const time_t &, const time_t &) noexcept {}
+};
+
+/**
+ * Counters of an atomic model type summed over all threads.
+ * Widths are in the units of the time endpoints, and sampled every time t_next is scheduled.
+ */
+struct model_counters {
+  std::string model;
+  std::array<std::uint64_t, phase_count> calls{};
+  std::array<std::uint64_t, phase_count> nanoseconds{};
+  std::uint64_t cache_hits = 0;
+  std::uint64_t cache_misses = 0;
+  std::uint64_t width_samples = 0;
+  // Sum and maximum of the t_next widths
+  double width_sum = 0;
+  double width_max = 0;
+  // Sum of the t_next widths minus the width of the t_last they were scheduled from
+  double width_growth_sum = 0;
+
+  [[nodiscard]] std::uint64_t get_calls(phase p) const noexcept {
+    return calls[static_cast<std::size_t>(p)];
+  }
+
+  [[nodiscard]] std::uint64_t transitions() const noexcept {
+    return get_calls(phase::internal_transition) + get_calls(phase::external_transition)
+        + get_calls(phase::confluent_transition);
+  }
+};
+
+namespace detail {
+// Model types instrumented per process, each has a slot in the counters of every thread
+inline constexpr std::size_t max_instrumented_models = 128;
+
+/**
+ * Counters of a model type on a thread. Only their thread writes them, and snapshots read
+ * them from any thread, so relaxed loads and stores are enough and no read-modify-write is needed.
+ */
+struct counter_slot {
+  std::array<std::atomic<std::uint64_t>, phase_count> calls{};
+  std::array<std::atomic<std::uint64_t>, phase_count> nanoseconds{};
+  std::atomic<std::uint64_t> cache_hits{0};
+  std::atomic<std::uint64_t> cache_misses{0};
+  std::atomic<std::uint64_t> width_samples{0};
+  std::atomic<double> width_sum{0};
+  std::atomic<double> width_max{0};
+  std::atomic<double> width_growth_sum{0};
+};
+
+struct thread_counters {
+  std::array<counter_slot, max_instrumented_models> slots;
+};
+
+template<typename T>
+inline void add(std::atomic<T> &counter, T value) noexcept {
+  counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+/**
+ * Sums the counters of a slot into the counters of its model type
+ */
+inline void accumulate(const counter_slot &slot, model_counters &result) noexcept {
+  for (std::size_t p = 0; p < phase_count; ++p) {
+    result.calls[p] += slot.calls[p].load(std::memory_order_relaxed);
+    result.nanoseconds[p] += slot.nanoseconds[p].load(std::memory_order_relaxed);
+  }
+  result.cache_hits += slot.cache_hits.load(std::memory_order_relaxed);
+  result.cache_misses += slot.cache_misses.load(std::memory_order_relaxed);
+  result.width_samples += slot.width_samples.load(std::memory_order_relaxed);
+  result.width_sum += slot.width_sum.load(std::memory_order_relaxed);
+  result.width_growth_sum += slot.width_growth_sum.load(std::memory_order_relaxed);
+  result.width_max = std::max(result.width_max, slot.width_max.load(std::memory_order_relaxed));
+}
+
+/**
+ * Model types and thread counters of the process. The counters of a thread are folded into
+ * the retired counts when it finishes, so their counts stay in the snapshots without keeping
+ * the slots of every thread that ever ran.
+ */
+struct counter_registry {
+  static counter_registry &instance() {
+    static counter_registry registry;
+    return registry;
+  }
+
+  /**
+   * @return the slot of the model in the thread counters
+   * @throw std::length_error if max_instrumented_models are already registered
+   */
+  std::size_t add_model(std::string_view name) {
+    std::lock_guard lock(_mutex);
+    if (_models.size() == max_instrumented_models) {
+      throw std::length_error("Too many instrumented model types");
+    }
+    _models.emplace_back(name);
+    _retired.emplace_back();
+    return _models.size() - 1;
+  }
+
+  void add_thread(const thread_counters &counters) {
+    std::lock_guard lock(_mutex);
+    _threads.push_back(&counters);
+  }
+
+  /**
+   * Folds the counts of a finishing thread into the retired counts, its counters are no longer read
+   */
+  void retire_thread(const thread_counters &counters) {
+    std::lock_guard lock(_mutex);
+    for (std::size_t id = 0; id < _models.size(); ++id) {
+      accumulate(counters.slots[id], _retired[id]);
+    }
+    std::erase(_threads, &counters);
+  }
+
+  /**
+   * @return the threads whose counters are read by the snapshots
+   */
+  [[nodiscard]] std::size_t thread_count() const {
+    std::lock_guard lock(_mutex);
+    return _threads.size();
+  }
+
+  std::vector<model_counters> snapshot() const {
+    std::lock_guard lock(_mutex);
+    std::vector<model_counters> result(_retired);
+    for (std::size_t id = 0; id < _models.size(); ++id) {
+      auto &r = result[id];
+      r.model = _models[id];
+      for (const auto *thread : _threads) {
+        accumulate(thread->slots[id], r);
+      }
+    }
+    return result;
+  }
+
+private:
+  mutable std::mutex _mutex;
+  std::vector<std::string> _models;
+  std::vector<const thread_counters *> _threads;
+  // Counts of the finished threads, per model type
+  std::vector<model_counters> _retired;
+};
+
+/**
+ * Name of a type as written in the source, from the signature the compiler reports
+ */
+template<typename T>
+constexpr std::string_view type_name() noexcept {
+  const std::string_view signature = __PRETTY_FUNCTION__;
+  const auto begin = signature.find("T = ") + 4;
+  return signature.substr(begin, signature.find_first_of(";]", begin) - begin);
+}
+
+template<typename model_t>
+std::size_t model_slot() {
+  static const std::size_t slot = counter_registry::instance().add_model(type_name<model_t>());
+  return slot;
+}
+
+/**
+ * Counters of the calling thread, registered on first use and retired when the thread finishes
+ */
+struct thread_registration {
+  thread_registration() : counters(std::make_unique<thread_counters>()) {
+    counter_registry::instance().add_thread(*counters);
+  }
+
+  thread_registration(const thread_registration &) = delete;
+  thread_registration &operator=(const thread_registration &) = delete;
+
+  ~thread_registration() {
+    counter_registry::instance().retire_thread(*counters);
+  }
+
+  std::unique_ptr<thread_counters> counters;
+};
+
+inline thread_counters &local_counters() {
+  thread_local const thread_registration registration;
+  return *registration.counters;
+}
+
+/**
+ * Width of a time interval as a double, false when the interval is not bounded
+ * or its endpoints are neither arithmetic nor a count of ticks like sim_time
+ */
+template<typename time_t>
+bool try_get_width(const time_t &t, double &width) {
+  if constexpr (requires(decltype(t.packed_lower_value()) w) { t.try_get_width(w); }) {
+    auto w = t.packed_lower_value();
+    if (t.try_get_width(w) != interval_status::ok) {
+      return false;
+    }
+    if constexpr (std::is_arithmetic_v<decltype(w)>) {
+      width = static_cast<double>(w);
+      return true;
+    } else if constexpr (requires { w.count(); }) {
+      width = static_cast<double>(w.count());
+      return true;
+    }
+  }
+  return false;
+}
+
+inline void write_json_string(std::string_view value, std::ostream &out) {
+  out << '"';
+  for (char c : value) {
+    if (c == '"' || c == '\\') {
+      out << '\\';
+    }
+    out << c;
+  }
+  out << '"';
+}
+
+/**
+ * Writes a sample of a Prometheus metric labelled by model, and by phase if given
+ */
+template<typename value_t>
+void write_sample(std::string_view metric, std::string_view model, std::string_view phase_name, value_t value,
+                  std::ostream &out) {
+  out << metric << "{model=\"";
+  for (char c : model) {
+    if (c == '"' || c == '\\') {
+      out << '\\' << c;
+    } else if (c == '\n') {
+      out << "\\n";
+    } else {
+      out << c;
+    }
+  }
+  out << '"';
+  if (!phase_name.empty()) {
+    out << ",phase=\"" << phase_name << '"';
+  }
+  out << "} " << value << '\n';
+}
+}
+
+/**
+ * Instrumentation policy counting, per atomic model type, the calls to each IA function and
+ * the time spent in them, the cache hits and misses, and the width of every t_next scheduled.
+ * Each thread records into its own counters, snapshot sums them.
+ * Timing reads the steady clock twice per call, which dominates the cost of an instrumented step.
+ */
+struct counting_instrumentation {
+  static constexpr bool enabled = true;
+
+  /**
+   * Times a call to an IA function, counted when the probe is destroyed
+   */
+  struct probe {
+    probe(detail::counter_slot &slot, phase p) noexcept
+        : _slot(slot), _phase(static_cast<std::size_t>(p)), _start(std::chrono::steady_clock::now()) {}
+
+    probe(const probe &) = delete;
+    probe &operator=(const probe &) = delete;
+
+    ~probe() {
+      const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _start);
+      detail::add(_slot.calls[_phase], std::uint64_t{1});
+      detail::add(_slot.nanoseconds[_phase], static_cast<std::uint64_t>(ns.count()));
+    }
+
+    /**
+     * Counts a cache lookup of the call
+     * @param hit whether the result was found in the cache
+     */
+    void cache_result(bool hit) noexcept {
+      detail::add(hit ? _slot.cache_hits : _slot.cache_misses, std::uint64_t{1});
+    }
+
+  private:
+    detail::counter_slot &_slot;
+    std::size_t _phase;
+    std::chrono::steady_clock::time_point _start;
+  };
+
+  template<typename model_t>
+  static probe start(phase p) {
+    return probe{detail::local_counters().slots[detail::model_slot<model_t>()], p};
+  }
+
+  /**
+   * Samples the width of a t_next scheduled and its growth over the t_last it was scheduled from
+   */
+  template<typename model_t, typename time_t>
+  static void record_t_next(const time_t &t_last, const time_t &t_next) {
+    double width = 0;
+    double last_width = 0;
+    if (!detail::try_get_width(t_next, width) || !detail::try_get_width(t_last, last_width)) {
+      return;
+    }
+    auto &slot = detail::local_counters().slots[detail::model_slot<model_t>()];
+    detail::add(slot.width_samples, std::uint64_t{1});
+    detail::add(slot.width_sum, width);
+    detail::add(slot.width_growth_sum, width - last_width);
+    if (slot.width_max.load(std::memory_order_relaxed) < width) {
+      slot.width_max.store(width, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * @return the counters of every model type instrumented so far, summed over all threads
+   */
+  static std::vector<model_counters> snapshot() {
+    return detail::counter_registry::instance().snapshot();
+  }
+};
+
+/**
+ * Writes counters as a JSON document, one object per model type under "models"
+ */
+inline void write_json(const std::vector<model_counters> &counters, std::ostream &out) {
+  const auto precision = out.precision(std::numeric_limits<double>::digits10);
+  out << "{\"models\": [";
+  const char *separator = "";
+  for (const auto &c : counters) {
+    out << separator << "{\"model\": ";
+    detail::write_json_string(c.model, out);
+    out << ", \"transitions\": " << c.transitions() << ", \"calls\": {";
+    for (std::size_t p = 0; p < phase_count; ++p) {
+      out << (p ? ", \"" : "\"") << phase_names[p] << "\": " << c.calls[p];
+    }
+    out << "}, \"nanoseconds\": {";
+    for (std::size_t p = 0; p < phase_count; ++p) {
+      out << (p ? ", \"" : "\"") << phase_names[p] << "\": " << c.nanoseconds[p];
+    }
+    out << "}, \"cache_hits\": " << c.cache_hits << ", \"cache_misses\": " << c.cache_misses
+        << ", \"t_next_width\": {\"samples\": " << c.width_samples << ", \"sum\": " << c.width_sum
+        << ", \"max\": " << c.width_max << ", \"growth_sum\": " << c.width_growth_sum << "}}";
+    separator = ", ";
+  }
+  out << "]}\n";
+  out.precision(precision);
+}
+
+/**
+ * Writes counters in the Prometheus text exposition format
+ */
+inline void write_prometheus(const std::vector<model_counters> &counters, std::ostream &out) {
+  const auto family = [&](std::string_view metric, std::string_view type, std::string_view help, auto &&samples) {
+    out << "# HELP " << metric << ' ' << help << '\n' << "# TYPE " << metric << ' ' << type << '\n';
+    for (const auto &c : counters) {
+      samples(metric, c);
+    }
+  };
+  const auto per_phase = [&out](auto value) {
+    return [&out, value](std::string_view metric, const model_counters &c) {
+      for (std::size_t p = 0; p < phase_count; ++p) {
+        detail::write_sample(metric, c.model, phase_names[p], value(c, p), out);
+      }
+    };
+  };
+  const auto per_model = [&out](auto value) {
+    return [&out, value](std::string_view metric, const model_counters &c) {
+      detail::write_sample(metric, c.model, {}, value(c), out);
+    };
+  };
+  const auto precision = out.precision(std::numeric_limits<double>::digits10);
+  family("iadevs_calls_total", "counter", "Calls to the IA functions of the model.",
+         per_phase([](const model_counters &c, std::size_t p) { return c.calls[p]; }));
+  family("iadevs_seconds_total", "counter", "Time spent in the IA functions of the model.",
+         per_phase([](const model_counters &c, std::size_t p) {
+           return static_cast<double>(c.nanoseconds[p]) * 1e-9;
+         }));
+  family("iadevs_transitions_total", "counter", "Transitions of the model.",
+         per_model([](const model_counters &c) { return c.transitions(); }));
+  family("iadevs_cache_hits_total", "counter", "IA function calls found in the cache.",
+         per_model([](const model_counters &c) { return c.cache_hits; }));
+  family("iadevs_cache_misses_total", "counter", "IA function calls not found in the cache.",
+         per_model([](const model_counters &c) { return c.cache_misses; }));
+  // A summary without quantiles, its _sum and _count samples are the sum of the widths and the samples taken
+  family("iadevs_t_next_width", "summary", "Widths of t_next when it was scheduled.",
+         [&out](std::string_view metric, const model_counters &c) {
+           detail::write_sample(std::string(metric) + "_sum", c.model, {}, c.width_sum, out);
+           detail::write_sample(std::string(metric) + "_count", c.model, {}, c.width_samples, out);
+         });
+  // Widths may shrink, so their accumulated growth is a gauge
+  family("iadevs_t_next_width_growth", "gauge", "Sum of the widths of t_next minus the width of t_last.",
+         per_model([](const model_counters &c) { return c.width_growth_sum; }));
+  family("iadevs_t_next_width_max", "gauge", "Largest width of t_next.",
+         per_model([](const model_counters &c) { return c.width_max; }));
+  out.precision(precision);
+}
+}
@@ -0,0 +1,326 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <cadmium/iadevs/concepts.h>
+#include <cadmium/iadevs/engine/coordinator.h>
+#include <cadmium/iadevs/engine/time_order.h>
+#include <cadmium/iadevs/utils/ia_interval.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace cadmium::iadevs::engine {
+
+/**
+ * Parallelism achieved by a run of a root coordinator advancing partitions in lookahead windows
+ */
+struct window_stats {
+  // Lookahead windows, where partitions advanced independently
+  std::size_t windows = 0;
+  // Rounds without a safe event, where the partitions imminent together executed a step each
+  std::size_t imminent_steps = 0;
+  // Events executed by every partition
+  std::size_t events = 0;
+  // Sum over rounds of the partitions executing at least an event
+  std::size_t active_partitions = 0;
+  std::size_t max_active_partitions = 0;
+
+  /**
+   * @return the mean number of partitions advancing together per round
+   */
+  [[nodiscard]] double mean_parallelism() const noexcept {
+    const std::size_t rounds = windows + imminent_steps;
+    return rounds == 0 ? 0.0 : static_cast<double>(active_partitions) / static_cast<double>(rounds);
+  }
+
+  /**
+   * Accounts for a round
+   * @param imminent_step whether the round was an imminent step instead of a window
+   * @param round_events the events executed by every partition in the round
+   * @param active the partitions executing at least an event
+   */
+  void record(bool imminent_step, std::size_t round_events, std::size_t active) noexcept {
+    ++(imminent_step ? imminent_steps : windows);
+    events += round_events;
+    active_partitions += active;
+    max_active_partitions = std::max(max_active_partitions, active);
+  }
+};
+
+/**
+ * Record of a round of a root coordinator run
+ */
+template<typename time_t>
+struct window_record {
+  // For lookahead windows, from the earliest event lower endpoint to the window end, right unbounded
+  // if no partition could interfere. For imminent steps, the next event time of the earliest partition.
+  time_t window;
+  bool imminent_step;
+  std::size_t events;
+  std::size_t active_partitions;
+};
+
+/**
+ * @return the lookahead lower endpoint a model declares, zero if it declares none
+ */
+template<typename model_t>
+endpoint_value_t<typename model_t::time_t> lookahead_of(const model_t &model) {
+  endpoint_value_t<typename model_t::time_t> lookahead{};
+  if constexpr (cadmium::iadevs::has_lookahead<model_t>) {
+    const typename model_t::time_t declared = model.lookahead_i();
+    if (declared.try_get_lower_endpoint_value(lookahead) != interval_status::ok) {
+      lookahead = {};
+    }
+  }
+  return lookahead;
+}
+
+/**
+ * What the window of the next round depends on from a partition
+ */
+template<typename time_t>
+struct partition_horizon {
+  // Next event of the partition, including its pending inputs
+  time_t t_next;
+  // Next event of its components coupled to other partitions, empty if they are passive
+  time_t boundary_next;
+  // Smallest lookahead among those components receiving inputs, as a degenerate interval.
+  // Empty if none of them receives inputs.
+  time_t lookahead;
+};
+
+/**
+ * A component with couplings to other partitions, seen from the coordinator of its partition
+ */
+template<typename time_t>
+struct boundary_component {
+  std::size_t local;
+  endpoint_value_t<time_t> lookahead;
+  bool has_inputs;
+};
+
+/**
+ * @return the horizon of a partition simulated by a coordinator
+ * @param partition the coordinator of the partition
+ * @param boundary its components coupled to other partitions
+ */
+template<typename time_t, typename message_t>
+partition_horizon<time_t> horizon_of(const coordinator<time_t, message_t> &partition,
+                                     std::span<const boundary_component<time_t>> boundary) {
+  partition_horizon<time_t> horizon{partition.t_next(), time_t{}, time_t{}};
+  for (const auto &b : boundary) {
+    horizon.boundary_next = detail::earliest_of(horizon.boundary_next, partition.get_component(b.local).t_next());
+    if (b.has_inputs && (horizon.lookahead.is_empty() || b.lookahead < horizon.lookahead.packed_lower_value())) {
+      horizon.lookahead = time_t::from_packed(b.lookahead, b.lookahead,
+                                              interval_flags::lower_closed | interval_flags::upper_closed);
+    }
+  }
+  return horizon;
+}
+
+/**
+ * Kind of a round of a root coordinator
+ */
+enum class round_kind : std::uint8_t {
+  // No event is left before the limit
+  none = 0,
+  // Partitions execute every event certainly before any value they may still receive
+  window = 1,
+  // No event is safe, the components imminent across all partitions execute a single event together
+  imminent_step = 2,
+};
+
+/**
+ * @return for each partition, the partitions with couplings into it, in increasing order
+ * @param partitions the number of partitions
+ * @param couplings the couplings across partitions
+ * @param partition_of maps the id of a component to its partition
+ */
+template<typename partition_of_t>
+std::vector<std::vector<std::size_t>> sources_of(std::size_t partitions, std::span<const coupling> couplings,
+                                                 partition_of_t &&partition_of) {
+  std::vector<std::vector<std::size_t>> sources(partitions);
+  for (const auto &c : couplings) {
+    sources[partition_of(c.to)].push_back(partition_of(c.from));
+  }
+  for (auto &s : sources) {
+    std::sort(s.begin(), s.end());
+    s.erase(std::unique(s.begin(), s.end()), s.end());
+  }
+  return sources;
+}
+
+/**
+ * Events the partitions execute in a round, planned from their horizons.
+ * Each partition has its own window, ending at the earliest time a value may reach it. A partition
+ * emits across partitions only at the internal events of its boundary components, so not before
+ * the lower endpoint of their t_next, and not before the earliest pending event plus their lookahead
+ * if an input changes their state first. The window of a partition ends at the earliest of those
+ * bounds among the partitions coupled into it, and partitions no other partition is coupled into
+ * have right unbounded windows. Partition events with an upper endpoint before the end of their
+ * window are certainly before any value they may still receive, so partitions execute them
+ * independently, and the values they emit are received by their destinations in a later round.
+ * When no event is safe, the round is an imminent step: the components of every partition imminent
+ * with respect to the earliest next event fire together, and the values they exchange are received
+ * in that same event, as in a coordinator step (see coordinator::begin_step).
+ */
+template<typename time_t>
+struct round_plan {
+  using value_t = endpoint_value_t<time_t>;
+
+  round_kind kind = round_kind::none;
+  // For windows, from the earliest event lower endpoint to the end of the longest partition window,
+  // right unbounded if any of them is. For imminent steps, the next event time of the earliest partition.
+  time_t span;
+  // Events with an upper endpoint after the limit are not executed
+  value_t limit{};
+  // For windows, the window of each partition, empty if a value may reach it before any of its events
+  std::vector<time_t> windows;
+
+  /**
+   * Plans the next round, reusing the storage of the previous one
+   * @param horizons the horizon of every partition
+   * @param sources for each partition, the partitions coupled into it, see sources_of
+   * @param until the time to simulate up to, events certainly not after it are executed
+   */
+  void next(std::span<const partition_horizon<time_t>> horizons, std::span<const std::vector<std::size_t>> sources,
+            const time_t &until) {
+    kind = round_kind::none;
+    span = time_t{};
+    windows.assign(horizons.size(), time_t{});
+    time_t earliest{};
+    for (const auto &h : horizons) {
+      earliest = detail::earliest_of(earliest, h.t_next);
+    }
+    value_t lower{};
+    if (until.try_get_lower_endpoint_value(limit) != interval_status::ok
+        || earliest.try_get_lower_endpoint_value(lower) != interval_status::ok) {
+      return;
+    }
+    value_t upper{};
+    if (earliest.try_get_upper_endpoint_value(upper) != interval_status::ok || limit < upper) {
+      return;
+    }
+    kind = round_kind::window;
+    plan_windows(horizons, sources, lower);
+    for (std::size_t p = 0; p < horizons.size(); ++p) {
+      if (admits(horizons[p].t_next, windows[p])) {
+        return;
+      }
+    }
+    kind = round_kind::imminent_step;
+    span = time_t{};
+    for (const auto &h : horizons) {
+      if (!h.t_next.is_empty() && (span.is_empty() || detail::upper_less(h.t_next, span))) {
+        span = h.t_next;
+      }
+    }
+  }
+
+  /**
+   * @param t_next the next event time of a partition
+   * @param window the window of the partition
+   * @return whether the next event of the partition is executed in this window
+   */
+  [[nodiscard]] bool admits(const time_t &t_next, const time_t &window) const noexcept {
+    value_t upper{};
+    return kind == round_kind::window && !window.is_empty()
+        && t_next.try_get_upper_endpoint_value(upper) == interval_status::ok && !(limit < upper)
+        && (window.is_right_unbounded() || upper < window.packed_upper_value());
+  }
+
+  /**
+   * Executes the events of a partition in its window. While the window runs, the partitions coupled
+   * into it only reach states emitting after the bounds the window was planned from.
+   * @param partition the coordinator of the partition
+   * @param window the window of the partition
+   * @return the number of events executed
+   */
+  template<typename partition_t>
+  std::size_t execute(partition_t &partition, const time_t &window) const {
+    std::size_t events = 0;
+    while (admits(partition.t_next(), window)) {
+      partition.step();
+      ++events;
+    }
+    return events;
+  }
+
+private:
+  // Earliest time each partition may emit across partitions, and whether it may emit at all
+  std::vector<value_t> _emission;
+  std::vector<std::uint8_t> _emits;
+
+  void plan_windows(std::span<const partition_horizon<time_t>> horizons,
+                    std::span<const std::vector<std::size_t>> sources, value_t earliest) {
+    _emission.assign(horizons.size(), earliest);
+    _emits.assign(horizons.size(), 0);
+    for (std::size_t q = 0; q < horizons.size(); ++q) {
+      const auto &h = horizons[q];
+      if (!h.boundary_next.is_empty()) {
+        _emits[q] = 1;
+        value_t bound{};
+        if (h.boundary_next.try_get_lower_endpoint_value(bound) != interval_status::ok) {
+          continue;
+        }
+        _emission[q] = bound;
+      }
+      if (!h.lookahead.is_empty() && (!_emits[q] || earliest + h.lookahead.packed_lower_value() < _emission[q])) {
+        _emission[q] = earliest + h.lookahead.packed_lower_value();
+        _emits[q] = 1;
+      }
+    }
+    bool unbounded = false;
+    value_t longest = earliest;
+    for (std::size_t p = 0; p < horizons.size(); ++p) {
+      bool bounded = false;
+      value_t end{};
+      for (auto q : sources[p]) {
+        if (_emits[q] && (!bounded || _emission[q] < end)) {
+          end = _emission[q];
+          bounded = true;
+        }
+      }
+      if (!bounded) {
+        windows[p].set_right_unbounded_with_lower_endpoint_value(earliest, true);
+        unbounded = true;
+      } else if (earliest < end) {
+        windows[p].set_bounded(earliest, true, end, false);
+        longest = std::max(longest, end);
+      }
+    }
+    if (unbounded) {
+      span.set_right_unbounded_with_lower_endpoint_value(earliest, true);
+    } else if (earliest < longest) {
+      span.set_bounded(earliest, true, longest, false);
+    }
+  }
+};
+}
@@ -0,0 +1,293 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <cadmium/iadevs/concepts.h>
+#include <cadmium/iadevs/engine/coordinator.h>
+#include <cadmium/iadevs/engine/coupling_graph.h>
+#include <cadmium/iadevs/engine/lookahead_window.h>
+#include <cadmium/iadevs/engine/thread_pool.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace cadmium::iadevs::engine {
+
+/**
+ * Conservative parallel root coordinator of a coupled model split in partitions.
+ * Each partition is simulated by its own coordinator, in rounds planned by round_plan: in lookahead
+ * windows partitions execute in parallel every event certainly before any value the partitions
+ * coupled into them may still send, so partitions without inbound couplings run up to the limit,
+ * and the values crossing partitions are received at the end of the window with the time they were
+ * emitted at. When no event is safe, the components imminent across all partitions fire together in
+ * an imminent step, whose phases also run in parallel, and the values crossing partitions in it are
+ * received in that same event.
+ * Models declare their lookahead with lookahead_i (see has_lookahead), models without it have
+ * no lookahead. Partitions are fixed, so results do not depend on the number of threads.
+ * @tparam time_t the time interval type
+ * @tparam message_t the type of the values exchanged through couplings
+ */
+template<typename time_t, typename message_t>
+struct parallel_root_coordinator {
+  using coordinator_t = coordinator<time_t, message_t>;
+  using value_t = endpoint_value_t<time_t>;
+  using window_record_t = window_record<time_t>;
+
+  /**
+   * @return the id of a new empty partition
+   */
+  std::size_t add_partition() {
+    _partitions.emplace_back();
+    return _partitions.size() - 1;
+  }
+
+  /**
+   * Adds an atomic component simulating model to a partition
+   * @param partition the partition the component is simulated in
+   * @param model the model instance
+   * @param initial_state the state the component starts in on init
+   * @return the id of the component, unique across partitions
+   */
+  template<typename model_t>
+  std::size_t add_component(std::size_t partition, model_t model, typename model_t::state_t initial_state) {
+    const auto lookahead = lookahead_of(model);
+    const auto local = _partitions.at(partition).add_component(std::move(model), std::move(initial_state));
+    _components.push_back(placement{partition, local, lookahead, false, false});
+    return _components.size() - 1;
+  }
+
+  /**
+   * Couples the output of a component to the input of another, in the same partition or not
+   * @throw std::out_of_range if any component does not exist
+   * @throw std::invalid_argument if the destination does not receive inputs
+   */
+  void add_coupling(std::size_t from, std::size_t to) {
+    const auto &source = _components.at(from);
+    auto &destination = _components.at(to);
+    if (source.partition == destination.partition) {
+      _partitions[source.partition].add_coupling(source.local, destination.local);
+    } else {
+      if (!_partitions[destination.partition].get_component(destination.local).accepts_inputs()) {
+        throw std::invalid_argument("Coupling to a component that does not receive inputs");
+      }
+      if (!_components[from].is_boundary) {
+        _components[from].is_boundary = true;
+        _partitions[source.partition].add_output_coupling(source.local);
+      }
+      _cross_couplings.push_back(coupling{from, to});
+    }
+    destination.has_inputs = true;
+  }
+
+  /**
+   * Runs partitions on the given pool, nullptr runs them on the calling thread.
+   * The pool must outlive the coordinator or be replaced before.
+   */
+  void set_thread_pool(thread_pool *pool) noexcept {
+    _pool = pool;
+  }
+
+  /**
+   * Initializes every partition, components and couplings cannot be added afterwards
+   * @param time the initial time
+   */
+  void init(const time_t &time) {
+    _cross = coupling_graph(_components.size(), _cross_couplings);
+    _sources = sources_of(_partitions.size(), std::span<const coupling>(_cross_couplings),
+                          [this](std::size_t id) { return _components[id].partition; });
+    _global_ids.assign(_partitions.size(), {});
+    _boundary.assign(_partitions.size(), {});
+    for (std::size_t id = 0; id < _components.size(); ++id) {
+      const auto &c = _components[id];
+      _global_ids[c.partition].push_back(id);
+      if (c.is_boundary) {
+        _boundary[c.partition].push_back(boundary_component<time_t>{c.local, c.lookahead, c.has_inputs});
+      }
+    }
+    for (auto &p : _partitions) {
+      p.init(time);
+    }
+    _horizons.resize(_partitions.size());
+    _events.assign(_partitions.size(), 0);
+    _step_times.assign(_partitions.size(), time_t{});
+    _stats = window_stats{};
+    _windows.clear();
+  }
+
+  /**
+   * Executes rounds while some partition has an event certainly not after time,
+   * this is, with an upper endpoint not greater than the time lower endpoint.
+   * @param time the time to simulate up to
+   * @return the number of events executed
+   */
+  std::size_t run_until(const time_t &time) {
+    std::size_t events = 0;
+    while (true) {
+      for (std::size_t p = 0; p < _partitions.size(); ++p) {
+        _horizons[p] = horizon_of(_partitions[p], std::span<const boundary_component<time_t>>(_boundary[p]));
+      }
+      _plan.next(_horizons, _sources, time);
+      if (_plan.kind == round_kind::none) {
+        break;
+      }
+      const bool imminent_step = _plan.kind == round_kind::imminent_step;
+      if (imminent_step) {
+        step_imminent(_plan.span);
+      } else {
+        for_each_partition([this](std::size_t p) { _events[p] = _plan.execute(_partitions[p], _plan.windows[p]); });
+        exchange();
+      }
+      // An imminent step is a single event of the coupled model
+      std::size_t round_events = imminent_step ? 1 : 0;
+      std::size_t active = 0;
+      for (auto e : _events) {
+        round_events += imminent_step ? 0 : e;
+        active += e != 0;
+      }
+      _windows.push_back(window_record_t{_plan.span, imminent_step, round_events, active});
+      _stats.record(imminent_step, round_events, active);
+      events += round_events;
+    }
+    return events;
+  }
+
+  /**
+   * @return the time the next event happens in: from the smallest lower endpoint to the smallest
+   * upper endpoint among partitions, empty if all of them are passive
+   */
+  [[nodiscard]] time_t t_next() const noexcept {
+    time_t next{};
+    for (const auto &p : _partitions) {
+      next = detail::earliest_of(next, p.t_next());
+    }
+    return next;
+  }
+
+  [[nodiscard]] const window_stats &stats() const noexcept {
+    return _stats;
+  }
+
+  /**
+   * @return the record of every round executed since init
+   */
+  [[nodiscard]] const std::vector<window_record_t> &windows() const noexcept {
+    return _windows;
+  }
+
+  [[nodiscard]] std::size_t size() const noexcept {
+    return _components.size();
+  }
+
+  [[nodiscard]] const typename coordinator_t::component_t &get_component(std::size_t id) const {
+    const auto &c = _components.at(id);
+    return _partitions[c.partition].get_component(c.local);
+  }
+
+  template<typename model_t>
+  [[nodiscard]] const simulator<model_t> &get_simulator(std::size_t id) const {
+    const auto &c = _components.at(id);
+    return _partitions[c.partition].template get_simulator<model_t>(c.local);
+  }
+
+private:
+  struct placement {
+    std::size_t partition;
+    std::size_t local;
+    value_t lookahead;
+    bool has_inputs;
+    bool is_boundary;
+  };
+
+  std::vector<coordinator_t> _partitions;
+  std::vector<placement> _components;
+  std::vector<coupling> _cross_couplings;
+  std::vector<std::vector<std::size_t>> _global_ids;
+  std::vector<std::vector<boundary_component<time_t>>> _boundary;
+  coupling_graph _cross;
+  // For each partition, the partitions coupled into it
+  std::vector<std::vector<std::size_t>> _sources;
+  thread_pool *_pool = nullptr;
+  std::vector<partition_horizon<time_t>> _horizons;
+  round_plan<time_t> _plan;
+  // Events each partition executed in the last window, or components it changed in the last imminent step
+  std::vector<std::size_t> _events;
+  std::vector<time_t> _step_times;
+  window_stats _stats;
+  std::vector<window_record_t> _windows;
+
+  // Fires the components imminent across all partitions at the intersection of their t_next, the values
+  // crossing partitions are received in the same event, after the ones routed inside each partition
+  void step_imminent(const time_t &earliest) {
+    for_each_partition([this, &earliest](std::size_t p) { _step_times[p] = _partitions[p].begin_step(earliest); });
+    time_t time{};
+    for (const auto &t : _step_times) {
+      if (!t.is_empty()) {
+        time = time.is_empty() ? t : time.intersect(t);
+      }
+    }
+    for (std::size_t p = 0; p < _partitions.size(); ++p) {
+      auto &outputs = _partitions[p].outputs();
+      for (auto &o : outputs) {
+        for (auto to : _cross.destinations(_global_ids[p][o.from])) {
+          const auto &destination = _components[to];
+          _partitions[destination.partition].receive(destination.local, o.value);
+        }
+      }
+      outputs.clear();
+    }
+    for_each_partition([this, &time](std::size_t p) { _events[p] = _partitions[p].end_step(time); });
+  }
+
+  // Delivers the values that crossed partitions during a window, in partition and emission order
+  void exchange() {
+    for (std::size_t p = 0; p < _partitions.size(); ++p) {
+      auto &outputs = _partitions[p].outputs();
+      for (auto &o : outputs) {
+        for (auto to : _cross.destinations(_global_ids[p][o.from])) {
+          const auto &destination = _components[to];
+          _partitions[destination.partition].inject(destination.local, o.time, o.value);
+        }
+      }
+      outputs.clear();
+    }
+  }
+
+  template<typename F>
+  void for_each_partition(F &&body) {
+    if (_pool) {
+      _pool->parallel_for(_partitions.size(), std::forward<F>(body));
+    } else {
+      for (std::size_t p = 0; p < _partitions.size(); ++p) {
+        body(p);
+      }
+    }
+  }
+};
+}
@@ -0,0 +1,402 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+/**
+ * Persistent cache of atomic model function results in a SQLite database, shared across
+ * simulation runs and experiments using the same atomic models.
+ * Entries are keyed by model type name, function name and serialized input.
+ * Lookups use a pool of read-only connections, so concurrent readers never block each
+ * other in WAL mode. Writes are queued and committed in batched transactions by a
+ * background thread, so inserting never waits on the database.
+ * Users of this header link SQLiteCpp.
+ */
+#include <cadmium/iadevs/concepts.h>
+#include <cadmium/iadevs/engine/simulator.h>
+
+#include <SQLiteCpp/SQLiteCpp.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace cadmium::iadevs::engine {
+
+struct persistent_cache_options {
+  // Maximum number of entries committed in a single transaction
+  std::size_t batch_size = 512;
+  // Writes queued beyond this are dropped instead of slowing down the simulation
+  std::size_t max_pending_writes = 1u << 16;
+  // Time a connection waits for a locked database before failing
+  int busy_timeout_ms = 5000;
+};
+
+/**
+ * Counters of a persistent cache since it was opened
+ */
+struct persistent_cache_stats {
+  std::uint64_t hits = 0;
+  std::uint64_t misses = 0;
+  std::uint64_t writes = 0;
+  std::uint64_t batches = 0;
+  std::uint64_t dropped_writes = 0;
+  std::uint64_t failed_writes = 0;
+  // Why the last failed batch was not committed, empty if none failed
+  std::string last_write_error;
+};
+
+struct persistent_cache {
+  /**
+   * Opens or creates the cache database
+   * @param path the SQLite database file
+   * @param options batching and locking configuration
+   */
+  explicit persistent_cache(const std::string &path, persistent_cache_options options = {})
+      : _path(path), _options(options),
+        _writer_db(path, SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE, options.busy_timeout_ms) {
+    _writer_db.exec("PRAGMA journal_mode=WAL");
+    _writer_db.exec("PRAGMA synchronous=NORMAL");
+    _writer_db.exec("CREATE TABLE IF NOT EXISTS model_function_cache ("
+                    "model TEXT NOT NULL, function TEXT NOT NULL, input BLOB NOT NULL, result BLOB NOT NULL, "
+                    "PRIMARY KEY (model, function, input)) WITHOUT ROWID");
+    _insert = std::make_unique<SQLite::Statement>(
+        _writer_db, "INSERT OR REPLACE INTO model_function_cache (model, function, input, result) VALUES (?, ?, ?, ?)");
+    _writer = std::thread([this] { write_loop(); });
+  }
+
+  persistent_cache(const persistent_cache &) = delete;
+  persistent_cache &operator=(const persistent_cache &) = delete;
+
+  /**
+   * Commits every queued write before closing
+   */
+  ~persistent_cache() {
+    {
+      std::lock_guard lock(_queue_mutex);
+      _stopping = true;
+    }
+    _queue_cv.notify_all();
+    _writer.join();
+  }
+
+  /**
+   * Looks up a function result, writes still queued are not visible
+   * @param model the model type name
+   * @param function the function name
+   * @param input the serialized function input
+   * @param result receives the serialized function result, untouched on a miss
+   * @return true on a hit
+   */
+  bool find(const std::string &model, const std::string &function, std::span<const std::byte> input,
+            std::vector<std::byte> &result) {
+    reader_lease lease(*this);
+    auto &select = lease.get().select;
+    // Resets the statement even when stepping throws, a statement left running would keep the reader locked
+    struct statement_reset {
+      SQLite::Statement &statement;
+      ~statement_reset() {
+        statement.tryReset();
+        clear_bindings(statement);
+      }
+    } reset{select};
+    select.bindNoCopy(1, model);
+    select.bindNoCopy(2, function);
+    select.bindNoCopy(3, input.data(), static_cast<int>(input.size()));
+    const bool found = select.executeStep();
+    if (found) {
+      const auto column = select.getColumn(0);
+      const auto *data = static_cast<const std::byte *>(column.getBlob());
+      result.assign(data, data + column.getBytes());
+    }
+    std::lock_guard lock(_stats_mutex);
+    ++(found ? _stats.hits : _stats.misses);
+    return found;
+  }
+
+  /**
+   * Queues a function result to be stored, returns without waiting for the database
+   * @param model the model type name
+   * @param function the function name
+   * @param input the serialized function input
+   * @param result the serialized function result
+   */
+  void insert(const std::string &model, const std::string &function, std::span<const std::byte> input,
+              std::span<const std::byte> result) {
+    {
+      std::lock_guard lock(_queue_mutex);
+      if (_queue.size() >= _options.max_pending_writes) {
+        std::lock_guard stats_lock(_stats_mutex);
+        ++_stats.dropped_writes;
+        return;
+      }
+      _queue.push_back(pending_write{model, function,
+                                     std::vector<std::byte>(input.begin(), input.end()),
+                                     std::vector<std::byte>(result.begin(), result.end())});
+      ++_queued;
+    }
+    _queue_cv.notify_one();
+  }
+
+  /**
+   * Waits until every write queued so far is committed
+   */
+  void flush() {
+    std::unique_lock lock(_queue_mutex);
+    const std::uint64_t target = _queued;
+    _queue_cv.notify_one();
+    _flushed_cv.wait(lock, [&] { return _processed >= target; });
+  }
+
+  [[nodiscard]] persistent_cache_stats stats() const {
+    std::lock_guard lock(_stats_mutex);
+    return _stats;
+  }
+
+private:
+  struct pending_write {
+    std::string model;
+    std::string function;
+    std::vector<std::byte> input;
+    std::vector<std::byte> result;
+  };
+
+  struct reader {
+    reader(const std::string &path, int busy_timeout_ms)
+        : db(path, SQLite::OPEN_READONLY, busy_timeout_ms),
+          select(db, "SELECT result FROM model_function_cache WHERE model = ? AND function = ? AND input = ?") {}
+    SQLite::Database db;
+    SQLite::Statement select;
+  };
+
+  // Borrows a read-only connection from the pool, opening a new one if all are in use
+  struct reader_lease {
+    explicit reader_lease(persistent_cache &cache) : _cache(cache) {
+      {
+        std::lock_guard lock(_cache._readers_mutex);
+        if (!_cache._readers.empty()) {
+          _reader = std::move(_cache._readers.back());
+          _cache._readers.pop_back();
+        }
+      }
+      if (!_reader) {
+        _reader = std::make_unique<reader>(_cache._path, _cache._options.busy_timeout_ms);
+      }
+    }
+    ~reader_lease() {
+      std::lock_guard lock(_cache._readers_mutex);
+      _cache._readers.push_back(std::move(_reader));
+    }
+    reader &get() {
+      return *_reader;
+    }
+  private:
+    persistent_cache &_cache;
+    std::unique_ptr<reader> _reader;
+  };
+
+  const std::string _path;
+  const persistent_cache_options _options;
+  SQLite::Database _writer_db;
+  std::unique_ptr<SQLite::Statement> _insert;
+
+  std::mutex _readers_mutex;
+  std::vector<std::unique_ptr<reader>> _readers;
+
+  std::mutex _queue_mutex;
+  std::condition_variable _queue_cv;
+  std::condition_variable _flushed_cv;
+  std::deque<pending_write> _queue;
+  std::uint64_t _queued = 0;
+  std::uint64_t _processed = 0;
+  bool _stopping = false;
+
+  mutable std::mutex _stats_mutex;
+  persistent_cache_stats _stats;
+
+  std::thread _writer;
+
+  void write_loop() {
+    std::vector<pending_write> batch;
+    std::unique_lock lock(_queue_mutex);
+    while (true) {
+      _queue_cv.wait(lock, [this] { return _stopping || !_queue.empty(); });
+      if (_queue.empty()) {
+        return;
+      }
+      const std::size_t count = std::min(_queue.size(), std::max<std::size_t>(_options.batch_size, 1));
+      std::move(_queue.begin(), _queue.begin() + static_cast<std::ptrdiff_t>(count), std::back_inserter(batch));
+      _queue.erase(_queue.begin(), _queue.begin() + static_cast<std::ptrdiff_t>(count));
+      lock.unlock();
+      const bool committed = commit(batch);
+      {
+        std::lock_guard stats_lock(_stats_mutex);
+        ++_stats.batches;
+        (committed ? _stats.writes : _stats.failed_writes) += batch.size();
+      }
+      batch.clear();
+      lock.lock();
+      _processed += count;
+      _flushed_cv.notify_all();
+    }
+  }
+
+  // sqlite3_clear_bindings cannot fail, but SQLiteCpp still checks its result and may throw
+  static void clear_bindings(SQLite::Statement &statement) noexcept {
+    try {
+      statement.clearBindings();
+    } catch (const SQLite::Exception &) {
+    }
+  }
+
+  bool commit(const std::vector<pending_write> &batch) {
+    try {
+      SQLite::Transaction transaction(_writer_db);
+      for (const auto &w : batch) {
+        _insert->bindNoCopy(1, w.model);
+        _insert->bindNoCopy(2, w.function);
+        _insert->bindNoCopy(3, w.input.data(), static_cast<int>(w.input.size()));
+        _insert->bindNoCopy(4, w.result.data(), static_cast<int>(w.result.size()));
+        _insert->exec();
+        _insert->reset();
+      }
+      transaction.commit();
+      clear_bindings(*_insert);
+      return true;
+    } catch (const std::exception &e) {
+      // The transaction rolls back, a cache losing entries is still correct
+      _insert->tryReset();
+      clear_bindings(*_insert);
+      std::lock_guard stats_lock(_stats_mutex);
+      _stats.last_write_error = e.what();
+      return false;
+    }
+  }
+};
+
+/**
+ * Decorates an atomic model, so its time advance, internal transition and output are
+ * read from a persistent cache when available, and stored there when computed.
+ * The decorated model is itself an atomic model to simulate with simulator.
+ * @tparam model_t the atomic model type decorated
+ * @tparam codec_t serialization for its state, time and output types
+ */
+template<typename model_t, typename codec_t> requires cadmium::iadevs::is_atomic<model_t>
+    && cadmium::iadevs::is_codec_for<codec_t, typename model_t::state_t>
+    && cadmium::iadevs::is_codec_for<codec_t, typename model_t::time_t>
+    && cadmium::iadevs::is_codec_for<codec_t, typename model_t::output_t>
+struct persistently_cached {
+  using state_t = typename model_t::state_t;
+  using time_t = typename model_t::time_t;
+  using output_t = typename model_t::output_t;
+  using input_t = typename detail::input_of<model_t>::type;
+
+  /**
+   * @param cache the persistent cache, has to outlive this model
+   * @param model_name identifies the model type and its parameters in the cache
+   * @param model the model instance decorated
+   */
+  persistently_cached(persistent_cache &cache, std::string model_name, model_t model = {})
+      : _cache(&cache), _model_name(std::move(model_name)), _model(std::move(model)) {}
+
+  time_t bounded_time_advance_i(const state_t &state) const {
+    return cached<time_t>(time_advance_name(), state,
+                          [this](const state_t &s) { return _model.bounded_time_advance_i(s); });
+  }
+
+  state_t internal_transition_i(const state_t &state) const {
+    return cached<state_t>(internal_transition_name(), state,
+                           [this](const state_t &s) { return _model.internal_transition_i(s); });
+  }
+
+  output_t output_i(const state_t &state) const {
+    return cached<output_t>(output_name(), state, [this](const state_t &s) { return _model.output_i(s); });
+  }
+
+  state_t external_transition_i(const state_t &state, const time_t &elapsed, std::span<const input_t> inputs) const
+  requires cadmium::iadevs::has_external_transition<model_t> {
+    return _model.external_transition_i(state, elapsed, inputs);
+  }
+
+  state_t confluent_transition_i(const state_t &state, std::span<const input_t> inputs) const
+  requires cadmium::iadevs::has_external_transition<model_t> {
+    return _model.confluent_transition_i(state, inputs);
+  }
+
+  time_t time_bound_add(const time_t &t1, const time_t &t2) const {
+    return _model.time_bound_add(t1, t2);
+  }
+
+  time_t time_bound_subtract(const time_t &t1, const time_t &t2) const
+  requires cadmium::iadevs::has_external_transition<model_t> {
+    return _model.time_bound_subtract(t1, t2);
+  }
+
+private:
+  persistent_cache *_cache;
+  std::string _model_name;
+  model_t _model;
+
+  static const std::string &time_advance_name() {
+    static const std::string name = "bounded_time_advance_i";
+    return name;
+  }
+  static const std::string &internal_transition_name() {
+    static const std::string name = "internal_transition_i";
+    return name;
+  }
+  static const std::string &output_name() {
+    static const std::string name = "output_i";
+    return name;
+  }
+
+  template<typename result_t, typename function_t>
+  result_t cached(const std::string &function, const state_t &state, function_t &&compute) const {
+    std::vector<std::byte> input;
+    codec_t::encode(state, input);
+    std::vector<std::byte> bytes;
+    result_t result{};
+    if (_cache->find(_model_name, function, input, bytes) && codec_t::decode(bytes, result)) {
+      return result;
+    }
+    result = compute(state);
+    bytes.clear();
+    codec_t::encode(result, bytes);
+    _cache->insert(_model_name, function, input, bytes);
+    return result;
+  }
+};
+}
@@ -0,0 +1,356 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <cadmium/iadevs/concepts.h>
+#include <cadmium/iadevs/engine/simulator.h>
+#include <cadmium/iadevs/engine/thread_pool.h>
+#include <cadmium/iadevs/utils/ia_interval.h>
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace cadmium::iadevs::engine {
+
+/**
+ * When a refining_simulator bisects its pieces
+ */
+template<typename time_t>
+struct refinement_policy {
+  // Pieces whose t_next is wider are bisected, and pieces are merged back when the hull of their
+  // t_next is not wider
+  endpoint_value_t<time_t> max_width;
+  // Bisection stops while this many pieces are simulated
+  std::size_t max_pieces = 64;
+};
+
+/**
+ * What a refining_simulator did to keep its pieces within the policy
+ */
+struct refinement_stats {
+  std::size_t bisections = 0;
+  std::size_t merges = 0;
+  std::size_t peak_pieces = 0;
+};
+
+/**
+ * Simulates an atomic model as a set of pieces, each a simulator of a part of the partial states
+ * and times, so the width of t_next is bounded by the precision needed instead of growing with
+ * every step.
+ * A piece whose t_next is wider than the policy allows is bisected: its t_last, or its state when the
+ * time advance contributes more width and the state is an interval itself, is split at its midpoint,
+ * and each half is simulated independently, on a thread pool if set.
+ * Pieces reconverge as they advance: pieces in the same state with overlapping t_last are coalesced
+ * into their union before bisecting again, so the pieces tile the reachable times instead of
+ * doubling at every step. When a run ends, neighbour pieces whose t_next hull fits in the allowed
+ * width are merged back if the model is mergeable, and identical pieces are always merged.
+ * Refinement is opt-in: a single piece behaves as a plain simulator.
+ * @tparam model_t an atomic IA model
+ */
+template<typename model_t> requires cadmium::iadevs::is_atomic<model_t>
+struct refining_simulator {
+  using simulator_t = simulator<model_t>;
+  using state_t = typename model_t::state_t;
+  using time_t = typename model_t::time_t;
+  using output_t = typename model_t::output_t;
+  using sim_state_t = typename simulator_t::sim_state_t;
+  using policy_t = refinement_policy<time_t>;
+
+  /**
+   * @param policy when to bisect and merge pieces
+   * @param model the model instance to simulate, for models with parameters
+   */
+  explicit refining_simulator(policy_t policy, model_t model = {}) : _policy(policy), _model(std::move(model)) {
+    if (_policy.max_pieces == 0) {
+      throw std::invalid_argument("The refinement policy must allow at least one piece");
+    }
+  }
+
+  /**
+   * Changes the policy, applied from the next call to run_until
+   */
+  void set_policy(policy_t policy) {
+    if (policy.max_pieces == 0) {
+      throw std::invalid_argument("The refinement policy must allow at least one piece");
+    }
+    _policy = policy;
+  }
+
+  /**
+   * Simulates pieces on the given pool, nullptr simulates them on the calling thread.
+   * The pool must outlive the simulator or be replaced before.
+   */
+  void set_thread_pool(thread_pool *pool) noexcept {
+    _pool = pool;
+  }
+
+  /**
+   * Starts a single piece
+   * @param state the initial state
+   * @param time the initial time
+   */
+  void init(state_t state, time_t time) {
+    _pieces.assign(1, simulator_t(_model));
+    _pieces.front().init(std::move(state), std::move(time));
+    _stats = refinement_stats{};
+    _stats.peak_pieces = 1;
+  }
+
+  /**
+   * Executes the internal events of every piece certainly not after time, bisecting pieces as they widen
+   * @param time the time to simulate up to
+   * @param on_output called with the time of each event and its output, piece by piece on the calling thread
+   * @return the number of internal events executed by all pieces
+   */
+  template<typename F>
+  std::size_t run_until(const time_t &time, F &&on_output) {
+    std::size_t events = 0;
+    while (true) {
+      refine();
+      const std::size_t pieces = _pieces.size();
+      const bool may_bisect = pieces < _policy.max_pieces;
+      _traces.resize(pieces);
+      _widened.assign(pieces, 0);
+      for_each_piece(pieces, [this, &time, may_bisect](std::size_t k) {
+        auto &piece = _pieces[k];
+        auto &trace = _traces[k];
+        trace.clear();
+        while (detail::is_certainly_not_after(piece.get_sim_state().t_next, time)) {
+          const auto &output = piece.step();
+          trace.emplace_back(piece.get_sim_state().t_last, output);
+          if (may_bisect && is_too_wide(piece.get_sim_state().t_next)) {
+            _widened[k] = 1;
+            break;
+          }
+        }
+      });
+      bool widened = false;
+      for (std::size_t k = 0; k < pieces; ++k) {
+        for (const auto &[t, output] : _traces[k]) {
+          on_output(t, output);
+        }
+        events += _traces[k].size();
+        widened = widened || _widened[k];
+      }
+      if (!widened) {
+        break;
+      }
+    }
+    merge_narrow();
+    return events;
+  }
+
+  std::size_t run_until(const time_t &time) {
+    return run_until(time, [](const time_t &, const output_t &) {});
+  }
+
+  [[nodiscard]] const std::vector<simulator_t> &pieces() const noexcept {
+    return _pieces;
+  }
+
+  /**
+   * @return the hull of the next event time of every piece
+   */
+  [[nodiscard]] time_t t_next() const noexcept {
+    time_t next{};
+    for (const auto &p : _pieces) {
+      next = next.hull(p.get_sim_state().t_next);
+    }
+    return next;
+  }
+
+  /**
+   * @return the hull of the state, t_last and t_next of every piece
+   */
+  [[nodiscard]] sim_state_t hull() const requires cadmium::iadevs::is_mergeable<model_t> {
+    auto merged = _pieces.front().get_sim_state();
+    for (std::size_t k = 1; k < _pieces.size(); ++k) {
+      merged = hull_of(merged, _pieces[k].get_sim_state());
+    }
+    return merged;
+  }
+
+  [[nodiscard]] const refinement_stats &stats() const noexcept {
+    return _stats;
+  }
+
+private:
+  // Half of a bisected piece: its state and t_last
+  struct half {
+    state_t state;
+    time_t t_last;
+  };
+
+  policy_t _policy;
+  model_t _model;
+  thread_pool *_pool = nullptr;
+  std::vector<simulator_t> _pieces;
+  refinement_stats _stats;
+  // Per round storage, kept across rounds to avoid allocations
+  std::vector<std::vector<std::pair<time_t, output_t>>> _traces;
+  std::vector<std::uint8_t> _widened;
+  std::vector<simulator_t> _next;
+
+  bool is_too_wide(const time_t &t) const noexcept {
+    endpoint_value_t<time_t> width{};
+    const interval_status status = t.try_get_width(width);
+    // Widths out of the domain range are wider than any max_width
+    return status == interval_status::overflow || (status == interval_status::ok && _policy.max_width < width);
+  }
+
+  // Splits the state when the time advance is wider than t_last and the state is an interval, t_last otherwise
+  bool bisect(const simulator_t &piece, half &low, half &high) const {
+    const auto &s = piece.get_sim_state();
+    if constexpr (requires(const state_t q, state_t &r) { { q.try_bisect(r, r) } -> std::same_as<interval_status>; }) {
+      endpoint_value_t<time_t> ta_width{};
+      endpoint_value_t<time_t> t_last_width{};
+      const auto ta = _model.bounded_time_advance_i(s.state);
+      if (ta.try_get_width(ta_width) == interval_status::ok && s.t_last.try_get_width(t_last_width) == interval_status::ok
+          && t_last_width < ta_width && s.state.try_bisect(low.state, high.state) == interval_status::ok) {
+        low.t_last = s.t_last;
+        high.t_last = s.t_last;
+        return true;
+      }
+    }
+    if (s.t_last.try_bisect(low.t_last, high.t_last) != interval_status::ok) {
+      return false;
+    }
+    low.state = s.state;
+    high.state = s.state;
+    return true;
+  }
+
+  // Coalesces pieces covering overlapping times in the same state, then bisects wide pieces while the policy allows
+  void refine() {
+    merge_overlapping();
+    bool split = true;
+    while (split && _pieces.size() < _policy.max_pieces) {
+      split = false;
+      _next.clear();
+      std::size_t count = _pieces.size();
+      for (auto &piece : _pieces) {
+        half low{};
+        half high{};
+        if (count < _policy.max_pieces && is_too_wide(piece.get_sim_state().t_next) && bisect(piece, low, high)) {
+          for (auto *h : {&low, &high}) {
+            _next.emplace_back(_model);
+            _next.back().init(std::move(h->state), std::move(h->t_last));
+          }
+          ++count;
+          ++_stats.bisections;
+          split = true;
+        } else {
+          _next.push_back(std::move(piece));
+        }
+      }
+      std::swap(_pieces, _next);
+    }
+    _stats.peak_pieces = std::max(_stats.peak_pieces, _pieces.size());
+  }
+
+  // Pieces in the same state whose t_last overlap are replaced by the union of both, which is exactly their hull
+  void merge_overlapping() {
+    if constexpr (std::equality_comparable<state_t>) {
+      std::stable_sort(_pieces.begin(), _pieces.end(), [](const simulator_t &a, const simulator_t &b) {
+        return a.get_sim_state().t_last.packed_lower_value() < b.get_sim_state().t_last.packed_lower_value();
+      });
+      std::size_t kept = 0;
+      for (std::size_t k = 0; k < _pieces.size(); ++k) {
+        if (kept > 0) {
+          auto &into = _pieces[kept - 1];
+          const auto &a = into.get_sim_state();
+          const auto &b = _pieces[k].get_sim_state();
+          if (a.state == b.state && !a.t_last.intersect(b.t_last).is_empty()) {
+            into.init(a.state, a.t_last.hull(b.t_last));
+            ++_stats.merges;
+            continue;
+          }
+        }
+        if (kept != k) {
+          _pieces[kept] = std::move(_pieces[k]);
+        }
+        ++kept;
+      }
+      _pieces.erase(_pieces.begin() + static_cast<std::ptrdiff_t>(kept), _pieces.end());
+    }
+  }
+
+  // Merges neighbour pieces that are identical, or whose hull is narrow enough for mergeable models
+  void merge_narrow() {
+    std::size_t kept = 0;
+    for (std::size_t k = 0; k < _pieces.size(); ++k) {
+      if (kept > 0 && try_merge(_pieces[kept - 1], _pieces[k])) {
+        ++_stats.merges;
+        continue;
+      }
+      if (kept != k) {
+        _pieces[kept] = std::move(_pieces[k]);
+      }
+      ++kept;
+    }
+    _pieces.erase(_pieces.begin() + static_cast<std::ptrdiff_t>(kept), _pieces.end());
+  }
+
+  bool try_merge(simulator_t &into, const simulator_t &from) {
+    const auto &a = into.get_sim_state();
+    const auto &b = from.get_sim_state();
+    if (a == b) {
+      return true;
+    }
+    if constexpr (cadmium::iadevs::is_mergeable<model_t>) {
+      if (!is_too_wide(a.t_next.hull(b.t_next)) && detail::states_overlap(_model, a.state, b.state)) {
+        const auto merged = hull_of(a, b);
+        // The merged piece schedules from the hulls, which may be wider than the hull of both t_next
+        if (!is_too_wide(_model.time_bound_add(merged.t_last, _model.bounded_time_advance_i(merged.state)))) {
+          into.init(merged.state, merged.t_last);
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  sim_state_t hull_of(const sim_state_t &a, const sim_state_t &b) const requires cadmium::iadevs::is_mergeable<model_t> {
+    return sim_state_t{detail::state_hull(_model, a.state, b.state), a.t_last.hull(b.t_last), a.t_next.hull(b.t_next)};
+  }
+
+  template<typename F>
+  void for_each_piece(std::size_t count, F &&body) {
+    if (_pool) {
+      _pool->parallel_for(count, std::forward<F>(body));
+    } else {
+      for (std::size_t k = 0; k < count; ++k) {
+        body(k);
+      }
+    }
+  }
+};
+}
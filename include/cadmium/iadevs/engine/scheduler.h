@@ -0,0 +1,259 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <cadmium/iadevs/engine/time_order.h>
+#include <cadmium/iadevs/utils/ia_interval.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace cadmium::iadevs::engine {
+
+/**
+ * Future event list of a coordinator, keeping the t_next of each component.
+ * IA-DEVS times are intervals, so components are only partially ordered: a component is
+ * imminent if no other component has a t_next certainly before its own.
+ * Two indexed binary heaps are kept, one by lower endpoint and one by upper endpoint, so
+ * scheduling, rescheduling and removing a component are O(log n), and the imminent set is
+ * found in O(k) for k imminent components by pruning the lower endpoint heap at the
+ * smallest upper endpoint.
+ * Component ids are expected to be dense, as storage grows up to the largest id scheduled.
+ * @tparam time_t the interval type of the component times
+ */
+template<typename time_t>
+struct scheduler {
+  using id_t = std::size_t;
+
+  /**
+   * Reserves storage for components with ids below count
+   * @param count the number of components expected
+   */
+  void reserve(std::size_t count) {
+    _t_next.reserve(count);
+    _lower_position.reserve(count);
+    _upper_position.reserve(count);
+    _by_lower.reserve(count);
+    _by_upper.reserve(count);
+  }
+
+  /**
+   * Schedules a component, or reschedules it if already scheduled.
+   * Components with an empty t_next are passive and are removed instead.
+   * @param id the component id
+   * @param t_next the time of the next internal event of the component
+   */
+  void schedule(id_t id, const time_t &t_next) {
+    if (t_next.is_empty()) {
+      remove(id);
+      return;
+    }
+    if (id >= _t_next.size()) {
+      _t_next.resize(id + 1);
+      _lower_position.resize(id + 1, npos);
+      _upper_position.resize(id + 1, npos);
+    }
+    _t_next[id] = t_next;
+    if (_lower_position[id] == npos) {
+      _lower_position[id] = _by_lower.size();
+      _by_lower.push_back(id);
+      _upper_position[id] = _by_upper.size();
+      _by_upper.push_back(id);
+    }
+    restore(_by_lower, _lower_position, _lower_position[id], lower_less{this});
+    restore(_by_upper, _upper_position, _upper_position[id], upper_less{this});
+  }
+
+  /**
+   * Removes a component, does nothing if the component is not scheduled
+   * @param id the component id
+   */
+  void remove(id_t id) {
+    if (!contains(id)) {
+      return;
+    }
+    erase(_by_lower, _lower_position, _lower_position[id], lower_less{this});
+    erase(_by_upper, _upper_position, _upper_position[id], upper_less{this});
+    _t_next[id] = time_t{};
+  }
+
+  [[nodiscard]] bool contains(id_t id) const noexcept {
+    return id < _lower_position.size() && _lower_position[id] != npos;
+  }
+
+  /**
+   * @param id a scheduled component id
+   * @return the t_next of the component
+   */
+  [[nodiscard]] const time_t &get_t_next(id_t id) const noexcept {
+    return _t_next[id];
+  }
+
+  [[nodiscard]] std::size_t size() const noexcept {
+    return _by_lower.size();
+  }
+
+  [[nodiscard]] bool empty() const noexcept {
+    return _by_lower.empty();
+  }
+
+  /**
+   * The time the next internal event happens in: from the smallest lower endpoint
+   * to the smallest upper endpoint of the scheduled components.
+   * @return the next event time, empty if no component is scheduled
+   */
+  [[nodiscard]] time_t t_next() const noexcept {
+    if (empty()) {
+      return time_t{};
+    }
+    const auto &first = _t_next[_by_lower.front()];
+    const auto &last = _t_next[_by_upper.front()];
+    const std::uint8_t flags = (first.packed_flags() & (interval_flags::lower_inf | interval_flags::lower_closed))
+        | (last.packed_flags() & (interval_flags::upper_inf | interval_flags::upper_closed));
+    return time_t::from_packed(first.packed_lower_value(), last.packed_upper_value(), flags);
+  }
+
+  /**
+   * Appends the ids of the imminent components, those with a t_next not certainly after
+   * the t_next of any other component. The order of the ids is unspecified.
+   * @param ids receives the imminent ids, previous content is kept
+   */
+  void imminent(std::vector<id_t> &ids) const {
+    if (!empty()) {
+      imminent(ids, _t_next[_by_upper.front()]);
+    }
+  }
+
+  /**
+   * Appends the ids of the components with a t_next not certainly after a reference time, the
+   * imminent ones when the reference is the earliest t_next among the components of several schedulers.
+   * The order of the ids is unspecified.
+   * @param ids receives the ids, previous content is kept
+   * @param earliest the reference time
+   */
+  void imminent(std::vector<id_t> &ids, const time_t &earliest) const {
+    if (empty() || earliest.certainly_before(_t_next[_by_lower.front()])) {
+      return;
+    }
+    // The heap order makes children of a component certainly after earliest certainly after too,
+    // so the appended ids are used as the traversal queue
+    const std::size_t first = ids.size();
+    ids.push_back(_by_lower.front());
+    for (std::size_t k = first; k < ids.size(); ++k) {
+      const std::size_t child = 2 * _lower_position[ids[k]] + 1;
+      for (std::size_t c = child; c < std::min(child + 2, _by_lower.size()); ++c) {
+        if (!earliest.certainly_before(_t_next[_by_lower[c]])) {
+          ids.push_back(_by_lower[c]);
+        }
+      }
+    }
+  }
+
+private:
+  static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+  std::vector<time_t> _t_next;
+  std::vector<std::size_t> _lower_position;
+  std::vector<std::size_t> _upper_position;
+  std::vector<id_t> _by_lower;
+  std::vector<id_t> _by_upper;
+
+  struct lower_less {
+    const scheduler *s;
+    bool operator()(id_t a, id_t b) const noexcept {
+      return detail::lower_less(s->_t_next[a], s->_t_next[b]);
+    }
+  };
+
+  struct upper_less {
+    const scheduler *s;
+    bool operator()(id_t a, id_t b) const noexcept {
+      return detail::upper_less(s->_t_next[a], s->_t_next[b]);
+    }
+  };
+
+  template<typename less_t>
+  static void restore(std::vector<id_t> &heap, std::vector<std::size_t> &position, std::size_t at, less_t less) {
+    at = sift_up(heap, position, at, less);
+    sift_down(heap, position, at, less);
+  }
+
+  template<typename less_t>
+  static void erase(std::vector<id_t> &heap, std::vector<std::size_t> &position, std::size_t at, less_t less) {
+    position[heap[at]] = npos;
+    const id_t last = heap.back();
+    heap.pop_back();
+    if (at < heap.size()) {
+      heap[at] = last;
+      position[last] = at;
+      restore(heap, position, at, less);
+    }
+  }
+
+  template<typename less_t>
+  static std::size_t sift_up(std::vector<id_t> &heap, std::vector<std::size_t> &position, std::size_t at, less_t less) {
+    const id_t id = heap[at];
+    while (at > 0) {
+      const std::size_t parent = (at - 1) / 2;
+      if (!less(id, heap[parent])) {
+        break;
+      }
+      heap[at] = heap[parent];
+      position[heap[at]] = at;
+      at = parent;
+    }
+    heap[at] = id;
+    position[id] = at;
+    return at;
+  }
+
+  template<typename less_t>
+  static void sift_down(std::vector<id_t> &heap, std::vector<std::size_t> &position, std::size_t at, less_t less) {
+    const id_t id = heap[at];
+    while (true) {
+      std::size_t child = 2 * at + 1;
+      if (child >= heap.size()) {
+        break;
+      }
+      if (child + 1 < heap.size() && less(heap[child + 1], heap[child])) {
+        ++child;
+      }
+      if (!less(heap[child], id)) {
+        break;
+      }
+      heap[at] = heap[child];
+      position[heap[at]] = at;
+      at = child;
+    }
+    heap[at] = id;
+    position[id] = at;
+  }
+};
+}
@@ -26,6 +26,15 @@
 #pragma once
 
 #include <cadmium/iadevs/concepts.h>
+#include <cadmium/iadevs/engine/function_cache.h>
+#include <cadmium/iadevs/engine/instrumentation.h>
+#include <cadmium/iadevs/engine/time_order.h>
+#include <cadmium/iadevs/utils/ia_interval.h>
+
+#include <cstddef>
+#include <span>
+#include <type_traits>
+#include <utility>
 
 namespace cadmium::iadevs::engine {
 
@@ -39,21 +48,263 @@ struct sim_state_triplet {
   STATE state;
   TIME t_last;
   TIME t_next;
+  constexpr bool operator==(const sim_state_triplet &) const = default;
+};
+
+/**
+ * Type of the finite endpoints of a time interval type
+ */
+template<typename time_t>
+using endpoint_value_t = std::remove_cvref_t<decltype(std::declval<const time_t &>().packed_lower_value())>;
+
+namespace detail {
+/**
+ * Input type of models receiving inputs, and a placeholder for models that do not
+ */
+struct no_input {};
+
+template<typename model_t>
+struct input_of {
+  using type = no_input;
+};
+
+template<typename model_t> requires cadmium::iadevs::has_external_transition<model_t>
+struct input_of<model_t> {
+  using type = typename model_t::input_t;
+};
+
+/**
+ * Function cache type of models that can be cached, and a placeholder for models that cannot
+ */
+struct no_cache {};
+
+template<typename model_t>
+struct cache_of {
+  using type = no_cache;
+};
+
+template<typename model_t> requires is_cacheable<model_t>
+struct cache_of<model_t> {
+  using type = model_function_cache<model_t>;
 };
 
+/**
+ * Hull and overlap of intervals of partial states of mergeable models
+ */
+template<typename model_t> requires cadmium::iadevs::is_mergeable<model_t>
+typename model_t::state_t state_hull(const model_t &model, const typename model_t::state_t &a,
+                                     const typename model_t::state_t &b) {
+  if constexpr (cadmium::iadevs::has_state_hull<model_t>) {
+    return model.state_hull_i(a, b);
+  } else {
+    return a.hull(b);
+  }
+}
+
+template<typename model_t> requires cadmium::iadevs::is_mergeable<model_t>
+bool states_overlap(const model_t &model, const typename model_t::state_t &a, const typename model_t::state_t &b) {
+  if constexpr (cadmium::iadevs::has_state_hull<model_t>) {
+    return model.states_overlap_i(a, b);
+  } else {
+    return !a.intersect(b).is_empty();
+  }
+}
+}
+
 /**
  * This implements the simulation algorithms for IA-DEVS atomic models
+ * Ref: UA-DEVS paper section 6.1
+ * The model instance, the sim_state_triplet and the output are members updated in place,
+ * so stepping allocates nothing unless the model functions themselves do.
  * @tparam model_t an atomic IA model
+ * @tparam instrumentation_t the policy recording the calls to the model, no_instrumentation records nothing
  */
-template<typename model_t> requires cadmium::iadevs::is_atomic<model_t>
+template<typename model_t, typename instrumentation_t = no_instrumentation>
+requires cadmium::iadevs::is_atomic<model_t>
 struct simulator {
-  using sim_state_t = sim_state_triplet<typename model_t::state_t, typename model_t::time_t>;
+  using state_t = typename model_t::state_t;
+  using time_t = typename model_t::time_t;
+  using output_t = typename model_t::output_t;
+  using input_t = typename detail::input_of<model_t>::type;
+  using cache_t = typename detail::cache_of<model_t>::type;
+  using sim_state_t = sim_state_triplet<state_t, time_t>;
+
+  constexpr simulator() = default;
+
+  /**
+   * @param model the model instance to simulate, for models with parameters
+   */
+  constexpr explicit simulator(model_t model) : _model(std::move(model)) {}
+
+  /**
+   * Function init(initstate q, R^+_I t)
+   * @param state the initial state
+   * @param time the initial time
+   * @return the state, t_last and t_next after initialization
+   */
+  constexpr sim_state_t init(state_t state, time_t time) {
+    auto t_next = _model.time_bound_add(time, time_advance(state));
+    instrumentation_t::template record_t_next<model_t>(time, t_next);
+    _sim_state = sim_state_t{std::move(state), std::move(time), std::move(t_next)};
+    return _sim_state;
+  }
+
+  /**
+   * Computes the output of the model for the next internal event.
+   * The reference stays valid until the next call to output.
+   * @return the output of the current state
+   */
+  constexpr const output_t &output() {
+    [[maybe_unused]] auto probe = instrumentation_t::template start<model_t>(phase::output);
+    if constexpr (is_cacheable<model_t>) {
+      if (_cache) [[unlikely]] {
+        _output = cached_output(_sim_state.state, probe);
+        return _output;
+      }
+    }
+    _output = _model.output_i(_sim_state.state);
+    return _output;
+  }
+
+  /**
+   * Applies the internal transition at t_next
+   */
+  constexpr void internal_transition() {
+    _sim_state.state = internal_transition_of(_sim_state.state);
+    _sim_state.t_last = _sim_state.t_next;
+    schedule_from_t_last();
+  }
+
+  /**
+   * Applies the external transition for inputs received at time, before t_next
+   * @param time the time the inputs were received
+   * @param inputs the bag of inputs received
+   */
+  constexpr void external_transition(const time_t &time, std::span<const input_t> inputs)
+  requires cadmium::iadevs::has_external_transition<model_t> {
+    const auto elapsed = _model.time_bound_subtract(time, _sim_state.t_last);
+    {
+      [[maybe_unused]] auto probe = instrumentation_t::template start<model_t>(phase::external_transition);
+      _sim_state.state = _model.external_transition_i(_sim_state.state, elapsed, inputs);
+    }
+    _sim_state.t_last = time;
+    schedule_from_t_last();
+  }
+
+  /**
+   * Applies the confluent transition for inputs received at t_next
+   * @param inputs the bag of inputs received
+   */
+  constexpr void confluent_transition(std::span<const input_t> inputs)
+  requires cadmium::iadevs::has_external_transition<model_t> {
+    {
+      [[maybe_unused]] auto probe = instrumentation_t::template start<model_t>(phase::confluent_transition);
+      _sim_state.state = _model.confluent_transition_i(_sim_state.state, inputs);
+    }
+    _sim_state.t_last = _sim_state.t_next;
+    schedule_from_t_last();
+  }
+
+  /**
+   * Executes the next internal event: computes the output and applies the internal transition
+   * @return the output emitted, valid until the next call to output or step
+   */
+  constexpr const output_t &step() {
+    output();
+    internal_transition();
+    return _output;
+  }
+
+  /**
+   * Executes internal events while t_next is certainly not after time,
+   * this is, while the t_next upper endpoint is not greater than the time lower endpoint.
+   * @param time the time to simulate up to
+   * @return the number of internal events executed
+   */
+  constexpr std::size_t run_until(const time_t &time) {
+    std::size_t events = 0;
+    while (detail::is_certainly_not_after(_sim_state.t_next, time)) {
+      step();
+      ++events;
+    }
+    return events;
+  }
+
+  /**
+   * Enables caching the time advance, internal transition and output of the model, nullptr disables it.
+   * The cache must outlive the simulator, and be shared only by simulators of instances with the same parameters.
+   * @param cache the cache to use
+   */
+  void set_cache(cache_t *cache) requires is_cacheable<model_t> {
+    _cache = cache;
+  }
+
+  constexpr const sim_state_t &get_sim_state() const {
+    return _sim_state;
+  }
+
+  constexpr const model_t &get_model() const {
+    return _model;
+  }
+
+private:
+  model_t _model{};
+  sim_state_t _sim_state{};
+  output_t _output{};
+  cache_t *_cache = nullptr;
+
+  using probe_t = decltype(instrumentation_t::template start<model_t>(phase::output));
+
+  constexpr time_t time_advance(const state_t &state) {
+    [[maybe_unused]] auto probe = instrumentation_t::template start<model_t>(phase::time_advance);
+    if constexpr (is_cacheable<model_t>) {
+      if (_cache) [[unlikely]] {
+        return cached_time_advance(state, probe);
+      }
+    }
+    return _model.bounded_time_advance_i(state);
+  }
+
+  constexpr state_t internal_transition_of(const state_t &state) {
+    [[maybe_unused]] auto probe = instrumentation_t::template start<model_t>(phase::internal_transition);
+    if constexpr (is_cacheable<model_t>) {
+      if (_cache) [[unlikely]] {
+        return cached_internal_transition(state, probe);
+      }
+    }
+    return _model.internal_transition_i(state);
+  }
+
+  // Cached calls are kept out of line, so simulators without cache keep the loop small
+  [[gnu::noinline]] time_t cached_time_advance(const state_t &state, probe_t &probe) {
+    return counted_cached_call(_cache->time_advance, state, probe,
+                       [this](const state_t &s) { return _model.bounded_time_advance_i(s); });
+  }
+
+  [[gnu::noinline]] state_t cached_internal_transition(const state_t &state, probe_t &probe) {
+    return counted_cached_call(_cache->internal_transition, state, probe,
+                       [this](const state_t &s) { return _model.internal_transition_i(s); });
+  }
+
+  [[gnu::noinline]] output_t cached_output(const state_t &state, probe_t &probe) {
+    return counted_cached_call(_cache->output, state, probe,
+                       [this](const state_t &s) { return _model.output_i(s); });
+  }
+
+  template<typename lru_cache_t, typename key_t, typename function_t>
+  static auto counted_cached_call(lru_cache_t &cache, const key_t &key, probe_t &probe, function_t &&function) {
+    bool hit = true;
+    auto value = cached_call(cache, key, [&](const key_t &k) {
+      hit = false;
+      return function(k);
+    });
+    probe.cache_result(hit);
+    return value;
+  }
 
-  sim_state_t init(typename model_t::state_t state, typename model_t::time_t time) {
-    model_t m;
-    auto time_advance = m.bounded_time_advance_i(state);
-    auto t_next = m.time_bound_add(time, time_advance);
-    return sim_state_t{state, time, t_next};
+  constexpr void schedule_from_t_last() {
+    _sim_state.t_next = _model.time_bound_add(_sim_state.t_last, time_advance(_sim_state.state));
+    instrumentation_t::template record_t_next<model_t>(_sim_state.t_last, _sim_state.t_next);
   }
 };
-}
\ No newline at end of file
+}
@@ -0,0 +1,206 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <cadmium/iadevs/concepts.h>
+#include <cadmium/iadevs/engine/batch_functions.h>
+#include <cadmium/iadevs/engine/simulator.h>
+#include <cadmium/iadevs/utils/ia_interval.h>
+#include <cadmium/iadevs/utils/ia_interval_batch.h>
+
+#include <concepts>
+#include <cstddef>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace cadmium::iadevs::engine {
+
+/**
+ * Simulates many instances of an atomic model type sharing the same model instance, eg. the
+ * tens of thousands of generators of a wide coupled model, without inputs.
+ * Instead of a simulator per instance, the states are stored in an array and t_last and t_next
+ * in interval batches. Each round of run_until scans the t_next upper endpoints for the
+ * instances due, and calls the model functions once for all of them, through their batch versions
+ * when the model declares them, see has_batch_time_advance.
+ * Every instance executes the same events a simulator of its own would, one event per round.
+ * @tparam model_t an atomic IA model whose time is an interval
+ */
+template<typename model_t> requires cadmium::iadevs::is_atomic<model_t>
+    && std::same_as<typename model_t::time_t, interval<endpoint_value_t<typename model_t::time_t>>>
+struct simulator_pool {
+  using state_t = typename model_t::state_t;
+  using time_t = typename model_t::time_t;
+  using output_t = typename model_t::output_t;
+  using sim_state_t = sim_state_triplet<state_t, time_t>;
+
+  simulator_pool() = default;
+
+  /**
+   * @param model the model instance simulated by every instance, for models with parameters
+   */
+  explicit simulator_pool(model_t model) : _model(std::move(model)) {}
+
+  void reserve(std::size_t instances) {
+    _states.reserve(instances);
+    _t_last.reserve(instances);
+    _t_next.reserve(instances);
+  }
+
+  /**
+   * Adds an instance, initialized as simulator::init does
+   * @param state the initial state
+   * @param time the initial time
+   * @return the id of the instance
+   */
+  std::size_t add(state_t state, time_t time) {
+    _t_next.push_back(_model.time_bound_add(time, _model.bounded_time_advance_i(state)));
+    _t_last.push_back(time);
+    _states.push_back(std::move(state));
+    return _states.size() - 1;
+  }
+
+  /**
+   * Adds an instance per state, all initialized at the same time with their time advances computed in a batch
+   * @param states the initial state of each instance
+   * @param time the initial time of every instance
+   * @return the id of the first instance added, the others follow it
+   */
+  std::size_t add(std::span<const state_t> states, const time_t &time) {
+    const std::size_t first = size();
+    _advances.resize(states.size());
+    batch_time_advance(_model, states, std::span<time_t>(_advances));
+    reserve(first + states.size());
+    for (std::size_t k = 0; k < states.size(); ++k) {
+      _t_next.push_back(_model.time_bound_add(time, _advances[k]));
+      _t_last.push_back(time);
+      _states.push_back(states[k]);
+    }
+    return first;
+  }
+
+  [[nodiscard]] std::size_t size() const noexcept {
+    return _states.size();
+  }
+
+  [[nodiscard]] sim_state_t get_sim_state(std::size_t id) const {
+    return sim_state_t{_states[id], _t_last.get(id), _t_next.get(id)};
+  }
+
+  [[nodiscard]] const model_t &get_model() const {
+    return _model;
+  }
+
+  /**
+   * Executes the internal events of every instance while its t_next is certainly not after time,
+   * this is, while the t_next upper endpoint is not greater than the time lower endpoint.
+   * @param time the time to simulate up to
+   * @param on_output called as on_output(id, t_next, output) for each event, in rounds by instance id
+   * @return the number of internal events executed by all instances
+   */
+  template<typename F>
+  std::size_t run_until(const time_t &time, F &&on_output) {
+    auto limit = time.packed_lower_value();
+    if (time.try_get_lower_endpoint_value(limit) != interval_status::ok) {
+      return 0;
+    }
+    std::size_t events = 0;
+    while (collect_due(limit)) {
+      events += _due.size();
+      step_due(on_output);
+    }
+    return events;
+  }
+
+  std::size_t run_until(const time_t &time) {
+    return run_until(time, [](std::size_t, const time_t &, const output_t &) {});
+  }
+
+private:
+  model_t _model{};
+  std::vector<state_t> _states;
+  interval_batch<endpoint_value_t<time_t>> _t_last;
+  interval_batch<endpoint_value_t<time_t>> _t_next;
+  // Per round storage, kept across rounds to avoid allocations
+  std::vector<std::size_t> _due;
+  std::vector<state_t> _due_states;
+  std::vector<state_t> _next_states;
+  std::vector<output_t> _outputs;
+  std::vector<time_t> _advances;
+
+  bool collect_due(endpoint_value_t<time_t> limit) {
+    _due.clear();
+    const auto upper = _t_next.upper_values();
+    const auto flags = _t_next.flags();
+    for (std::size_t id = 0; id < upper.size(); ++id) {
+      if (!(flags[id] & interval_flags::not_bounded) && !(limit < upper[id])) {
+        _due.push_back(id);
+      }
+    }
+    return !_due.empty();
+  }
+
+  template<typename F>
+  void step_due(F &on_output) {
+    const std::size_t due = _due.size();
+    // When every instance is due, as generators in lockstep, the states are used in place
+    const bool all = due == _states.size();
+    if (!all) {
+      _due_states.resize(due);
+      for (std::size_t k = 0; k < due; ++k) {
+        _due_states[k] = _states[_due[k]];
+      }
+    }
+    const std::span<const state_t> states = all ? std::span<const state_t>(_states) : _due_states;
+    _outputs.resize(due);
+    batch_output(_model, states, std::span<output_t>(_outputs));
+    for (std::size_t k = 0; k < due; ++k) {
+      on_output(_due[k], _t_next.get(_due[k]), _outputs[k]);
+    }
+    _next_states.resize(due);
+    batch_internal_transition(_model, states, std::span<state_t>(_next_states));
+    _advances.resize(due);
+    batch_time_advance(_model, std::span<const state_t>(_next_states), std::span<time_t>(_advances));
+    if (all) {
+      _t_last = _t_next;
+      for (std::size_t id = 0; id < due; ++id) {
+        _t_next.set(id, _model.time_bound_add(_t_last.get(id), _advances[id]));
+      }
+      _states.swap(_next_states);
+    } else {
+      for (std::size_t k = 0; k < due; ++k) {
+        const auto id = _due[k];
+        const auto t_last = _t_next.get(id);
+        _t_last.set(id, t_last);
+        _t_next.set(id, _model.time_bound_add(t_last, _advances[k]));
+      }
+      for (std::size_t k = 0; k < due; ++k) {
+        _states[_due[k]] = std::move(_next_states[k]);
+      }
+    }
+  }
+};
+}
@@ -0,0 +1,596 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <cadmium/iadevs/concepts.h>
+#include <cadmium/iadevs/engine/simulator.h>
+#include <cadmium/iadevs/engine/time_order.h>
+#include <cadmium/iadevs/utils/ia_interval.h>
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace cadmium::iadevs::engine {
+
+/**
+ * Z-function of couplings that pass values unchanged
+ */
+struct identity_translation {
+  template<typename T>
+  constexpr const T &operator()(const T &value) const noexcept {
+    return value;
+  }
+};
+
+/**
+ * Coupling from the output of the component at index from to the input of the component at index to
+ * of the same coupled model. Values are translated by the Z-function z_t, a default constructible
+ * function object.
+ */
+template<std::size_t from, std::size_t to, typename z_t = identity_translation>
+struct internal_coupling {};
+
+/**
+ * Coupling from the input of a coupled model to the input of its component at index to
+ */
+template<std::size_t to, typename z_t = identity_translation>
+struct input_coupling {};
+
+/**
+ * Coupling from the output of the component at index from to the output of its coupled model
+ */
+template<std::size_t from, typename z_t = identity_translation>
+struct output_coupling {};
+
+template<typename... component_ts>
+struct component_list {};
+
+template<typename... coupling_ts>
+struct coupling_list {};
+
+/**
+ * A coupled model declared as a type: its components, atomic models or other static_coupled models,
+ * and its couplings between them by index, of any of the three coupling kinds.
+ * Ref: DEVS coupled model, the components are D and the couplings I and Z.
+ */
+template<typename component_list_t, typename coupling_list_t>
+struct static_coupled;
+
+template<typename... component_ts, typename... coupling_ts>
+struct static_coupled<component_list<component_ts...>, coupling_list<coupling_ts...>> {
+  using components_t = std::tuple<component_ts...>;
+  using couplings_t = coupling_list<coupling_ts...>;
+  static constexpr std::size_t size = sizeof...(component_ts);
+};
+
+namespace detail {
+template<typename... ts>
+struct type_list {};
+
+template<typename... lists>
+struct concat {
+  using type = type_list<>;
+};
+
+template<typename... as>
+struct concat<type_list<as...>> {
+  using type = type_list<as...>;
+};
+
+template<typename... as, typename... bs, typename... rest>
+struct concat<type_list<as...>, type_list<bs...>, rest...> {
+  using type = typename concat<type_list<as..., bs...>, rest...>::type;
+};
+
+template<typename... lists>
+using concat_t = typename concat<lists...>::type;
+
+template<typename T>
+struct is_static_coupled : std::false_type {};
+
+template<typename component_list_t, typename coupling_list_t>
+struct is_static_coupled<static_coupled<component_list_t, coupling_list_t>> : std::true_type {};
+
+/**
+ * The Z-functions applied, in order, to a value routed through nested couplings.
+ * Identity translations are skipped, a chain of them passes the value by reference.
+ */
+template<typename... z_ts>
+struct translation_chain {
+  template<typename T>
+  static constexpr decltype(auto) apply(const T &value) {
+    return value;
+  }
+};
+
+template<typename z_t, typename... z_ts>
+struct translation_chain<z_t, z_ts...> {
+  template<typename T>
+  static constexpr decltype(auto) apply(const T &value) {
+    if constexpr (std::is_same_v<z_t, identity_translation>) {
+      return translation_chain<z_ts...>::apply(value);
+    } else {
+      // The translated value is local, so the result is returned by value
+      const auto translated = z_t{}(value);
+      using result_t = std::remove_cvref_t<decltype(translation_chain<z_ts...>::apply(translated))>;
+      return static_cast<result_t>(translation_chain<z_ts...>::apply(translated));
+    }
+  }
+};
+
+template<typename chain_t, typename... z_ts>
+struct append_chain;
+
+template<typename... as, typename... z_ts>
+struct append_chain<translation_chain<as...>, z_ts...> {
+  using type = translation_chain<as..., z_ts...>;
+};
+
+template<typename first_t, typename second_t>
+struct join_chains;
+
+template<typename... as, typename... bs>
+struct join_chains<translation_chain<as...>, translation_chain<bs...>> {
+  using type = translation_chain<as..., bs...>;
+};
+
+template<typename z_t, typename chain_t>
+struct prepend_chain;
+
+template<typename z_t, typename... as>
+struct prepend_chain<z_t, translation_chain<as...>> {
+  using type = translation_chain<z_t, as...>;
+};
+
+/**
+ * An atomic component of the flattened model, and the translations applied on the way to or from it
+ */
+template<std::size_t index, typename chain_t>
+struct flat_endpoint {
+  static constexpr std::size_t flat_index = index;
+  using chain = chain_t;
+};
+
+/**
+ * A coupling between two atomic components of the flattened model, or to the output of the root
+ */
+template<std::size_t from_index, std::size_t to_index, typename chain_t>
+struct flat_coupling {
+  static constexpr std::size_t from = from_index;
+  static constexpr std::size_t to = to_index;
+  using chain = chain_t;
+};
+
+template<std::size_t from_index, typename chain_t>
+struct flat_output {
+  static constexpr std::size_t from = from_index;
+  using chain = chain_t;
+};
+
+// Atomic models of a component, in depth first order
+template<typename component_t>
+struct atomics_of {
+  using type = type_list<component_t>;
+};
+
+template<typename... component_ts, typename coupling_list_t>
+struct atomics_of<static_coupled<component_list<component_ts...>, coupling_list_t>> {
+  using type = concat_t<typename atomics_of<component_ts>::type...>;
+};
+
+template<typename list_t>
+struct list_size;
+
+template<typename... ts>
+struct list_size<type_list<ts...>> : std::integral_constant<std::size_t, sizeof...(ts)> {};
+
+template<typename component_t>
+inline constexpr std::size_t atomic_count = list_size<typename atomics_of<component_t>::type>::value;
+
+/**
+ * Flat index of the first atomic model of each component of a coupled model, relative to the coupled model
+ */
+template<typename coupled_t>
+struct offsets;
+
+template<typename... component_ts, typename coupling_list_t>
+struct offsets<static_coupled<component_list<component_ts...>, coupling_list_t>> {
+  static constexpr std::array<std::size_t, sizeof...(component_ts)> value = [] {
+    std::array<std::size_t, sizeof...(component_ts)> result{};
+    const std::array<std::size_t, sizeof...(component_ts)> counts{atomic_count<component_ts>...};
+    std::size_t offset = 0;
+    for (std::size_t k = 0; k < counts.size(); ++k) {
+      result[k] = offset;
+      offset += counts[k];
+    }
+    return result;
+  }();
+};
+
+template<typename coupled_t, std::size_t index>
+using component_at = std::tuple_element_t<index, typename coupled_t::components_t>;
+
+template<typename coupled_t, std::size_t index, std::size_t offset>
+inline constexpr std::size_t offset_at = offset + offsets<coupled_t>::value[index];
+
+template<typename coupled_t, std::size_t index>
+inline constexpr bool valid_index = index < coupled_t::size;
+
+// Atomic components producing the outputs of a component, with the translations up to its output
+template<typename component_t, std::size_t offset>
+struct sources_of {
+  using type = type_list<flat_endpoint<offset, translation_chain<>>>;
+};
+
+// Atomic components receiving the inputs of a component, with the translations from its input
+template<typename component_t, std::size_t offset>
+struct targets_of {
+  using type = type_list<flat_endpoint<offset, translation_chain<>>>;
+};
+
+template<typename endpoints_t, typename z_t>
+struct append_to_sources;
+
+template<typename... endpoint_ts, typename z_t>
+struct append_to_sources<type_list<endpoint_ts...>, z_t> {
+  using type = type_list<flat_endpoint<endpoint_ts::flat_index,
+                                       typename append_chain<typename endpoint_ts::chain, z_t>::type>...>;
+};
+
+template<typename z_t, typename endpoints_t>
+struct prepend_to_targets;
+
+template<typename z_t, typename... endpoint_ts>
+struct prepend_to_targets<z_t, type_list<endpoint_ts...>> {
+  using type = type_list<flat_endpoint<endpoint_ts::flat_index,
+                                       typename prepend_chain<z_t, typename endpoint_ts::chain>::type>...>;
+};
+
+template<typename coupled_t, std::size_t offset, typename coupling_t>
+struct sources_through {
+  using type = type_list<>;
+};
+
+template<typename coupled_t, std::size_t offset, std::size_t from, typename z_t>
+struct sources_through<coupled_t, offset, output_coupling<from, z_t>> {
+  static_assert(valid_index<coupled_t, from>, "Output coupling from a component that does not exist");
+  using type = typename append_to_sources<
+      typename sources_of<component_at<coupled_t, from>, offset_at<coupled_t, from, offset>>::type, z_t>::type;
+};
+
+template<typename coupled_t, std::size_t offset, typename coupling_t>
+struct targets_through {
+  using type = type_list<>;
+};
+
+template<typename coupled_t, std::size_t offset, std::size_t to, typename z_t>
+struct targets_through<coupled_t, offset, input_coupling<to, z_t>> {
+  static_assert(valid_index<coupled_t, to>, "Input coupling to a component that does not exist");
+  using type = typename prepend_to_targets<
+      z_t, typename targets_of<component_at<coupled_t, to>, offset_at<coupled_t, to, offset>>::type>::type;
+};
+
+template<typename... component_ts, typename... coupling_ts, std::size_t offset>
+struct sources_of<static_coupled<component_list<component_ts...>, coupling_list<coupling_ts...>>, offset> {
+  using coupled_t = static_coupled<component_list<component_ts...>, coupling_list<coupling_ts...>>;
+  using type = concat_t<typename sources_through<coupled_t, offset, coupling_ts>::type...>;
+};
+
+template<typename... component_ts, typename... coupling_ts, std::size_t offset>
+struct targets_of<static_coupled<component_list<component_ts...>, coupling_list<coupling_ts...>>, offset> {
+  using coupled_t = static_coupled<component_list<component_ts...>, coupling_list<coupling_ts...>>;
+  using type = concat_t<typename targets_through<coupled_t, offset, coupling_ts>::type...>;
+};
+
+// Every pair of a source and a target, with the translations of the source, z_t and the target
+template<typename source_t, typename z_t, typename targets_t>
+struct couple_source;
+
+template<typename source_t, typename z_t, typename... target_ts>
+struct couple_source<source_t, z_t, type_list<target_ts...>> {
+  template<typename target_t>
+  using chain_of = typename join_chains<typename append_chain<typename source_t::chain, z_t>::type,
+                                        typename target_t::chain>::type;
+  using type = type_list<flat_coupling<source_t::flat_index, target_ts::flat_index, chain_of<target_ts>>...>;
+};
+
+template<typename sources_t, typename z_t, typename targets_t>
+struct couple_all;
+
+template<typename... source_ts, typename z_t, typename targets_t>
+struct couple_all<type_list<source_ts...>, z_t, targets_t> {
+  using type = concat_t<typename couple_source<source_ts, z_t, targets_t>::type...>;
+};
+
+template<typename coupled_t, std::size_t offset, typename coupling_t>
+struct couplings_through {
+  using type = type_list<>;
+};
+
+template<typename coupled_t, std::size_t offset, std::size_t from, std::size_t to, typename z_t>
+struct couplings_through<coupled_t, offset, internal_coupling<from, to, z_t>> {
+  static_assert(valid_index<coupled_t, from> && valid_index<coupled_t, to>,
+                "Internal coupling between components that do not exist");
+  using type = typename couple_all<
+      typename sources_of<component_at<coupled_t, from>, offset_at<coupled_t, from, offset>>::type, z_t,
+      typename targets_of<component_at<coupled_t, to>, offset_at<coupled_t, to, offset>>::type>::type;
+};
+
+// Couplings between atomic components of a component, including those of nested coupled models
+template<typename component_t, std::size_t offset>
+struct flat_couplings_of {
+  using type = type_list<>;
+};
+
+template<typename coupled_t, std::size_t offset, typename indexes_t>
+struct nested_couplings;
+
+template<typename coupled_t, std::size_t offset, std::size_t... indexes>
+struct nested_couplings<coupled_t, offset, std::index_sequence<indexes...>> {
+  using type = concat_t<typename flat_couplings_of<component_at<coupled_t, indexes>,
+                                                   offset_at<coupled_t, indexes, offset>>::type...>;
+};
+
+template<typename... component_ts, typename... coupling_ts, std::size_t offset>
+struct flat_couplings_of<static_coupled<component_list<component_ts...>, coupling_list<coupling_ts...>>, offset> {
+  using coupled_t = static_coupled<component_list<component_ts...>, coupling_list<coupling_ts...>>;
+  using type = concat_t<typename couplings_through<coupled_t, offset, coupling_ts>::type...,
+                        typename nested_couplings<coupled_t, offset,
+                                                  std::make_index_sequence<sizeof...(component_ts)>>::type>;
+};
+
+template<typename endpoints_t>
+struct as_outputs;
+
+template<typename... endpoint_ts>
+struct as_outputs<type_list<endpoint_ts...>> {
+  using type = type_list<flat_output<endpoint_ts::flat_index, typename endpoint_ts::chain>...>;
+};
+
+template<typename list_t>
+struct simulators_of;
+
+template<typename... model_ts>
+struct simulators_of<type_list<model_ts...>> {
+  using models_t = std::tuple<model_ts...>;
+  using type = std::tuple<simulator<model_ts>...>;
+  using inboxes_t = std::tuple<std::vector<typename input_of<model_ts>::type>...>;
+};
+
+template<typename list_t>
+struct first_of;
+
+template<typename first_t, typename... ts>
+struct first_of<type_list<first_t, ts...>> {
+  using type = first_t;
+};
+
+template<typename list_t, typename time_t>
+struct same_time;
+
+template<typename... model_ts, typename time_t>
+struct same_time<type_list<model_ts...>, time_t>
+    : std::bool_constant<(std::same_as<typename model_ts::time_t, time_t> && ...)> {};
+}
+
+/**
+ * Coordinator of a static_coupled model, flattened at compile time into its atomic models.
+ * Couplings through nested coupled models are resolved into couplings between atomic models, with
+ * the Z-functions along the way composed, so routing a value is an inlined call per coupling.
+ * Atomic simulators are stored in a tuple and stepped without virtual dispatch nor type erasure,
+ * and each receives values of its own input type.
+ * Steps follow the coordinator: imminent components fire together at the intersection of their
+ * t_next, compute their outputs, outputs are routed, and then imminent components apply their
+ * internal or confluent transition while receivers apply the external one.
+ * Input couplings of the root model are not used, it receives no inputs.
+ * @tparam coupled_t the static_coupled model
+ */
+template<typename coupled_t> requires detail::is_static_coupled<coupled_t>::value
+struct static_coordinator {
+  using atomics_t = typename detail::atomics_of<coupled_t>::type;
+  using time_t = typename detail::first_of<atomics_t>::type::time_t;
+  using couplings_t = typename detail::flat_couplings_of<coupled_t, 0>::type;
+  using outputs_t = typename detail::as_outputs<typename detail::sources_of<coupled_t, 0>::type>::type;
+  static constexpr std::size_t size = detail::atomic_count<coupled_t>;
+
+  static_assert(detail::same_time<atomics_t, time_t>::value, "Atomic models must share the time type");
+
+  template<std::size_t index>
+  using model_at = std::tuple_element_t<index, typename detail::simulators_of<atomics_t>::models_t>;
+
+  static_coordinator() = default;
+
+  /**
+   * @param models the instances of the atomic models, in depth first order, for models with parameters
+   */
+  template<typename... model_ts> requires (sizeof...(model_ts) == size && size > 0)
+  explicit static_coordinator(model_ts... models) : _simulators(std::move(models)...) {}
+
+  /**
+   * Initializes every atomic model
+   * @param time the initial time
+   * @param states the initial state of each atomic model, in depth first order
+   */
+  template<typename... state_ts> requires (sizeof...(state_ts) == size)
+  void init(const time_t &time, state_ts &&... states) {
+    init_each(time, std::make_index_sequence<size>{}, std::forward<state_ts>(states)...);
+  }
+
+  /**
+   * @return the time the next event happens in, empty if all components are passive
+   */
+  [[nodiscard]] time_t t_next() const noexcept {
+    time_t next{};
+    for_each_index([&](auto index) {
+      next = detail::earliest_of(next, t_next_of<index>());
+    });
+    return next;
+  }
+
+  /**
+   * Executes the next event of the coupled model
+   * @param on_output called as on_output(from, time, value) for each value leaving the root through an
+   * output coupling, with from an std::integral_constant of the atomic model index
+   * @return the number of atomic models that changed state
+   */
+  template<typename F>
+  std::size_t step(F &&on_output) {
+    const time_t *earliest = nullptr;
+    for_each_index([&](auto index) {
+      const auto &t = t_next_of<index>();
+      if (!t.is_empty() && (!earliest || detail::upper_less(t, *earliest))) {
+        earliest = &t;
+      }
+    });
+    if (!earliest) {
+      return 0;
+    }
+    const time_t reference = *earliest;
+    time_t time = reference;
+    for_each_index([&](auto index) {
+      const auto &t = t_next_of<index>();
+      _imminent[index] = !t.is_empty() && !reference.certainly_before(t);
+      if (_imminent[index]) {
+        time = time.intersect(t);
+      }
+    });
+    for_each_index([&](auto index) {
+      if (_imminent[index]) {
+        route<index>(std::get<index>(_simulators).output(), time, on_output, couplings_t{}, outputs_t{});
+      }
+    });
+    std::size_t changed = 0;
+    for_each_index([&](auto index) {
+      auto &sim = std::get<index>(_simulators);
+      auto &inbox = std::get<index>(_inboxes);
+      if constexpr (cadmium::iadevs::has_external_transition<model_at<index>>) {
+        if (_imminent[index]) {
+          if (inbox.empty()) {
+            sim.internal_transition();
+          } else {
+            sim.confluent_transition(inbox);
+          }
+        } else if (!inbox.empty()) {
+          sim.external_transition(time, inbox);
+        } else {
+          return;
+        }
+        inbox.clear();
+      } else {
+        if (!_imminent[index]) {
+          return;
+        }
+        sim.internal_transition();
+      }
+      ++changed;
+    });
+    return changed;
+  }
+
+  std::size_t step() {
+    return step([](auto, const time_t &, const auto &) {});
+  }
+
+  /**
+   * Executes events while the next event time is certainly not after time,
+   * this is, while its upper endpoint is not greater than the time lower endpoint.
+   * @param time the time to simulate up to
+   * @param on_output called for each value leaving the root, as in step
+   * @return the number of events executed
+   */
+  template<typename F>
+  std::size_t run_until(const time_t &time, F &&on_output) {
+    std::size_t events = 0;
+    while (detail::is_certainly_not_after(t_next(), time)) {
+      step(on_output);
+      ++events;
+    }
+    return events;
+  }
+
+  std::size_t run_until(const time_t &time) {
+    return run_until(time, [](auto, const time_t &, const auto &) {});
+  }
+
+  /**
+   * @return the simulator of the atomic model at the given index, in depth first order
+   */
+  template<std::size_t index>
+  [[nodiscard]] const auto &get_simulator() const noexcept {
+    return std::get<index>(_simulators);
+  }
+
+private:
+  typename detail::simulators_of<atomics_t>::type _simulators;
+  typename detail::simulators_of<atomics_t>::inboxes_t _inboxes;
+  std::array<bool, size> _imminent{};
+
+  template<typename F>
+  static constexpr void for_each_index(F &&body) {
+    [&]<std::size_t... indexes>(std::index_sequence<indexes...>) {
+      (body(std::integral_constant<std::size_t, indexes>{}), ...);
+    }(std::make_index_sequence<size>{});
+  }
+
+  template<std::size_t index>
+  [[nodiscard]] const time_t &t_next_of() const noexcept {
+    return std::get<index>(_simulators).get_sim_state().t_next;
+  }
+
+  template<std::size_t... indexes, typename... state_ts>
+  void init_each(const time_t &time, std::index_sequence<indexes...>, state_ts &&... states) {
+    (std::get<indexes>(_simulators).init(std::forward<state_ts>(states), time), ...);
+    (std::get<indexes>(_inboxes).clear(), ...);
+  }
+
+  /**
+   * Delivers an output through every coupling from the atomic model at index from
+   */
+  template<std::size_t from, typename value_t, typename F, typename... coupling_ts, typename... output_ts>
+  void route(const value_t &value, const time_t &time, F &on_output, detail::type_list<coupling_ts...>,
+             detail::type_list<output_ts...>) {
+    ([&] {
+      if constexpr (coupling_ts::from == from) {
+        static_assert(cadmium::iadevs::has_external_transition<model_at<coupling_ts::to>>,
+                      "Coupling to an atomic model that does not receive inputs");
+        std::get<coupling_ts::to>(_inboxes).push_back(coupling_ts::chain::apply(value));
+      }
+    }(), ...);
+    ([&] {
+      if constexpr (output_ts::from == from) {
+        on_output(std::integral_constant<std::size_t, from>{}, time, output_ts::chain::apply(value));
+      }
+    }(), ...);
+  }
+};
+}
@@ -0,0 +1,209 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace cadmium::iadevs::engine {
+
+/**
+ * Fixed size pool of threads running data parallel loops with work stealing.
+ * Each call to parallel_for splits the index range in chunks dealt to per-thread queues;
+ * threads take chunks from the back of their own queue and steal from the front of the
+ * others, so uneven chunk costs are balanced. The calling thread takes part in the loop,
+ * and parallel_for returns once every index was processed.
+ * parallel_for is not reentrant, and a pool runs one loop at a time.
+ */
+struct thread_pool {
+  /**
+   * @param threads the number of threads running loops, including the calling thread
+   */
+  explicit thread_pool(std::size_t threads = std::max(1u, std::thread::hardware_concurrency()))
+      : _queues(std::max<std::size_t>(threads, 1)) {
+    for (std::size_t worker = 1; worker < _queues.size(); ++worker) {
+      _workers.emplace_back([this, worker] { work_loop(worker); });
+    }
+  }
+
+  thread_pool(const thread_pool &) = delete;
+  thread_pool &operator=(const thread_pool &) = delete;
+
+  ~thread_pool() {
+    {
+      std::lock_guard lock(_wake_mutex);
+      _stopping = true;
+    }
+    _wake.notify_all();
+    for (auto &worker : _workers) {
+      worker.join();
+    }
+  }
+
+  /**
+   * @return the number of threads running loops, including the calling thread
+   */
+  [[nodiscard]] std::size_t size() const noexcept {
+    return _queues.size();
+  }
+
+  /**
+   * Calls body(index) for every index in [0, count), distributed over the pool threads.
+   * The first exception thrown by body is rethrown once all the chunks are finished.
+   * @param count the number of indexes
+   * @param body the loop body, called concurrently from several threads
+   */
+  template<typename F>
+  void parallel_for(std::size_t count, F &&body) {
+    if (count == 0) {
+      return;
+    }
+    if (count == 1 || size() == 1) {
+      for (std::size_t index = 0; index < count; ++index) {
+        body(index);
+      }
+      return;
+    }
+    job loop{&body, [](void *context, std::size_t begin, std::size_t end) {
+      auto &f = *static_cast<std::remove_reference_t<F> *>(context);
+      for (std::size_t index = begin; index < end; ++index) {
+        f(index);
+      }
+    }};
+    // A few chunks per thread leave room for stealing without paying a queue operation per index
+    const std::size_t grain = std::max<std::size_t>(1, count / (size() * chunks_per_thread));
+    // Threads still looking for chunks of the previous loop may start on these as soon as they are queued
+    loop.pending.store((count + grain - 1) / grain, std::memory_order_release);
+    for (std::size_t begin = 0, chunks = 0; begin < count; begin += grain, ++chunks) {
+      auto &queue = _queues[chunks % size()];
+      std::lock_guard lock(queue.mutex);
+      queue.chunks.push_back(chunk{&loop, begin, std::min(begin + grain, count)});
+    }
+    {
+      std::lock_guard lock(_wake_mutex);
+      ++_generation;
+    }
+    _wake.notify_all();
+    run_chunks(0);
+    while (loop.pending.load(std::memory_order_acquire) != 0) {
+      std::this_thread::yield();
+    }
+    if (loop.error) {
+      std::rethrow_exception(loop.error);
+    }
+  }
+
+private:
+  static constexpr std::size_t chunks_per_thread = 4;
+
+  struct job {
+    void *context;
+    void (*run)(void *, std::size_t, std::size_t);
+    std::atomic<std::size_t> pending{0};
+    std::mutex error_mutex{};
+    std::exception_ptr error{};
+  };
+
+  struct chunk {
+    job *loop;
+    std::size_t begin;
+    std::size_t end;
+  };
+
+  struct queue {
+    std::mutex mutex;
+    std::deque<chunk> chunks;
+  };
+
+  std::vector<queue> _queues;
+  std::vector<std::thread> _workers;
+  std::mutex _wake_mutex;
+  std::condition_variable _wake;
+  std::size_t _generation = 0;
+  bool _stopping = false;
+
+  bool take(std::size_t worker, chunk &c) {
+    {
+      auto &own = _queues[worker];
+      std::lock_guard lock(own.mutex);
+      if (!own.chunks.empty()) {
+        c = own.chunks.back();
+        own.chunks.pop_back();
+        return true;
+      }
+    }
+    for (std::size_t k = 1; k < size(); ++k) {
+      auto &victim = _queues[(worker + k) % size()];
+      std::lock_guard lock(victim.mutex);
+      if (!victim.chunks.empty()) {
+        c = victim.chunks.front();
+        victim.chunks.pop_front();
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void run_chunks(std::size_t worker) {
+    chunk c{};
+    while (take(worker, c)) {
+      try {
+        c.loop->run(c.loop->context, c.begin, c.end);
+      } catch (...) {
+        std::lock_guard lock(c.loop->error_mutex);
+        if (!c.loop->error) {
+          c.loop->error = std::current_exception();
+        }
+      }
+      c.loop->pending.fetch_sub(1, std::memory_order_acq_rel);
+    }
+  }
+
+  void work_loop(std::size_t worker) {
+    std::size_t seen = 0;
+    while (true) {
+      {
+        std::unique_lock lock(_wake_mutex);
+        _wake.wait(lock, [&] { return _stopping || _generation != seen; });
+        if (_stopping) {
+          return;
+        }
+        seen = _generation;
+      }
+      run_chunks(worker);
+    }
+  }
+};
+}
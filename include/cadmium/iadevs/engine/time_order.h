@@ -0,0 +1,93 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <cadmium/iadevs/utils/ia_interval.h>
+
+namespace cadmium::iadevs::engine::detail {
+
+/**
+ * Order of lower endpoints: -inf first, and closed before open at the same value
+ */
+template<typename time_t>
+constexpr bool lower_less(const time_t &a, const time_t &b) noexcept {
+  if (b.is_left_unbounded()) {
+    return false;
+  }
+  if (a.is_left_unbounded()) {
+    return true;
+  }
+  return a.packed_lower_value() < b.packed_lower_value()
+      || (a.packed_lower_value() == b.packed_lower_value() && a.is_lower_endpoint_closed() && !b.is_lower_endpoint_closed());
+}
+
+/**
+ * Order of upper endpoints: +inf last, and open before closed at the same value
+ */
+template<typename time_t>
+constexpr bool upper_less(const time_t &a, const time_t &b) noexcept {
+  if (a.is_right_unbounded()) {
+    return false;
+  }
+  if (b.is_right_unbounded()) {
+    return true;
+  }
+  return a.packed_upper_value() < b.packed_upper_value()
+      || (a.packed_upper_value() == b.packed_upper_value() && !a.is_upper_endpoint_closed() && b.is_upper_endpoint_closed());
+}
+
+/**
+ * @return the next event time of two sets of events: from the smallest lower endpoint to the
+ * smallest upper endpoint, empty if both are
+ */
+template<typename time_t>
+constexpr time_t earliest_of(const time_t &a, const time_t &b) noexcept {
+  if (a.is_empty()) {
+    return b;
+  }
+  if (b.is_empty()) {
+    return a;
+  }
+  const auto &first = lower_less(b, a) ? b : a;
+  const auto &last = upper_less(b, a) ? b : a;
+  return time_t::from_packed(first.packed_lower_value(), last.packed_upper_value(),
+                             (first.packed_flags() & (interval_flags::lower_inf | interval_flags::lower_closed))
+                                 | (last.packed_flags() & (interval_flags::upper_inf | interval_flags::upper_closed)));
+}
+
+/**
+ * @return whether every element of t is at or before every element of limit, false if either is empty
+ * or t is right unbounded
+ */
+template<typename time_t>
+constexpr bool is_certainly_not_after(const time_t &t, const time_t &limit) {
+  auto upper = t.packed_upper_value();
+  auto lower = limit.packed_lower_value();
+  return t.try_get_upper_endpoint_value(upper) == interval_status::ok
+      && limit.try_get_lower_endpoint_value(lower) == interval_status::ok
+      && !(lower < upper);
+}
+}
@@ -0,0 +1,576 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <cadmium/iadevs/concepts.h>
+#include <cadmium/iadevs/engine/coupling_graph.h>
+#include <cadmium/iadevs/engine/simulator.h>
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace cadmium::iadevs::engine {
+
+/**
+ * Limits on the trajectories a trajectory_set tracks, exceeding any of them triggers merging
+ */
+struct trajectory_budget {
+  // Maximum number of trajectories kept after each round, at least one
+  std::size_t max_trajectories = 1024;
+  // Maximum bytes of component states kept after each round, zero for no limit
+  std::size_t max_bytes = 0;
+};
+
+/**
+ * What a trajectory_set did to keep the number of trajectories bounded
+ */
+struct trajectory_stats {
+  std::size_t rounds = 0;
+  // Trajectories created by branching, beyond the one each trajectory continues in
+  std::size_t branches = 0;
+  // Trajectories dropped for being identical to another one
+  std::size_t deduplicated = 0;
+  // Trajectories merged into the hull of another one
+  std::size_t merged = 0;
+  std::size_t peak_trajectories = 0;
+};
+
+namespace detail {
+template<typename T, typename... Ts>
+constexpr std::size_t index_of() {
+  constexpr bool matches[] = {std::is_same_v<T, Ts>...};
+  for (std::size_t k = 0; k < sizeof...(Ts); ++k) {
+    if (matches[k]) {
+      return k;
+    }
+  }
+  return sizeof...(Ts);
+}
+}
+
+/**
+ * Simulation of a coupled model tracking every trajectory it may follow.
+ * When components have overlapping next event times, the order they fire in is uncertain: each
+ * trajectory branches into one where all imminent components fire together, at the intersection
+ * of their t_next, and one per imminent component where it fires alone, before the earliest upper
+ * endpoint. Other components receive the outputs as in a coordinator.
+ * Branches are pruned after every round: identical trajectories are kept once, found by hash, and
+ * when the budget is exceeded trajectories whose states and next times overlap are merged into
+ * their hull. If that is not enough, neighbour trajectories in next event order are merged until
+ * the budget holds, trading precision for a bounded memory.
+ * @tparam time_t the time interval type
+ * @tparam message_t the type of the values exchanged through couplings
+ * @tparam model_ts the model types of the components, each listed once
+ */
+template<typename time_t, typename message_t, typename... model_ts> requires
+    (cadmium::iadevs::is_mergeable<model_ts> && ...)
+    && (std::same_as<typename model_ts::time_t, time_t> && ...)
+    && (std::same_as<typename model_ts::output_t, message_t> && ...)
+struct trajectory_set {
+  template<typename model_t>
+  using sim_state_of = sim_state_triplet<typename model_t::state_t, time_t>;
+
+  /**
+   * States of every component along a trajectory, grouped by model type
+   */
+  struct trajectory {
+    std::tuple<std::vector<sim_state_of<model_ts>>...> states;
+    std::size_t hash = 0;
+
+    bool operator==(const trajectory &that) const {
+      return states == that.states;
+    }
+  };
+
+  /**
+   * Adds an atomic component simulating model
+   * @param model the model instance
+   * @param initial_state the state the component starts in on init
+   * @return the id of the component
+   */
+  template<typename model_t>
+  std::size_t add_component(model_t model, typename model_t::state_t initial_state) {
+    constexpr std::size_t kind = detail::index_of<model_t, model_ts...>();
+    static_assert(kind < sizeof...(model_ts), "The model type is not one of the trajectory set model types");
+    auto &models = std::get<kind>(_models);
+    _placements.push_back(placement{kind, models.size()});
+    models.push_back(std::move(model));
+    std::get<kind>(_initial_states).push_back(std::move(initial_state));
+    return _placements.size() - 1;
+  }
+
+  /**
+   * Couples the output of a component to the input of another
+   * @throw std::out_of_range if any component does not exist
+   * @throw std::invalid_argument if the destination does not receive inputs
+   */
+  void add_coupling(std::size_t from, std::size_t to) {
+    if (from >= _placements.size() || to >= _placements.size()) {
+      throw std::out_of_range("Coupling refers to a component that does not exist");
+    }
+    if (!accepts_inputs[_placements[to].kind]) {
+      throw std::invalid_argument("Coupling to a component that does not receive inputs");
+    }
+    _couplings.push_back(coupling{from, to});
+  }
+
+  /**
+   * @throw std::invalid_argument if the budget allows no trajectory at all
+   */
+  void set_budget(const trajectory_budget &budget) {
+    if (budget.max_trajectories == 0) {
+      throw std::invalid_argument("The trajectory budget must allow at least one trajectory");
+    }
+    _budget = budget;
+  }
+
+  /**
+   * Starts a single trajectory with every component in its initial state,
+   * components and couplings cannot be added afterwards
+   * @param time the initial time
+   */
+  void init(const time_t &time) {
+    _graph = coupling_graph(_placements.size(), _couplings);
+    _inboxes.assign(_placements.size(), {});
+    _firing.assign(_placements.size(), 0);
+    _t_next.resize(_placements.size());
+    trajectory first;
+    for_each_kind([this, &time, &first]<std::size_t K>() {
+      const auto &models = std::get<K>(_models);
+      const auto &initial = std::get<K>(_initial_states);
+      auto &states = std::get<K>(first.states);
+      states.clear();
+      for (std::size_t i = 0; i < models.size(); ++i) {
+        states.push_back(sim_state_of<model_type<K>>{initial[i], time,
+                                                     models[i].time_bound_add(time, models[i].bounded_time_advance_i(initial[i]))});
+      }
+    });
+    first.hash = hash_of(first);
+    _trajectories.assign(1, std::move(first));
+    _stats = trajectory_stats{};
+    _stats.peak_trajectories = 1;
+  }
+
+  /**
+   * Executes rounds while some trajectory has an event certainly not after time. In each round,
+   * every such trajectory executes its next event in every order it may happen, and the others
+   * are kept as they are.
+   * @param time the time to simulate up to
+   * @return the number of rounds executed
+   */
+  std::size_t run_until(const time_t &time) {
+    std::size_t rounds = 0;
+    endpoint_t limit{};
+    if (time.try_get_lower_endpoint_value(limit) != interval_status::ok) {
+      return rounds;
+    }
+    while (true) {
+      _next.clear();
+      bool advanced = false;
+      for (auto &t : _trajectories) {
+        if (!expand(t, limit)) {
+          _next.push_back(std::move(t));
+        } else {
+          advanced = true;
+        }
+      }
+      std::swap(_trajectories, _next);
+      if (!advanced) {
+        break;
+      }
+      ++rounds;
+      ++_stats.rounds;
+      _stats.peak_trajectories = std::max(_stats.peak_trajectories, _trajectories.size());
+      prune();
+    }
+    return rounds;
+  }
+
+  [[nodiscard]] const std::vector<trajectory> &trajectories() const noexcept {
+    return _trajectories;
+  }
+
+  /**
+   * @return the state of a component along a trajectory
+   * @throw std::out_of_range if the trajectory or the component does not exist
+   */
+  template<typename model_t>
+  [[nodiscard]] const sim_state_of<model_t> &get_sim_state(std::size_t trajectory, std::size_t id) const {
+    constexpr std::size_t kind = detail::index_of<model_t, model_ts...>();
+    static_assert(kind < sizeof...(model_ts), "The model type is not one of the trajectory set model types");
+    const auto &p = _placements.at(id);
+    if (p.kind != kind) {
+      throw std::invalid_argument("The component does not simulate the model type requested");
+    }
+    return std::get<kind>(_trajectories.at(trajectory).states)[p.instance];
+  }
+
+  /**
+   * @return the hull of the state of a component over every trajectory
+   */
+  template<typename model_t>
+  [[nodiscard]] sim_state_of<model_t> hull(std::size_t id) const {
+    auto merged = get_sim_state<model_t>(0, id);
+    const auto &model = std::get<detail::index_of<model_t, model_ts...>()>(_models)[_placements[id].instance];
+    for (std::size_t k = 1; k < _trajectories.size(); ++k) {
+      const auto &s = get_sim_state<model_t>(k, id);
+      merged = sim_state_of<model_t>{detail::state_hull(model, merged.state, s.state), merged.t_last.hull(s.t_last),
+                                     merged.t_next.hull(s.t_next)};
+    }
+    return merged;
+  }
+
+  [[nodiscard]] const trajectory_stats &stats() const noexcept {
+    return _stats;
+  }
+
+  [[nodiscard]] std::size_t size() const noexcept {
+    return _placements.size();
+  }
+
+  /**
+   * @return the bytes of component states held by each trajectory, the unit of the byte budget
+   */
+  [[nodiscard]] std::size_t bytes_per_trajectory() const noexcept {
+    std::size_t bytes = sizeof(trajectory);
+    for_each_kind([this, &bytes]<std::size_t K>() {
+      bytes += std::get<K>(_models).size() * sizeof(sim_state_of<model_type<K>>);
+    });
+    return bytes;
+  }
+
+private:
+  using endpoint_t = endpoint_value_t<time_t>;
+
+  template<std::size_t K>
+  using model_type = std::tuple_element_t<K, std::tuple<model_ts...>>;
+
+  static constexpr bool accepts_inputs[] = {cadmium::iadevs::has_external_transition<model_ts>...};
+
+  struct placement {
+    std::size_t kind;
+    std::size_t instance;
+  };
+
+  std::tuple<std::vector<model_ts>...> _models;
+  std::tuple<std::vector<typename model_ts::state_t>...> _initial_states;
+  std::vector<placement> _placements;
+  std::vector<coupling> _couplings;
+  coupling_graph _graph;
+  trajectory_budget _budget;
+  trajectory_stats _stats;
+  std::vector<trajectory> _trajectories;
+  std::vector<trajectory> _next;
+  // Per round storage, kept across rounds to avoid allocations
+  std::vector<time_t> _t_next;
+  std::vector<std::size_t> _imminent;
+  std::vector<std::vector<message_t>> _inboxes;
+  std::vector<std::size_t> _receivers;
+  std::vector<std::uint8_t> _firing;
+  std::vector<std::size_t> _order;
+  std::vector<std::uint8_t> _duplicate;
+
+  template<typename F>
+  void for_each_kind(F &&body) const {
+    [&body]<std::size_t... K>(std::index_sequence<K...>) {
+      (body.template operator()<K>(), ...);
+    }(std::index_sequence_for<model_ts...>{});
+  }
+
+  // Calls body with the model and the state of a component
+  template<typename F>
+  void visit(trajectory &t, std::size_t id, F &&body) {
+    const auto &p = _placements[id];
+    for_each_kind([this, &t, &p, &body]<std::size_t K>() {
+      if (p.kind == K) {
+        body(std::get<K>(_models)[p.instance], std::get<K>(t.states)[p.instance]);
+      }
+    });
+  }
+
+  // Appends the successors of a trajectory to _next, false if it has no event until limit
+  bool expand(trajectory &t, endpoint_t limit) {
+    std::size_t earliest = _placements.size();
+    for (std::size_t id = 0; id < _placements.size(); ++id) {
+      visit(t, id, [this, id](const auto &, const auto &s) { _t_next[id] = s.t_next; });
+      if (!_t_next[id].is_empty() && !_t_next[id].is_right_unbounded()
+          && (earliest == _placements.size() || _t_next[id].packed_upper_value() < _t_next[earliest].packed_upper_value()
+              || (_t_next[id].packed_upper_value() == _t_next[earliest].packed_upper_value()
+                  && !_t_next[id].is_upper_endpoint_closed()))) {
+        earliest = id;
+      }
+    }
+    if (earliest == _placements.size() || limit < _t_next[earliest].packed_upper_value()) {
+      return false;
+    }
+    const auto &first = _t_next[earliest];
+    _imminent.clear();
+    for (std::size_t id = 0; id < _placements.size(); ++id) {
+      if (!_t_next[id].is_empty() && !first.certainly_before(_t_next[id])) {
+        _imminent.push_back(id);
+      }
+    }
+    // All imminent components together, the only order when there is a single one
+    time_t together = first;
+    for (auto id : _imminent) {
+      together = together.intersect(_t_next[id]);
+    }
+    if (_imminent.size() > 1) {
+      time_t before_first{};
+      before_first.set_left_unbounded_with_upper_endpoint_value(first.packed_upper_value(),
+                                                                first.is_upper_endpoint_closed());
+      for (std::size_t k = 0; k < _imminent.size(); ++k) {
+        const auto id = _imminent[k];
+        _next.push_back(t);
+        fire(_next.back(), std::span<const std::size_t>(&_imminent[k], 1), _t_next[id].intersect(before_first));
+      }
+      _stats.branches += _imminent.size();
+    }
+    _next.push_back(std::move(t));
+    fire(_next.back(), _imminent, together);
+    return true;
+  }
+
+  // Executes the event of the firing components at time along a trajectory
+  void fire(trajectory &t, std::span<const std::size_t> firing, const time_t &time) {
+    _receivers.clear();
+    for (auto id : firing) {
+      _firing[id] = 1;
+    }
+    for (auto id : firing) {
+      visit(t, id, [this, id](const auto &model, const auto &s) {
+        const message_t value = model.output_i(s.state);
+        for (auto to : _graph.destinations(id)) {
+          if (_inboxes[to].empty() && !_firing[to]) {
+            _receivers.push_back(to);
+          }
+          _inboxes[to].push_back(value);
+        }
+      });
+    }
+    for (auto id : firing) {
+      visit(t, id, [this, id, &time](const auto &model, auto &s) {
+        using model_t = std::remove_cvref_t<decltype(model)>;
+        if constexpr (cadmium::iadevs::has_external_transition<model_t>) {
+          if (!_inboxes[id].empty()) {
+            s.state = model.confluent_transition_i(s.state, std::span<const message_t>(_inboxes[id]));
+          } else {
+            s.state = model.internal_transition_i(s.state);
+          }
+        } else {
+          s.state = model.internal_transition_i(s.state);
+        }
+        s.t_last = time;
+        s.t_next = model.time_bound_add(time, model.bounded_time_advance_i(s.state));
+      });
+    }
+    for (auto id : _receivers) {
+      visit(t, id, [this, id, &time](const auto &model, auto &s) {
+        using model_t = std::remove_cvref_t<decltype(model)>;
+        if constexpr (cadmium::iadevs::has_external_transition<model_t>) {
+          const auto elapsed = model.time_bound_subtract(time, s.t_last);
+          s.state = model.external_transition_i(s.state, elapsed, std::span<const message_t>(_inboxes[id]));
+          s.t_last = time;
+          s.t_next = model.time_bound_add(time, model.bounded_time_advance_i(s.state));
+        }
+      });
+    }
+    for (auto id : firing) {
+      _firing[id] = 0;
+      _inboxes[id].clear();
+    }
+    for (auto id : _receivers) {
+      _inboxes[id].clear();
+    }
+    t.hash = hash_of(t);
+  }
+
+  // Drops duplicates, then merges trajectories while the budget is exceeded
+  void prune() {
+    deduplicate();
+    const std::size_t budget = max_trajectories();
+    if (_trajectories.size() > budget) {
+      merge_overlapping();
+    }
+    while (_trajectories.size() > budget) {
+      merge_neighbours();
+    }
+  }
+
+  [[nodiscard]] std::size_t max_trajectories() const noexcept {
+    std::size_t budget = _budget.max_trajectories;
+    if (_budget.max_bytes != 0) {
+      budget = std::min(budget, std::max<std::size_t>(1, _budget.max_bytes / bytes_per_trajectory()));
+    }
+    return budget;
+  }
+
+  // Keeps the first of identical trajectories, in their current order
+  void deduplicate() {
+    _order.resize(_trajectories.size());
+    std::iota(_order.begin(), _order.end(), std::size_t{0});
+    std::sort(_order.begin(), _order.end(), [this](std::size_t a, std::size_t b) {
+      return _trajectories[a].hash < _trajectories[b].hash || (_trajectories[a].hash == _trajectories[b].hash && a < b);
+    });
+    auto &duplicate = _duplicate;
+    duplicate.assign(_trajectories.size(), 0);
+    for (std::size_t k = 0; k < _order.size();) {
+      std::size_t end = k + 1;
+      while (end < _order.size() && _trajectories[_order[end]].hash == _trajectories[_order[k]].hash) {
+        ++end;
+      }
+      for (std::size_t a = k; a < end; ++a) {
+        for (std::size_t b = a + 1; b < end && !duplicate[_order[a]]; ++b) {
+          if (!duplicate[_order[b]] && _trajectories[_order[a]] == _trajectories[_order[b]]) {
+            duplicate[_order[b]] = 1;
+          }
+        }
+      }
+      k = end;
+    }
+    std::size_t kept = 0;
+    for (std::size_t k = 0; k < _trajectories.size(); ++k) {
+      if (!duplicate[k]) {
+        if (kept != k) {
+          _trajectories[kept] = std::move(_trajectories[k]);
+        }
+        ++kept;
+      }
+    }
+    _stats.deduplicated += _trajectories.size() - kept;
+    _trajectories.resize(kept);
+  }
+
+  // Merges each trajectory into the first kept one it overlaps with
+  void merge_overlapping() {
+    std::size_t kept = 0;
+    for (std::size_t k = 0; k < _trajectories.size(); ++k) {
+      std::size_t into = 0;
+      while (into < kept && !overlap(_trajectories[into], _trajectories[k])) {
+        ++into;
+      }
+      if (into < kept) {
+        merge(_trajectories[into], _trajectories[k]);
+        ++_stats.merged;
+      } else {
+        if (kept != k) {
+          _trajectories[kept] = std::move(_trajectories[k]);
+        }
+        ++kept;
+      }
+    }
+    _trajectories.resize(kept);
+  }
+
+  // Sorts trajectories by their next event and merges them in pairs
+  void merge_neighbours() {
+    std::vector<time_t> next(_trajectories.size());
+    for (std::size_t k = 0; k < _trajectories.size(); ++k) {
+      next[k] = next_event(_trajectories[k]);
+    }
+    _order.resize(_trajectories.size());
+    std::iota(_order.begin(), _order.end(), std::size_t{0});
+    std::stable_sort(_order.begin(), _order.end(), [&next](std::size_t a, std::size_t b) {
+      return !next[a].is_empty() && (next[b].is_empty() || next[a].packed_lower_value() < next[b].packed_lower_value());
+    });
+    std::vector<trajectory> merged;
+    merged.reserve((_order.size() + 1) / 2);
+    for (std::size_t k = 0; k < _order.size(); k += 2) {
+      merged.push_back(std::move(_trajectories[_order[k]]));
+      if (k + 1 < _order.size()) {
+        merge(merged.back(), _trajectories[_order[k + 1]]);
+        ++_stats.merged;
+      }
+    }
+    _trajectories = std::move(merged);
+  }
+
+  bool overlap(const trajectory &a, const trajectory &b) const {
+    bool all = true;
+    for_each_kind([this, &a, &b, &all]<std::size_t K>() {
+      const auto &models = std::get<K>(_models);
+      const auto &sa = std::get<K>(a.states);
+      const auto &sb = std::get<K>(b.states);
+      for (std::size_t i = 0; all && i < models.size(); ++i) {
+        all = detail::states_overlap(models[i], sa[i].state, sb[i].state)
+            && !sa[i].t_next.intersect(sb[i].t_next).is_empty();
+      }
+    });
+    return all;
+  }
+
+  void merge(trajectory &into, const trajectory &from) const {
+    for_each_kind([this, &into, &from]<std::size_t K>() {
+      const auto &models = std::get<K>(_models);
+      auto &si = std::get<K>(into.states);
+      const auto &sf = std::get<K>(from.states);
+      for (std::size_t i = 0; i < models.size(); ++i) {
+        si[i].state = detail::state_hull(models[i], si[i].state, sf[i].state);
+        si[i].t_last = si[i].t_last.hull(sf[i].t_last);
+        si[i].t_next = si[i].t_next.hull(sf[i].t_next);
+      }
+    });
+    into.hash = hash_of(into);
+  }
+
+  time_t next_event(const trajectory &t) const {
+    time_t next{};
+    for_each_kind([&t, &next]<std::size_t K>() {
+      for (const auto &s : std::get<K>(t.states)) {
+        if (!s.t_next.is_empty() && (next.is_empty() || s.t_next.packed_lower_value() < next.packed_lower_value())) {
+          next = s.t_next;
+        }
+      }
+    });
+    return next;
+  }
+
+  static std::size_t hash_of(const trajectory &t) {
+    std::size_t h = 0;
+    const auto combine = [&h](std::size_t v) { h = cadmium::iadevs::detail::hash_combine(h, v); };
+    [&]<std::size_t... K>(std::index_sequence<K...>) {
+      ([&] {
+        for (const auto &s : std::get<K>(t.states)) {
+          combine(std::hash<typename model_type<K>::state_t>{}(s.state));
+          combine(std::hash<time_t>{}(s.t_last));
+          combine(std::hash<time_t>{}(s.t_next));
+        }
+      }(), ...);
+    }(std::index_sequence_for<model_ts...>{});
+    return h;
+  }
+};
+}
@@ -0,0 +1,500 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <cadmium/iadevs/concepts.h>
+#include <cadmium/iadevs/engine/simulator.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace cadmium::iadevs::engine {
+
+/**
+ * Operations a simulation worker serves, first byte of each request frame
+ */
+enum class worker_op : std::uint8_t {
+  // Payload: state, time. Response: t_next
+  init = 1,
+  // Response: output
+  output = 2,
+  // Response: t_next
+  internal_transition = 3,
+  // Payload: time, input count, inputs. Response: t_next
+  external_transition = 4,
+  // Payload: input count, inputs. Response: t_next
+  confluent_transition = 5,
+  // Output and internal transition in one request. Response: output, t_next
+  step = 6,
+  // Response: state
+  get_state = 7,
+  // Stops serving once the batch is answered. Response: empty
+  shutdown = 8,
+};
+
+/**
+ * Outcome of a request, first byte of each response frame
+ */
+enum class worker_status : std::uint8_t {
+  ok = 0,
+  unknown_operation = 1,
+  // The instance was never initialized
+  unknown_instance = 2,
+  // The payload could not be decoded
+  malformed_request = 3,
+  // The model function threw, or the model does not support the operation
+  model_error = 4,
+};
+
+/**
+ * Sequence of frames stored back to back in a single buffer, so a whole batch of
+ * requests or responses is built without an allocation per frame and can be handed to
+ * the transport as is.
+ * Frame layouts are: request = op (1 byte), instance (u32), payload;
+ * response = status (1 byte), payload. Integers are little-endian, and each encoded
+ * value is prefixed with its u32 length.
+ */
+struct worker_batch {
+  void clear() noexcept {
+    _bytes.clear();
+    _offsets.assign(1, 0);
+  }
+
+  [[nodiscard]] std::size_t size() const noexcept {
+    return _offsets.size() - 1;
+  }
+
+  [[nodiscard]] std::span<const std::byte> frame(std::size_t k) const noexcept {
+    return {_bytes.data() + _offsets[k], _bytes.data() + _offsets[k + 1]};
+  }
+
+  /**
+   * Moves out the buffer holding every frame, leaving the batch empty
+   */
+  [[nodiscard]] std::vector<std::byte> release_bytes() noexcept {
+    auto bytes = std::move(_bytes);
+    clear();
+    return bytes;
+  }
+
+  [[nodiscard]] const std::vector<std::size_t> &offsets() const noexcept {
+    return _offsets;
+  }
+
+  // Appending to the last frame, end_frame closes it
+  void append_u8(std::uint8_t value) {
+    _bytes.push_back(std::byte{value});
+  }
+
+  void append_u32(std::uint32_t value) {
+    for (int k = 0; k < 4; ++k) {
+      _bytes.push_back(static_cast<std::byte>(value >> (8 * k)));
+    }
+  }
+
+  void append_value(std::span<const std::byte> bytes) {
+    append_u32(static_cast<std::uint32_t>(bytes.size()));
+    _bytes.insert(_bytes.end(), bytes.begin(), bytes.end());
+  }
+
+  // Appends bytes already encoded, without a length prefix
+  void append_bytes(std::span<const std::byte> bytes) {
+    _bytes.insert(_bytes.end(), bytes.begin(), bytes.end());
+  }
+
+  void end_frame() {
+    _offsets.push_back(_bytes.size());
+  }
+
+  // Rewriting the last frame, positions are offsets in the whole buffer
+  void set_byte(std::size_t position, std::uint8_t value) noexcept {
+    _bytes[position] = std::byte{value};
+  }
+
+  void truncate_frame(std::size_t size) noexcept {
+    _bytes.resize(size);
+  }
+
+private:
+  std::vector<std::byte> _bytes;
+  std::vector<std::size_t> _offsets{0};
+};
+
+/**
+ * Sequential reader over a frame, reads fail instead of going past the end
+ */
+struct worker_frame_reader {
+  explicit worker_frame_reader(std::span<const std::byte> frame) noexcept: _frame(frame) {}
+
+  bool read_u8(std::uint8_t &value) noexcept {
+    if (_frame.size() < 1) {
+      return false;
+    }
+    value = std::to_integer<std::uint8_t>(_frame[0]);
+    _frame = _frame.subspan(1);
+    return true;
+  }
+
+  bool read_u32(std::uint32_t &value) noexcept {
+    if (_frame.size() < 4) {
+      return false;
+    }
+    value = 0;
+    for (int k = 0; k < 4; ++k) {
+      value |= std::to_integer<std::uint32_t>(_frame[k]) << (8 * k);
+    }
+    _frame = _frame.subspan(4);
+    return true;
+  }
+
+  /**
+   * Reads a length-prefixed value in place, without copying it
+   */
+  bool read_value(std::span<const std::byte> &bytes) noexcept {
+    std::uint32_t length = 0;
+    if (!read_u32(length) || _frame.size() < length) {
+      return false;
+    }
+    bytes = _frame.first(length);
+    _frame = _frame.subspan(length);
+    return true;
+  }
+
+  [[nodiscard]] bool at_end() const noexcept {
+    return _frame.empty();
+  }
+
+  [[nodiscard]] std::size_t remaining() const noexcept {
+    return _frame.size();
+  }
+
+private:
+  std::span<const std::byte> _frame;
+};
+
+/**
+ * Typed encoding of the requests and responses of a worker simulating model_t
+ * @tparam model_t the atomic model simulated by the worker
+ * @tparam codec_t serialization for its state, time, output and input types
+ */
+template<typename model_t, typename codec_t> requires cadmium::iadevs::is_atomic<model_t>
+    && cadmium::iadevs::is_codec_for<codec_t, typename model_t::state_t>
+    && cadmium::iadevs::is_codec_for<codec_t, typename model_t::time_t>
+    && cadmium::iadevs::is_codec_for<codec_t, typename model_t::output_t>
+struct worker_protocol {
+  using state_t = typename model_t::state_t;
+  using time_t = typename model_t::time_t;
+  using output_t = typename model_t::output_t;
+  using input_t = typename detail::input_of<model_t>::type;
+
+  static void add_init(worker_batch &batch, std::uint32_t instance, const state_t &state, const time_t &time) {
+    begin(batch, worker_op::init, instance);
+    append(batch, state);
+    append(batch, time);
+    batch.end_frame();
+  }
+
+  static void add_output(worker_batch &batch, std::uint32_t instance) {
+    begin(batch, worker_op::output, instance);
+    batch.end_frame();
+  }
+
+  static void add_internal_transition(worker_batch &batch, std::uint32_t instance) {
+    begin(batch, worker_op::internal_transition, instance);
+    batch.end_frame();
+  }
+
+  static void add_external_transition(worker_batch &batch, std::uint32_t instance, const time_t &time,
+                                      std::span<const input_t> inputs)
+  requires cadmium::iadevs::has_external_transition<model_t> {
+    begin(batch, worker_op::external_transition, instance);
+    append(batch, time);
+    append_inputs(batch, inputs);
+    batch.end_frame();
+  }
+
+  static void add_confluent_transition(worker_batch &batch, std::uint32_t instance, std::span<const input_t> inputs)
+  requires cadmium::iadevs::has_external_transition<model_t> {
+    begin(batch, worker_op::confluent_transition, instance);
+    append_inputs(batch, inputs);
+    batch.end_frame();
+  }
+
+  static void add_step(worker_batch &batch, std::uint32_t instance) {
+    begin(batch, worker_op::step, instance);
+    batch.end_frame();
+  }
+
+  static void add_get_state(worker_batch &batch, std::uint32_t instance) {
+    begin(batch, worker_op::get_state, instance);
+    batch.end_frame();
+  }
+
+  static void add_shutdown(worker_batch &batch) {
+    begin(batch, worker_op::shutdown, 0);
+    batch.end_frame();
+  }
+
+  /**
+   * Reads the response to init and transition requests
+   * @return the response status, malformed_request if the frame is not a valid response
+   */
+  static worker_status read_t_next(std::span<const std::byte> frame, time_t &t_next) {
+    worker_frame_reader reader(frame);
+    const auto status = read_status(reader);
+    if (status != worker_status::ok) {
+      return status;
+    }
+    return read(reader, t_next) && reader.at_end() ? status : worker_status::malformed_request;
+  }
+
+  static worker_status read_output(std::span<const std::byte> frame, output_t &output) {
+    worker_frame_reader reader(frame);
+    const auto status = read_status(reader);
+    if (status != worker_status::ok) {
+      return status;
+    }
+    return read(reader, output) && reader.at_end() ? status : worker_status::malformed_request;
+  }
+
+  static worker_status read_step(std::span<const std::byte> frame, output_t &output, time_t &t_next) {
+    worker_frame_reader reader(frame);
+    const auto status = read_status(reader);
+    if (status != worker_status::ok) {
+      return status;
+    }
+    return read(reader, output) && read(reader, t_next) && reader.at_end() ? status : worker_status::malformed_request;
+  }
+
+  static worker_status read_state(std::span<const std::byte> frame, state_t &state) {
+    worker_frame_reader reader(frame);
+    const auto status = read_status(reader);
+    if (status != worker_status::ok) {
+      return status;
+    }
+    return read(reader, state) && reader.at_end() ? status : worker_status::malformed_request;
+  }
+
+  // Shared with the worker, which encodes the same layouts in the other direction
+
+  template<typename value_t>
+  static void append(worker_batch &batch, const value_t &value) {
+    thread_local std::vector<std::byte> scratch;
+    codec_t::encode(value, scratch);
+    batch.append_value(scratch);
+  }
+
+  template<typename value_t>
+  static bool read(worker_frame_reader &reader, value_t &value) {
+    std::span<const std::byte> bytes;
+    return reader.read_value(bytes) && codec_t::decode(bytes, value);
+  }
+
+  static void append_inputs(worker_batch &batch, std::span<const input_t> inputs) {
+    batch.append_u32(static_cast<std::uint32_t>(inputs.size()));
+    for (const auto &input : inputs) {
+      append(batch, input);
+    }
+  }
+
+private:
+  static void begin(worker_batch &batch, worker_op op, std::uint32_t instance) {
+    batch.append_u8(static_cast<std::uint8_t>(op));
+    batch.append_u32(instance);
+  }
+
+  static worker_status read_status(worker_frame_reader &reader) {
+    std::uint8_t status = 0;
+    if (!reader.read_u8(status) || status > static_cast<std::uint8_t>(worker_status::model_error)) {
+      return worker_status::malformed_request;
+    }
+    return static_cast<worker_status>(status);
+  }
+};
+
+/**
+ * Hosts simulator instances of a model and answers batches of requests for them.
+ * It is independent of the transport: each request frame produces exactly one response
+ * frame, in order, so requests for many instances are pipelined in a single round trip.
+ * Instance ids are chosen by the client and must be dense: an instance is initialized with an id
+ * already in use or the next one, so a request cannot make the worker allocate for ids it never uses.
+ * @tparam model_t the atomic model simulated
+ * @tparam codec_t serialization for its state, time, output and input types
+ */
+template<typename model_t, typename codec_t>
+struct simulation_worker {
+  using protocol_t = worker_protocol<model_t, codec_t>;
+  using state_t = typename model_t::state_t;
+  using time_t = typename model_t::time_t;
+  using input_t = typename protocol_t::input_t;
+
+  /**
+   * @param model the model instance every simulator is created from, for models with parameters
+   */
+  explicit simulation_worker(model_t model = {}) : _model(std::move(model)) {}
+
+  /**
+   * Answers a request, appending its response frame
+   * @param request the request frame
+   * @param responses the batch receiving the response frame
+   * @return the status of the response
+   */
+  worker_status handle(std::span<const std::byte> request, worker_batch &responses) {
+    worker_frame_reader reader(request);
+    std::uint8_t op = 0;
+    std::uint32_t instance = 0;
+    worker_status status = worker_status::malformed_request;
+    const std::size_t response_start = responses.offsets().back();
+    responses.append_u8(0);
+    if (reader.read_u8(op) && reader.read_u32(instance)) {
+      try {
+        status = dispatch(static_cast<worker_op>(op), instance, reader, responses);
+      } catch (...) {
+        status = worker_status::model_error;
+      }
+    }
+    if (status != worker_status::ok) {
+      responses.truncate_frame(response_start + 1);
+    }
+    responses.set_byte(response_start, static_cast<std::uint8_t>(status));
+    responses.end_frame();
+    return status;
+  }
+
+  /**
+   * @return true once a shutdown request was answered
+   */
+  [[nodiscard]] bool stopping() const noexcept {
+    return _stopping;
+  }
+
+  /**
+   * @return the simulator of an instance, nullptr if it was never initialized
+   */
+  [[nodiscard]] const simulator<model_t> *get_simulator(std::uint32_t instance) const noexcept {
+    return instance < _simulators.size() && _simulators[instance] ? &*_simulators[instance] : nullptr;
+  }
+
+private:
+  model_t _model;
+  std::vector<std::optional<simulator<model_t>>> _simulators;
+  std::vector<input_t> _inputs;
+  bool _stopping = false;
+
+  worker_status dispatch(worker_op op, std::uint32_t instance, worker_frame_reader &reader, worker_batch &responses) {
+    if (op < worker_op::init || op > worker_op::shutdown) {
+      return worker_status::unknown_operation;
+    }
+    if (op == worker_op::shutdown) {
+      _stopping = true;
+      return reader.at_end() ? worker_status::ok : worker_status::malformed_request;
+    }
+    if (op == worker_op::init) {
+      state_t state{};
+      time_t time{};
+      if (!protocol_t::read(reader, state) || !protocol_t::read(reader, time) || !reader.at_end()
+          || instance > _simulators.size()) {
+        return worker_status::malformed_request;
+      }
+      if (instance == _simulators.size()) {
+        _simulators.emplace_back();
+      }
+      _simulators[instance].emplace(_model);
+      protocol_t::append(responses, _simulators[instance]->init(std::move(state), std::move(time)).t_next);
+      return worker_status::ok;
+    }
+    if (instance >= _simulators.size() || !_simulators[instance]) {
+      return worker_status::unknown_instance;
+    }
+    auto &s = *_simulators[instance];
+    switch (op) {
+      case worker_op::output:
+        if (!reader.at_end()) {
+          return worker_status::malformed_request;
+        }
+        protocol_t::append(responses, s.output());
+        return worker_status::ok;
+      case worker_op::internal_transition:
+        if (!reader.at_end()) {
+          return worker_status::malformed_request;
+        }
+        s.internal_transition();
+        break;
+      case worker_op::step:
+        if (!reader.at_end()) {
+          return worker_status::malformed_request;
+        }
+        protocol_t::append(responses, s.step());
+        break;
+      case worker_op::get_state:
+        if (!reader.at_end()) {
+          return worker_status::malformed_request;
+        }
+        protocol_t::append(responses, s.get_sim_state().state);
+        return worker_status::ok;
+      case worker_op::external_transition:
+      case worker_op::confluent_transition:
+        if constexpr (cadmium::iadevs::has_external_transition<model_t>) {
+          time_t time{};
+          if ((op == worker_op::external_transition && !protocol_t::read(reader, time)) || !read_inputs(reader)) {
+            return worker_status::malformed_request;
+          }
+          if (op == worker_op::external_transition) {
+            s.external_transition(time, _inputs);
+          } else {
+            s.confluent_transition(_inputs);
+          }
+          break;
+        } else {
+          return worker_status::model_error;
+        }
+      default:
+        return worker_status::unknown_operation;
+    }
+    protocol_t::append(responses, s.get_sim_state().t_next);
+    return worker_status::ok;
+  }
+
+  bool read_inputs(worker_frame_reader &reader) {
+    std::uint32_t count = 0;
+    // Every input takes at least its length prefix, larger counts cannot be valid
+    if (!reader.read_u32(count) || count > reader.remaining() / 4) {
+      return false;
+    }
+    _inputs.resize(count);
+    for (auto &input : _inputs) {
+      if (!protocol_t::read(reader, input)) {
+        return false;
+      }
+    }
+    return reader.at_end();
+  }
+};
+}
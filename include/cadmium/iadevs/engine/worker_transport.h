@@ -0,0 +1,186 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <cadmium/iadevs/engine/worker_protocol.h>
+
+#include <zmq.hpp>
+#include <zmq_addon.hpp>
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <iterator>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace cadmium::iadevs::engine {
+
+namespace detail {
+/**
+ * Buffer shared by the frames of a batch sent without copies. Each message referring to it
+ * holds a reference, released by ZeroMQ once the message is sent or dropped, and the sender
+ * holds one more while building the messages.
+ */
+struct zmq_shared_buffer {
+  std::vector<std::byte> bytes;
+  std::atomic<std::size_t> references{1};
+
+  static void release(void *, void *hint) {
+    auto *buffer = static_cast<zmq_shared_buffer *>(hint);
+    if (buffer->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      delete buffer;
+    }
+  }
+};
+
+/**
+ * Sends the frames of a batch as the remaining parts of a multipart message,
+ * each frame referring to the batch buffer instead of copying it. Empty batches send nothing.
+ */
+inline void send_frames(zmq::socket_t &socket, worker_batch &batch) {
+  const auto offsets = batch.offsets();
+  const std::size_t frames = batch.size();
+  // Releases the sender reference on return or throw, the buffer lives on in the messages not yet sent
+  struct sender_reference {
+    zmq_shared_buffer *buffer;
+    ~sender_reference() {
+      zmq_shared_buffer::release(nullptr, buffer);
+    }
+  } sender{new zmq_shared_buffer{batch.release_bytes()}};
+  auto *buffer = sender.buffer;
+  for (std::size_t k = 0; k < frames; ++k) {
+    zmq::message_t message(buffer->bytes.data() + offsets[k], offsets[k + 1] - offsets[k],
+                           &zmq_shared_buffer::release, buffer);
+    // Counted once the message owns it, dropping the message releases it
+    buffer->references.fetch_add(1, std::memory_order_relaxed);
+    socket.send(std::move(message), k + 1 < frames ? zmq::send_flags::sndmore : zmq::send_flags::none);
+  }
+}
+
+inline std::span<const std::byte> frame_of(const zmq::message_t &message) noexcept {
+  return {static_cast<const std::byte *>(message.data()), message.size()};
+}
+}
+
+/**
+ * Responses to a batch of requests, read in place from the received message parts
+ */
+struct worker_responses {
+  [[nodiscard]] std::size_t size() const noexcept {
+    return _parts.size();
+  }
+
+  [[nodiscard]] std::span<const std::byte> frame(std::size_t k) const noexcept {
+    return detail::frame_of(_parts[k]);
+  }
+
+private:
+  friend struct worker_client;
+  std::vector<zmq::message_t> _parts;
+};
+
+/**
+ * Serves a simulation worker on a ROUTER socket until a shutdown request is answered.
+ * Each multipart message received is a batch of request frames after the client identity,
+ * and is answered with one multipart message holding a response frame per request.
+ * Messages holding only the identity are dropped.
+ * @param socket a bound or connected ROUTER socket
+ * @param worker the worker answering the requests
+ * @return false if the context was terminated before a shutdown request
+ */
+template<typename worker_t>
+bool serve_worker(zmq::socket_t &socket, worker_t &worker) {
+  std::vector<zmq::message_t> parts;
+  worker_batch responses;
+  while (!worker.stopping()) {
+    parts.clear();
+    try {
+      if (!zmq::recv_multipart(socket, std::back_inserter(parts))) {
+        continue;
+      }
+    } catch (const zmq::error_t &e) {
+      if (e.num() == ETERM) {
+        return false;
+      }
+      throw;
+    }
+    // Messages without requests after the identity get no response, there would be no frame to send
+    if (parts.size() < 2) {
+      continue;
+    }
+    for (std::size_t k = 1; k < parts.size(); ++k) {
+      worker.handle(detail::frame_of(parts[k]), responses);
+    }
+    socket.send(std::move(parts[0]), zmq::send_flags::sndmore);
+    detail::send_frames(socket, responses);
+  }
+  return true;
+}
+
+/**
+ * Client side of a simulation worker, over a DEALER socket.
+ * Batches can be sent before the responses of previous batches are received,
+ * responses arrive in the order the batches were sent.
+ */
+struct worker_client {
+  using responses_t = worker_responses;
+
+  /**
+   * @param context the ZeroMQ context
+   * @param endpoint the worker endpoint, eg. ipc:///tmp/worker or inproc://worker
+   */
+  worker_client(zmq::context_t &context, const std::string &endpoint)
+      : _socket(context, zmq::socket_type::dealer) {
+    _socket.set(zmq::sockopt::linger, 0);
+    _socket.connect(endpoint);
+  }
+
+  /**
+   * Sends a batch of requests, the batch is left empty to build the next one.
+   * Empty batches are not sent, and get no responses.
+   */
+  void send(worker_batch &requests) {
+    if (requests.size() != 0) {
+      detail::send_frames(_socket, requests);
+    }
+  }
+
+  /**
+   * Receives the responses of the oldest batch sent and not yet received
+   * @param responses receives one frame per request, in request order
+   */
+  void receive(worker_responses &responses) {
+    responses._parts.clear();
+    zmq::recv_multipart(_socket, std::back_inserter(responses._parts));
+  }
+
+private:
+  zmq::socket_t _socket;
+};
+}
@@ -29,41 +29,203 @@
  * Definition of a generic interval struct to use in IA models definition.
  * The order and bound functions are required to apply over domain_t values only.
  */
+#include <algorithm>
+#include <bit>
 #include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <numeric>
 #include <stdexcept>
 
 namespace cadmium::iadevs {
 
+/**
+ * Flags describing the shape of an interval, packed in a single byte.
+ * Endpoints flagged as infinite, and both endpoints of an empty interval, always
+ * hold a value-initialized domain_t so that every interval has a single representation.
+ */
+namespace interval_flags {
+constexpr std::uint8_t empty = 1u << 0;
+constexpr std::uint8_t lower_closed = 1u << 1;
+constexpr std::uint8_t upper_closed = 1u << 2;
+constexpr std::uint8_t lower_inf = 1u << 3;
+constexpr std::uint8_t upper_inf = 1u << 4;
+// Any of these flags takes an interval out of the bounded fast paths
+constexpr std::uint8_t not_bounded = empty | lower_inf | upper_inf;
+constexpr std::uint8_t closed = lower_closed | upper_closed;
+constexpr std::uint8_t inf = lower_inf | upper_inf;
+
+/**
+ * Swaps the lower and upper flags, as required when negating an interval
+ */
+constexpr std::uint8_t mirror(std::uint8_t flags) noexcept {
+  return (flags & empty)
+      | ((flags & lower_closed) << 1) | ((flags & upper_closed) >> 1)
+      | ((flags & lower_inf) << 1) | ((flags & upper_inf) >> 1);
+}
+
+/**
+ * Closed flags matching the given infinite flags, infinite endpoints are never closed
+ */
+constexpr std::uint8_t closed_mask_of(std::uint8_t inf_flags) noexcept {
+  return (inf_flags & inf) >> 2;
+}
+
+/**
+ * Closed flags of the hull of two bounded intervals: an endpoint is closed if
+ * any of the endpoints reaching the extreme value is closed
+ */
+template<typename T>
+constexpr std::uint8_t hull_closed(T a_lower, T a_upper, std::uint8_t a_flags,
+                                   T b_lower, T b_upper, std::uint8_t b_flags) noexcept {
+  return (((a_lower <= b_lower ? a_flags : 0) | (b_lower <= a_lower ? b_flags : 0)) & lower_closed)
+      | (((b_upper <= a_upper ? a_flags : 0) | (a_upper <= b_upper ? b_flags : 0)) & upper_closed);
+}
+
+/**
+ * Closed flags of the intersection of two bounded intervals: an endpoint is closed
+ * only if all the endpoints reaching the extreme value are closed
+ */
+template<typename T>
+constexpr std::uint8_t intersect_closed(T a_lower, T a_upper, std::uint8_t a_flags,
+                                        T b_lower, T b_upper, std::uint8_t b_flags) noexcept {
+  return ((b_lower <= a_lower ? a_flags : closed) & (a_lower <= b_lower ? b_flags : closed) & lower_closed)
+      | ((a_upper <= b_upper ? a_flags : closed) & (b_upper <= a_upper ? b_flags : closed) & upper_closed);
+}
+
+/**
+ * Finite endpoints of an intersection may describe no element at all
+ */
+template<typename T>
+constexpr bool is_empty_intersection(T lower, T upper, std::uint8_t flags) noexcept {
+  return upper < lower || (lower == upper && (flags & closed) != closed);
+}
+}
+
+/**
+ * Directed rounding of endpoint additions, lower endpoints are rounded down and upper endpoints up,
+ * so that the sum of two intervals includes the sum of every pair of their elements.
+ * Additions on exact domains, as integers, need no rounding.
+ */
+template<typename T>
+struct outward_rounding {
+  static constexpr bool is_exact = true;
+  static constexpr T add_down(T a, T b) noexcept {
+    return a + b;
+  }
+  static constexpr T add_up(T a, T b) noexcept {
+    return a + b;
+  }
+  static constexpr bool is_finite(T) noexcept {
+    return true;
+  }
+};
+
+/**
+ * IEEE 754 binary32 and binary64 additions are rounded to nearest by the processor, the rounding error
+ * is recovered exactly with Knuth's TwoSum and the sum is moved one ulp outwards when it was rounded
+ * inwards. Results are the same than rounding towards -inf and +inf, without switching the processor
+ * rounding mode, which must be left at its round to nearest default. Sums have to be evaluated in the
+ * precision of T (FLT_EVAL_METHOD 0, as on x86-64 and ARM), and options that reorder floating point
+ * arithmetic, as -ffast-math, break the error recovery.
+ * Sums overflowing in the outward direction are infinite, the ones overflowing inwards saturate to
+ * the largest finite value. Domains that are not exact report the sums that overflowed with is_finite.
+ */
+template<std::floating_point T> requires std::numeric_limits<T>::is_iec559 && (sizeof(T) == 4 || sizeof(T) == 8)
+struct outward_rounding<T> {
+  static constexpr bool is_exact = false;
+  using bits_t = std::conditional_t<sizeof(T) == 8, std::uint64_t, std::uint32_t>;
+
+  static constexpr T add_down(T a, T b) noexcept {
+    const T sum = a + b;
+    if (sum == std::numeric_limits<T>::infinity() && is_finite(a) && is_finite(b)) [[unlikely]] {
+      return std::numeric_limits<T>::max();
+    }
+    return rounding_error(a, b, sum) < 0 ? step(sum, sum < 0) : sum;
+  }
+
+  static constexpr T add_up(T a, T b) noexcept {
+    const T sum = a + b;
+    if (sum == -std::numeric_limits<T>::infinity() && is_finite(a) && is_finite(b)) [[unlikely]] {
+      return std::numeric_limits<T>::lowest();
+    }
+    return rounding_error(a, b, sum) > 0 ? step(sum, sum > 0) : sum;
+  }
+
+  /**
+   * Exact sum minus the rounded sum, NaN when the sum is infinite.
+   * A rounded sum is never zero unless exact, as sums of tiny values are exact thanks to subnormals.
+   */
+  static constexpr T rounding_error(T a, T b, T sum) noexcept {
+    const T b_virtual = sum - a;
+    const T a_virtual = sum - b_virtual;
+    return (a - a_virtual) + (b - b_virtual);
+  }
+
+  static constexpr bool is_finite(T value) noexcept {
+    return value - value == 0;
+  }
+
+private:
+  // Adjacent non-zero finite values of the same sign have adjacent bit patterns, stepping away
+  // from zero increments the pattern and stepping towards zero decrements it
+  static constexpr T step(T value, bool away) noexcept {
+    const bits_t bits = std::bit_cast<bits_t>(value);
+    return std::bit_cast<T>(bits + (away ? bits_t{1} : ~bits_t{0}));
+  }
+};
+
+/**
+ * Outcome of the non-throwing interval operations, each value other than ok matches
+ * one of the exceptions thrown by the equivalent throwing operation.
+ */
+enum class interval_status : std::uint8_t {
+  ok,
+  // The operation is out of the domain of empty intervals (std::domain_error)
+  empty_operand,
+  // A finite value was requested from an empty interval (std::out_of_range)
+  empty_interval,
+  // A finite value was requested from an infinite endpoint (std::out_of_range)
+  infinite_endpoint,
+  // The endpoints do not describe a non-empty interval (std::domain_error)
+  invalid_endpoints,
+  // The result is out of the range of domain_t (std::overflow_error)
+  overflow,
+};
+
 template<typename T>
 struct bound {
-  void set_value(T value, bool closed) {
+  constexpr void set_value(T value, bool closed) noexcept {
     _value = value;
-    _closed = closed;
+    _flags = closed ? closed_flag : 0;
   }
-  [[nodiscard]] bool is_closed() const {
-    return _closed;
+  [[nodiscard]] constexpr bool is_closed() const noexcept {
+    return _flags & closed_flag;
   }
 
-  T get_value() const {
+  constexpr T get_value() const {
     if (is_inf()) {
       throw std::out_of_range("Getting finite value from infinite bound");
     }
     return bound<T>::_value;
   }
 
-  [[nodiscard]] bool is_inf() const {
-    return _inf;
+  [[nodiscard]] constexpr bool is_inf() const noexcept {
+    return _flags & inf_flag;
   }
 
-  void set_inf() {
-    _inf = true;
-    _closed = false;
+  constexpr void set_inf() noexcept {
+    _value = T{};
+    _flags = inf_flag;
   }
 
 private:
-  bool _closed;
-  bool _inf;
-  T _value;
+  static constexpr std::uint8_t closed_flag = 1u << 0;
+  static constexpr std::uint8_t inf_flag = 1u << 1;
+  T _value{};
+  std::uint8_t _flags = 0;
 };
 
 /**
@@ -71,74 +233,184 @@ private:
  * In this context: left unbounded interval is an interval starting in -\inf with a finite upper bound;
  * right unbounded interval is an interval starting in a finite lower bound and extending to +\inf;
  * empty interval is an interval with no elements, and unbounded interval is the (-\inf, \inf) interval.
+ * Both endpoint values are stored next to each other followed by a single flags byte,
+ * which keeps the struct trivially copyable and as small as the domain_t alignment allows.
+ * Additions round endpoints outwards as defined by outward_rounding, so floating point intervals
+ * stay rigorous enclosures.
  * @tparam domain_t
  */
 template<typename domain_t> requires std::totally_ordered<domain_t>
     && requires(domain_t t) { t + t; }
 struct interval {
   using domain_bound_t = bound<domain_t>;
+  using rounding_t = outward_rounding<domain_t>;
+
+  /**
+   * Creates an empty interval
+   */
+  constexpr interval() noexcept = default;
+
+  /**
+   * Creates the bounded interval of a compile time literal, eg. interval<int>{997, true, 1005, true}
+   * Validation runs while compiling, so invalid endpoints fail the build instead of throwing.
+   * For runtime values use set_bounded.
+   * @param lower_value the lower bound value
+   * @param lower_closed is the lower bound closed?
+   * @param upper_value the upper bound value
+   * @param upper_closed is the upper bound closed?
+   */
+  consteval interval(domain_t lower_value, bool lower_closed, domain_t upper_value, bool upper_closed) {
+    set_bounded(lower_value, lower_closed, upper_value, upper_closed);
+  }
   /**
    * @return Is this a interval empty of elements?
    */
-  [[nodiscard]] bool is_empty() const {
-    return _empty;
+  [[nodiscard]] constexpr bool is_empty() const noexcept {
+    return _flags & interval_flags::empty;
   }
 
   /**
    * @return Is this interval lacking of a finite upper bound?
    */
-  [[nodiscard]] bool is_right_unbounded() const {
-    return is_bound_inf(_upper_bound);
+  [[nodiscard]] constexpr bool is_right_unbounded() const noexcept {
+    return _flags & interval_flags::upper_inf;
   }
 
   /**
    * @return Is this interval lacking of a finite lower bound?
    */
-  [[nodiscard]] bool is_left_unbounded() const {
-    return is_bound_inf(_lower_bound);
+  [[nodiscard]] constexpr bool is_left_unbounded() const noexcept {
+    return _flags & interval_flags::lower_inf;
   }
 
   /**
    * @return Is this interval unbounded at both ends?
    */
-  [[nodiscard]] bool is_unbounded() const {
-    return is_left_unbounded() && is_right_unbounded();
+  [[nodiscard]] constexpr bool is_unbounded() const noexcept {
+    return (_flags & interval_flags::inf) == interval_flags::inf;
+  }
+
+  /**
+   * @return Is this interval non-empty with finite values at both ends?
+   */
+  [[nodiscard]] constexpr bool is_bounded() const noexcept {
+    return !(_flags & interval_flags::not_bounded);
   }
 
   /**
    * @return Is this interval upper endpoint closed?
    */
-  [[nodiscard]] bool is_upper_endpoint_closed() const {
-    return is_bound_closed(_upper_bound);
+  [[nodiscard]] constexpr bool is_upper_endpoint_closed() const noexcept {
+    return _flags & interval_flags::upper_closed;
   }
 
   /**
    * @return Is this interval lower endpoint closed?
    */
-  [[nodiscard]] bool is_lower_endpoint_closed() const {
-    return is_bound_closed(_lower_bound);
+  [[nodiscard]] constexpr bool is_lower_endpoint_closed() const noexcept {
+    return _flags & interval_flags::lower_closed;
   }
 
   /**
    * @return lower endpoint finite value
    */
-  domain_t get_lower_endpoint_value() const {
-    return get_bound_value(_lower_bound);
+  constexpr domain_t get_lower_endpoint_value() const {
+    throw_if_no_value(finite_endpoint_status(interval_flags::lower_inf));
+    return _lower_value;
   }
 
   /**
    * @return upper endpoint finite value
    */
-  domain_t get_upper_endpoint_value() const {
-    return get_bound_value(_upper_bound);
+  constexpr domain_t get_upper_endpoint_value() const {
+    throw_if_no_value(finite_endpoint_status(interval_flags::upper_inf));
+    return _upper_value;
+  }
+
+  /**
+   * Non-throwing version of get_lower_endpoint_value
+   * @param value receives the lower endpoint finite value, untouched unless ok is returned
+   * @return ok, empty_interval or infinite_endpoint
+   */
+  constexpr interval_status try_get_lower_endpoint_value(domain_t &value) const noexcept {
+    const interval_status status = finite_endpoint_status(interval_flags::lower_inf);
+    if (status == interval_status::ok) [[likely]] {
+      value = _lower_value;
+    }
+    return status;
+  }
+
+  /**
+   * Non-throwing version of get_upper_endpoint_value
+   * @param value receives the upper endpoint finite value, untouched unless ok is returned
+   * @return ok, empty_interval or infinite_endpoint
+   */
+  constexpr interval_status try_get_upper_endpoint_value(domain_t &value) const noexcept {
+    const interval_status status = finite_endpoint_status(interval_flags::upper_inf);
+    if (status == interval_status::ok) [[likely]] {
+      value = _upper_value;
+    }
+    return status;
+  }
+
+  /**
+   * Non-throwing width of the interval, the distance between its endpoints. Widths of inexact domains
+   * are rounded upwards, so that they are never below the exact distance.
+   * @param width receives the upper endpoint minus the lower one, untouched unless ok is returned
+   * @return ok, empty_interval, infinite_endpoint, or overflow if an integral width is not representable
+   */
+  constexpr interval_status try_get_width(domain_t &width) const noexcept {
+    const interval_status status = bounded_status();
+    if (status != interval_status::ok) [[unlikely]] {
+      return status;
+    }
+    if constexpr (std::is_integral_v<domain_t>) {
+      domain_t difference{};
+      if (__builtin_sub_overflow(_upper_value, _lower_value, &difference)) [[unlikely]] {
+        return interval_status::overflow;
+      }
+      width = difference;
+    } else if constexpr (!rounding_t::is_exact) {
+      width = rounding_t::add_up(_upper_value, -_lower_value);
+    } else {
+      width = _upper_value - _lower_value;
+    }
+    return interval_status::ok;
+  }
+
+  /**
+   * Non-throwing split of a bounded interval at the midpoint of its endpoints, into the elements
+   * up to the midpoint, included, and the elements after it. Outer endpoints keep their closedness.
+   * @param low receives the lower half, untouched unless ok is returned
+   * @param high receives the upper half, untouched unless ok is returned
+   * @return ok, empty_interval, infinite_endpoint, or invalid_endpoints if the midpoint is not
+   * strictly between the endpoints
+   */
+  constexpr interval_status try_bisect(interval<domain_t> &low, interval<domain_t> &high) const noexcept {
+    const interval_status status = bounded_status();
+    if (status != interval_status::ok) {
+      return status;
+    }
+    domain_t middle{};
+    if constexpr (std::is_arithmetic_v<domain_t>) {
+      // Integral midpoints are rounded towards the lower endpoint, neither overflows
+      middle = std::midpoint(_lower_value, _upper_value);
+    } else {
+      middle = _lower_value + (_upper_value - _lower_value) / 2;
+    }
+    if (!(_lower_value < middle && middle < _upper_value)) {
+      return interval_status::invalid_endpoints;
+    }
+    low = from_packed(_lower_value, middle, (_flags & interval_flags::lower_closed) | interval_flags::upper_closed);
+    high = from_packed(middle, _upper_value, _flags & interval_flags::upper_closed);
+    return interval_status::ok;
   }
 
   /**
    * Set the interval as empty, including no elements
    */
-  void set_empty() {
-    _lower_bound.set_value(0, false);
-    _upper_bound.set_value(0, false);
+  constexpr void set_empty() noexcept {
+    set_packed(domain_t{}, domain_t{}, interval_flags::empty);
   }
 
   /**
@@ -146,9 +418,9 @@ struct interval {
    * @param value the upper endpoint
    * @param closed if the upper endpoint is itself included
    */
-  void set_left_unbounded_with_upper_endpoint_value(domain_t value, bool closed) {
-    set_finite_bound(_upper_bound, value, closed);
-    set_infinite_bound(_lower_bound);
+  constexpr void set_left_unbounded_with_upper_endpoint_value(domain_t value, bool closed) noexcept {
+    set_packed(domain_t{}, value,
+               interval_flags::lower_inf | (closed ? interval_flags::upper_closed : 0));
   }
 
   /**
@@ -156,9 +428,9 @@ struct interval {
    * @param value the upper endpoint
    * @param closed if the lower endpoint is itself included
    */
-  void set_right_unbounded_with_lower_endpoint_value(domain_t value, bool closed) {
-    set_finite_bound(_lower_bound, value, closed);
-    set_infinite_bound(_upper_bound);
+  constexpr void set_right_unbounded_with_lower_endpoint_value(domain_t value, bool closed) noexcept {
+    set_packed(value, domain_t{},
+               interval_flags::upper_inf | (closed ? interval_flags::lower_closed : 0));
   }
   /**
    * Set the interval to have both endpoints with finite values
@@ -167,78 +439,87 @@ struct interval {
    * @param upper_value the upper bound value
    * @param upper_closed is the upper bound closed?
    */
-  void set_bounded(domain_t lower_value, bool lower_closed, domain_t upper_value, bool upper_closed) {
+  constexpr void set_bounded(domain_t lower_value, bool lower_closed, domain_t upper_value, bool upper_closed) {
     if (lower_value == upper_value && (!lower_closed || !upper_closed)) {
       throw std::domain_error("There value cannot be included and excluded at the same time");
     }
     if (upper_value < lower_value) {
       throw std::domain_error("Upper endpoint has to be grater than lower endpoint");
     }
-    set_finite_bound(_lower_bound, lower_value, lower_closed);
-    set_finite_bound(_upper_bound, upper_value, upper_closed);
+    set_packed(lower_value, upper_value,
+               (lower_closed ? interval_flags::lower_closed : 0)
+                   | (upper_closed ? interval_flags::upper_closed : 0));
+  }
+
+  /**
+   * Non-throwing version of set_bounded
+   * @return ok, or invalid_endpoints leaving the interval untouched
+   */
+  constexpr interval_status try_set_bounded(domain_t lower_value, bool lower_closed,
+                                            domain_t upper_value, bool upper_closed) noexcept {
+    if (upper_value < lower_value || (lower_value == upper_value && (!lower_closed || !upper_closed))) {
+      return interval_status::invalid_endpoints;
+    }
+    set_packed(lower_value, upper_value,
+               (lower_closed ? interval_flags::lower_closed : 0)
+                   | (upper_closed ? interval_flags::upper_closed : 0));
+    return interval_status::ok;
   }
   /**
    * Set the interval to have no lower and no upper bounds effectively including all elements
    */
-  void set_unbounded() {
-    set_infinite_bound(_lower_bound);
-    set_infinite_bound(_upper_bound);
+  constexpr void set_unbounded() noexcept {
+    set_packed(domain_t{}, domain_t{}, interval_flags::inf);
   }
 
   /**
    * Add this interval and that interval by adding their endpoints independently
    * And endpoint in the result is closed only if the 2 endpoints being added are closed
+   * An endpoint in the result is infinite if any of the 2 endpoints being added is infinite
    * Adding to an empty is considered a domain error
    * @param that the interval to be added to this
    * @return a new interval with the addition result
    */
-  interval<domain_t> operator+(const interval<domain_t> &that) const {
-    interval<domain_t> result{};
-    if (is_empty() || that.is_empty()) {
+  constexpr interval<domain_t> operator+(const interval<domain_t> &that) const {
+    interval<domain_t> result;
+    if (try_add(that, result) != interval_status::ok) {
       throw std::domain_error("Adding to empty is out of the domain of interval addition");
     }
-    if (is_unbounded() || that.is_unbounded()
-        || (is_left_unbounded() && that.is_right_unbounded())
-        || (that.is_left_unbounded() && is_left_unbounded())
-        ) {
-      result.set_unbounded();
-    } else if (is_left_unbounded() || that.is_left_unbounded()) {
-      result.set_left_unbounded_with_upper_endpoint_value(
-          get_upper_endpoint_value() + that.get_upper_endpoint_value(),
-          is_upper_endpoint_closed() && that.is_upper_endpoint_closed());
-    } else if (is_right_unbounded() || that.is_right_unbounded()) {
-      result.set_right_unbounded_with_lower_endpoint_value(
-          get_lower_endpoint_value() + that.get_lower_endpoint_value(),
-          is_lower_endpoint_closed() && that.is_lower_endpoint_closed());
-    } else {
-      result.set_bounded(get_lower_endpoint_value() + that.get_lower_endpoint_value(),
-                         is_lower_endpoint_closed() && that.is_lower_endpoint_closed(),
-                         get_upper_endpoint_value() + that.get_upper_endpoint_value(),
-                         is_upper_endpoint_closed() && that.is_upper_endpoint_closed());
-    }
     return result;
   }
 
+  /**
+   * Non-throwing version of operator+
+   * @param that the interval to be added to this
+   * @param result receives the addition result, untouched unless ok is returned
+   * @return ok, or empty_operand if any of the intervals is empty
+   */
+  constexpr interval_status try_add(const interval<domain_t> &that, interval<domain_t> &result) const noexcept {
+    const std::uint8_t both = _flags | that._flags;
+    if (!(both & interval_flags::not_bounded)) [[likely]] {
+      // Closed flags are the only ones set, an endpoint stays closed if closed in both
+      result.set_sum(rounding_t::add_down(_lower_value, that._lower_value),
+                     rounding_t::add_up(_upper_value, that._upper_value),
+                     _flags & that._flags);
+      return interval_status::ok;
+    }
+    return try_add_not_bounded(that, result);
+  }
+
 /**
  * Negates an interval, eg. (5, 6) -> (-6, -5)
  * @return a new interval with the addition result
  */
-  interval<domain_t> operator-() const {
-    if (this->is_empty() || this->is_unbounded()) {
-      return *this;
+  constexpr interval<domain_t> operator-() const noexcept {
+    if (is_bounded()) [[likely]] {
+      return from_packed(-_upper_value, -_lower_value, interval_flags::mirror(_flags));
     }
-    interval<domain_t> result{};
-    if (this->is_left_unbounded()) {
-      result.set_right_unbounded_with_lower_endpoint_value(-this->get_lower_endpoint_value(),
-                                                           this->is_lower_endpoint_closed());
-    } else if (this->is_right_unbounded()) {
-      result.set_left_unbounded_with_upper_endpoint_value(-this->get_upper_endpoint_value(),
-                                                          this->is_upper_endpoint_closed());
-    } else {
-      result.set_bounded(-this->get_upper_endpoint_value(), this->is_upper_endpoint_closed(),
-                         -this->get_lower_endpoint_value(), this->is_lower_endpoint_closed());
+    if (is_empty() || is_unbounded()) {
+      return *this;
     }
-    return result;
+    return from_packed(is_right_unbounded() ? domain_t{} : -_upper_value,
+                       is_left_unbounded() ? domain_t{} : -_lower_value,
+                       interval_flags::mirror(_flags));
   }
 
   /**
@@ -247,71 +528,266 @@ struct interval {
  * @param that the interval to be subtracted to this
  * @return a new interval with the subtraction result
  */
-  interval<domain_t> operator-(const interval<domain_t> &that) const {
-    if (is_empty() || that.is_empty()) {
+  constexpr interval<domain_t> operator-(const interval<domain_t> &that) const {
+    interval<domain_t> result;
+    if (try_subtract(that, result) != interval_status::ok) {
       throw std::domain_error("Adding to empty is out of the domain of interval addition");
     }
-    return *this + (-that);
+    return result;
   }
 
-  bool operator==(const interval<domain_t> &that) const {
-    if (this->is_empty()) {
-      return that.is_empty();
+  /**
+   * Non-throwing version of binary operator-
+   * @param that the interval to be subtracted to this
+   * @param result receives the subtraction result, untouched unless ok is returned
+   * @return ok, or empty_operand if any of the intervals is empty
+   */
+  constexpr interval_status try_subtract(const interval<domain_t> &that, interval<domain_t> &result) const noexcept {
+    return try_add(-that, result);
+  }
+
+  /**
+   * Smallest interval including all the elements of this and that
+   * The hull with an empty interval is the other interval
+   * @param that the interval to be joined to this
+   * @return a new interval with the hull
+   */
+  constexpr interval<domain_t> hull(const interval<domain_t> &that) const noexcept {
+    if (is_empty()) {
+      return that;
+    }
+    if (that.is_empty()) {
+      return *this;
+    }
+    const std::uint8_t inf = (_flags | that._flags) & interval_flags::inf;
+    const std::uint8_t closed = interval_flags::hull_closed(_lower_value, _upper_value, _flags,
+                                                            that._lower_value, that._upper_value, that._flags);
+    return from_packed((inf & interval_flags::lower_inf) ? domain_t{} : std::min(_lower_value, that._lower_value),
+                       (inf & interval_flags::upper_inf) ? domain_t{} : std::max(_upper_value, that._upper_value),
+                       inf | (closed & ~interval_flags::closed_mask_of(inf)));
+  }
+
+  /**
+   * Interval of the elements included in both this and that
+   * The intersection with an empty interval is empty
+   * @param that the interval to be intersected with this
+   * @return a new interval with the intersection
+   */
+  constexpr interval<domain_t> intersect(const interval<domain_t> &that) const noexcept {
+    if ((_flags | that._flags) & interval_flags::empty) {
+      return interval<domain_t>{};
     }
-    if (this->is_unbounded()) {
-      return that.is_unbounded();
+    if (is_bounded() && that.is_bounded()) [[likely]] {
+      return intersect_bounded(_lower_value, _upper_value,
+                               that._lower_value, that._upper_value,
+                               interval_flags::intersect_closed(_lower_value, _upper_value, _flags,
+                                                                that._lower_value, that._upper_value, that._flags));
     }
-    if (this->is_left_unbounded()) {
-      if (that.is_left_unbounded()) {
-        return (this->get_upper_endpoint_value() == that.get_upper_endpoint_value())
-            && (this->is_upper_endpoint_closed() == that.is_upper_endpoint_closed());
+    // An infinite endpoint does not constrain the intersection, so the other operand endpoint is taken
+    const std::uint8_t inf = _flags & that._flags & interval_flags::inf;
+    domain_t lower{};
+    domain_t upper{};
+    std::uint8_t flags = inf;
+    if (!(inf & interval_flags::lower_inf)) {
+      if (is_left_unbounded() || (!that.is_left_unbounded() && _lower_value < that._lower_value)) {
+        lower = that._lower_value;
+        flags |= that._flags & interval_flags::lower_closed;
+      } else if (that.is_left_unbounded() || that._lower_value < _lower_value) {
+        lower = _lower_value;
+        flags |= _flags & interval_flags::lower_closed;
       } else {
-        return false;
+        lower = _lower_value;
+        flags |= _flags & that._flags & interval_flags::lower_closed;
       }
     }
-    if (this->is_right_unbounded()) {
-      if (that.is_right_unbounded()) {
-        return (this->get_lower_endpoint_value() == that.get_lower_endpoint_value())
-            && (this->is_lower_endpoint_closed() == that.is_lower_endpoint_closed());
+    if (!(inf & interval_flags::upper_inf)) {
+      if (is_right_unbounded() || (!that.is_right_unbounded() && that._upper_value < _upper_value)) {
+        upper = that._upper_value;
+        flags |= that._flags & interval_flags::upper_closed;
+      } else if (that.is_right_unbounded() || _upper_value < that._upper_value) {
+        upper = _upper_value;
+        flags |= _flags & interval_flags::upper_closed;
       } else {
-        return false;
+        upper = _upper_value;
+        flags |= _flags & that._flags & interval_flags::upper_closed;
       }
     }
-    return !that.is_left_unbounded()
-        && !that.is_right_unbounded()
-        && (this->get_upper_endpoint_value() == that.get_upper_endpoint_value())
-        && (this->get_lower_endpoint_value() == that.get_lower_endpoint_value())
-        && (this->is_lower_endpoint_closed() == that.is_lower_endpoint_closed())
-        && (this->is_upper_endpoint_closed() == that.is_upper_endpoint_closed());
+    if (!inf) {
+      return intersect_bounded(lower, upper, lower, upper, flags);
+    }
+    return from_packed(lower, upper, flags);
+  }
+
+  /**
+   * Is every element of this interval smaller than every element of that?
+   * Comparisons with an empty interval are false.
+   * @param that the interval compared to this
+   * @return true if this is certainly before that
+   */
+  [[nodiscard]] constexpr bool certainly_before(const interval<domain_t> &that) const noexcept {
+    if (((_flags | that._flags) & interval_flags::empty)
+        || (_flags & interval_flags::upper_inf) || (that._flags & interval_flags::lower_inf)) {
+      return false;
+    }
+    return _upper_value < that._lower_value
+        || (_upper_value == that._lower_value
+            && ((_flags & interval_flags::upper_closed) == 0 || (that._flags & interval_flags::lower_closed) == 0));
+  }
+
+  /**
+   * Is some element of this interval smaller than some element of that?
+   * Comparisons with an empty interval are false.
+   * @param that the interval compared to this
+   * @return true if this is possibly before that
+   */
+  [[nodiscard]] constexpr bool possibly_before(const interval<domain_t> &that) const noexcept {
+    if ((_flags | that._flags) & interval_flags::empty) {
+      return false;
+    }
+    return (_flags & interval_flags::lower_inf) || (that._flags & interval_flags::upper_inf)
+        || _lower_value < that._upper_value;
+  }
+
+  /**
+   * Representation is unique for each interval, so equality is a plain field comparison
+   */
+  constexpr bool operator==(const interval<domain_t> &that) const noexcept {
+    return (_flags == that._flags)
+        & (_lower_value == that._lower_value)
+        & (_upper_value == that._upper_value);
+  }
+
+  /**
+   * Raw access to the packed representation, for vectorized and serialization code.
+   * Values of infinite endpoints and of empty intervals are domain_t{}.
+   */
+  [[nodiscard]] constexpr std::uint8_t packed_flags() const noexcept {
+    return _flags;
+  }
+  [[nodiscard]] constexpr domain_t packed_lower_value() const noexcept {
+    return _lower_value;
+  }
+  [[nodiscard]] constexpr domain_t packed_upper_value() const noexcept {
+    return _upper_value;
+  }
+
+  /**
+   * Builds an interval from its packed representation without any validation.
+   * The caller is responsible for passing a well-formed, canonical representation.
+   */
+  static constexpr interval<domain_t> from_packed(domain_t lower_value, domain_t upper_value, std::uint8_t flags) noexcept {
+    interval<domain_t> result;
+    result.set_packed(lower_value, upper_value, flags);
+    return result;
   }
 
   //TODO: add other comparison and arithmetic operations
 private:
-  bool _empty = true;
-  domain_bound_t _lower_bound;
-  domain_bound_t _upper_bound;
+  domain_t _lower_value{};
+  domain_t _upper_value{};
+  std::uint8_t _flags = interval_flags::empty;
+
+  static constexpr interval<domain_t> intersect_bounded(domain_t a_lower, domain_t a_upper,
+                                                        domain_t b_lower, domain_t b_upper,
+                                                        std::uint8_t closed) noexcept {
+    const domain_t lower = std::max(a_lower, b_lower);
+    const domain_t upper = std::min(a_upper, b_upper);
+    if (interval_flags::is_empty_intersection(lower, upper, closed)) {
+      return interval<domain_t>{};
+    }
+    return from_packed(lower, upper, closed);
+  }
+
+  // Kept apart from try_add, so that the bounded fast path is small enough to inline in callers
+  constexpr interval_status try_add_not_bounded(const interval<domain_t> &that, interval<domain_t> &result) const noexcept {
+    const std::uint8_t both = _flags | that._flags;
+    if (both & interval_flags::empty) {
+      return interval_status::empty_operand;
+    }
+    const std::uint8_t inf = both & interval_flags::inf;
+    result.set_sum((inf & interval_flags::lower_inf) ? domain_t{} : rounding_t::add_down(_lower_value, that._lower_value),
+                   (inf & interval_flags::upper_inf) ? domain_t{} : rounding_t::add_up(_upper_value, that._upper_value),
+                   inf | (_flags & that._flags & interval_flags::closed));
+    return interval_status::ok;
+  }
 
-  bool is_bound_inf(const domain_bound_t &bound) const {
-    return bound.is_inf();
+  constexpr interval_status finite_endpoint_status(std::uint8_t inf_flag) const noexcept {
+    if (_flags & interval_flags::empty) {
+      return interval_status::empty_interval;
+    }
+    if (_flags & inf_flag) {
+      return interval_status::infinite_endpoint;
+    }
+    return interval_status::ok;
   }
-  bool is_bound_closed(const domain_bound_t &bound) const {
-    return bound.is_closed();
+
+  constexpr interval_status bounded_status() const noexcept {
+    const interval_status status = finite_endpoint_status(interval_flags::lower_inf);
+    return status == interval_status::ok ? finite_endpoint_status(interval_flags::upper_inf) : status;
   }
-  domain_t get_bound_value(const domain_bound_t &bound) const {
-    if (_empty) {
+
+  static constexpr void throw_if_no_value(interval_status status) {
+    if (status == interval_status::empty_interval) {
       throw std::out_of_range("There is no value on empty intervals");
     }
-    return bound.get_value();
+    if (status == interval_status::infinite_endpoint) {
+      throw std::out_of_range("Getting finite value from infinite bound");
+    }
+  }
+
+  constexpr void set_packed(domain_t lower_value, domain_t upper_value, std::uint8_t flags) noexcept {
+    _lower_value = lower_value;
+    _upper_value = upper_value;
+    _flags = flags;
+  }
+
+  /**
+   * Sets the result of an addition, rounded endpoints that overflowed outwards become infinite endpoints
+   */
+  constexpr void set_sum(domain_t lower_value, domain_t upper_value, std::uint8_t flags) noexcept {
+    if constexpr (!rounding_t::is_exact) {
+      if (!rounding_t::is_finite(lower_value) || !rounding_t::is_finite(upper_value)) [[unlikely]] {
+        set_overflowed_sum(lower_value, upper_value, flags);
+        return;
+      }
+    }
+    set_packed(lower_value, upper_value, flags);
   }
 
-  void set_finite_bound(domain_bound_t &bound, domain_t value, bool closed) {
-    _empty = false;
-    bound.set_value(value, closed);
+  // Kept out of line, so that the common sums inline into their callers
+  [[gnu::noinline]] constexpr void set_overflowed_sum(domain_t lower_value, domain_t upper_value,
+                                                      std::uint8_t flags) noexcept {
+    if (!rounding_t::is_finite(lower_value)) {
+      lower_value = domain_t{};
+      flags = (flags | interval_flags::lower_inf) & ~interval_flags::lower_closed;
+    }
+    if (!rounding_t::is_finite(upper_value)) {
+      upper_value = domain_t{};
+      flags = (flags | interval_flags::upper_inf) & ~interval_flags::upper_closed;
+    }
+    set_packed(lower_value, upper_value, flags);
   }
+};
+}
 
-  void set_infinite_bound(domain_bound_t &bound) {
-    _empty = false;
-    bound.set_inf();
+namespace cadmium::iadevs::detail {
+/**
+ * Mixes a hash into a seed, the way boost::hash_combine does
+ */
+constexpr std::size_t hash_combine(std::size_t seed, std::size_t value) noexcept {
+  return seed ^ (value + static_cast<std::size_t>(0x9e3779b97f4a7c15ull) + (seed << 6) + (seed >> 2));
+}
+}
+
+/**
+ * Hash of intervals, consistent with operator== as every interval has a single representation
+ */
+template<typename domain_t>
+struct std::hash<cadmium::iadevs::interval<domain_t>> {
+  std::size_t operator()(const cadmium::iadevs::interval<domain_t> &i) const noexcept {
+    using cadmium::iadevs::detail::hash_combine;
+    const std::size_t h = hash_combine(std::hash<domain_t>{}(i.packed_lower_value()),
+                                       std::hash<domain_t>{}(i.packed_upper_value()));
+    return hash_combine(h, i.packed_flags());
   }
 };
-}
\ No newline at end of file
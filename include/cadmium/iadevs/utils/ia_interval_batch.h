@@ -0,0 +1,444 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+/**
+ * Structure of arrays storage for many intervals of the same domain, and vectorized
+ * arithmetic over them. Results are bit-identical to applying the interval operators
+ * one element at a time, including the outward rounding of floating point sums.
+ * Blocks where all operands are bounded run on AVX2 or SSE registers when the
+ * compiler targets them, any other block falls back to the scalar interval operators.
+ */
+#include <cadmium/iadevs/utils/ia_interval.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace cadmium::iadevs {
+
+namespace detail {
+/**
+ * Single lane operations, used for the tail of the arrays and when no SIMD
+ * instructions are available for the domain.
+ * min and max pick the same operand than std::min and std::max on ties.
+ */
+template<typename T>
+struct scalar_lanes {
+  static constexpr std::size_t lanes = 1;
+  using reg_t = T;
+  static reg_t load(const T *p) { return *p; }
+  static void store(T *p, reg_t r) { *p = r; }
+  static reg_t add(reg_t x, reg_t y) { return x + y; }
+  static reg_t sub(reg_t x, reg_t y) { return x - y; }
+  static reg_t neg(reg_t x) { return -x; }
+  static reg_t min(reg_t x, reg_t y) { return (y < x) ? y : x; }
+  static reg_t max(reg_t x, reg_t y) { return (x < y) ? y : x; }
+  static reg_t add_down(reg_t x, reg_t y) { return outward_rounding<T>::add_down(x, y); }
+  static reg_t add_up(reg_t x, reg_t y) { return outward_rounding<T>::add_up(x, y); }
+  static bool all_finite(reg_t x) { return outward_rounding<T>::is_finite(x); }
+};
+
+template<typename T>
+struct simd_lanes : scalar_lanes<T> {};
+
+#if defined(__AVX2__)
+template<>
+struct simd_lanes<std::int32_t> {
+  static constexpr std::size_t lanes = 8;
+  using reg_t = __m256i;
+  static reg_t load(const std::int32_t *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+  static void store(std::int32_t *p, reg_t r) { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), r); }
+  static reg_t add(reg_t x, reg_t y) { return _mm256_add_epi32(x, y); }
+  static reg_t sub(reg_t x, reg_t y) { return _mm256_sub_epi32(x, y); }
+  static reg_t neg(reg_t x) { return _mm256_sub_epi32(_mm256_setzero_si256(), x); }
+  static reg_t min(reg_t x, reg_t y) { return _mm256_min_epi32(x, y); }
+  static reg_t max(reg_t x, reg_t y) { return _mm256_max_epi32(x, y); }
+  static reg_t add_down(reg_t x, reg_t y) { return add(x, y); }
+  static reg_t add_up(reg_t x, reg_t y) { return add(x, y); }
+};
+
+template<>
+struct simd_lanes<std::int64_t> {
+  static constexpr std::size_t lanes = 4;
+  using reg_t = __m256i;
+  static reg_t load(const std::int64_t *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+  static void store(std::int64_t *p, reg_t r) { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), r); }
+  static reg_t add(reg_t x, reg_t y) { return _mm256_add_epi64(x, y); }
+  static reg_t sub(reg_t x, reg_t y) { return _mm256_sub_epi64(x, y); }
+  static reg_t neg(reg_t x) { return _mm256_sub_epi64(_mm256_setzero_si256(), x); }
+  static reg_t min(reg_t x, reg_t y) { return _mm256_blendv_epi8(x, y, _mm256_cmpgt_epi64(x, y)); }
+  static reg_t max(reg_t x, reg_t y) { return _mm256_blendv_epi8(x, y, _mm256_cmpgt_epi64(y, x)); }
+  static reg_t add_down(reg_t x, reg_t y) { return add(x, y); }
+  static reg_t add_up(reg_t x, reg_t y) { return add(x, y); }
+};
+
+template<>
+struct simd_lanes<double> {
+  static constexpr std::size_t lanes = 4;
+  using reg_t = __m256d;
+  static reg_t load(const double *p) { return _mm256_loadu_pd(p); }
+  static void store(double *p, reg_t r) { _mm256_storeu_pd(p, r); }
+  static reg_t add(reg_t x, reg_t y) { return _mm256_add_pd(x, y); }
+  static reg_t sub(reg_t x, reg_t y) { return _mm256_sub_pd(x, y); }
+  static reg_t neg(reg_t x) { return _mm256_xor_pd(x, _mm256_set1_pd(-0.0)); }
+  // The hardware min/max return the second operand on ties, operands are swapped to match std::min/std::max
+  static reg_t min(reg_t x, reg_t y) { return _mm256_min_pd(y, x); }
+  static reg_t max(reg_t x, reg_t y) { return _mm256_max_pd(y, x); }
+  static reg_t add_down(reg_t x, reg_t y) { return add_outward<_CMP_LT_OQ>(x, y); }
+  static reg_t add_up(reg_t x, reg_t y) { return add_outward<_CMP_GT_OQ>(x, y); }
+  static bool all_finite(reg_t x) {
+    return _mm256_movemask_pd(_mm256_cmp_pd(_mm256_sub_pd(x, x), _mm256_setzero_pd(), _CMP_EQ_OQ)) == 0xF;
+  }
+private:
+  // Same steps than outward_rounding<double>, lanes whose rounding error has the outward sign move one ulp
+  template<int outward>
+  static reg_t add_outward(reg_t x, reg_t y) {
+    const reg_t sum = _mm256_add_pd(x, y);
+    const reg_t y_virtual = _mm256_sub_pd(sum, x);
+    const reg_t x_virtual = _mm256_sub_pd(sum, y_virtual);
+    const reg_t error = _mm256_add_pd(_mm256_sub_pd(x, x_virtual), _mm256_sub_pd(y, y_virtual));
+    const reg_t zero = _mm256_setzero_pd();
+    // Moving away from zero increments the bit pattern, moving towards zero decrements it
+    const __m256i away = _mm256_castpd_si256(_mm256_cmp_pd(sum, zero, outward));
+    const __m256i step = _mm256_sub_epi64(_mm256_and_si256(away, _mm256_set1_epi64x(2)), _mm256_set1_epi64x(1));
+    const reg_t moved = _mm256_castsi256_pd(_mm256_add_epi64(_mm256_castpd_si256(sum), step));
+    return _mm256_blendv_pd(sum, moved, _mm256_cmp_pd(error, zero, outward));
+  }
+};
+#elif defined(__SSE2__)
+template<>
+struct simd_lanes<std::int32_t> {
+  static constexpr std::size_t lanes = 4;
+  using reg_t = __m128i;
+  static reg_t load(const std::int32_t *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+  static void store(std::int32_t *p, reg_t r) { _mm_storeu_si128(reinterpret_cast<__m128i *>(p), r); }
+  static reg_t add(reg_t x, reg_t y) { return _mm_add_epi32(x, y); }
+  static reg_t sub(reg_t x, reg_t y) { return _mm_sub_epi32(x, y); }
+  static reg_t neg(reg_t x) { return _mm_sub_epi32(_mm_setzero_si128(), x); }
+  static reg_t min(reg_t x, reg_t y) { return select(_mm_cmpgt_epi32(x, y), y, x); }
+  static reg_t max(reg_t x, reg_t y) { return select(_mm_cmpgt_epi32(y, x), y, x); }
+  static reg_t add_down(reg_t x, reg_t y) { return add(x, y); }
+  static reg_t add_up(reg_t x, reg_t y) { return add(x, y); }
+private:
+  static reg_t select(reg_t mask, reg_t if_set, reg_t if_unset) {
+    return _mm_or_si128(_mm_and_si128(mask, if_set), _mm_andnot_si128(mask, if_unset));
+  }
+};
+
+template<>
+struct simd_lanes<double> {
+  static constexpr std::size_t lanes = 2;
+  using reg_t = __m128d;
+  static reg_t load(const double *p) { return _mm_loadu_pd(p); }
+  static void store(double *p, reg_t r) { _mm_storeu_pd(p, r); }
+  static reg_t add(reg_t x, reg_t y) { return _mm_add_pd(x, y); }
+  static reg_t sub(reg_t x, reg_t y) { return _mm_sub_pd(x, y); }
+  static reg_t neg(reg_t x) { return _mm_xor_pd(x, _mm_set1_pd(-0.0)); }
+  // The hardware min/max return the second operand on ties, operands are swapped to match std::min/std::max
+  static reg_t min(reg_t x, reg_t y) { return _mm_min_pd(y, x); }
+  static reg_t max(reg_t x, reg_t y) { return _mm_max_pd(y, x); }
+  static reg_t add_down(reg_t x, reg_t y) { return add_outward<false>(x, y); }
+  static reg_t add_up(reg_t x, reg_t y) { return add_outward<true>(x, y); }
+  static bool all_finite(reg_t x) {
+    return _mm_movemask_pd(_mm_cmpeq_pd(_mm_sub_pd(x, x), _mm_setzero_pd())) == 0x3;
+  }
+private:
+  // Same steps than outward_rounding<double>, lanes whose rounding error has the outward sign move one ulp
+  template<bool up>
+  static reg_t add_outward(reg_t x, reg_t y) {
+    const reg_t sum = _mm_add_pd(x, y);
+    const reg_t y_virtual = _mm_sub_pd(sum, x);
+    const reg_t x_virtual = _mm_sub_pd(sum, y_virtual);
+    const reg_t error = _mm_add_pd(_mm_sub_pd(x, x_virtual), _mm_sub_pd(y, y_virtual));
+    const reg_t zero = _mm_setzero_pd();
+    // Moving away from zero increments the bit pattern, moving towards zero decrements it
+    const __m128i away = _mm_castpd_si128(up ? _mm_cmpgt_pd(sum, zero) : _mm_cmplt_pd(sum, zero));
+    const __m128i step = _mm_sub_epi64(_mm_and_si128(away, _mm_set1_epi64x(2)), _mm_set1_epi64x(1));
+    const reg_t moved = _mm_castsi128_pd(_mm_add_epi64(_mm_castpd_si128(sum), step));
+    const reg_t outward = up ? _mm_cmpgt_pd(error, zero) : _mm_cmplt_pd(error, zero);
+    return _mm_or_pd(_mm_and_pd(outward, moved), _mm_andnot_pd(outward, sum));
+  }
+};
+#endif
+}
+
+/**
+ * A sequence of intervals stored as separate arrays of lower values, upper values and flags.
+ * Elements use the same packed representation than interval<domain_t>.
+ * @tparam domain_t
+ */
+template<typename domain_t>
+struct interval_batch {
+  using interval_t = interval<domain_t>;
+
+  interval_batch() = default;
+
+  /**
+   * @param size the number of intervals in the batch, all initially empty
+   */
+  explicit interval_batch(std::size_t size)
+      : _lower_values(size), _upper_values(size), _flags(size, interval_flags::empty) {}
+
+  [[nodiscard]] std::size_t size() const {
+    return _flags.size();
+  }
+
+  /**
+   * Resizes the batch, new elements are empty intervals.
+   * Shrinking keeps the capacity, so reusing a batch as output does not allocate.
+   */
+  void resize(std::size_t size) {
+    _lower_values.resize(size);
+    _upper_values.resize(size);
+    _flags.resize(size, interval_flags::empty);
+  }
+
+  void reserve(std::size_t capacity) {
+    _lower_values.reserve(capacity);
+    _upper_values.reserve(capacity);
+    _flags.reserve(capacity);
+  }
+
+  void push_back(const interval_t &i) {
+    _lower_values.push_back(i.packed_lower_value());
+    _upper_values.push_back(i.packed_upper_value());
+    _flags.push_back(i.packed_flags());
+  }
+
+  [[nodiscard]] interval_t get(std::size_t index) const {
+    return interval_t::from_packed(_lower_values[index], _upper_values[index], _flags[index]);
+  }
+
+  void set(std::size_t index, const interval_t &i) {
+    _lower_values[index] = i.packed_lower_value();
+    _upper_values[index] = i.packed_upper_value();
+    _flags[index] = i.packed_flags();
+  }
+
+  [[nodiscard]] std::span<const domain_t> lower_values() const { return _lower_values; }
+  [[nodiscard]] std::span<const domain_t> upper_values() const { return _upper_values; }
+  [[nodiscard]] std::span<const std::uint8_t> flags() const { return _flags; }
+
+  /**
+   * Elementwise a + b into result, result may be one of the operands
+   * Throws std::domain_error as interval addition when an element is empty
+   */
+  friend void add(const interval_batch &a, const interval_batch &b, interval_batch &result) {
+    transform(a, b, result, add_op{});
+  }
+
+  /**
+   * Elementwise a - b into result, result may be one of the operands
+   * Throws std::domain_error as interval subtraction when an element is empty
+   */
+  friend void subtract(const interval_batch &a, const interval_batch &b, interval_batch &result) {
+    transform(a, b, result, subtract_op{});
+  }
+
+  /**
+   * Elementwise -a into result, result may be the operand
+   */
+  friend void negate(const interval_batch &a, interval_batch &result) {
+    transform(a, a, result, negate_op{});
+  }
+
+  /**
+   * Elementwise hull of a and b into result, result may be one of the operands
+   */
+  friend void hull(const interval_batch &a, const interval_batch &b, interval_batch &result) {
+    transform(a, b, result, hull_op{});
+  }
+
+  /**
+   * Elementwise intersection of a and b into result, result may be one of the operands
+   */
+  friend void intersect(const interval_batch &a, const interval_batch &b, interval_batch &result) {
+    transform(a, b, result, intersect_op{});
+  }
+
+private:
+  std::vector<domain_t> _lower_values;
+  std::vector<domain_t> _upper_values;
+  std::vector<std::uint8_t> _flags;
+
+  // Each operation provides the register arithmetic for bounded operands, the closed
+  // flags for bounded operands, and the scalar operator for everything else.
+  struct add_op {
+    template<typename lanes_t, typename reg_t>
+    static void values(reg_t al, reg_t au, reg_t bl, reg_t bu, reg_t &rl, reg_t &ru) {
+      rl = lanes_t::add_down(al, bl);
+      ru = lanes_t::add_up(au, bu);
+    }
+    static std::uint8_t closed(domain_t, domain_t, std::uint8_t af, domain_t, domain_t, std::uint8_t bf) {
+      return af & bf;
+    }
+    static constexpr bool may_be_empty = false;
+    static constexpr bool rounds = true;
+    static interval_t scalar(const interval_t &a, const interval_t &b) { return a + b; }
+  };
+
+  struct subtract_op {
+    template<typename lanes_t, typename reg_t>
+    static void values(reg_t al, reg_t au, reg_t bl, reg_t bu, reg_t &rl, reg_t &ru) {
+      rl = lanes_t::add_down(al, lanes_t::neg(bu));
+      ru = lanes_t::add_up(au, lanes_t::neg(bl));
+    }
+    static std::uint8_t closed(domain_t, domain_t, std::uint8_t af, domain_t, domain_t, std::uint8_t bf) {
+      return af & interval_flags::mirror(bf);
+    }
+    static constexpr bool may_be_empty = false;
+    static constexpr bool rounds = true;
+    static interval_t scalar(const interval_t &a, const interval_t &b) { return a - b; }
+  };
+
+  struct negate_op {
+    template<typename lanes_t, typename reg_t>
+    static void values(reg_t al, reg_t au, reg_t, reg_t, reg_t &rl, reg_t &ru) {
+      rl = lanes_t::neg(au);
+      ru = lanes_t::neg(al);
+    }
+    static std::uint8_t closed(domain_t, domain_t, std::uint8_t af, domain_t, domain_t, std::uint8_t) {
+      return interval_flags::mirror(af);
+    }
+    static constexpr bool may_be_empty = false;
+    static constexpr bool rounds = false;
+    static interval_t scalar(const interval_t &a, const interval_t &) { return -a; }
+  };
+
+  struct hull_op {
+    template<typename lanes_t, typename reg_t>
+    static void values(reg_t al, reg_t au, reg_t bl, reg_t bu, reg_t &rl, reg_t &ru) {
+      rl = lanes_t::min(al, bl);
+      ru = lanes_t::max(au, bu);
+    }
+    static std::uint8_t closed(domain_t al, domain_t au, std::uint8_t af, domain_t bl, domain_t bu, std::uint8_t bf) {
+      return interval_flags::hull_closed(al, au, af, bl, bu, bf);
+    }
+    static constexpr bool may_be_empty = false;
+    static constexpr bool rounds = false;
+    static interval_t scalar(const interval_t &a, const interval_t &b) { return a.hull(b); }
+  };
+
+  struct intersect_op {
+    template<typename lanes_t, typename reg_t>
+    static void values(reg_t al, reg_t au, reg_t bl, reg_t bu, reg_t &rl, reg_t &ru) {
+      rl = lanes_t::max(al, bl);
+      ru = lanes_t::min(au, bu);
+    }
+    static std::uint8_t closed(domain_t al, domain_t au, std::uint8_t af, domain_t bl, domain_t bu, std::uint8_t bf) {
+      return interval_flags::intersect_closed(al, au, af, bl, bu, bf);
+    }
+    static constexpr bool may_be_empty = true;
+    static constexpr bool rounds = false;
+    static interval_t scalar(const interval_t &a, const interval_t &b) { return a.intersect(b); }
+  };
+
+  /**
+   * Processes lanes_t::lanes elements starting at index if all their operands are bounded
+   * @return false if any operand in the block is not bounded, nothing is written then
+   */
+  template<typename lanes_t, typename op_t>
+  static bool transform_bounded_block(const interval_batch &a, const interval_batch &b,
+                                      interval_batch &result, std::size_t index) {
+    constexpr std::size_t lanes = lanes_t::lanes;
+    std::uint8_t any_flags = 0;
+    for (std::size_t k = 0; k < lanes; ++k) {
+      any_flags |= a._flags[index + k] | b._flags[index + k];
+    }
+    if (any_flags & interval_flags::not_bounded) {
+      return false;
+    }
+    // Everything is computed into locals before writing, so result can alias the operands
+    typename lanes_t::reg_t lower, upper;
+    op_t::template values<lanes_t>(lanes_t::load(&a._lower_values[index]), lanes_t::load(&a._upper_values[index]),
+                                   lanes_t::load(&b._lower_values[index]), lanes_t::load(&b._upper_values[index]),
+                                   lower, upper);
+    // Sums overflowing the domain change the shape of the result, they are left to the scalar operator
+    if constexpr (op_t::rounds && !outward_rounding<domain_t>::is_exact) {
+      if (!lanes_t::all_finite(lower) || !lanes_t::all_finite(upper)) [[unlikely]] {
+        return false;
+      }
+    }
+    std::uint8_t flags[lanes];
+    for (std::size_t k = 0; k < lanes; ++k) {
+      const std::size_t i = index + k;
+      flags[k] = op_t::closed(a._lower_values[i], a._upper_values[i], a._flags[i],
+                              b._lower_values[i], b._upper_values[i], b._flags[i]);
+    }
+    lanes_t::store(&result._lower_values[index], lower);
+    lanes_t::store(&result._upper_values[index], upper);
+    for (std::size_t k = 0; k < lanes; ++k) {
+      const std::size_t i = index + k;
+      result._flags[i] = flags[k];
+      if constexpr (op_t::may_be_empty) {
+        if (interval_flags::is_empty_intersection(result._lower_values[i], result._upper_values[i], flags[k])) {
+          result.set(i, interval_t{});
+        }
+      }
+    }
+    return true;
+  }
+
+  template<typename op_t>
+  static void transform(const interval_batch &a, const interval_batch &b, interval_batch &result, op_t) {
+    if (a.size() != b.size()) {
+      throw std::invalid_argument("Interval batches have different sizes");
+    }
+    const std::size_t size = a.size();
+    result.resize(size);
+    using vector_lanes = detail::simd_lanes<domain_t>;
+    using single_lane = detail::scalar_lanes<domain_t>;
+    std::size_t index = 0;
+    for (; index + vector_lanes::lanes <= size; index += vector_lanes::lanes) {
+      if (transform_bounded_block<vector_lanes, op_t>(a, b, result, index)) [[likely]] {
+        continue;
+      }
+      for (std::size_t k = index; k < index + vector_lanes::lanes; ++k) {
+        transform_lane<single_lane, op_t>(a, b, result, k);
+      }
+    }
+    for (; index < size; ++index) {
+      transform_lane<single_lane, op_t>(a, b, result, index);
+    }
+  }
+
+  template<typename single_lane, typename op_t>
+  static void transform_lane(const interval_batch &a, const interval_batch &b, interval_batch &result,
+                             std::size_t index) {
+    if (!transform_bounded_block<single_lane, op_t>(a, b, result, index)) {
+      result.set(index, op_t::scalar(a.get(index), b.get(index)));
+    }
+  }
+};
+}
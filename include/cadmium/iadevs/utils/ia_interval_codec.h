@@ -0,0 +1,258 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <cadmium/iadevs/utils/ia_interval.h>
+
+#include <bit>
+#include <charconv>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace cadmium::iadevs {
+
+/**
+ * Opt-in for domain types wrapping a single integer, encoded as the bits of that integer
+ */
+template<typename T>
+inline constexpr bool enable_binary_encoding = false;
+
+/**
+ * Domains with a fixed-width binary representation: integers, IEEE single or double floats,
+ * and the integer wrappers enabling it
+ */
+template<typename T>
+concept is_binary_encodable = (std::integral<T> && !std::same_as<T, bool>)
+    || (std::floating_point<T> && std::numeric_limits<T>::is_iec559 && (sizeof(T) == 4 || sizeof(T) == 8))
+    || (enable_binary_encoding<T> && std::is_trivially_copyable_v<T> && (sizeof(T) == 4 || sizeof(T) == 8));
+
+namespace detail {
+// Unsigned integer holding the bits of an encoded endpoint value
+template<std::size_t size>
+struct unsigned_bits;
+template<>
+struct unsigned_bits<1> { using type = std::uint8_t; };
+template<>
+struct unsigned_bits<2> { using type = std::uint16_t; };
+template<>
+struct unsigned_bits<4> { using type = std::uint32_t; };
+template<>
+struct unsigned_bits<8> { using type = std::uint64_t; };
+}
+
+/**
+ * Fixed-width binary encoding of intervals over arithmetic domains, meant to be used
+ * as cache keys and values without going through text.
+ * Each interval takes encoded_size<T> bytes: a format version byte, the flags byte,
+ * and both endpoint values in little-endian order. Intervals are stored canonically,
+ * so two intervals are equal if and only if their encodings compare equal with memcmp.
+ * Decoding validates every byte and rejects anything encode cannot produce.
+ */
+struct interval_codec {
+  static constexpr std::uint8_t version = 1;
+
+  template<typename domain_t> requires is_binary_encodable<domain_t>
+  static constexpr std::size_t encoded_size = 2 + 2 * sizeof(domain_t);
+
+  /**
+   * Encodes an interval into a buffer of exactly encoded_size bytes
+   * @param i the interval to encode
+   * @param bytes the destination buffer
+   */
+  template<typename domain_t>
+  static constexpr void encode_to(const interval<domain_t> &i,
+                                  std::span<std::byte, encoded_size<domain_t>> bytes) noexcept {
+    bytes[0] = std::byte{version};
+    bytes[1] = std::byte{i.packed_flags()};
+    store(canonical(i.packed_lower_value()), bytes.template subspan<2, sizeof(domain_t)>());
+    store(canonical(i.packed_upper_value()), bytes.template subspan<2 + sizeof(domain_t), sizeof(domain_t)>());
+  }
+
+  /**
+   * Decodes an interval from a buffer of exactly encoded_size bytes
+   * @param bytes the encoded interval
+   * @param i receives the interval, untouched if the bytes are not a valid encoding
+   * @return true if the bytes were a valid encoding
+   */
+  template<typename domain_t>
+  static constexpr bool decode_from(std::span<const std::byte, encoded_size<domain_t>> bytes,
+                                    interval<domain_t> &i) noexcept {
+    const auto flags = std::to_integer<std::uint8_t>(bytes[1]);
+    const auto lower = load<domain_t>(bytes.template subspan<2, sizeof(domain_t)>());
+    const auto upper = load<domain_t>(bytes.template subspan<2 + sizeof(domain_t), sizeof(domain_t)>());
+    if (std::to_integer<std::uint8_t>(bytes[0]) != version || !is_canonical(lower, upper, flags)) {
+      return false;
+    }
+    i = interval<domain_t>::from_packed(lower, upper, flags);
+    return true;
+  }
+
+  /**
+   * Encodes an interval replacing the content of a byte vector
+   */
+  template<typename domain_t>
+  static void encode(const interval<domain_t> &i, std::vector<std::byte> &bytes) {
+    bytes.resize(encoded_size<domain_t>);
+    encode_to(i, std::span<std::byte, encoded_size<domain_t>>(bytes.data(), encoded_size<domain_t>));
+  }
+
+  /**
+   * Decodes an interval from a byte span of any length
+   * @return false if the span has the wrong size or is not a valid encoding
+   */
+  template<typename domain_t>
+  static constexpr bool decode(std::span<const std::byte> bytes, interval<domain_t> &i) noexcept {
+    return bytes.size() == encoded_size<domain_t>
+        && decode_from(bytes.template first<encoded_size<domain_t>>(), i);
+  }
+
+  /**
+   * Encodes a sequence of intervals back to back, without intermediate allocations
+   * @param intervals the intervals to encode
+   * @param bytes the destination, at least intervals.size() * encoded_size bytes
+   * @return the number of bytes written, zero if the destination is too small
+   */
+  template<typename domain_t>
+  static constexpr std::size_t encode_batch(std::span<const interval<domain_t>> intervals,
+                                            std::span<std::byte> bytes) noexcept {
+    constexpr std::size_t size = encoded_size<domain_t>;
+    if (bytes.size() / size < intervals.size()) {
+      return 0;
+    }
+    for (std::size_t k = 0; k < intervals.size(); ++k) {
+      encode_to(intervals[k], bytes.subspan(k * size).template first<size>());
+    }
+    return intervals.size() * size;
+  }
+
+  /**
+   * Decodes a sequence of intervals encoded back to back, reading the bytes in place
+   * @param bytes the encoded intervals, a whole multiple of encoded_size bytes
+   * @param intervals the destination, one interval per encoded interval
+   * @return false if the sizes do not match or any interval is not a valid encoding,
+   * in which case the destination content is unspecified
+   */
+  template<typename domain_t>
+  static constexpr bool decode_batch(std::span<const std::byte> bytes,
+                                     std::span<interval<domain_t>> intervals) noexcept {
+    constexpr std::size_t size = encoded_size<domain_t>;
+    if (bytes.size() != intervals.size() * size) {
+      return false;
+    }
+    for (std::size_t k = 0; k < intervals.size(); ++k) {
+      if (!decode_from(bytes.subspan(k * size).template first<size>(), intervals[k])) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * Human-readable form, eg. "[997, 1005)", "(-inf, 3]" or "{}". Intended for
+   * logs and test failures only, caching and messaging use the binary encoding.
+   */
+  template<typename domain_t>
+  static std::string to_debug_string(const interval<domain_t> &i) {
+    if (i.is_empty()) {
+      return "{}";
+    }
+    const auto flags = i.packed_flags();
+    std::string text = (flags & interval_flags::lower_closed) ? "[" : "(";
+    text += i.is_left_unbounded() ? "-inf" : to_chars(i.packed_lower_value());
+    text += ", ";
+    text += i.is_right_unbounded() ? "inf" : to_chars(i.packed_upper_value());
+    text += (flags & interval_flags::upper_closed) ? "]" : ")";
+    return text;
+  }
+
+private:
+  // Shortest text that reads back to the same value, std::to_string rounds floats to 6 decimals
+  template<typename domain_t>
+  static std::string to_chars(domain_t value) {
+    if constexpr (std::is_arithmetic_v<domain_t>) {
+      char buffer[64];
+      const auto end = std::to_chars(buffer, buffer + sizeof(buffer), value).ptr;
+      return {buffer, end};
+    } else {
+      return to_chars(value.count());
+    }
+  }
+
+  template<typename domain_t>
+  using bits_t = typename detail::unsigned_bits<sizeof(domain_t)>::type;
+
+  // Signed and unsigned zero are the same value, they have to share one encoding
+  template<typename domain_t>
+  static constexpr domain_t canonical(domain_t value) noexcept {
+    return value == domain_t{} ? domain_t{} : value;
+  }
+
+  template<typename domain_t>
+  static constexpr void store(domain_t value, std::span<std::byte, sizeof(domain_t)> bytes) noexcept {
+    const auto bits = std::bit_cast<bits_t<domain_t>>(value);
+    for (std::size_t k = 0; k < sizeof(domain_t); ++k) {
+      bytes[k] = static_cast<std::byte>(bits >> (8 * k));
+    }
+  }
+
+  template<typename domain_t>
+  static constexpr domain_t load(std::span<const std::byte, sizeof(domain_t)> bytes) noexcept {
+    bits_t<domain_t> bits = 0;
+    for (std::size_t k = 0; k < sizeof(domain_t); ++k) {
+      bits |= static_cast<bits_t<domain_t>>(std::to_integer<bits_t<domain_t>>(bytes[k]) << (8 * k));
+    }
+    return std::bit_cast<domain_t>(bits);
+  }
+
+  // Only the representations an interval can hold decode successfully
+  template<typename domain_t>
+  static constexpr bool is_canonical(domain_t lower, domain_t upper, std::uint8_t flags) noexcept {
+    constexpr std::uint8_t known = interval_flags::not_bounded | interval_flags::closed;
+    if ((flags & ~known) != 0 || std::bit_cast<bits_t<domain_t>>(canonical(lower)) != std::bit_cast<bits_t<domain_t>>(lower)
+        || std::bit_cast<bits_t<domain_t>>(canonical(upper)) != std::bit_cast<bits_t<domain_t>>(upper)) {
+      return false;
+    }
+    if (flags & interval_flags::empty) {
+      return flags == interval_flags::empty && lower == domain_t{} && upper == domain_t{};
+    }
+    if ((flags & interval_flags::closed_mask_of(flags)) != 0
+        || ((flags & interval_flags::lower_inf) && lower != domain_t{})
+        || ((flags & interval_flags::upper_inf) && upper != domain_t{})) {
+      return false;
+    }
+    if ((flags & interval_flags::inf) != 0) {
+      return lower == lower && upper == upper;
+    }
+    return lower <= upper && (lower != upper || (flags & interval_flags::closed) == interval_flags::closed);
+  }
+};
+}
@@ -0,0 +1,424 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+/**
+ * Set of elements of a domain represented as a union of disjoint intervals.
+ * Intervals are kept sorted and canonical, no two of them overlap or touch, so every set
+ * has a single representation. Set operations are linear merges over the sorted intervals,
+ * and the first inline_capacity intervals are stored in the set itself, which covers the
+ * common case of results made of a few fragments without allocating.
+ */
+#include <cadmium/iadevs/utils/ia_interval.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <utility>
+
+namespace cadmium::iadevs {
+
+template<typename domain_t, std::size_t inline_capacity = 4> requires std::totally_ordered<domain_t>
+    && requires(domain_t t) { t + t; } && (inline_capacity > 0)
+struct interval_set {
+  using interval_t = interval<domain_t>;
+  using const_iterator = const interval_t *;
+
+  /**
+   * Creates an empty set
+   */
+  interval_set() noexcept = default;
+
+  /**
+   * Creates the set of the elements of an interval, empty if the interval is empty
+   */
+  explicit interval_set(const interval_t &i) {
+    if (!i.is_empty()) {
+      push_back(i);
+    }
+  }
+
+  /**
+   * Creates the union of a list of intervals given in any order
+   */
+  interval_set(std::initializer_list<interval_t> intervals) {
+    for (const interval_t &i: intervals) {
+      insert(i);
+    }
+  }
+
+  interval_set(const interval_set &that) {
+    assign(that);
+  }
+
+  interval_set(interval_set &&that) noexcept {
+    steal(that);
+  }
+
+  interval_set &operator=(const interval_set &that) {
+    if (this != &that) {
+      _size = 0;
+      assign(that);
+    }
+    return *this;
+  }
+
+  interval_set &operator=(interval_set &&that) noexcept {
+    if (this != &that) {
+      _heap.reset();
+      _capacity = inline_capacity;
+      steal(that);
+    }
+    return *this;
+  }
+
+  [[nodiscard]] bool empty() const noexcept {
+    return _size == 0;
+  }
+
+  /**
+   * @return the number of disjoint intervals in the set
+   */
+  [[nodiscard]] std::size_t size() const noexcept {
+    return _size;
+  }
+
+  [[nodiscard]] std::size_t capacity() const noexcept {
+    return _capacity;
+  }
+
+  /**
+   * @return is the set stored in the inline buffer, with no heap allocation
+   */
+  [[nodiscard]] bool is_inline() const noexcept {
+    return !_heap;
+  }
+
+  [[nodiscard]] const_iterator begin() const noexcept {
+    return data();
+  }
+
+  [[nodiscard]] const_iterator end() const noexcept {
+    return data() + _size;
+  }
+
+  const interval_t &operator[](std::size_t index) const noexcept {
+    return data()[index];
+  }
+
+  void clear() noexcept {
+    _size = 0;
+  }
+
+  void reserve(std::size_t capacity) {
+    if (capacity > _capacity) {
+      grow(capacity);
+    }
+  }
+
+  /**
+   * Adds the elements of an interval to the set, merging it with the intervals it overlaps or touches
+   */
+  void insert(const interval_t &i) {
+    if (i.is_empty()) {
+      return;
+    }
+    // Intervals ending before i and not touching it are kept, as are the ones starting after it
+    interval_t *first = std::partition_point(data(), data() + _size, [&i](const interval_t &x) {
+      return !connected(x, i);
+    });
+    interval_t *last = std::partition_point(first, data() + _size, [&i](const interval_t &x) {
+      return connected(i, x);
+    });
+    if (first != last) {
+      *first = first->hull(i).hull(*(last - 1));
+      std::move(last, data() + _size, first + 1);
+      _size -= static_cast<std::size_t>(last - first) - 1;
+      return;
+    }
+    const auto index = static_cast<std::size_t>(first - data());
+    push_back(i);
+    std::move_backward(data() + index, data() + _size - 1, data() + _size);
+    data()[index] = i;
+  }
+
+  /**
+   * @return is the value an element of the set?
+   */
+  [[nodiscard]] bool contains(domain_t value) const noexcept {
+    interval_t point{};
+    point.set_bounded(value, true, value, true);
+    return overlaps(point);
+  }
+
+  /**
+   * @return has the set any element in common with the interval?
+   */
+  [[nodiscard]] bool overlaps(const interval_t &i) const noexcept {
+    const interval_t *it = first_not_before(i);
+    return it != end() && !it->intersect(i).is_empty();
+  }
+
+  /**
+   * @return are all the elements of the interval in the set? The empty interval is always included.
+   */
+  [[nodiscard]] bool includes(const interval_t &i) const noexcept {
+    if (i.is_empty()) {
+      return true;
+    }
+    const interval_t *it = first_not_before(i);
+    return it != end() && it->intersect(i) == i;
+  }
+
+  /**
+   * @return the smallest interval including all the elements of the set, empty for the empty set
+   */
+  [[nodiscard]] interval_t hull() const noexcept {
+    return empty() ? interval_t{} : front().hull(back());
+  }
+
+  /**
+   * Set of the elements in this or that
+   */
+  [[nodiscard]] interval_set unite(const interval_set &that) const {
+    interval_set result;
+    result.reserve(_size + that._size);
+    const interval_t *a = begin();
+    const interval_t *b = that.begin();
+    while (a != end() || b != that.end()) {
+      if (b == that.end() || (a != end() && !lower_before(*b, *a))) {
+        result.append(*a++);
+      } else {
+        result.append(*b++);
+      }
+    }
+    return result;
+  }
+
+  /**
+   * Set of the elements in both this and that
+   */
+  [[nodiscard]] interval_set intersect(const interval_set &that) const {
+    interval_set result;
+    const interval_t *a = begin();
+    const interval_t *b = that.begin();
+    while (a != end() && b != that.end()) {
+      const interval_t i = a->intersect(*b);
+      if (!i.is_empty()) {
+        result.push_back(i);
+      }
+      // The interval ending first cannot intersect any later interval of the other set
+      if (upper_before(*a, *b)) {
+        ++a;
+      } else {
+        ++b;
+      }
+    }
+    return result;
+  }
+
+  /**
+   * Set of the elements of the domain not in this set
+   */
+  [[nodiscard]] interval_set complement() const {
+    interval_set result;
+    // The gap before each interval starts where the previous interval ends, with the closedness flipped
+    domain_t lower{};
+    std::uint8_t flags = interval_flags::lower_inf;
+    for (const interval_t &i: *this) {
+      if (!i.is_left_unbounded()) {
+        result.push_back(interval_t::from_packed(
+            lower, i.packed_lower_value(),
+            flags | (i.is_lower_endpoint_closed() ? 0 : interval_flags::upper_closed)));
+      }
+      if (i.is_right_unbounded()) {
+        return result;
+      }
+      lower = i.packed_upper_value();
+      flags = i.is_upper_endpoint_closed() ? 0 : interval_flags::lower_closed;
+    }
+    result.push_back(interval_t::from_packed(lower, domain_t{}, flags | interval_flags::upper_inf));
+    return result;
+  }
+
+  /**
+   * Set of the elements in this and not in that
+   */
+  [[nodiscard]] interval_set difference(const interval_set &that) const {
+    if (empty() || that.empty()) {
+      return *this;
+    }
+    return intersect(that.complement());
+  }
+
+  /**
+   * Minkowski sum, the set of the sums of an element of this and an element of that.
+   * The sum with an empty set is empty, as there is no pair of elements to add.
+   */
+  [[nodiscard]] interval_set operator+(const interval_t &that) const {
+    interval_set result;
+    if (that.is_empty()) {
+      return result;
+    }
+    result.reserve(_size);
+    // Adding the same interval keeps the lower endpoints sorted, so only touching results need merging
+    for (const interval_t &i: *this) {
+      interval_t sum{};
+      i.try_add(that, sum);
+      result.append(sum);
+    }
+    return result;
+  }
+
+  /**
+   * Minkowski sum of two sets, merging the shifted copies of this set one interval of that at a time
+   */
+  [[nodiscard]] interval_set operator+(const interval_set &that) const {
+    interval_set result;
+    for (const interval_t &i: that) {
+      result = result.unite(*this + i);
+    }
+    return result;
+  }
+
+  /**
+   * Representation is unique for each set, so equality is an interval by interval comparison
+   */
+  bool operator==(const interval_set &that) const noexcept {
+    return std::equal(begin(), end(), that.begin(), that.end());
+  }
+
+private:
+  interval_t _inline[inline_capacity]{};
+  std::unique_ptr<interval_t[]> _heap;
+  std::size_t _size = 0;
+  std::size_t _capacity = inline_capacity;
+
+  [[nodiscard]] interval_t *data() noexcept {
+    return _heap ? _heap.get() : _inline;
+  }
+
+  [[nodiscard]] const interval_t *data() const noexcept {
+    return _heap ? _heap.get() : _inline;
+  }
+
+  [[nodiscard]] const interval_t &front() const noexcept {
+    return data()[0];
+  }
+
+  [[nodiscard]] const interval_t &back() const noexcept {
+    return data()[_size - 1];
+  }
+
+  void grow(std::size_t capacity) {
+    auto heap = std::make_unique<interval_t[]>(capacity);
+    std::copy(data(), data() + _size, heap.get());
+    _heap = std::move(heap);
+    _capacity = capacity;
+  }
+
+  void push_back(const interval_t &i) {
+    if (_size == _capacity) {
+      grow(2 * _capacity);
+    }
+    data()[_size++] = i;
+  }
+
+  /**
+   * Appends an interval starting no earlier than every interval in the set, merging it with the last one if they connect
+   */
+  void append(const interval_t &i) {
+    if (_size != 0 && connected(back(), i)) {
+      data()[_size - 1] = back().hull(i);
+    } else {
+      push_back(i);
+    }
+  }
+
+  void assign(const interval_set &that) {
+    reserve(that._size);
+    std::copy(that.begin(), that.end(), data());
+    _size = that._size;
+  }
+
+  void steal(interval_set &that) noexcept {
+    if (that._heap) {
+      _heap = std::move(that._heap);
+      _capacity = that._capacity;
+    } else {
+      std::copy(that._inline, that._inline + that._size, _inline);
+    }
+    _size = that._size;
+    that._size = 0;
+    that._capacity = inline_capacity;
+  }
+
+  const interval_t *first_not_before(const interval_t &i) const noexcept {
+    return std::partition_point(begin(), end(), [&i](const interval_t &x) {
+      return x.certainly_before(i);
+    });
+  }
+
+  /**
+   * Does the lower endpoint of a start strictly before the lower endpoint of b? Both are non-empty.
+   */
+  static bool lower_before(const interval_t &a, const interval_t &b) noexcept {
+    if (a.is_left_unbounded() || b.is_left_unbounded()) {
+      return !b.is_left_unbounded();
+    }
+    return a.packed_lower_value() < b.packed_lower_value()
+        || (a.packed_lower_value() == b.packed_lower_value()
+            && a.is_lower_endpoint_closed() && !b.is_lower_endpoint_closed());
+  }
+
+  /**
+   * Does the upper endpoint of a end strictly before the upper endpoint of b? Both are non-empty.
+   */
+  static bool upper_before(const interval_t &a, const interval_t &b) noexcept {
+    if (a.is_right_unbounded() || b.is_right_unbounded()) {
+      return !a.is_right_unbounded();
+    }
+    return a.packed_upper_value() < b.packed_upper_value()
+        || (a.packed_upper_value() == b.packed_upper_value()
+            && !a.is_upper_endpoint_closed() && b.is_upper_endpoint_closed());
+  }
+
+  /**
+   * Does a reach b, leaving no element of the domain between them, so that their union is an interval?
+   * Both are non-empty and a does not start after b.
+   */
+  static bool connected(const interval_t &a, const interval_t &b) noexcept {
+    if (a.is_right_unbounded() || b.is_left_unbounded()) {
+      return true;
+    }
+    return b.packed_lower_value() < a.packed_upper_value()
+        || (a.packed_upper_value() == b.packed_lower_value()
+            && (a.is_upper_endpoint_closed() || b.is_lower_endpoint_closed()));
+  }
+};
+}
@@ -0,0 +1,280 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+/**
+ * Simulation time as a 64 bits count of ticks of a compile time unit, eg. sim_time<std::milli>.
+ * A millisecond clock covers about 292 million years instead of the 24 days of an int one.
+ * Units are part of the type, conversions between them multiply or divide by constants known at
+ * compile time, and only lossless conversions are implicit.
+ * The counts +INT64_MAX and -INT64_MAX are reserved for +inf and -inf: sums that would overflow saturate to them
+ * instead of wrapping around, and intervals turn them into infinite endpoints.
+ */
+#include <cadmium/iadevs/utils/ia_interval.h>
+#include <cadmium/iadevs/utils/ia_interval_codec.h>
+
+#include <algorithm>
+#include <chrono>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <ratio>
+
+namespace cadmium::iadevs {
+
+template<typename period_t = std::milli>
+struct sim_time {
+  static_assert(period_t::num > 0 && period_t::den > 0, "The unit of time has to be a positive std::ratio");
+  using rep = std::int64_t;
+  using period = period_t;
+
+  /**
+   * Creates the zero time
+   */
+  constexpr sim_time() noexcept = default;
+
+  /**
+   * @param count the number of ticks, counts beyond the finite range saturate to infinity
+   */
+  constexpr explicit sim_time(rep count) noexcept: _count(std::clamp(count, -infinite_count, infinite_count)) {}
+
+  /**
+   * Lossless conversion from a coarser unit, saturating to infinity when the count overflows
+   */
+  template<typename from_period_t> requires (std::ratio_divide<from_period_t, period_t>::den == 1)
+  constexpr sim_time(sim_time<from_period_t> t) noexcept {
+    _count = scale(t.count(), std::ratio_divide<from_period_t, period_t>::num, 1, false);
+  }
+
+  /**
+   * Conversion from a std::chrono duration of the same unit
+   */
+  constexpr explicit sim_time(std::chrono::duration<rep, period_t> d) noexcept: sim_time(d.count()) {}
+
+  static constexpr sim_time infinity() noexcept {
+    return sim_time{infinite_count};
+  }
+
+  /**
+   * @return the largest finite time
+   */
+  static constexpr sim_time max() noexcept {
+    return sim_time{infinite_count - 1};
+  }
+
+  [[nodiscard]] constexpr rep count() const noexcept {
+    return _count;
+  }
+
+  [[nodiscard]] constexpr bool is_finite() const noexcept {
+    return _count != infinite_count && _count != -infinite_count;
+  }
+
+  [[nodiscard]] constexpr std::chrono::duration<rep, period_t> to_duration() const noexcept {
+    return std::chrono::duration<rep, period_t>{_count};
+  }
+
+  /**
+   * Saturating addition, finite sums out of range or reaching the reserved counts are infinite.
+   * Adding opposite infinities has no meaningful result, the first operand is returned.
+   */
+  friend constexpr sim_time operator+(sim_time a, sim_time b) noexcept {
+    rep sum = 0;
+    if (!__builtin_add_overflow(a._count, b._count, &sum) && a.is_finite() && b.is_finite()) [[likely]] {
+      // The lowest count is below the finite range, unlike the highest one, and saturates here
+      return from_count(std::max(sum, -infinite_count));
+    }
+    return add_saturated(a, b);
+  }
+
+  /**
+   * Saturating addition of finite times, cheaper than operator+ as infinite operands are not checked.
+   * Sums out of range or reaching the reserved counts are infinite.
+   */
+  static constexpr sim_time add_finite(sim_time a, sim_time b) noexcept {
+    rep sum = 0;
+    const bool overflow = __builtin_add_overflow(a._count, b._count, &sum);
+    // Selected without branches, to keep the sum small enough to inline into the interval operations
+    return from_count(overflow ? (b._count < 0 ? -infinite_count : infinite_count) : std::max(sum, -infinite_count));
+  }
+
+  friend constexpr sim_time operator-(sim_time a, sim_time b) noexcept {
+    return a + -b;
+  }
+
+  /**
+   * Negation is exact, the finite range is symmetric
+   */
+  constexpr sim_time operator-() const noexcept {
+    return from_count(-_count);
+  }
+
+  /**
+   * Division of a time by a count, rounding towards zero, as used to split intervals
+   */
+  friend constexpr sim_time operator/(sim_time t, rep divisor) noexcept {
+    if (!t.is_finite()) {
+      return (t._count < 0) == (divisor < 0) ? infinity() : -infinity();
+    }
+    return sim_time{t._count / divisor};
+  }
+
+  friend constexpr auto operator<=>(sim_time, sim_time) noexcept = default;
+
+  /**
+   * Multiplies a count by num / den with the quotient rounded down or up, saturating to infinity
+   * when the product overflows. Infinite counts stay infinite.
+   */
+  static constexpr rep scale(rep count, rep num, rep den, bool round_up) noexcept {
+    if (count == infinite_count || count == -infinite_count) {
+      return count;
+    }
+    rep product = 0;
+    if (__builtin_mul_overflow(count, num, &product)) {
+      return count < 0 ? -infinite_count : infinite_count;
+    }
+    rep quotient = product / den;
+    const rep remainder = product % den;
+    if (remainder != 0 && ((remainder > 0) == round_up)) {
+      quotient += round_up ? 1 : -1;
+    }
+    return std::clamp(quotient, -infinite_count, infinite_count);
+  }
+
+private:
+  static constexpr rep infinite_count = std::numeric_limits<rep>::max();
+  rep _count = 0;
+
+  // Counts already known to be in range skip the saturation of the public constructor
+  static constexpr sim_time from_count(rep count) noexcept {
+    sim_time result;
+    result._count = count;
+    return result;
+  }
+
+  // Kept out of line, so the common finite sums inline into the interval operations
+  [[gnu::cold, gnu::noinline]] static constexpr sim_time add_saturated(sim_time a, sim_time b) noexcept {
+    if (!a.is_finite()) {
+      return a;
+    }
+    if (!b.is_finite()) {
+      return b;
+    }
+    return b._count < 0 ? -infinity() : infinity();
+  }
+};
+
+/**
+ * Converts a time to another unit rounding down, saturating to infinity on overflow
+ */
+template<typename to_period_t, typename from_period_t>
+constexpr sim_time<to_period_t> time_floor(sim_time<from_period_t> t) noexcept {
+  using factor = std::ratio_divide<from_period_t, to_period_t>;
+  return sim_time<to_period_t>{sim_time<from_period_t>::scale(t.count(), factor::num, factor::den, false)};
+}
+
+/**
+ * Converts a time to another unit rounding up, saturating to infinity on overflow
+ */
+template<typename to_period_t, typename from_period_t>
+constexpr sim_time<to_period_t> time_ceil(sim_time<from_period_t> t) noexcept {
+  using factor = std::ratio_divide<from_period_t, to_period_t>;
+  return sim_time<to_period_t>{sim_time<from_period_t>::scale(t.count(), factor::num, factor::den, true)};
+}
+
+/**
+ * Interval of simulation times in a unit
+ */
+template<typename period_t = std::milli>
+using time_interval = interval<sim_time<period_t>>;
+
+/**
+ * Converts an interval of times to another unit rounding outwards, so that the result includes
+ * every time of the original interval. Rounded endpoints are closed, overflowed ones infinite.
+ */
+template<typename to_period_t, typename from_period_t>
+constexpr time_interval<to_period_t> interval_cast(const time_interval<from_period_t> &i) noexcept {
+  if (i.is_empty()) {
+    return time_interval<to_period_t>{};
+  }
+  std::uint8_t flags = i.packed_flags() & interval_flags::inf;
+  sim_time<to_period_t> lower{};
+  sim_time<to_period_t> upper{};
+  if (!i.is_left_unbounded()) {
+    lower = time_floor<to_period_t>(i.packed_lower_value());
+    if (!lower.is_finite()) {
+      lower = sim_time<to_period_t>{};
+      flags |= interval_flags::lower_inf;
+    } else if (time_ceil<to_period_t>(i.packed_lower_value()) == lower) {
+      flags |= i.packed_flags() & interval_flags::lower_closed;
+    } else {
+      flags |= interval_flags::lower_closed;
+    }
+  }
+  if (!i.is_right_unbounded()) {
+    upper = time_ceil<to_period_t>(i.packed_upper_value());
+    if (!upper.is_finite()) {
+      upper = sim_time<to_period_t>{};
+      flags |= interval_flags::upper_inf;
+    } else if (time_floor<to_period_t>(i.packed_upper_value()) == upper) {
+      flags |= i.packed_flags() & interval_flags::upper_closed;
+    } else {
+      flags |= interval_flags::upper_closed;
+    }
+  }
+  return time_interval<to_period_t>::from_packed(lower, upper, flags);
+}
+
+/**
+ * Saturated sums are the infinite counts, intervals turn them into infinite endpoints.
+ * Infinite endpoints are flags and hold no count, so endpoint sums only add finite times.
+ */
+template<typename period_t>
+struct outward_rounding<sim_time<period_t>> {
+  static constexpr bool is_exact = false;
+  static constexpr sim_time<period_t> add_down(sim_time<period_t> a, sim_time<period_t> b) noexcept {
+    return sim_time<period_t>::add_finite(a, b);
+  }
+  static constexpr sim_time<period_t> add_up(sim_time<period_t> a, sim_time<period_t> b) noexcept {
+    return sim_time<period_t>::add_finite(a, b);
+  }
+  static constexpr bool is_finite(sim_time<period_t> t) noexcept {
+    return t.is_finite();
+  }
+};
+
+template<typename period_t>
+inline constexpr bool enable_binary_encoding<sim_time<period_t>> = true;
+}
+
+template<typename period_t>
+struct std::hash<cadmium::iadevs::sim_time<period_t>> {
+  std::size_t operator()(const cadmium::iadevs::sim_time<period_t> &t) const noexcept {
+    return std::hash<std::int64_t>{}(t.count());
+  }
+};
@@ -0,0 +1,118 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cadmium/iadevs/basic_models/counter.h>
+#include <cadmium/iadevs/basic_models/generator.h>
+#include <cadmium/iadevs/engine/coordinator.h>
+
+#include <catch.hpp>
+
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+using generator = cadmium::iadevs::basic_models::generator;
+using counter = cadmium::iadevs::basic_models::counter;
+using message_t = cadmium::iadevs::interval<int>;
+using coordinator_t = cadmium::iadevs::engine::coordinator<generator::time_t, message_t>;
+
+// Generators with different phases, each feeding one of a few counters
+std::unique_ptr<coordinator_t> wide_model(std::size_t generators, std::size_t counters) {
+  auto c = std::make_unique<coordinator_t>();
+  std::vector<std::size_t> counter_ids;
+  for (std::size_t k = 0; k < counters; ++k) {
+    counter_ids.push_back(c->add_component(counter{}, counter::state_t{counter::no_time, counter::no_time}));
+  }
+  for (std::size_t k = 0; k < generators; ++k) {
+    generator::state_t phase{};
+    const int elapsed = static_cast<int>(k % 5) * 100;
+    phase.set_bounded(elapsed, true, elapsed, true);
+    const auto id = c->add_component(generator{}, phase);
+    c->add_coupling(id, counter_ids[k % counters]);
+  }
+  return c;
+}
+}
+
+SCENARIO("Coordinator of a generator coupled to a counter", "[COORDINATOR]") {
+  GIVEN("a generator sending its outputs to a counter") {
+    coordinator_t c;
+    const auto g = c.add_component(generator{}, generator::just_emitted);
+    const auto n = c.add_component(counter{}, counter::state_t{counter::no_time, counter::no_time});
+    c.add_coupling(g, n);
+    c.init(generator::time_t{0, true, 0, true});
+    THEN("the next event is the earliest of the generator and counter events") {
+      REQUIRE(c.t_next() == generator::time_t{997, true, 1000, true});
+    }WHEN("the first event is executed") {
+      const auto changed = c.step();
+      THEN("both components fire together, and the counter counts the generator output") {
+        REQUIRE(changed == 2);
+        REQUIRE(c.get_simulator<counter>(n).get_sim_state().state.count == counter::count_t{1, true, 1, true});
+        REQUIRE(c.get_simulator<generator>(g).get_sim_state().t_next == generator::time_t{1994, true, 2010, true});
+      }
+    }WHEN("a coupling is added towards the generator") {
+      THEN("it is refused as generators receive no inputs") {
+        REQUIRE_THROWS_AS(c.add_coupling(n, g), std::invalid_argument);
+        REQUIRE_THROWS_AS(c.add_coupling(n, 7), std::out_of_range);
+      }
+    }WHEN("the simulator is requested with the wrong model type") {
+      THEN("it is refused") {
+        REQUIRE_THROWS_AS(c.get_simulator<counter>(g), std::bad_cast);
+      }
+    }
+  }
+}
+
+SCENARIO("Parallel coordinator matches the serial run", "[COORDINATOR]") {
+  GIVEN("a wide coupled model of a thousand generators and ten counters") {
+    const generator::time_t limit{20'000, true, 20'000, true};
+    auto serial = wide_model(1000, 10);
+    serial->init(generator::time_t{0, true, 0, true});
+    const auto serial_events = serial->run_until(limit);
+    for (std::size_t threads : {2, 4, 8}) {
+      WHEN("it runs on a pool of " << threads << " threads") {
+        cadmium::iadevs::engine::thread_pool pool(threads);
+        auto parallel = wide_model(1000, 10);
+        parallel->set_thread_pool(&pool);
+        parallel->init(generator::time_t{0, true, 0, true});
+        const auto parallel_events = parallel->run_until(limit);
+        THEN("every component ends in the same state at the same times") {
+          REQUIRE(serial_events > 0);
+          REQUIRE(parallel_events == serial_events);
+          REQUIRE(parallel->t_next() == serial->t_next());
+          for (std::size_t id = 0; id < 10; ++id) {
+            REQUIRE(parallel->get_simulator<counter>(id).get_sim_state().state
+                        == serial->get_simulator<counter>(id).get_sim_state().state);
+          }
+          for (std::size_t id = 10; id < serial->size(); ++id) {
+            REQUIRE(parallel->get_component(id).t_next() == serial->get_component(id).t_next());
+            REQUIRE(parallel->get_component(id).t_last() == serial->get_component(id).t_last());
+          }
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,68 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cadmium/iadevs/basic_models/counter.h>
+
+#include <catch.hpp>
+
+#include <array>
+
+SCENARIO("Counter basic model functions", "[COUNTER]") {
+  GIVEN("A counter that counted [3, 4] inputs, [200, 250] milliseconds after its last report") {
+    WARN("Current test assumes time is in milliseconds, units are not yet implemented");
+    using counter = cadmium::iadevs::basic_models::counter;
+    counter c{};
+    counter::state_t s{counter::count_t{3, true, 4, true}, counter::time_t{200, true, 250, true}};
+    std::array<counter::input_t, 2> inputs{counter::input_t{1, true, 2, true}, counter::input_t{1, true, 1, true}};
+    WHEN("bounded_time_advance_i is called") {
+      auto ta = c.bounded_time_advance_i(s);
+      THEN("interval [750, 800] is returned") {
+        REQUIRE(ta == counter::time_t{750, true, 800, true});
+      }
+    }WHEN("output_i is called") {
+      THEN("the count [3, 4] is returned") {
+        REQUIRE(c.output_i(s) == counter::count_t{3, true, 4, true});
+      }
+    }WHEN("internal_transition_i is called") {
+      auto next = c.internal_transition_i(s);
+      THEN("the count is kept and the elapsed time restarts") {
+        REQUIRE(next.count == s.count);
+        REQUIRE(next.elapsed == counter::no_time);
+      }
+    }WHEN("external_transition_i is called with 2 inputs after [10, 20] milliseconds") {
+      auto next = c.external_transition_i(s, counter::time_t{10, true, 20, true}, inputs);
+      THEN("the count is [5, 6] and the elapsed time [210, 270]") {
+        REQUIRE(next.count == counter::count_t{5, true, 6, true});
+        REQUIRE(next.elapsed == counter::time_t{210, true, 270, true});
+      }
+    }WHEN("confluent_transition_i is called with 2 inputs") {
+      auto next = c.confluent_transition_i(s, inputs);
+      THEN("the count is [5, 6] and the elapsed time restarts") {
+        REQUIRE(next.count == counter::count_t{5, true, 6, true});
+        REQUIRE(next.elapsed == counter::no_time);
+      }
+    }
+  }
+}
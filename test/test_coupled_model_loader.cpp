@@ -0,0 +1,167 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <cadmium/iadevs/basic_models/counter.h>
+#include <cadmium/iadevs/basic_models/generator.h>
+#include <cadmium/iadevs/engine/coordinator.h>
+#include <cadmium/iadevs/engine/coupled_model_loader.h>
+
+#include <catch.hpp>
+
+#include <functional>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+using generator = cadmium::iadevs::basic_models::generator;
+using counter = cadmium::iadevs::basic_models::counter;
+using coordinator_t = cadmium::iadevs::engine::coordinator<generator::time_t, cadmium::iadevs::interval<int>>;
+using cadmium::iadevs::engine::coupled_model_loader;
+
+// Two stations of a generator reporting to a counter, whose outputs are counted by a third counter
+const std::string network = R"({"name": "network", "components": [
+  {"name": "a", "components": [{"name": "g", "type": "generator"}, {"name": "n", "type": "counter"}],
+   "couplings": [{"from": "g", "to": "n"}, {"from": "g"}, {"from": "n"}, {"to": "n"}]},
+  {"name": "b", "components": [{"name": "g", "type": "generator"}, {"name": "n", "type": "counter"}],
+   "couplings": [{"from": "g", "to": "n"}, {"from": "n"}, {"to": "n"}]},
+  {"name": "total", "type": "counter"}],
+ "couplings": [{"from": "a", "to": "total"}, {"from": "b", "to": "total"}, {"from": "a", "to": "b"},
+               {"to": "a"}, {"from": "total"}]})";
+
+std::vector<std::size_t> destinations(const cadmium::iadevs::engine::flat_coupled_model &m, std::size_t from) {
+  const auto d = m.graph().destinations(from);
+  return {d.begin(), d.end()};
+}
+}
+
+SCENARIO("Loading a coupled model defined in JSON", "[COUPLED_MODEL_LOADER]") {
+  GIVEN("a definition with nested coupled models") {
+    const auto m = coupled_model_loader::load(network);
+    THEN("atomic components are numbered depth first with their full names and types") {
+      REQUIRE(m.size() == 5);
+      const std::vector<std::string_view> names{m.name(0), m.name(1), m.name(2), m.name(3), m.name(4)};
+      REQUIRE(names == std::vector<std::string_view>{"a.g", "a.n", "b.g", "b.n", "total"});
+      REQUIRE(m.type_names()[m.type(0)] == "generator");
+      REQUIRE(m.type_names()[m.type(4)] == "counter");
+      REQUIRE(m.type_names().size() == 2);
+    }THEN("couplings through nested models are resolved into couplings between atomic components") {
+      REQUIRE(destinations(m, 0) == std::vector<std::size_t>{1, 4, 3});
+      REQUIRE(destinations(m, 1) == std::vector<std::size_t>{4, 3});
+      REQUIRE(destinations(m, 2) == std::vector<std::size_t>{3});
+      REQUIRE(destinations(m, 3) == std::vector<std::size_t>{4});
+      REQUIRE(destinations(m, 4).empty());
+    }THEN("the input and output couplings of the root are resolved too") {
+      REQUIRE(std::vector<std::size_t>(m.inputs().begin(), m.inputs().end()) == std::vector<std::size_t>{1});
+      REQUIRE(std::vector<std::size_t>(m.outputs().begin(), m.outputs().end()) == std::vector<std::size_t>{4});
+    }
+  }
+  GIVEN("invalid definitions") {
+    const std::vector<std::string> invalid{
+        R"([])",
+        R"({"couplings": []})",
+        R"({"components": [{"name": "g", "type": "generator"}], "extra": 1})",
+        R"({"components": [{"name": "g"}]})",
+        R"({"components": [{"type": "generator"}]})",
+        R"({"components": [{"name": "", "type": "generator"}]})",
+        R"({"components": [{"name": "a.b", "type": "generator"}]})",
+        R"({"components": [{"name": "g", "type": "generator"}, {"name": "g", "type": "counter"}]})",
+        R"({"components": [{"name": "g", "type": "generator", "components": []}]})",
+        R"({"components": [{"name": "g", "type": "generator", "port": "out"}]})",
+        R"({"components": [{"name": "g", "type": "generator"}], "couplings": [{"from": "g", "to": "n"}]})",
+        R"({"components": [{"name": "g", "type": "generator"}], "couplings": [{"from": "g", "to": "g"}]})",
+        R"({"components": [{"name": "g", "type": "generator"}], "couplings": [{"from": "g"}, {"from": "g"}]})",
+        R"({"components": [{"name": "g", "type": "generator"}], "couplings": [{}]})",
+        R"({"components": [{"name": "g", "type": "generator"}], "couplings": [{"from": 1}]})",
+        R"({"components": [{"name": "s", "components": [{"name": "g", "type": "generator"}],
+                            "couplings": [{"from": "x"}]}]})",
+        R"({"components": [{"name": "g", "type": "generator"}])"};
+    THEN("all of them are rejected") {
+      for (const auto &text : invalid) {
+        INFO(text);
+        REQUIRE_THROWS_AS(coupled_model_loader::load(text), std::invalid_argument);
+      }
+    }
+  }
+}
+
+SCENARIO("Populating a coordinator from a loaded coupled model", "[COUPLED_MODEL_LOADER]") {
+  GIVEN("the loaded model in a coordinator, and the same model built by hand") {
+    const auto m = coupled_model_loader::load(network);
+    std::map<std::string, std::function<void(coordinator_t &, std::string_view)>, std::less<>> factories{
+        {"generator",
+         [](coordinator_t &c, std::string_view name) {
+           generator::state_t phase{};
+           phase.set_bounded(name == "b.g" ? 100 : 0, true, name == "b.g" ? 100 : 0, true);
+           c.add_component(generator{}, phase);
+         }},
+        {"counter",
+         [](coordinator_t &c, std::string_view) {
+           c.add_component(counter{}, counter::state_t{counter::no_time, counter::no_time});
+         }}};
+    coordinator_t loaded;
+    REQUIRE(cadmium::iadevs::engine::populate(loaded, m, factories) == 0);
+    loaded.init(generator::time_t{0, true, 0, true});
+
+    coordinator_t built;
+    const auto ag = built.add_component(generator{}, generator::just_emitted);
+    const auto an = built.add_component(counter{}, counter::state_t{counter::no_time, counter::no_time});
+    const auto bg = built.add_component(generator{}, generator::state_t{100, true, 100, true});
+    const auto bn = built.add_component(counter{}, counter::state_t{counter::no_time, counter::no_time});
+    const auto total = built.add_component(counter{}, counter::state_t{counter::no_time, counter::no_time});
+    for (auto [from, to] : {std::pair{ag, an}, {ag, total}, {ag, bn}, {an, total}, {an, bn}, {bg, bn},
+                            {bn, total}}) {
+      built.add_coupling(from, to);
+    }
+    built.add_output_coupling(total);
+    built.init(generator::time_t{0, true, 0, true});
+    WHEN("both run for ten seconds") {
+      REQUIRE(loaded.run_until(generator::time_t{10000, true, 10000, true})
+                  == built.run_until(generator::time_t{10000, true, 10000, true}));
+      THEN("every component reaches the same state and the same outputs leave the model") {
+        for (std::size_t id = 0; id < 5; ++id) {
+          REQUIRE(loaded.get_component(id).t_next() == built.get_component(id).t_next());
+          REQUIRE(loaded.get_component(id).t_last() == built.get_component(id).t_last());
+        }
+        REQUIRE(loaded.get_simulator<counter>(4).get_sim_state()
+                == built.get_simulator<counter>(total).get_sim_state());
+        REQUIRE(loaded.outputs().size() == built.outputs().size());
+      }
+    }
+  }
+  GIVEN("a model using a type without factory") {
+    const auto m = coupled_model_loader::load(network);
+    std::map<std::string, std::function<void(coordinator_t &, std::string_view)>, std::less<>> factories{
+        {"generator",
+         [](coordinator_t &c, std::string_view) { c.add_component(generator{}, generator::just_emitted); }}};
+    coordinator_t c;
+    THEN("populating the coordinator is refused") {
+      REQUIRE_THROWS_AS(cadmium::iadevs::engine::populate(c, m, factories), std::invalid_argument);
+    }
+  }
+}
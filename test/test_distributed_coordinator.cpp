@@ -0,0 +1,285 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cadmium/iadevs/basic_models/counter.h>
+#include <cadmium/iadevs/basic_models/generator.h>
+#include <cadmium/iadevs/engine/distributed_coordinator.h>
+#include <cadmium/iadevs/engine/parallel_root_coordinator.h>
+#include <cadmium/iadevs/utils/ia_interval_codec.h>
+
+#include <catch.hpp>
+
+#include <deque>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+using generator = cadmium::iadevs::basic_models::generator;
+using counter = cadmium::iadevs::basic_models::counter;
+using message_t = cadmium::iadevs::interval<int>;
+using cadmium::iadevs::engine::worker_batch;
+using cadmium::iadevs::engine::worker_status;
+
+// Counter states are two intervals encoded back to back
+struct counter_codec : cadmium::iadevs::interval_codec {
+  using interval_codec::encode;
+  using interval_codec::decode;
+  static void encode(const counter::state_t &s, std::vector<std::byte> &bytes) {
+    std::vector<std::byte> elapsed;
+    encode(s.count, bytes);
+    encode(s.elapsed, elapsed);
+    bytes.insert(bytes.end(), elapsed.begin(), elapsed.end());
+  }
+  static bool decode(std::span<const std::byte> bytes, counter::state_t &s) {
+    constexpr auto size = encoded_size<int>;
+    return bytes.size() == 2 * size && decode(bytes.first(size), s.count) && decode(bytes.subspan(size), s.elapsed);
+  }
+};
+
+using worker_t = cadmium::iadevs::engine::partition_worker<generator::time_t, message_t, counter_codec>;
+using protocol_t = worker_t::protocol_t;
+
+// Answers batches in place, as a worker in another process would
+struct loopback_client {
+  using responses_t = worker_batch;
+
+  explicit loopback_client(worker_t &worker) : _worker(&worker) {}
+
+  void send(worker_batch &requests) {
+    worker_batch responses;
+    for (std::size_t k = 0; k < requests.size(); ++k) {
+      _worker->handle(requests.frame(k), responses);
+    }
+    requests.clear();
+    _responses.push_back(std::move(responses));
+  }
+
+  void receive(worker_batch &responses) {
+    responses = std::move(_responses.front());
+    _responses.pop_front();
+  }
+
+private:
+  worker_t *_worker;
+  std::deque<worker_batch> _responses;
+};
+
+using distributed_t = cadmium::iadevs::engine::distributed_coordinator<generator::time_t, message_t, counter_codec,
+                                                                       loopback_client>;
+using root_t = cadmium::iadevs::engine::parallel_root_coordinator<generator::time_t, message_t>;
+
+const counter::state_t counter_start{counter::no_time, counter::no_time};
+const generator::time_t start{0, true, 0, true};
+
+// Partitions of generators feeding a local counter, the first generator of each also feeds the next partition,
+// and the last one feeds the first one if ring is set. Without couplings if chained is not set.
+// The same description builds the workers, the distributed coordinator and a parallel root coordinator.
+template<typename builder_t>
+void build_chain(builder_t &builder, std::size_t partitions, std::size_t generators, bool chained, bool ring) {
+  std::vector<std::size_t> counters;
+  std::vector<std::size_t> first_generators;
+  for (std::size_t p = 0; p < partitions; ++p) {
+    counters.push_back(builder.add_component(p, counter{}, counter_start));
+    for (std::size_t k = 0; k < generators; ++k) {
+      generator::state_t phase{};
+      const int elapsed = static_cast<int>((p * generators + k) % 7) * 50;
+      phase.set_bounded(elapsed, true, elapsed, true);
+      const auto id = builder.add_component(p, generator{}, phase);
+      builder.add_coupling(id, counters[p]);
+      if (k == 0) {
+        first_generators.push_back(id);
+      }
+    }
+  }
+  for (std::size_t p = 0; chained && p + (ring ? 0 : 1) < partitions; ++p) {
+    builder.add_coupling(first_generators[p], counters[(p + 1) % partitions]);
+  }
+}
+
+template<typename builder_t>
+void build_ring(builder_t &builder, std::size_t partitions, std::size_t generators) {
+  build_chain(builder, partitions, generators, true, true);
+}
+}
+
+SCENARIO("Distributed coordinator matches the parallel root coordinator", "[COORDINATOR]") {
+  GIVEN("four partition workers and a parallel root coordinator built from the same ring") {
+    constexpr std::size_t partitions = 4;
+    constexpr std::size_t generators = 20;
+    std::vector<std::unique_ptr<worker_t>> workers;
+    distributed_t distributed;
+    root_t reference;
+    for (std::size_t p = 0; p < partitions; ++p) {
+      workers.push_back(std::make_unique<worker_t>(p));
+      build_ring(*workers.back(), partitions, generators);
+      distributed.add_partition(loopback_client(*workers.back()));
+      reference.add_partition();
+    }
+    build_ring(distributed, partitions, generators);
+    build_ring(reference, partitions, generators);
+    WHEN("both run for 20 seconds") {
+      const generator::time_t limit{20'000, true, 20'000, true};
+      distributed.init(start);
+      reference.init(start);
+      const auto events = distributed.run_until(limit);
+      const auto reference_events = reference.run_until(limit);
+      THEN("they execute the same rounds and every component ends in the same state") {
+        REQUIRE(events == reference_events);
+        REQUIRE(distributed.t_next() == reference.t_next());
+        REQUIRE(distributed.stats().windows == reference.stats().windows);
+        REQUIRE(distributed.stats().imminent_steps == reference.stats().imminent_steps);
+        REQUIRE(distributed.stats().max_active_partitions > 1);
+        for (std::size_t id = 0; id < distributed.size(); ++id) {
+          if (id % (generators + 1) == 0) {
+            REQUIRE(distributed.get_state<counter>(id) == reference.get_simulator<counter>(id).get_sim_state().state);
+          } else {
+            REQUIRE(distributed.get_state<generator>(id) == reference.get_simulator<generator>(id).get_sim_state().state);
+          }
+        }
+      }
+    }
+    WHEN("it runs past the limit in two calls") {
+      distributed.init(start);
+      reference.init(start);
+      distributed.run_until(generator::time_t{5'000, true, 5'000, true});
+      distributed.run_until(generator::time_t{10'000, true, 10'000, true});
+      reference.run_until(generator::time_t{10'000, true, 10'000, true});
+      THEN("values routed at the end of the first call are delivered in the second") {
+        for (std::size_t p = 0; p < partitions; ++p) {
+          const auto id = p * (generators + 1);
+          REQUIRE(distributed.get_state<counter>(id) == reference.get_simulator<counter>(id).get_sim_state().state);
+        }
+      }
+    }
+    WHEN("the coordinator shuts the workers down") {
+      distributed.init(start);
+      distributed.shutdown();
+      THEN("every worker stops serving") {
+        for (const auto &w : workers) {
+          REQUIRE(w->stopping());
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("Distributed coordinator advances partitions together in windows", "[COORDINATOR]") {
+  constexpr std::size_t partitions = 4;
+  constexpr std::size_t generators = 10;
+  const generator::time_t limit{20'000, true, 20'000, true};
+  for (bool chained : {false, true}) {
+    GIVEN(partitions << (chained ? " partitions each feeding the counter of the next one" : " uncoupled partitions")) {
+      std::vector<std::unique_ptr<worker_t>> workers;
+      distributed_t distributed;
+      root_t reference;
+      for (std::size_t p = 0; p < partitions; ++p) {
+        workers.push_back(std::make_unique<worker_t>(p));
+        build_chain(*workers.back(), partitions, generators, chained, false);
+        distributed.add_partition(loopback_client(*workers.back()));
+        reference.add_partition();
+      }
+      build_chain(distributed, partitions, generators, chained, false);
+      build_chain(reference, partitions, generators, chained, false);
+      distributed.init(start);
+      reference.init(start);
+      REQUIRE(distributed.run_until(limit) == reference.run_until(limit));
+      THEN("workers execute the windows of several partitions concurrently") {
+        REQUIRE(distributed.stats().max_active_partitions == reference.stats().max_active_partitions);
+        REQUIRE(distributed.stats().max_active_partitions > (chained ? 1 : partitions - 1));
+        REQUIRE(distributed.stats().mean_parallelism() > 1.0);
+        for (std::size_t p = 0; p < partitions; ++p) {
+          const auto id = p * (generators + 1);
+          REQUIRE(distributed.get_state<counter>(id) == reference.get_simulator<counter>(id).get_sim_state().state);
+        }
+      }
+    }
+  }
+  GIVEN("generators of two partitions imminent together feeding a counter") {
+    const auto build = [](auto &builder) {
+      generator::state_t late{};
+      late.set_bounded(3, true, 3, true);
+      const auto n = builder.add_component(0, counter{}, counter_start);
+      builder.add_coupling(builder.add_component(0, generator{}, generator::just_emitted), n);
+      builder.add_coupling(builder.add_component(1, generator{}, late), n);
+    };
+    std::vector<std::unique_ptr<worker_t>> workers;
+    distributed_t distributed;
+    for (std::size_t p = 0; p < 2; ++p) {
+      workers.push_back(std::make_unique<worker_t>(p));
+      build(*workers.back());
+      distributed.add_partition(loopback_client(*workers.back()));
+    }
+    build(distributed);
+    WHEN("it runs for 20 seconds") {
+      distributed.init(start);
+      distributed.run_until(limit);
+      THEN("the partition without inputs runs ahead, and every output is counted") {
+        REQUIRE(distributed.stats().max_active_partitions == 2);
+        REQUIRE(distributed.get_state<counter>(0).count == counter::count_t{40, true, 40, true});
+      }
+    }
+  }
+}
+
+SCENARIO("Partition worker rejects invalid requests", "[COORDINATOR]") {
+  GIVEN("the worker of the first partition of a ring") {
+    worker_t worker(0);
+    build_ring(worker, 2, 3);
+    worker_batch requests;
+    protocol_t::add_get_state(requests, 0);
+    protocol_t::add_init(requests, start);
+    protocol_t::add_get_state(requests, 4);
+    requests.append_u8(static_cast<std::uint8_t>(cadmium::iadevs::engine::partition_op::round));
+    requests.append_u8(7);
+    requests.end_frame();
+    requests.append_u8(99);
+    requests.end_frame();
+    protocol_t::begin_end_step(requests, start, 0);
+    requests.end_frame();
+    WHEN("the worker handles them") {
+      worker_batch responses;
+      THEN("each one reports why it failed") {
+        REQUIRE(worker.handle(requests.frame(0), responses) == worker_status::unknown_instance);
+        REQUIRE(worker.handle(requests.frame(1), responses) == worker_status::ok);
+        REQUIRE(worker.handle(requests.frame(2), responses) == worker_status::malformed_request);
+        REQUIRE(worker.handle(requests.frame(3), responses) == worker_status::malformed_request);
+        REQUIRE(worker.handle(requests.frame(4), responses) == worker_status::unknown_operation);
+        REQUIRE(responses.frame(4).size() == 1);
+        // An imminent step ends only after it began
+        REQUIRE(worker.handle(requests.frame(5), responses) == worker_status::malformed_request);
+        REQUIRE(worker.get_coordinator().size() == 4);
+      }
+    }
+  }
+  GIVEN("a generator coupled to a generator in another partition") {
+    worker_t worker(1);
+    const auto a = worker.add_component(0, generator{}, generator::just_emitted);
+    const auto b = worker.add_component(1, generator{}, generator::just_emitted);
+    THEN("the worker of the destination refuses the coupling") {
+      REQUIRE_THROWS_AS(worker.add_coupling(a, b), std::invalid_argument);
+    }
+  }
+}
@@ -0,0 +1,154 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cadmium/iadevs/basic_models/counter.h>
+#include <cadmium/iadevs/basic_models/generator.h>
+#include <cadmium/iadevs/engine/distributed_coordinator.h>
+#include <cadmium/iadevs/engine/parallel_root_coordinator.h>
+#include <cadmium/iadevs/engine/worker_transport.h>
+#include <cadmium/iadevs/utils/ia_interval_codec.h>
+
+#include <catch.hpp>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace {
+using generator = cadmium::iadevs::basic_models::generator;
+using counter = cadmium::iadevs::basic_models::counter;
+using message_t = cadmium::iadevs::interval<int>;
+using codec_t = cadmium::iadevs::interval_codec;
+using worker_t = cadmium::iadevs::engine::partition_worker<generator::time_t, message_t, codec_t>;
+using distributed_t = cadmium::iadevs::engine::distributed_coordinator<generator::time_t, message_t, codec_t,
+                                                                       cadmium::iadevs::engine::worker_client>;
+using root_t = cadmium::iadevs::engine::parallel_root_coordinator<generator::time_t, message_t>;
+
+const generator::time_t start{0, true, 0, true};
+const generator::time_t limit{20'000, true, 20'000, true};
+
+// Partitions of generators feeding a local counter, the first generator of each also feeds the next partition
+template<typename builder_t>
+void build_ring(builder_t &builder, std::size_t partitions, std::size_t generators) {
+  std::vector<std::size_t> counters;
+  std::vector<std::size_t> first_generators;
+  for (std::size_t p = 0; p < partitions; ++p) {
+    counters.push_back(builder.add_component(p, counter{}, counter::state_t{counter::no_time, counter::no_time}));
+    for (std::size_t k = 0; k < generators; ++k) {
+      generator::state_t phase{};
+      const int elapsed = static_cast<int>((p * generators + k) % 7) * 50;
+      phase.set_bounded(elapsed, true, elapsed, true);
+      const auto id = builder.add_component(p, generator{}, phase);
+      builder.add_coupling(id, counters[p]);
+      if (k == 0) {
+        first_generators.push_back(id);
+      }
+    }
+  }
+  for (std::size_t p = 0; p < partitions; ++p) {
+    builder.add_coupling(first_generators[p], counters[(p + 1) % partitions]);
+  }
+}
+
+std::string endpoint_of(std::size_t partition) {
+  return "ipc:///tmp/iadevs_partition_" + std::to_string(::getpid()) + "_" + std::to_string(partition);
+}
+
+// Serves a partition in a child process until the coordinator shuts it down
+pid_t spawn_partition(std::size_t partition, std::size_t partitions, std::size_t generators) {
+  const auto endpoint = endpoint_of(partition);
+  const pid_t pid = ::fork();
+  if (pid == 0) {
+    int status = 1;
+    try {
+      worker_t worker(partition);
+      build_ring(worker, partitions, generators);
+      zmq::context_t context;
+      zmq::socket_t socket(context, zmq::socket_type::router);
+      socket.bind(endpoint);
+      status = cadmium::iadevs::engine::serve_worker(socket, worker) ? 0 : 1;
+    } catch (...) {
+    }
+    ::_exit(status);
+  }
+  return pid;
+}
+}
+
+SCENARIO("Distributed coordinator drives partitions in other processes", "[COORDINATOR]") {
+  GIVEN("three partition worker processes served over ipc") {
+    constexpr std::size_t partitions = 3;
+    constexpr std::size_t generators = 10;
+    std::vector<pid_t> children;
+    for (std::size_t p = 0; p < partitions; ++p) {
+      children.push_back(spawn_partition(p, partitions, generators));
+    }
+    REQUIRE(std::find(children.begin(), children.end(), pid_t{-1}) == children.end());
+    zmq::context_t context;
+    distributed_t distributed;
+    for (std::size_t p = 0; p < partitions; ++p) {
+      distributed.add_partition(cadmium::iadevs::engine::worker_client(context, endpoint_of(p)));
+    }
+    build_ring(distributed, partitions, generators);
+    WHEN("it runs for 20 seconds and shuts the workers down") {
+      distributed.init(start);
+      const auto events = distributed.run_until(limit);
+      std::vector<generator::state_t> states;
+      for (std::size_t id = 0; id < distributed.size(); ++id) {
+        if (id % (generators + 1) != 0) {
+          states.push_back(distributed.get_state<generator>(id));
+        }
+      }
+      distributed.shutdown();
+      std::vector<int> exit_codes;
+      for (auto pid : children) {
+        int status = 0;
+        ::waitpid(pid, &status, 0);
+        exit_codes.push_back(WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+      }
+      THEN("results match a parallel root coordinator, and every worker exits cleanly") {
+        root_t reference;
+        for (std::size_t p = 0; p < partitions; ++p) {
+          reference.add_partition();
+        }
+        build_ring(reference, partitions, generators);
+        reference.init(start);
+        REQUIRE(events == reference.run_until(limit));
+        REQUIRE(distributed.t_next() == reference.t_next());
+        REQUIRE(distributed.stats().windows == reference.stats().windows);
+        std::size_t k = 0;
+        for (std::size_t id = 0; id < reference.size(); ++id) {
+          if (id % (generators + 1) != 0) {
+            REQUIRE(states[k++] == reference.get_simulator<generator>(id).get_sim_state().state);
+          }
+        }
+        REQUIRE(exit_codes == std::vector<int>(partitions, 0));
+      }
+    }
+  }
+}
@@ -0,0 +1,153 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <cadmium/iadevs/basic_models/generator.h>
+#include <cadmium/iadevs/engine/ensemble.h>
+#include <cadmium/iadevs/engine/thread_pool.h>
+
+#include <catch.hpp>
+
+#include <stdexcept>
+#include <vector>
+
+namespace {
+using generator = cadmium::iadevs::basic_models::generator;
+using ensemble_t = cadmium::iadevs::engine::ensemble<generator>;
+
+/**
+ * A model counting ticks of a fixed period, the parameter of a sweep
+ */
+struct ticker {
+  using state_t = cadmium::iadevs::interval<int>;
+  using time_t = cadmium::iadevs::interval<int>;
+  using output_t = cadmium::iadevs::interval<int>;
+
+  time_t period{1000, true, 1000, true};
+
+  constexpr time_t bounded_time_advance_i(const state_t &) const {
+    return period;
+  }
+
+  constexpr state_t internal_transition_i(const state_t &state) const {
+    return state + state_t{1, true, 1, true};
+  }
+
+  constexpr output_t output_i(const state_t &state) const {
+    return state;
+  }
+
+  constexpr time_t time_bound_add(const time_t &t1, const time_t &t2) const {
+    return t1 + t2;
+  }
+};
+
+// Generators that emitted between 0 and runs - 1 ms before the start
+std::vector<ensemble_t::initial_condition> phases(int runs) {
+  std::vector<ensemble_t::initial_condition> initial(static_cast<std::size_t>(runs));
+  for (int k = 0; k < runs; ++k) {
+    initial[static_cast<std::size_t>(k)].state.set_bounded(k, true, k, true);
+    initial[static_cast<std::size_t>(k)].time.set_bounded(0, true, 0, true);
+  }
+  return initial;
+}
+
+// Histogram of the lower endpoint of t_next
+auto t_next_histogram() {
+  return cadmium::iadevs::engine::ensemble_histogram(9900, 11000, 11, [](const auto &result) {
+    return static_cast<double>(result.sim_state.t_next.get_lower_endpoint_value());
+  });
+}
+}
+
+SCENARIO("Ensemble of generators from different initial states", "[ENSEMBLE]") {
+  GIVEN("an ensemble of a thousand generator runs with different phases") {
+    const auto initial = phases(1000);
+    ensemble_t e;
+    const generator::time_t until{10'000, true, 10'000, true};
+    WHEN("the runs are reduced to a summary serially") {
+      const auto summary = e.run(std::span(initial), until, cadmium::iadevs::engine::ensemble_summary<generator>{});
+      THEN("every run is counted and the hulls cover the final states and next event times") {
+        REQUIRE(summary.runs == 1000);
+        // The n-th event of the run with phase k is in [997 n - k, 1005 n - k], so runs
+        // with phases below 50 fire 9 times before 10'000 and the rest 10 times
+        REQUIRE(summary.events == 50 * 9 + 950 * 10);
+        REQUIRE(summary.state_hull == generator::just_emitted);
+        REQUIRE(summary.t_next_hull == generator::time_t{10 * 997 - 49, true, 11 * 1005 - 50, true});
+      }
+    }WHEN("the runs are reduced to histograms on thread pools of different sizes") {
+      const auto serial = e.run(std::span(initial), until, t_next_histogram());
+      cadmium::iadevs::engine::thread_pool two(2), eight(8);
+      e.set_thread_pool(&two);
+      const auto on_two = e.run(std::span(initial), until, t_next_histogram());
+      e.set_thread_pool(&eight);
+      const auto on_eight = e.run(std::span(initial), until, t_next_histogram());
+      THEN("every run is counted once and the histograms match the serial run") {
+        std::size_t counted = serial.underflow() + serial.overflow();
+        for (auto bin : serial.bins()) {
+          counted += bin;
+        }
+        REQUIRE(counted == 1000);
+        REQUIRE(serial.underflow() + serial.overflow() == 0);
+        REQUIRE(on_two.bins() == serial.bins());
+        REQUIRE(on_eight.bins() == serial.bins());
+        REQUIRE(on_eight.underflow() == serial.underflow());
+      }
+    }
+  }
+}
+
+SCENARIO("Parameter sweep over model instances", "[ENSEMBLE]") {
+  GIVEN("tickers with periods from 100 to 1000 ms") {
+    std::vector<ticker> models(10);
+    for (int k = 0; k < 10; ++k) {
+      models[static_cast<std::size_t>(k)].period.set_bounded(100 * (k + 1), true, 100 * (k + 1), true);
+    }
+    cadmium::iadevs::engine::ensemble<ticker> e;
+    cadmium::iadevs::engine::thread_pool pool(3);
+    e.set_thread_pool(&pool);
+    WHEN("each is simulated for 10 seconds") {
+      const auto summary = e.sweep(std::span<const ticker>(models), ticker::state_t{0, true, 0, true},
+                                   ticker::time_t{0, true, 0, true}, ticker::time_t{10'000, true, 10'000, true},
+                                   cadmium::iadevs::engine::ensemble_summary<ticker>{});
+      THEN("each run ticks with its own period") {
+        REQUIRE(summary.runs == 10);
+        REQUIRE(summary.events == 100 + 50 + 33 + 25 + 20 + 16 + 14 + 12 + 11 + 10);
+        REQUIRE(summary.state_hull == ticker::state_t{10, true, 100, true});
+        REQUIRE(summary.t_next_hull == ticker::time_t{10'100, true, 11'000, true});
+      }
+    }
+  }
+}
+
+SCENARIO("Ensemble histograms validate their bins", "[ENSEMBLE]") {
+  GIVEN("a projection") {
+    const auto projection = [](const auto &) { return 0.0; };
+    THEN("histograms without bins or with an empty range are refused") {
+      REQUIRE_THROWS_AS(cadmium::iadevs::engine::ensemble_histogram(0, 1, 0, projection), std::invalid_argument);
+      REQUIRE_THROWS_AS(cadmium::iadevs::engine::ensemble_histogram(1, 1, 4, projection), std::invalid_argument);
+    }
+  }
+}
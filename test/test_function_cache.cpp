@@ -0,0 +1,132 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cadmium/iadevs/basic_models/counter.h>
+#include <cadmium/iadevs/basic_models/generator.h>
+#include <cadmium/iadevs/engine/function_cache.h>
+#include <cadmium/iadevs/engine/simulator.h>
+
+#include <catch.hpp>
+
+#include <thread>
+#include <vector>
+
+SCENARIO("Sharded LRU cache", "[CACHE]") {
+  GIVEN("a single shard cache with capacity for 2 entries") {
+    cadmium::iadevs::engine::sharded_lru_cache<int, int> cache(2, 1);
+    int value = 0;
+    WHEN("looking up an empty cache") {
+      THEN("it misses") {
+        REQUIRE_FALSE(cache.find(1, value));
+        REQUIRE(cache.stats().misses == 1);
+      }
+    }WHEN("3 entries are inserted after using the first one") {
+      cache.insert(1, 10);
+      cache.insert(2, 20);
+      REQUIRE(cache.find(1, value));
+      cache.insert(3, 30);
+      THEN("the least recently used entry is evicted") {
+        REQUIRE(cache.size() == 2);
+        REQUIRE_FALSE(cache.find(2, value));
+        REQUIRE(cache.find(1, value));
+        REQUIRE(value == 10);
+        REQUIRE(cache.find(3, value));
+        REQUIRE(value == 30);
+        REQUIRE(cache.stats().hits == 3);
+        REQUIRE(cache.stats().misses == 1);
+        REQUIRE(cache.stats().evictions == 1);
+      }
+    }
+  }GIVEN("a cache shared by several threads") {
+    cadmium::iadevs::engine::sharded_lru_cache<int, int> cache(64, 8);
+    WHEN("all threads read and write overlapping keys") {
+      std::vector<std::thread> threads;
+      for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&cache] {
+          for (int i = 0; i < 10000; ++i) {
+            int value = 0;
+            const int key = i % 100;
+            if (!cache.find(key, value)) {
+              cache.insert(key, key * 2);
+            } else if (value != key * 2) {
+              throw std::logic_error("Wrong value cached");
+            }
+          }
+        });
+      }
+      for (auto &t : threads) {
+        t.join();
+      }
+      THEN("every lookup is counted and the capacity is respected") {
+        const auto stats = cache.stats();
+        REQUIRE(stats.hits + stats.misses == 40000);
+        REQUIRE(cache.size() <= 64);
+      }
+    }
+  }
+}
+
+SCENARIO("Simulators using a function cache", "[CACHE]") {
+  GIVEN("two generator simulators sharing a cache, and one without cache") {
+    using generator = cadmium::iadevs::basic_models::generator;
+    cadmium::iadevs::engine::model_function_cache<generator> cache(16);
+    cadmium::iadevs::engine::simulator<generator> cached_1{};
+    cadmium::iadevs::engine::simulator<generator> cached_2{};
+    cadmium::iadevs::engine::simulator<generator> uncached{};
+    cached_1.set_cache(&cache);
+    cached_2.set_cache(&cache);
+    const generator::time_t limit{100000, true, 100000, true};
+    WHEN("all run for the same time") {
+      for (auto *s : {&cached_1, &cached_2, &uncached}) {
+        s->init(generator::state_t{0, true, 0, true}, generator::time_t{0, true, 0, true});
+        s->run_until(limit);
+      }
+      THEN("the results are the same and repeated states hit the cache") {
+        REQUIRE(cached_1.get_sim_state().t_next == uncached.get_sim_state().t_next);
+        REQUIRE(cached_2.get_sim_state().t_next == uncached.get_sim_state().t_next);
+        // The initial state is the just emitted state, the only one ever computed
+        REQUIRE(cache.time_advance.stats().misses == 1);
+        REQUIRE(cache.internal_transition.stats().misses == 1);
+        REQUIRE(cache.output.stats().misses == 1);
+        REQUIRE(cache.time_advance.stats().hits > 100);
+      }
+    }
+  }GIVEN("a counter simulator with a cache") {
+    using counter = cadmium::iadevs::basic_models::counter;
+    cadmium::iadevs::engine::model_function_cache<counter> cache(16);
+    cadmium::iadevs::engine::simulator<counter> sc{};
+    sc.set_cache(&cache);
+    WHEN("it reports twice without inputs") {
+      sc.init(counter::state_t{counter::count_t{0, true, 0, true}, counter::no_time}, counter::no_time);
+      sc.step();
+      sc.step();
+      THEN("the second report is served from the cache") {
+        REQUIRE(sc.get_sim_state().t_next == counter::time_t{3000, true, 3000, true});
+        REQUIRE(cache.output.stats().hits == 1);
+        REQUIRE(cache.internal_transition.stats().hits == 1);
+      }
+    }
+  }
+}
@@ -70,3 +70,54 @@ SCENARIO("Generator basic model time_bound_add function", "[GENERATOR]") {
     }
   }
 }
+
+SCENARIO("Generator basic model functions are constant expressions", "[GENERATOR]") {
+  GIVEN("A generator and a constant q_state ([0, 0], [0, 0])") {
+    using generator = cadmium::iadevs::basic_models::generator;
+    constexpr generator g{};
+    constexpr generator::state_t s{0, true, 0, true};
+    THEN("bounded_time_advance_i folds to [997, 1005] at compile time") {
+      constexpr auto i = g.bounded_time_advance_i(s);
+      STATIC_REQUIRE(i == generator::time_t{997, true, 1005, true});
+    } AND_THEN("time_bound_t_add_time_advance folds to [1994, 2010] at compile time") {
+      constexpr auto i = g.time_bound_t_add_time_advance(s, generator::output_period);
+      STATIC_REQUIRE(i == generator::time_t{1994, true, 2010, true});
+    }
+  }
+}
+
+SCENARIO("Generator basic model internal transition and output functions", "[GENERATOR]") {
+  GIVEN("A generator with q_state ([500, 600], [0, 0])") {
+    cadmium::iadevs::basic_models::generator g{};
+    cadmium::iadevs::basic_models::generator::state_t s{};
+    s.set_bounded(500, true, 600, true);
+    WHEN("output_i is called") {
+      auto o = g.output_i(s);
+      THEN("interval [1, 2] is returned") {
+        REQUIRE(o == cadmium::iadevs::basic_models::generator::output_t{1, true, 2, true});
+      }
+    }WHEN("internal_transition_i is called") {
+      auto next = g.internal_transition_i(s);
+      THEN("the elapsed time restarts from [0, 0]") {
+        REQUIRE(next == cadmium::iadevs::basic_models::generator::state_t{0, true, 0, true});
+      }
+    }
+  }
+}
+
+SCENARIO("Generator basic model time interval serialization", "[GENERATOR]") {
+  GIVEN("A generator and the time interval [997, 1005]") {
+    cadmium::iadevs::basic_models::generator g{};
+    const auto t = cadmium::iadevs::basic_models::generator::output_period;
+    WHEN("the interval is serialized") {
+      auto bytes = g.serialize_time_interval(t);
+      THEN("deserializing returns the same interval") {
+        REQUIRE(bytes.size() == cadmium::iadevs::interval_codec::encoded_size<int>);
+        REQUIRE(g.deserialize_time_interval(bytes) == t);
+      } AND_THEN("truncated bytes are rejected") {
+        bytes.pop_back();
+        REQUIRE_THROWS_AS(g.deserialize_time_interval(bytes), std::invalid_argument);
+      }
+    }
+  }
+}
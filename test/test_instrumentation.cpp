@@ -0,0 +1,212 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <cadmium/iadevs/basic_models/counter.h>
+#include <cadmium/iadevs/basic_models/generator.h>
+#include <cadmium/iadevs/engine/coordinator.h>
+#include <cadmium/iadevs/engine/instrumentation.h>
+#include <cadmium/iadevs/engine/simulator.h>
+#include <cadmium/iadevs/engine/thread_pool.h>
+
+#include <catch.hpp>
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace {
+using cadmium::iadevs::engine::counting_instrumentation;
+using cadmium::iadevs::engine::phase;
+using counter = cadmium::iadevs::basic_models::counter;
+using generator = cadmium::iadevs::basic_models::generator;
+
+// Counters are per model type and process wide, each scenario instruments its own model types
+// and runs a single path, so its counts start from zero
+struct traced_generator : generator {};
+struct cached_generator : generator {};
+struct coordinated_generator : generator {};
+struct coordinated_counter : counter {};
+struct threaded_generator : generator {};
+
+cadmium::iadevs::engine::model_counters counters_of(std::string_view model) {
+  const auto snapshot = counting_instrumentation::snapshot();
+  const auto it = std::find_if(snapshot.begin(), snapshot.end(), [&](const auto &c) {
+    return c.model.ends_with(model);
+  });
+  return it == snapshot.end() ? cadmium::iadevs::engine::model_counters{} : *it;
+}
+}
+
+SCENARIO("Simulators without instrumentation record nothing", "[INSTRUMENTATION]") {
+  GIVEN("the default instrumentation policy") {
+    THEN("its probe is empty and simulators keep their size") {
+      STATIC_REQUIRE(std::is_empty_v<cadmium::iadevs::engine::no_instrumentation::probe>);
+      STATIC_REQUIRE(std::is_same_v<cadmium::iadevs::engine::simulator<generator>,
+                                    cadmium::iadevs::engine::simulator<generator,
+                                                                       cadmium::iadevs::engine::no_instrumentation>>);
+      STATIC_REQUIRE(sizeof(cadmium::iadevs::engine::simulator<generator, counting_instrumentation>)
+                         == sizeof(cadmium::iadevs::engine::simulator<generator>));
+    }
+  }
+}
+
+SCENARIO("Instrumented simulator counts calls and interval widening", "[INSTRUMENTATION]") {
+  GIVEN("an instrumented generator simulator initialized at [0, 0]") {
+    cadmium::iadevs::engine::simulator<traced_generator, counting_instrumentation> sg{};
+    sg.init(generator::just_emitted, generator::time_t{0, true, 0, true});
+    WHEN("it runs 4 events") {
+      sg.run_until(generator::time_t{5000, true, 5000, true});
+      const auto c = counters_of("traced_generator");
+      THEN("every IA function call and transition is counted, and t_next widens by 8 ms per event") {
+        REQUIRE(c.get_calls(phase::time_advance) == 5);
+        REQUIRE(c.get_calls(phase::output) == 4);
+        REQUIRE(c.get_calls(phase::internal_transition) == 4);
+        REQUIRE(c.get_calls(phase::external_transition) == 0);
+        REQUIRE(c.transitions() == 4);
+        REQUIRE(c.cache_hits + c.cache_misses == 0);
+        REQUIRE(c.width_samples == 5);
+        REQUIRE(c.width_sum == 8 + 16 + 24 + 32 + 40);
+        REQUIRE(c.width_max == 40);
+        REQUIRE(c.width_growth_sum == 5 * 8);
+      }
+    }
+  }
+}
+
+SCENARIO("Instrumented simulator counts cache hits", "[INSTRUMENTATION]") {
+  GIVEN("two instrumented generator simulators sharing a function cache") {
+    cadmium::iadevs::engine::model_function_cache<cached_generator> cache(16);
+    cadmium::iadevs::engine::simulator<cached_generator, counting_instrumentation> first{}, second{};
+    first.set_cache(&cache);
+    second.set_cache(&cache);
+    WHEN("both run the same events") {
+      first.init(generator::just_emitted, generator::time_t{0, true, 0, true});
+      first.step();
+      second.init(generator::just_emitted, generator::time_t{0, true, 0, true});
+      second.step();
+      const auto c = counters_of("cached_generator");
+      THEN("the first computes each function once and the rest are hits") {
+        // just_emitted is the only state, so one miss per function out of 4 lookups per simulator
+        REQUIRE(c.cache_misses == 3);
+        REQUIRE(c.cache_hits == 2 * 4 - 3);
+        REQUIRE(c.transitions() == 2);
+      }
+    }
+  }
+}
+
+SCENARIO("Instrumented coordinator counts per model across threads", "[INSTRUMENTATION]") {
+  GIVEN("an instrumented coordinator of generators feeding a counter on a thread pool") {
+    using coordinator_t = cadmium::iadevs::engine::coordinator<generator::time_t, generator::output_t,
+                                                               counting_instrumentation>;
+    cadmium::iadevs::engine::thread_pool pool(4);
+    coordinator_t c;
+    const auto n = c.add_component(coordinated_counter{}, counter::state_t{counter::no_time, counter::no_time});
+    for (int k = 0; k < 100; ++k) {
+      c.add_coupling(c.add_component(coordinated_generator{}, generator::just_emitted), n);
+    }
+    c.set_thread_pool(&pool);
+    c.init(generator::time_t{0, true, 0, true});
+    WHEN("the first two events are executed") {
+      c.step();
+      c.step();
+      const auto g = counters_of("coordinated_generator");
+      const auto r = counters_of("coordinated_counter");
+      THEN("the counts of every thread are summed per model type") {
+        // The counter reports together with the generators in both events
+        REQUIRE(g.get_calls(phase::internal_transition) == 200);
+        REQUIRE(g.get_calls(phase::time_advance) == 300);
+        REQUIRE(r.get_calls(phase::output) == 2);
+        REQUIRE(r.get_calls(phase::confluent_transition) == 2);
+        REQUIRE(r.transitions() == 2);
+      }
+    }
+  }
+}
+
+SCENARIO("Counts of finished threads are kept", "[INSTRUMENTATION]") {
+  GIVEN("instrumented generator simulators run on threads that finish") {
+    const auto &registry = cadmium::iadevs::engine::detail::counter_registry::instance();
+    counting_instrumentation::snapshot();
+    const auto threads = registry.thread_count();
+    WHEN("each thread runs an event and exits") {
+      for (int k = 0; k < 3; ++k) {
+        std::thread([] {
+          cadmium::iadevs::engine::simulator<threaded_generator, counting_instrumentation> sg{};
+          sg.init(generator::just_emitted, generator::time_t{0, true, 0, true});
+          sg.step();
+        }).join();
+      }
+      THEN("their counters are released and their counts stay in the snapshots") {
+        REQUIRE(registry.thread_count() == threads);
+        REQUIRE(counters_of("threaded_generator").transitions() == 3);
+      }
+    }
+  }
+}
+
+SCENARIO("Instrumentation snapshots are exported", "[INSTRUMENTATION]") {
+  GIVEN("a snapshot with a single model") {
+    cadmium::iadevs::engine::model_counters c{};
+    c.model = "models::\"quoted\"";
+    c.calls[static_cast<std::size_t>(phase::internal_transition)] = 3;
+    c.nanoseconds[static_cast<std::size_t>(phase::internal_transition)] = 1'500'000'000;
+    c.cache_hits = 2;
+    c.width_samples = 4;
+    c.width_max = 0.5;
+    std::ostringstream out;
+    WHEN("it is written as JSON") {
+      cadmium::iadevs::engine::write_json({c}, out);
+      THEN("the model name is escaped and every counter is written") {
+        REQUIRE(out.str().starts_with(R"({"models": [{"model": "models::\"quoted\"", "transitions": 3, )"));
+        REQUIRE(out.str().find(R"("internal_transition": 3,)") != std::string::npos);
+        REQUIRE(out.str().find(R"("internal_transition": 1500000000,)") != std::string::npos);
+        REQUIRE(out.str().find(R"("cache_hits": 2, "cache_misses": 0)") != std::string::npos);
+        REQUIRE(out.str().find(R"("t_next_width": {"samples": 4, "sum": 0, "max": 0.5, "growth_sum": 0}}]})")
+                    != std::string::npos);
+      }
+    }WHEN("it is written as Prometheus text") {
+      cadmium::iadevs::engine::write_prometheus({c}, out);
+      THEN("there is a sample per phase and per model counter") {
+        const auto text = out.str();
+        REQUIRE(text.find("# TYPE iadevs_calls_total counter\n") != std::string::npos);
+        REQUIRE(text.find(R"(iadevs_calls_total{model="models::\"quoted\"",phase="internal_transition"} 3)"
+                          "\n") != std::string::npos);
+        REQUIRE(text.find(R"(iadevs_seconds_total{model="models::\"quoted\"",phase="internal_transition"} 1.5)"
+                          "\n") != std::string::npos);
+        REQUIRE(text.find(R"(iadevs_transitions_total{model="models::\"quoted\""} 3)" "\n") != std::string::npos);
+        REQUIRE(text.find(R"(iadevs_t_next_width_max{model="models::\"quoted\""} 0.5)" "\n") != std::string::npos);
+        REQUIRE(text.find("# TYPE iadevs_t_next_width summary\n") != std::string::npos);
+        REQUIRE(text.find(R"(iadevs_t_next_width_count{model="models::\"quoted\""} 4)" "\n") != std::string::npos);
+        REQUIRE(text.find(R"(iadevs_t_next_width_sum{model="models::\"quoted\""} 0)" "\n") != std::string::npos);
+        REQUIRE(text.find("# TYPE iadevs_t_next_width_growth gauge\n") != std::string::npos);
+      }
+    }
+  }
+}
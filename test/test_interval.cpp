@@ -27,6 +27,12 @@
 
 #include <catch.hpp>
 
+#include <cfenv>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <type_traits>
+
 SCENARIO("Basic operations with intervals", "[INTERVALS]") {
   GIVEN("an infinite integer interval") {
     cadmium::iadevs::interval<int> i{};
@@ -175,6 +181,23 @@ SCENARIO("Intervals additions", "[INTERVALS]") {
         REQUIRE(k.is_lower_endpoint_closed());
         REQUIRE(k.get_lower_endpoint_value() == 8);
       }
+    }WHEN("both intervals are left unbounded") {
+      i.set_left_unbounded_with_upper_endpoint_value(2, true);
+      j.set_left_unbounded_with_upper_endpoint_value(7, false);
+      THEN("their addition is left unbounded") {
+        auto k = i + j;
+        REQUIRE(k.is_left_unbounded());
+        REQUIRE_FALSE(k.is_right_unbounded());
+        REQUIRE_FALSE(k.is_upper_endpoint_closed());
+        REQUIRE(k.get_upper_endpoint_value() == 9);
+      }
+    }WHEN("one interval is right unbounded and the other left unbounded") {
+      i.set_right_unbounded_with_lower_endpoint_value(1, true);
+      j.set_left_unbounded_with_upper_endpoint_value(7, true);
+      THEN("their addition is unbounded") {
+        REQUIRE((i + j).is_unbounded());
+        REQUIRE((j + i).is_unbounded());
+      }
     }WHEN("an interval endpoint is open") {
       i.set_bounded(1, false, 2, true);
       j.set_bounded(5, true, 7, false);
@@ -284,3 +307,310 @@ SCENARIO("Equality of intervals", "[INTERVALS]") {
     }
   }
 }
+
+SCENARIO("Negation of intervals", "[INTERVALS]") {
+  GIVEN("an interval") {
+    cadmium::iadevs::interval<int> i{};
+    WHEN("it is bounded [1, 2)") {
+      i.set_bounded(1, true, 2, false);
+      THEN("its negation is (-2, -1]") {
+        cadmium::iadevs::interval<int> expected{};
+        expected.set_bounded(-2, false, -1, true);
+        REQUIRE(-i == expected);
+      }
+    }WHEN("it is left unbounded (inf-, 4]") {
+      i.set_left_unbounded_with_upper_endpoint_value(4, true);
+      THEN("its negation is [-4, inf+)") {
+        cadmium::iadevs::interval<int> expected{};
+        expected.set_right_unbounded_with_lower_endpoint_value(-4, true);
+        REQUIRE(-i == expected);
+      }
+    }WHEN("it is right unbounded (5, inf+)") {
+      i.set_right_unbounded_with_lower_endpoint_value(5, false);
+      THEN("its negation is (inf-, -5)") {
+        cadmium::iadevs::interval<int> expected{};
+        expected.set_left_unbounded_with_upper_endpoint_value(-5, false);
+        REQUIRE(-i == expected);
+      }
+    }WHEN("it is empty") {
+      THEN("its negation is empty") {
+        REQUIRE((-i).is_empty());
+      }
+    }
+  }
+}
+
+SCENARIO("Packed representation of intervals", "[INTERVALS]") {
+  GIVEN("integer intervals") {
+    using int_interval = cadmium::iadevs::interval<int>;
+    THEN("they are trivially copyable and hold two ints and a flags byte") {
+      STATIC_REQUIRE(std::is_trivially_copyable_v<int_interval>);
+      STATIC_REQUIRE(sizeof(int_interval) == 3 * sizeof(int));
+    }
+    WHEN("an interval is reused after being unbounded") {
+      int_interval i{};
+      i.set_unbounded();
+      i.set_bounded(1, true, 2, true);
+      THEN("no infinite endpoint is left behind") {
+        REQUIRE(i.is_bounded());
+        REQUIRE(i.get_lower_endpoint_value() == 1);
+        REQUIRE(i.get_upper_endpoint_value() == 2);
+      } AND_WHEN("it is set empty again") {
+        i.set_empty();
+        THEN("it is equal to a default constructed interval") {
+          REQUIRE(i.is_empty());
+          REQUIRE(i == int_interval{});
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("Scalar hull and intersection of intervals", "[INTERVALS]") {
+  GIVEN("intervals [1, 3) and (2, 5]") {
+    cadmium::iadevs::interval<int> i{};
+    cadmium::iadevs::interval<int> j{};
+    i.set_bounded(1, true, 3, false);
+    j.set_bounded(2, false, 5, true);
+    THEN("their hull is [1, 5] and their intersection is (2, 3)") {
+      cadmium::iadevs::interval<int> expected_hull{};
+      expected_hull.set_bounded(1, true, 5, true);
+      cadmium::iadevs::interval<int> expected_intersection{};
+      expected_intersection.set_bounded(2, false, 3, false);
+      REQUIRE(i.hull(j) == expected_hull);
+      REQUIRE(i.intersect(j) == expected_intersection);
+    }
+  }GIVEN("intervals [1, 2) and [2, 3]") {
+    cadmium::iadevs::interval<int> i{};
+    cadmium::iadevs::interval<int> j{};
+    i.set_bounded(1, true, 2, false);
+    j.set_bounded(2, true, 3, true);
+    THEN("their hull is [1, 3] and their intersection is empty") {
+      cadmium::iadevs::interval<int> expected_hull{};
+      expected_hull.set_bounded(1, true, 3, true);
+      REQUIRE(i.hull(j) == expected_hull);
+      REQUIRE(i.intersect(j).is_empty());
+    }
+  }GIVEN("intervals (inf-, 4] and (2, inf+)") {
+    cadmium::iadevs::interval<int> i{};
+    cadmium::iadevs::interval<int> j{};
+    i.set_left_unbounded_with_upper_endpoint_value(4, true);
+    j.set_right_unbounded_with_lower_endpoint_value(2, false);
+    THEN("their hull is unbounded and their intersection is (2, 4]") {
+      cadmium::iadevs::interval<int> expected_intersection{};
+      expected_intersection.set_bounded(2, false, 4, true);
+      REQUIRE(i.hull(j).is_unbounded());
+      REQUIRE(i.intersect(j) == expected_intersection);
+    }
+  }
+}
+
+SCENARIO("Non-throwing interval operations", "[INTERVALS]") {
+  using cadmium::iadevs::interval_status;
+  GIVEN("an empty interval and a bounded interval [1, 2]") {
+    cadmium::iadevs::interval<int> i{};
+    cadmium::iadevs::interval<int> j{};
+    j.set_bounded(1, true, 2, true);
+    WHEN("adding or subtracting them") {
+      cadmium::iadevs::interval<int> k{};
+      k.set_unbounded();
+      THEN("empty_operand is reported and the result is untouched") {
+        REQUIRE(i.try_add(j, k) == interval_status::empty_operand);
+        REQUIRE(j.try_subtract(i, k) == interval_status::empty_operand);
+        REQUIRE(k.is_unbounded());
+      }
+    }WHEN("getting the endpoint values of the empty interval") {
+      int value = 7;
+      THEN("empty_interval is reported and the value is untouched") {
+        REQUIRE(i.try_get_lower_endpoint_value(value) == interval_status::empty_interval);
+        REQUIRE(i.try_get_upper_endpoint_value(value) == interval_status::empty_interval);
+        REQUIRE(value == 7);
+      }
+    }WHEN("adding [1, 2] to itself") {
+      cadmium::iadevs::interval<int> k{};
+      THEN("ok is reported and the result is [2, 4]") {
+        REQUIRE(j.try_add(j, k) == interval_status::ok);
+        REQUIRE(k == j + j);
+      }
+    }WHEN("subtracting [1, 2] from itself") {
+      cadmium::iadevs::interval<int> k{};
+      THEN("ok is reported and the result is [-1, 1]") {
+        REQUIRE(j.try_subtract(j, k) == interval_status::ok);
+        REQUIRE(k == j - j);
+      }
+    }
+  }GIVEN("a right unbounded interval [5, inf+)") {
+    cadmium::iadevs::interval<int> i{};
+    i.set_right_unbounded_with_lower_endpoint_value(5, true);
+    THEN("the lower value is read and the upper one reports infinite_endpoint") {
+      int value = 0;
+      REQUIRE(i.try_get_lower_endpoint_value(value) == interval_status::ok);
+      REQUIRE(value == 5);
+      REQUIRE(i.try_get_upper_endpoint_value(value) == interval_status::infinite_endpoint);
+    }
+  }GIVEN("an interval to be set bounded") {
+    cadmium::iadevs::interval<int> i{};
+    THEN("invalid endpoints are reported and valid ones are set") {
+      REQUIRE(i.try_set_bounded(1, false, 0, false) == interval_status::invalid_endpoints);
+      REQUIRE(i.try_set_bounded(0, true, 0, false) == interval_status::invalid_endpoints);
+      REQUIRE(i.is_empty());
+      REQUIRE(i.try_set_bounded(0, true, 1, false) == interval_status::ok);
+      REQUIRE(i.get_upper_endpoint_value() == 1);
+    }
+  }
+}
+
+SCENARIO("Ordering of intervals", "[INTERVALS]") {
+  GIVEN("the intervals [0, 2], [2, 3], (2, 3], [1, 5] and (-inf, 0]") {
+    cadmium::iadevs::interval<int> a{0, true, 2, true};
+    cadmium::iadevs::interval<int> b{2, true, 3, true};
+    cadmium::iadevs::interval<int> c{};
+    c.set_bounded(2, false, 3, true);
+    cadmium::iadevs::interval<int> d{1, true, 5, true};
+    cadmium::iadevs::interval<int> e{};
+    e.set_left_unbounded_with_upper_endpoint_value(0, true);
+    THEN("an interval is certainly before another only if no element of it is reached by the other") {
+      REQUIRE_FALSE(a.certainly_before(b));
+      REQUIRE(a.certainly_before(c));
+      REQUIRE_FALSE(a.certainly_before(d));
+      REQUIRE_FALSE(a.certainly_before(a));
+      REQUIRE_FALSE(e.certainly_before(a));
+      REQUIRE(e.certainly_before(c));
+      REQUIRE_FALSE(c.certainly_before(e));
+    } AND_THEN("an interval is possibly before another if any of its elements is before one of the other") {
+      REQUIRE(a.possibly_before(b));
+      REQUIRE(d.possibly_before(a));
+      REQUIRE_FALSE(b.possibly_before(a));
+      REQUIRE(a.possibly_before(a));
+      REQUIRE(e.possibly_before(e));
+      REQUIRE_FALSE(a.possibly_before(e));
+    } AND_THEN("empty intervals are neither before nor after") {
+      cadmium::iadevs::interval<int> empty{};
+      REQUIRE_FALSE(empty.certainly_before(a));
+      REQUIRE_FALSE(a.certainly_before(empty));
+      REQUIRE_FALSE(empty.possibly_before(a));
+      REQUIRE_FALSE(a.possibly_before(empty));
+    }
+  }
+}
+
+SCENARIO("Width and bisection of intervals", "[INTERVALS]") {
+  GIVEN("the intervals [0, 10], (2, 3], [4, 4] and [0, inf)") {
+    cadmium::iadevs::interval<int> a{0, true, 10, true};
+    cadmium::iadevs::interval<int> b{};
+    b.set_bounded(2, false, 3, true);
+    cadmium::iadevs::interval<int> c{4, true, 4, true};
+    cadmium::iadevs::interval<int> d{};
+    d.set_right_unbounded_with_lower_endpoint_value(0, true);
+    THEN("the width of a bounded interval is the distance between its endpoints") {
+      int width = 0;
+      REQUIRE(a.try_get_width(width) == cadmium::iadevs::interval_status::ok);
+      REQUIRE(width == 10);
+      REQUIRE(c.try_get_width(width) == cadmium::iadevs::interval_status::ok);
+      REQUIRE(width == 0);
+      REQUIRE(d.try_get_width(width) != cadmium::iadevs::interval_status::ok);
+    } AND_THEN("bisecting splits at the midpoint into two disjoint halves whose hull is the original") {
+      cadmium::iadevs::interval<int> low{}, high{};
+      REQUIRE(a.try_bisect(low, high) == cadmium::iadevs::interval_status::ok);
+      REQUIRE(low.get_lower_endpoint_value() == 0);
+      REQUIRE(low.get_upper_endpoint_value() == 5);
+      REQUIRE(high.get_lower_endpoint_value() == 5);
+      REQUIRE_FALSE(high.is_lower_endpoint_closed());
+      REQUIRE(high.get_upper_endpoint_value() == 10);
+      REQUIRE(low.certainly_before(high));
+      REQUIRE(low.hull(high) == a);
+    } AND_THEN("intervals without an interior midpoint are not bisected") {
+      cadmium::iadevs::interval<int> low{}, high{};
+      REQUIRE(b.try_bisect(low, high) != cadmium::iadevs::interval_status::ok);
+      REQUIRE(c.try_bisect(low, high) != cadmium::iadevs::interval_status::ok);
+      REQUIRE(d.try_bisect(low, high) != cadmium::iadevs::interval_status::ok);
+    }
+  }
+  GIVEN("an integer interval wider than the largest int") {
+    constexpr int max = std::numeric_limits<int>::max();
+    cadmium::iadevs::interval<int> wide{-max, true, max, true};
+    THEN("its width overflows and is reported instead of computed") {
+      int width = 7;
+      REQUIRE(wide.try_get_width(width) == cadmium::iadevs::interval_status::overflow);
+      REQUIRE(width == 7);
+    } AND_THEN("it is still bisected at its midpoint") {
+      cadmium::iadevs::interval<int> low{}, high{};
+      REQUIRE(wide.try_bisect(low, high) == cadmium::iadevs::interval_status::ok);
+      REQUIRE(low.get_lower_endpoint_value() == -max);
+      REQUIRE(low.get_upper_endpoint_value() == 0);
+      REQUIRE(high.get_lower_endpoint_value() == 0);
+      REQUIRE(high.get_upper_endpoint_value() == max);
+    }
+  }
+  GIVEN("floating point intervals whose width is rounded or overflows") {
+    cadmium::iadevs::interval<double> a{-1e-17, true, 1.0, true};
+    constexpr double max = std::numeric_limits<double>::max();
+    cadmium::iadevs::interval<double> wide{-max, true, max, true};
+    THEN("the width is rounded upwards") {
+      double width = 0;
+      REQUIRE(a.try_get_width(width) == cadmium::iadevs::interval_status::ok);
+      REQUIRE(width == std::nextafter(1.0, 2.0));
+      REQUIRE(wide.try_get_width(width) == cadmium::iadevs::interval_status::ok);
+      REQUIRE(width == std::numeric_limits<double>::infinity());
+    } AND_THEN("bisecting does not overflow") {
+      cadmium::iadevs::interval<double> low{}, high{};
+      REQUIRE(wide.try_bisect(low, high) == cadmium::iadevs::interval_status::ok);
+      REQUIRE(low.get_upper_endpoint_value() == 0.0);
+      REQUIRE(high.get_upper_endpoint_value() == max);
+    }
+  }
+}
+
+SCENARIO("Outward rounding of floating point intervals", "[INTERVALS]") {
+  GIVEN("the intervals [0.1, 0.1] and [0.2, 0.2], whose sum is not representable") {
+    cadmium::iadevs::interval<double> a{0.1, true, 0.1, true};
+    cadmium::iadevs::interval<double> b{0.2, true, 0.2, true};
+    THEN("the sum is widened to the closest doubles enclosing the exact sum") {
+      const auto sum = a + b;
+      REQUIRE(sum.get_lower_endpoint_value() < sum.get_upper_endpoint_value());
+      REQUIRE(std::nextafter(sum.get_lower_endpoint_value(), 1.0) == sum.get_upper_endpoint_value());
+      REQUIRE(sum.get_lower_endpoint_value() <= 0.1 + 0.2);
+      REQUIRE(0.1 + 0.2 <= sum.get_upper_endpoint_value());
+    } AND_THEN("exact sums are not widened") {
+      cadmium::iadevs::interval<double> c{0.5, true, 0.75, true};
+      REQUIRE(c + c == cadmium::iadevs::interval<double>{1.0, true, 1.5, true});
+      REQUIRE(c - c == cadmium::iadevs::interval<double>{-0.25, true, 0.25, true});
+    }
+  }
+  GIVEN("random doubles") {
+    std::mt19937_64 gen(3);
+    std::uniform_real_distribution<double> mantissa(-1.0, 1.0);
+    std::uniform_int_distribution<int> exponent(-60, 60);
+    THEN("endpoints match sums rounded by the processor towards -inf and +inf") {
+      for (int k = 0; k < 10000; ++k) {
+        volatile double x = std::ldexp(mantissa(gen), exponent(gen));
+        volatile double y = std::ldexp(mantissa(gen), exponent(gen));
+        std::fesetround(FE_DOWNWARD);
+        const double down = x + y;
+        std::fesetround(FE_UPWARD);
+        const double up = x + y;
+        std::fesetround(FE_TONEAREST);
+        cadmium::iadevs::interval<double> a{}, b{};
+        a.set_bounded(x, true, x, true);
+        b.set_bounded(y, true, y, true);
+        const auto sum = a + b;
+        REQUIRE(sum.get_lower_endpoint_value() == down);
+        REQUIRE(sum.get_upper_endpoint_value() == up);
+      }
+    }
+  }
+  GIVEN("the interval [max, max] of the largest finite double") {
+    constexpr double max = std::numeric_limits<double>::max();
+    cadmium::iadevs::interval<double> a{max, true, max, true};
+    THEN("an overflowing sum saturates inwards and becomes unbounded outwards") {
+      const auto sum = a + a;
+      REQUIRE(sum.get_lower_endpoint_value() == max);
+      REQUIRE(sum.is_lower_endpoint_closed());
+      REQUIRE(sum.is_right_unbounded());
+      REQUIRE_FALSE(sum.is_upper_endpoint_closed());
+      const auto negated = -a - a;
+      REQUIRE(negated.get_upper_endpoint_value() == -max);
+      REQUIRE(negated.is_left_unbounded());
+    }
+  }
+}
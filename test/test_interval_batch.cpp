@@ -0,0 +1,192 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cadmium/iadevs/utils/ia_interval_batch.h>
+
+#include <catch.hpp>
+
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <random>
+
+namespace {
+using namespace cadmium::iadevs;
+
+template<typename T>
+interval<T> random_interval(std::mt19937 &gen, bool allow_empty) {
+  std::uniform_int_distribution<int> shape(0, 19);
+  std::uniform_int_distribution<int> value(-50, 50);
+  std::bernoulli_distribution closed;
+  T a = static_cast<T>(value(gen));
+  T b = static_cast<T>(value(gen));
+  if constexpr (std::is_floating_point_v<T>) {
+    a += static_cast<T>(value(gen)) / 7;
+    b += static_cast<T>(value(gen)) / 7;
+  }
+  interval<T> i{};
+  switch (shape(gen)) {
+  case 0:
+    if (!allow_empty) {
+      i.set_unbounded();
+    }
+    break;
+  case 1:
+    i.set_unbounded();
+    break;
+  case 2:
+    i.set_left_unbounded_with_upper_endpoint_value(a, closed(gen));
+    break;
+  case 3:
+    i.set_right_unbounded_with_lower_endpoint_value(a, closed(gen));
+    break;
+  case 4:
+    i.set_bounded(a, true, a, true);
+    break;
+  default:
+    if (a == b) {
+      i.set_bounded(a, true, b, true);
+    } else {
+      i.set_bounded(std::min(a, b), closed(gen), std::max(a, b), closed(gen));
+    }
+  }
+  return i;
+}
+
+template<typename T>
+bool bit_identical(const interval<T> &a, const interval<T> &b) {
+  using bits_t = std::conditional_t<sizeof(T) == 8, std::uint64_t, std::uint32_t>;
+  return a.packed_flags() == b.packed_flags()
+      && std::bit_cast<bits_t>(a.packed_lower_value()) == std::bit_cast<bits_t>(b.packed_lower_value())
+      && std::bit_cast<bits_t>(a.packed_upper_value()) == std::bit_cast<bits_t>(b.packed_upper_value());
+}
+
+template<typename T>
+void check_matches_scalar(bool allow_empty) {
+  std::mt19937 gen(42);
+  // Odd size to exercise both the vector blocks and the scalar tail
+  constexpr std::size_t size = 1027;
+  interval_batch<T> a;
+  interval_batch<T> b;
+  for (std::size_t k = 0; k < size; ++k) {
+    // Long runs of bounded intervals reach the vectorized path
+    const bool bounded_run = (k / 64) % 2 == 0;
+    auto i = random_interval<T>(gen, allow_empty);
+    auto j = random_interval<T>(gen, allow_empty);
+    if (bounded_run) {
+      i.set_bounded(static_cast<T>(k % 13), true, static_cast<T>(k % 17 + 13), (k % 3) != 0);
+    }
+    a.push_back(i);
+    b.push_back(j);
+  }
+  interval_batch<T> r;
+  if (!allow_empty) {
+    add(a, b, r);
+    for (std::size_t k = 0; k < size; ++k) {
+      REQUIRE(bit_identical(r.get(k), a.get(k) + b.get(k)));
+    }
+    subtract(a, b, r);
+    for (std::size_t k = 0; k < size; ++k) {
+      REQUIRE(bit_identical(r.get(k), a.get(k) - b.get(k)));
+    }
+  }
+  negate(a, r);
+  for (std::size_t k = 0; k < size; ++k) {
+    REQUIRE(bit_identical(r.get(k), -a.get(k)));
+  }
+  hull(a, b, r);
+  for (std::size_t k = 0; k < size; ++k) {
+    REQUIRE(bit_identical(r.get(k), a.get(k).hull(b.get(k))));
+  }
+  intersect(a, b, r);
+  for (std::size_t k = 0; k < size; ++k) {
+    REQUIRE(bit_identical(r.get(k), a.get(k).intersect(b.get(k))));
+  }
+}
+}
+
+SCENARIO("Batch interval arithmetic matches scalar arithmetic", "[INTERVALS]") {
+  GIVEN("batches of random int intervals") {
+    THEN("all operations are bit-identical to the scalar ones") {
+      check_matches_scalar<std::int32_t>(false);
+      check_matches_scalar<std::int32_t>(true);
+    }
+  }GIVEN("batches of random int64 intervals") {
+    THEN("all operations are bit-identical to the scalar ones") {
+      check_matches_scalar<std::int64_t>(false);
+      check_matches_scalar<std::int64_t>(true);
+    }
+  }GIVEN("batches of random double intervals") {
+    THEN("all operations are bit-identical to the scalar ones") {
+      check_matches_scalar<double>(false);
+      check_matches_scalar<double>(true);
+    }
+  }
+}
+
+SCENARIO("Batch interval arithmetic errors", "[INTERVALS]") {
+  GIVEN("batches with different sizes") {
+    interval_batch<int> a(3);
+    interval_batch<int> b(4);
+    interval_batch<int> r;
+    THEN("operations are rejected") {
+      REQUIRE_THROWS_AS(hull(a, b, r), std::invalid_argument);
+    }
+  }GIVEN("a batch with an empty interval") {
+    interval_batch<int> a(1);
+    THEN("adding it is out of the domain") {
+      interval_batch<int> r;
+      REQUIRE_THROWS_AS(add(a, a, r), std::domain_error);
+    }
+  }GIVEN("a batch of double intervals whose sums overflow") {
+    interval_batch<double> a;
+    interval<double> i{};
+    for (int k = 0; k < 9; ++k) {
+      i.set_bounded(0.1 * k, true, k == 5 ? std::numeric_limits<double>::max() : 1.0, true);
+      a.push_back(i);
+    }
+    interval_batch<double> r;
+    add(a, a, r);
+    THEN("the overflowing block matches the scalar sums") {
+      for (std::size_t k = 0; k < a.size(); ++k) {
+        REQUIRE(bit_identical(r.get(k), a.get(k) + a.get(k)));
+        REQUIRE(r.get(k).is_right_unbounded() == (k == 5));
+      }
+    }
+  }GIVEN("a batch used as its own output") {
+    interval_batch<int> a;
+    interval<int> i{};
+    for (int k = 0; k < 20; ++k) {
+      i.set_bounded(k, true, k + 1, false);
+      a.push_back(i);
+    }
+    add(a, a, a);
+    THEN("each element is added to itself") {
+      interval<int> expected{};
+      expected.set_bounded(38, true, 40, false);
+      REQUIRE(a.get(19) == expected);
+    }
+  }
+}
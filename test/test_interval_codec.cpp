@@ -0,0 +1,176 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cadmium/iadevs/utils/ia_interval_codec.h>
+
+#include <catch.hpp>
+
+#include <array>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+using cadmium::iadevs::interval;
+using cadmium::iadevs::interval_codec;
+
+SCENARIO("Interval binary encoding", "[INTERVAL]") {
+  GIVEN("the bounded interval [997, 1005)") {
+    interval<int> i{};
+    i.set_bounded(997, true, 1005, false);
+    WHEN("it is encoded") {
+      std::vector<std::byte> bytes;
+      interval_codec::encode(i, bytes);
+      THEN("it takes a version byte, the flags and both endpoints in little-endian order") {
+        REQUIRE(bytes.size() == 10);
+        REQUIRE(bytes[0] == std::byte{interval_codec::version});
+        REQUIRE(bytes[1] == std::byte{i.packed_flags()});
+        REQUIRE(bytes[2] == std::byte{997 & 0xff});
+        REQUIRE(bytes[3] == std::byte{997 >> 8});
+        REQUIRE(bytes[6] == std::byte{1005 & 0xff});
+        REQUIRE(bytes[7] == std::byte{1005 >> 8});
+      } AND_THEN("decoding returns the same interval") {
+        interval<int> decoded{};
+        REQUIRE(interval_codec::decode(bytes, decoded));
+        REQUIRE(decoded == i);
+      }
+    }
+  }
+  GIVEN("intervals of every shape") {
+    std::vector<interval<long long>> intervals(5);
+    intervals[1].set_bounded(-3, false, 7, true);
+    intervals[2].set_left_unbounded_with_upper_endpoint_value(-5, true);
+    intervals[3].set_right_unbounded_with_lower_endpoint_value(std::numeric_limits<long long>::max(), false);
+    intervals[4].set_unbounded();
+    THEN("each one round trips, and only equal intervals have equal encodings") {
+      for (const auto &a : intervals) {
+        std::vector<std::byte> a_bytes;
+        interval_codec::encode(a, a_bytes);
+        interval<long long> decoded{};
+        REQUIRE(interval_codec::decode(a_bytes, decoded));
+        REQUIRE(decoded == a);
+        for (const auto &b : intervals) {
+          std::vector<std::byte> b_bytes;
+          interval_codec::encode(b, b_bytes);
+          REQUIRE((std::memcmp(a_bytes.data(), b_bytes.data(), a_bytes.size()) == 0) == (a == b));
+        }
+      }
+    }
+  }
+  GIVEN("double intervals ending at positive and negative zero") {
+    interval<double> positive{};
+    positive.set_bounded(-1.5, true, 0.0, true);
+    interval<double> negative{};
+    negative.set_bounded(-1.5, true, -0.0, true);
+    THEN("both have the same encoding") {
+      std::vector<std::byte> p, n;
+      interval_codec::encode(positive, p);
+      interval_codec::encode(negative, n);
+      REQUIRE(p == n);
+    }
+  }
+  GIVEN("invalid encodings") {
+    interval<int> i{};
+    i.set_bounded(1, true, 2, true);
+    std::vector<std::byte> bytes;
+    interval_codec::encode(i, bytes);
+    interval<int> decoded{};
+    THEN("an unknown version is rejected") {
+      bytes[0] = std::byte{interval_codec::version + 1};
+      REQUIRE_FALSE(interval_codec::decode(bytes, decoded));
+    } AND_THEN("unknown flags are rejected") {
+      bytes[1] |= std::byte{0x80};
+      REQUIRE_FALSE(interval_codec::decode(bytes, decoded));
+    } AND_THEN("reversed endpoints are rejected") {
+      std::swap(bytes[2], bytes[6]);
+      REQUIRE_FALSE(interval_codec::decode(bytes, decoded));
+    } AND_THEN("values under infinite endpoints are rejected") {
+      bytes[1] = std::byte{cadmium::iadevs::interval_flags::lower_inf | cadmium::iadevs::interval_flags::upper_closed};
+      REQUIRE_FALSE(interval_codec::decode(bytes, decoded));
+    } AND_THEN("the wrong size is rejected") {
+      bytes.push_back(std::byte{0});
+      REQUIRE_FALSE(interval_codec::decode(bytes, decoded));
+    } AND_THEN("the destination is left untouched") {
+      REQUIRE(decoded.is_empty());
+    }
+  }
+}
+
+SCENARIO("Interval encoding is a constant expression", "[INTERVAL]") {
+  GIVEN("the constant interval [997, 1005]") {
+    constexpr interval<int> i{997, true, 1005, true};
+    THEN("it round trips at compile time") {
+      constexpr auto decoded = [] {
+        std::array<std::byte, interval_codec::encoded_size<int>> bytes{};
+        interval_codec::encode_to(interval<int>{997, true, 1005, true}, std::span(bytes));
+        interval<int> result{};
+        interval_codec::decode_from(std::span<const std::byte, interval_codec::encoded_size<int>>(bytes), result);
+        return result;
+      }();
+      STATIC_REQUIRE(decoded == i);
+    }
+  }
+}
+
+SCENARIO("Interval batch encoding", "[INTERVAL]") {
+  GIVEN("a sequence of intervals") {
+    std::vector<interval<double>> intervals(100);
+    for (std::size_t k = 0; k < intervals.size(); ++k) {
+      intervals[k].set_bounded(k * 0.5, true, k * 0.5 + 1, k % 2 == 0);
+    }
+    WHEN("they are encoded into a single buffer") {
+      std::vector<std::byte> bytes(intervals.size() * interval_codec::encoded_size<double>);
+      auto written = interval_codec::encode_batch<double>(intervals, bytes);
+      THEN("the whole buffer is used and decodes back to the sequence") {
+        REQUIRE(written == bytes.size());
+        std::vector<interval<double>> decoded(intervals.size());
+        REQUIRE(interval_codec::decode_batch<double>(bytes, decoded));
+        REQUIRE(decoded == intervals);
+      } AND_THEN("a short destination is refused") {
+        std::vector<std::byte> small(bytes.size() - 1);
+        REQUIRE(interval_codec::encode_batch<double>(intervals, small) == 0);
+      } AND_THEN("a mismatched destination count is refused") {
+        std::vector<interval<double>> decoded(intervals.size() - 1);
+        REQUIRE_FALSE(interval_codec::decode_batch<double>(bytes, decoded));
+      }
+    }
+  }
+}
+
+SCENARIO("Interval debug text", "[INTERVAL]") {
+  GIVEN("intervals of every shape") {
+    interval<double> bounded{};
+    bounded.set_bounded(0.1, true, 2.5, false);
+    interval<int> left{};
+    left.set_left_unbounded_with_upper_endpoint_value(3, true);
+    interval<int> right{};
+    right.set_right_unbounded_with_lower_endpoint_value(-3, false);
+    THEN("they are printed in interval notation") {
+      REQUIRE(interval_codec::to_debug_string(bounded) == "[0.1, 2.5)");
+      REQUIRE(interval_codec::to_debug_string(left) == "(-inf, 3]");
+      REQUIRE(interval_codec::to_debug_string(right) == "(-3, inf)");
+      REQUIRE(interval_codec::to_debug_string(interval<int>{}) == "{}");
+    }
+  }
+}
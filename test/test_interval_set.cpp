@@ -0,0 +1,219 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cadmium/iadevs/utils/ia_interval_set.h>
+
+#include <catch.hpp>
+
+#include <random>
+
+namespace {
+using namespace cadmium::iadevs;
+using set_t = interval_set<double>;
+
+interval<double> bounded(double lower, bool lower_closed, double upper, bool upper_closed) {
+  interval<double> i{};
+  i.set_bounded(lower, lower_closed, upper, upper_closed);
+  return i;
+}
+
+interval<double> random_interval(std::mt19937 &gen) {
+  std::uniform_int_distribution<int> shape(0, 9);
+  std::uniform_int_distribution<int> value(-20, 20);
+  std::bernoulli_distribution closed;
+  const double a = value(gen);
+  const double b = value(gen);
+  interval<double> i{};
+  switch (shape(gen)) {
+  case 0:
+    i.set_left_unbounded_with_upper_endpoint_value(a, closed(gen));
+    break;
+  case 1:
+    i.set_right_unbounded_with_lower_endpoint_value(a, closed(gen));
+    break;
+  case 2:
+    i.set_bounded(a, true, a, true);
+    break;
+  default:
+    if (a != b) {
+      i.set_bounded(std::min(a, b), closed(gen), std::max(a, b), closed(gen));
+    }
+  }
+  return i;
+}
+
+set_t random_set(std::mt19937 &gen) {
+  std::uniform_int_distribution<int> count(0, 6);
+  set_t result;
+  for (int n = count(gen); n > 0; --n) {
+    result.insert(random_interval(gen));
+  }
+  return result;
+}
+}
+
+SCENARIO("Building interval sets", "[INTERVALS]") {
+  GIVEN("intervals inserted out of order") {
+    set_t s{bounded(5, true, 6, false), bounded(0, true, 1, true), bounded(3, false, 4, true)};
+    THEN("they are stored sorted in the inline buffer") {
+      REQUIRE(s.size() == 3);
+      REQUIRE(s.is_inline());
+      REQUIRE(s[0] == bounded(0, true, 1, true));
+      REQUIRE(s[1] == bounded(3, false, 4, true));
+      REQUIRE(s[2] == bounded(5, true, 6, false));
+    } AND_WHEN("an interval touching two of them is inserted") {
+      s.insert(bounded(1, false, 3, true));
+      THEN("they are merged in a single interval") {
+        REQUIRE(s.size() == 2);
+        REQUIRE(s[0] == bounded(0, true, 4, true));
+      }
+    } AND_WHEN("intervals meeting at an excluded value are inserted") {
+      s.insert(bounded(6, false, 7, true));
+      THEN("they are kept apart") {
+        REQUIRE(s.size() == 4);
+        REQUIRE_FALSE(s.contains(6));
+      }
+    } AND_WHEN("more intervals than the inline capacity are inserted") {
+      for (int k = 10; k < 20; k += 2) {
+        s.insert(bounded(k, true, k + 1, true));
+      }
+      THEN("the set moves to the heap and stays sorted") {
+        REQUIRE(s.size() == 8);
+        REQUIRE_FALSE(s.is_inline());
+        REQUIRE(s[7] == bounded(18, true, 19, true));
+        set_t moved = std::move(s);
+        REQUIRE(moved.size() == 8);
+        REQUIRE(s.empty());
+        set_t copied = moved;
+        REQUIRE(copied == moved);
+      }
+    }
+  }
+  GIVEN("an empty interval") {
+    THEN("its set is empty") {
+      REQUIRE(set_t{interval<double>{}}.empty());
+      REQUIRE(set_t{}.hull().is_empty());
+    }
+  }
+}
+
+SCENARIO("Queries on interval sets", "[INTERVALS]") {
+  GIVEN("the set [0, 1] U (3, 4) U [6, inf)") {
+    interval<double> tail{};
+    tail.set_right_unbounded_with_lower_endpoint_value(6, true);
+    set_t s{bounded(0, true, 1, true), bounded(3, false, 4, false), tail};
+    THEN("points are looked up in the fragments") {
+      REQUIRE(s.contains(0));
+      REQUIRE(s.contains(1));
+      REQUIRE_FALSE(s.contains(2));
+      REQUIRE_FALSE(s.contains(3));
+      REQUIRE(s.contains(3.5));
+      REQUIRE(s.contains(100));
+    } AND_THEN("intervals overlap the set if they share an element with any fragment") {
+      REQUIRE(s.overlaps(bounded(1, true, 3, true)));
+      REQUIRE_FALSE(s.overlaps(bounded(1, false, 3, true)));
+      REQUIRE(s.overlaps(bounded(5, true, 7, true)));
+      REQUIRE_FALSE(s.overlaps(interval<double>{}));
+    } AND_THEN("intervals are included only if a single fragment covers them") {
+      REQUIRE(s.includes(bounded(3.5, true, 3.75, true)));
+      REQUIRE_FALSE(s.includes(bounded(0, true, 4, true)));
+      REQUIRE(s.includes(interval<double>{}));
+    } AND_THEN("the hull spans from the first to the last fragment") {
+      interval<double> hull{};
+      hull.set_right_unbounded_with_lower_endpoint_value(0, true);
+      REQUIRE(s.hull() == hull);
+    }
+  }
+}
+
+SCENARIO("Set operations on interval sets", "[INTERVALS]") {
+  GIVEN("the sets A = [0, 2] U [4, 6] and B = (1, 5)") {
+    set_t a{bounded(0, true, 2, true), bounded(4, true, 6, true)};
+    set_t b{bounded(1, false, 5, false)};
+    THEN("the union is a single interval") {
+      REQUIRE(a.unite(b) == set_t{bounded(0, true, 6, true)});
+    } AND_THEN("the intersection keeps the overlapping fragments") {
+      REQUIRE(a.intersect(b) == set_t{bounded(1, false, 2, true), bounded(4, true, 5, false)});
+    } AND_THEN("the difference removes them, leaving a non-convex result") {
+      REQUIRE(a.difference(b) == set_t{bounded(0, true, 1, true), bounded(5, true, 6, true)});
+      REQUIRE(b.difference(a) == set_t{bounded(2, false, 4, false)});
+    } AND_THEN("the complement of A fills the gaps with flipped endpoints") {
+      interval<double> head{};
+      head.set_left_unbounded_with_upper_endpoint_value(0, false);
+      interval<double> tail{};
+      tail.set_right_unbounded_with_lower_endpoint_value(6, false);
+      REQUIRE(a.complement() == set_t{head, bounded(2, false, 4, false), tail});
+      REQUIRE(a.complement().complement() == a);
+      interval<double> all{};
+      all.set_unbounded();
+      REQUIRE(set_t{}.complement() == set_t{all});
+      REQUIRE(set_t{all}.complement().empty());
+    } AND_THEN("the Minkowski sum with an interval shifts and merges the fragments") {
+      REQUIRE(a + bounded(0, true, 1, true) == set_t{bounded(0, true, 3, true), bounded(4, true, 7, true)});
+      REQUIRE(a + bounded(0, true, 2, true) == set_t{bounded(0, true, 8, true)});
+      REQUIRE((a + interval<double>{}).empty());
+    } AND_THEN("the Minkowski sum of two sets adds every pair of fragments") {
+      set_t c{bounded(0, true, 0, true), bounded(10, true, 10, true)};
+      REQUIRE(a + c == set_t{bounded(0, true, 2, true), bounded(4, true, 6, true),
+                             bounded(10, true, 12, true), bounded(14, true, 16, true)});
+    }
+  }
+}
+
+SCENARIO("Interval set operations match element-wise membership", "[INTERVALS]") {
+  GIVEN("random sets over integer endpoints") {
+    std::mt19937 gen(17);
+    for (int round = 0; round < 500; ++round) {
+      const set_t a = random_set(gen);
+      const set_t b = random_set(gen);
+      const set_t u = a.unite(b);
+      const set_t i = a.intersect(b);
+      const set_t d = a.difference(b);
+      const set_t c = a.complement();
+      // Every endpoint is an integer, so membership at integers and half integers describes the sets
+      for (int k = -50; k <= 50; ++k) {
+        const double x = k / 2.0;
+        REQUIRE(u.contains(x) == (a.contains(x) || b.contains(x)));
+        REQUIRE(i.contains(x) == (a.contains(x) && b.contains(x)));
+        REQUIRE(d.contains(x) == (a.contains(x) && !b.contains(x)));
+        REQUIRE(c.contains(x) == !a.contains(x));
+      }
+      for (const set_t *s: {&a, &u, &i, &d, &c}) {
+        for (std::size_t k = 1; k < s->size(); ++k) {
+          // Fragments are sorted and a gap is left between them
+          REQUIRE((*s)[k - 1].certainly_before((*s)[k]));
+          REQUIRE(set_t{(*s)[k - 1], (*s)[k]}.size() == 2);
+        }
+      }
+      set_t sum;
+      for (const interval<double> &x: a) {
+        for (const interval<double> &y: b) {
+          sum.insert(x + y);
+        }
+      }
+      REQUIRE(a + b == sum);
+    }
+  }
+}
@@ -0,0 +1,263 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cadmium/iadevs/basic_models/counter.h>
+#include <cadmium/iadevs/basic_models/generator.h>
+#include <cadmium/iadevs/engine/parallel_root_coordinator.h>
+
+#include <catch.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace {
+using generator = cadmium::iadevs::basic_models::generator;
+using counter = cadmium::iadevs::basic_models::counter;
+using message_t = cadmium::iadevs::interval<int>;
+using coordinator_t = cadmium::iadevs::engine::coordinator<generator::time_t, message_t>;
+using root_t = cadmium::iadevs::engine::parallel_root_coordinator<generator::time_t, message_t>;
+
+const counter::state_t counter_start{counter::no_time, counter::no_time};
+
+// A coordinator described as a parallel root coordinator, every component in the same partition
+struct flat_builder {
+  coordinator_t coordinator;
+
+  std::size_t add_partition() {
+    return 0;
+  }
+
+  template<typename model_t>
+  std::size_t add_component(std::size_t, model_t model, typename model_t::state_t initial_state) {
+    return coordinator.add_component(std::move(model), std::move(initial_state));
+  }
+
+  void add_coupling(std::size_t from, std::size_t to) {
+    coordinator.add_coupling(from, to);
+  }
+};
+
+generator::state_t elapsed(int ms) {
+  generator::state_t phase{};
+  phase.set_bounded(ms, true, ms, true);
+  return phase;
+}
+
+// A partition of generators feeding a local counter, with phases depending on the partition
+template<typename builder_t>
+std::size_t build_partition(builder_t &builder, std::size_t partition, std::size_t generators) {
+  builder.add_partition();
+  const auto n = builder.add_component(partition, counter{}, counter_start);
+  for (std::size_t k = 0; k < generators; ++k) {
+    const auto phase = elapsed(static_cast<int>((partition * generators + k) % 7) * 50);
+    builder.add_coupling(builder.add_component(partition, generator{}, phase), n);
+  }
+  return n;
+}
+
+// Partitions built by build_partition, the first generator of each also feeds the counter of the next one,
+// and the last one feeds the first one if ring is set
+template<typename builder_t>
+void build_chain(builder_t &builder, std::size_t partitions, std::size_t generators, bool ring) {
+  std::vector<std::size_t> counters;
+  for (std::size_t p = 0; p < partitions; ++p) {
+    counters.push_back(build_partition(builder, p, generators));
+  }
+  for (std::size_t p = 0; p + (ring ? 0 : 1) < partitions; ++p) {
+    builder.add_coupling(counters[p] + 1, counters[(p + 1) % partitions]);
+  }
+}
+
+std::unique_ptr<root_t> ring_model(std::size_t partitions, std::size_t generators) {
+  auto root = std::make_unique<root_t>();
+  build_chain(*root, partitions, generators, true);
+  return root;
+}
+
+// Runs the same components in a coordinator, and compares the counters, the only components with inputs
+template<typename build_t>
+void require_flat_counts(const root_t &root, build_t build, const generator::time_t &limit) {
+  flat_builder flat;
+  build(flat);
+  flat.coordinator.init(generator::time_t{0, true, 0, true});
+  flat.coordinator.run_until(limit);
+  for (std::size_t id = 0; id < root.size(); ++id) {
+    if (root.get_component(id).accepts_inputs()) {
+      REQUIRE(root.get_simulator<counter>(id).get_sim_state().state
+                  == flat.coordinator.get_simulator<counter>(id).get_sim_state().state);
+    }
+  }
+}
+}
+
+SCENARIO("Parallel root coordinator with a single partition", "[COORDINATOR]") {
+  GIVEN("the same generators and counter in a single partition and in a coordinator") {
+    root_t root;
+    coordinator_t serial;
+    root.add_partition();
+    const auto root_counter = root.add_component(0, counter{}, counter_start);
+    const auto serial_counter = serial.add_component(counter{}, counter_start);
+    for (int k = 0; k < 5; ++k) {
+      generator::state_t phase{};
+      phase.set_bounded(k * 100, true, k * 100, true);
+      root.add_coupling(root.add_component(0, generator{}, phase), root_counter);
+      serial.add_coupling(serial.add_component(generator{}, phase), serial_counter);
+    }
+    WHEN("both run for 20 seconds") {
+      const generator::time_t limit{20'000, true, 20'000, true};
+      root.init(generator::time_t{0, true, 0, true});
+      serial.init(generator::time_t{0, true, 0, true});
+      const auto root_events = root.run_until(limit);
+      const auto serial_events = serial.run_until(limit);
+      THEN("they execute the same events in a single unbounded window") {
+        REQUIRE(root_events == serial_events);
+        REQUIRE(root.get_simulator<counter>(root_counter).get_sim_state().state
+                    == serial.get_simulator<counter>(serial_counter).get_sim_state().state);
+        REQUIRE(root.t_next() == serial.t_next());
+        REQUIRE(root.stats().windows == 1);
+        REQUIRE(root.stats().imminent_steps == 0);
+        REQUIRE(root.windows().front().window.is_right_unbounded());
+      }
+    }
+  }
+}
+
+SCENARIO("Parallel root coordinator exchanges values across partitions", "[COORDINATOR]") {
+  GIVEN("a generator in a partition sending its outputs to a counter in another") {
+    root_t root;
+    root.add_partition();
+    root.add_partition();
+    const auto g = root.add_component(0, generator{}, generator::just_emitted);
+    const auto n = root.add_component(1, counter{}, counter_start);
+    root.add_coupling(g, n);
+    WHEN("it runs for 10 seconds") {
+      root.init(generator::time_t{0, true, 0, true});
+      root.run_until(generator::time_t{10'000, true, 10'000, true});
+      THEN("the counter receives every output at the time it was emitted at") {
+        REQUIRE(root.get_simulator<counter>(n).get_sim_state().state.count == counter::count_t{10, true, 10, true});
+        REQUIRE(root.get_simulator<generator>(g).get_sim_state().t_next == generator::time_t{10967, true, 11055, true});
+        // The generator partition receives no values, so it runs ahead of the counter
+        REQUIRE(root.stats().max_active_partitions == 2);
+        REQUIRE(root.stats().events == [&] {
+          std::size_t events = 0;
+          for (const auto &w : root.windows()) {
+            events += w.events;
+          }
+          return events;
+        }());
+      }
+    }
+  }
+}
+
+SCENARIO("Parallel root coordinator results do not depend on the threads", "[COORDINATOR]") {
+  GIVEN("eight partitions of generators coupled in a ring") {
+    const generator::time_t limit{30'000, true, 30'000, true};
+    auto reference = ring_model(8, 50);
+    reference->init(generator::time_t{0, true, 0, true});
+    const auto reference_events = reference->run_until(limit);
+    THEN("partitions take part together in the events") {
+      REQUIRE(reference->stats().mean_parallelism() > 1.0);
+      REQUIRE(reference->stats().max_active_partitions > 1);
+    }
+    for (std::size_t threads : {2, 4}) {
+      WHEN("it runs on a pool of " << threads << " threads") {
+        cadmium::iadevs::engine::thread_pool pool(threads);
+        auto parallel = ring_model(8, 50);
+        parallel->set_thread_pool(&pool);
+        parallel->init(generator::time_t{0, true, 0, true});
+        const auto parallel_events = parallel->run_until(limit);
+        THEN("every component ends in the same state at the same times") {
+          REQUIRE(parallel_events == reference_events);
+          REQUIRE(parallel->stats().windows == reference->stats().windows);
+          REQUIRE(parallel->stats().imminent_steps == reference->stats().imminent_steps);
+          for (std::size_t id = 0; id < reference->size(); ++id) {
+            REQUIRE(parallel->get_component(id).t_next() == reference->get_component(id).t_next());
+            REQUIRE(parallel->get_component(id).t_last() == reference->get_component(id).t_last());
+          }
+          for (std::size_t p = 0; p < 8; ++p) {
+            const auto id = p * 51;
+            REQUIRE(parallel->get_simulator<counter>(id).get_sim_state().state
+                        == reference->get_simulator<counter>(id).get_sim_state().state);
+          }
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("Parallel root coordinator advances partitions together in windows", "[COORDINATOR]") {
+  const generator::time_t limit{20'000, true, 20'000, true};
+  for (std::size_t partitions : {2, 4, 8}) {
+    GIVEN(partitions << " uncoupled partitions of generators feeding a counter") {
+      root_t root;
+      for (std::size_t p = 0; p < partitions; ++p) {
+        build_partition(root, p, 10);
+      }
+      root.init(generator::time_t{0, true, 0, true});
+      root.run_until(limit);
+      THEN("every partition runs in the same windows, and ends as a coordinator of its components") {
+        REQUIRE(root.stats().max_active_partitions == partitions);
+        REQUIRE(root.stats().imminent_steps == 0);
+        for (std::size_t p = 0; p < partitions; ++p) {
+          flat_builder flat;
+          build_partition(flat, p, 10);
+          flat.coordinator.init(generator::time_t{0, true, 0, true});
+          flat.coordinator.run_until(limit);
+          for (std::size_t k = 0; k <= 10; ++k) {
+            REQUIRE(root.get_component(p * 11 + k).t_last() == flat.coordinator.get_component(k).t_last());
+            REQUIRE(root.get_component(p * 11 + k).t_next() == flat.coordinator.get_component(k).t_next());
+          }
+        }
+      }
+    }
+    GIVEN(partitions << " partitions each feeding the counter of the next one") {
+      root_t root;
+      build_chain(root, partitions, 10, false);
+      root.init(generator::time_t{0, true, 0, true});
+      root.run_until(limit);
+      THEN("partitions advance together while the previous ones cannot reach them, counting every output") {
+        REQUIRE(root.stats().max_active_partitions > 1);
+        REQUIRE(root.stats().mean_parallelism() > 1.0);
+        require_flat_counts(root, [partitions](auto &builder) { build_chain(builder, partitions, 10, false); }, limit);
+      }
+    }
+  }
+  GIVEN("generators of two partitions imminent together feeding a counter") {
+    root_t root;
+    root.add_partition();
+    root.add_partition();
+    const auto n = root.add_component(0, counter{}, counter_start);
+    root.add_coupling(root.add_component(0, generator{}, elapsed(0)), n);
+    root.add_coupling(root.add_component(1, generator{}, elapsed(3)), n);
+    WHEN("it runs for 20 seconds") {
+      root.init(generator::time_t{0, true, 0, true});
+      root.run_until(limit);
+      THEN("the counter receives every output emitted before the limit") {
+        REQUIRE(root.get_simulator<counter>(n).get_sim_state().state.count == counter::count_t{40, true, 40, true});
+      }
+    }
+  }
+}
@@ -0,0 +1,180 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cadmium/iadevs/basic_models/generator.h>
+#include <cadmium/iadevs/engine/persistent_cache.h>
+#include <cadmium/iadevs/engine/simulator.h>
+#include <cadmium/iadevs/utils/ia_interval_codec.h>
+
+#include <catch.hpp>
+
+#include <filesystem>
+#include <thread>
+#include <vector>
+
+namespace {
+// A fresh database file per scenario, removed afterwards
+struct temporary_database {
+  temporary_database() : path(std::filesystem::temp_directory_path() / "ia_devs_test_persistent_cache.db") {
+    remove();
+  }
+  ~temporary_database() {
+    remove();
+  }
+  void remove() const {
+    for (const char *suffix : {"", "-wal", "-shm"}) {
+      std::filesystem::remove(path.string() + suffix);
+    }
+  }
+  std::filesystem::path path;
+};
+
+std::vector<std::byte> bytes_of(std::initializer_list<int> values) {
+  std::vector<std::byte> bytes;
+  for (int v : values) {
+    bytes.push_back(static_cast<std::byte>(v));
+  }
+  return bytes;
+}
+}
+
+SCENARIO("Persistent cache stores function results", "[CACHE]") {
+  GIVEN("an empty persistent cache") {
+    temporary_database db;
+    const std::string model = "generator";
+    const std::string function = "bounded_time_advance_i";
+    const auto input = bytes_of({1, 2, 3});
+    std::vector<std::byte> result;
+    WHEN("looking up a result") {
+      cadmium::iadevs::engine::persistent_cache cache(db.path.string());
+      THEN("it misses") {
+        REQUIRE_FALSE(cache.find(model, function, input, result));
+        REQUIRE(cache.stats().misses == 1);
+      }
+    }WHEN("many results are inserted and flushed") {
+      cadmium::iadevs::engine::persistent_cache cache(db.path.string(), {.batch_size = 64});
+      for (int i = 0; i < 1000; ++i) {
+        cache.insert(model, function, bytes_of({i % 256, i / 256}), bytes_of({i % 7}));
+      }
+      cache.flush();
+      THEN("they are found, written in batched transactions") {
+        REQUIRE(cache.find(model, function, bytes_of({999 % 256, 999 / 256}), result));
+        REQUIRE(result == bytes_of({999 % 7}));
+        REQUIRE_FALSE(cache.find(model, "output_i", bytes_of({999 % 256, 999 / 256}), result));
+        REQUIRE(cache.stats().writes == 1000);
+        REQUIRE(cache.stats().batches >= 1000 / 64);
+      }
+    }WHEN("a result is inserted and the cache is closed") {
+      {
+        cadmium::iadevs::engine::persistent_cache cache(db.path.string());
+        cache.insert(model, function, input, bytes_of({9}));
+      }
+      THEN("the result is found after reopening") {
+        cadmium::iadevs::engine::persistent_cache cache(db.path.string());
+        REQUIRE(cache.find(model, function, input, result));
+        REQUIRE(result == bytes_of({9}));
+      }
+    }WHEN("the write queue is full") {
+      cadmium::iadevs::engine::persistent_cache cache(db.path.string(), {.max_pending_writes = 0});
+      cache.insert(model, function, input, bytes_of({9}));
+      cache.flush();
+      THEN("writes are dropped instead of waiting") {
+        REQUIRE(cache.stats().dropped_writes == 1);
+        REQUIRE_FALSE(cache.find(model, function, input, result));
+      }
+    }WHEN("another connection holds the write lock") {
+      cadmium::iadevs::engine::persistent_cache cache(db.path.string(), {.busy_timeout_ms = 0});
+      SQLite::Database other(db.path.string(), SQLite::OPEN_READWRITE);
+      other.exec("BEGIN EXCLUSIVE");
+      cache.insert(model, function, input, bytes_of({9}));
+      cache.flush();
+      other.exec("ROLLBACK");
+      THEN("the batch is reported as failed and the writer keeps going") {
+        REQUIRE(cache.stats().failed_writes == 1);
+        REQUIRE_FALSE(cache.stats().last_write_error.empty());
+        cache.insert(model, function, input, bytes_of({9}));
+        cache.flush();
+        REQUIRE(cache.stats().writes == 1);
+        REQUIRE(cache.find(model, function, input, result));
+      }
+    }WHEN("several threads read concurrently") {
+      cadmium::iadevs::engine::persistent_cache cache(db.path.string());
+      for (int i = 0; i < 100; ++i) {
+        cache.insert(model, function, bytes_of({i}), bytes_of({i + 1}));
+      }
+      cache.flush();
+      std::vector<std::thread> threads;
+      std::atomic<int> hits{0};
+      for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&] {
+          std::vector<std::byte> r;
+          for (int i = 0; i < 100; ++i) {
+            if (cache.find(model, function, bytes_of({i}), r) && r == bytes_of({i + 1})) {
+              ++hits;
+            }
+          }
+        });
+      }
+      for (auto &t : threads) {
+        t.join();
+      }
+      THEN("all of them find the results") {
+        REQUIRE(hits == 400);
+      }
+    }
+  }
+}
+
+SCENARIO("Persistently cached models skip computation across runs", "[CACHE]") {
+  GIVEN("a generator decorated with a persistent cache") {
+    using generator = cadmium::iadevs::basic_models::generator;
+    using cached_generator = cadmium::iadevs::engine::persistently_cached<generator, cadmium::iadevs::interval_codec>;
+    temporary_database db;
+    const generator::time_t limit{10000, true, 10000, true};
+    generator::time_t first_t_next{};
+    WHEN("it is simulated in two runs") {
+      {
+        cadmium::iadevs::engine::persistent_cache cache(db.path.string());
+        cadmium::iadevs::engine::simulator<cached_generator> s(cached_generator(cache, "generator"));
+        s.init(generator::state_t{0, true, 0, true}, generator::time_t{0, true, 0, true});
+        s.run_until(limit);
+        first_t_next = s.get_sim_state().t_next;
+      }
+      cadmium::iadevs::engine::persistent_cache cache(db.path.string());
+      cadmium::iadevs::engine::simulator<cached_generator> s(cached_generator(cache, "generator"));
+      s.init(generator::state_t{0, true, 0, true}, generator::time_t{0, true, 0, true});
+      s.run_until(limit);
+      THEN("the second run computes the same results from the cache only") {
+        cadmium::iadevs::engine::simulator<generator> reference{};
+        reference.init(generator::state_t{0, true, 0, true}, generator::time_t{0, true, 0, true});
+        reference.run_until(limit);
+        REQUIRE(first_t_next == reference.get_sim_state().t_next);
+        REQUIRE(s.get_sim_state().t_next == reference.get_sim_state().t_next);
+        REQUIRE(cache.stats().misses == 0);
+        REQUIRE(cache.stats().hits > 0);
+      }
+    }
+  }
+}
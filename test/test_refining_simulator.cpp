@@ -0,0 +1,132 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cadmium/iadevs/basic_models/generator.h>
+#include <cadmium/iadevs/engine/refining_simulator.h>
+
+#include <catch.hpp>
+
+#include <vector>
+
+namespace {
+using generator = cadmium::iadevs::basic_models::generator;
+using refining_t = cadmium::iadevs::engine::refining_simulator<generator>;
+using policy_t = refining_t::policy_t;
+
+const generator::time_t start{0, true, 0, true};
+const generator::time_t limit{10'000, true, 10'000, true};
+
+int width_of(const generator::time_t &t) {
+  int width = 0;
+  REQUIRE(t.try_get_width(width) == cadmium::iadevs::interval_status::ok);
+  return width;
+}
+}
+
+SCENARIO("Refining simulator bounds the width of t_next", "[SIMULATOR]") {
+  GIVEN("a generator refined to t_next no wider than 10 ms") {
+    refining_t refining(policy_t{10, 64});
+    refining.init(generator::just_emitted, start);
+    WHEN("it runs for 10 seconds") {
+      std::vector<generator::time_t> emitted;
+      const auto events = refining.run_until(limit, [&](const generator::time_t &t, const generator::output_t &) {
+        emitted.push_back(t);
+      });
+      THEN("every piece stays narrow, and each event is in the times the unrefined k-th event may happen") {
+        REQUIRE(refining.pieces().size() > 1);
+        REQUIRE(refining.pieces().size() <= 64);
+        for (const auto &p : refining.pieces()) {
+          REQUIRE(width_of(p.get_sim_state().t_next) <= 10);
+        }
+        for (const auto &t : emitted) {
+          const int k = (t.get_upper_endpoint_value() + 1004) / 1005;
+          generator::time_t kth_event{};
+          kth_event.set_bounded(997 * k, true, 1005 * k, true);
+          REQUIRE(kth_event.hull(t) == kth_event);
+        }
+        REQUIRE(emitted.size() == events);
+        REQUIRE(events > 9);
+        REQUIRE(refining.stats().bisections >= refining.pieces().size() - 1);
+        REQUIRE(refining.stats().merges > 0);
+      }
+    }
+    WHEN("the precision needed is relaxed after running") {
+      refining.run_until(generator::time_t{5'000, true, 5'000, true});
+      const auto pieces = refining.pieces().size();
+      refining.set_policy(policy_t{1'000, 64});
+      refining.run_until(generator::time_t{5'000, true, 5'000, true});
+      THEN("pieces are merged back") {
+        REQUIRE(refining.pieces().size() < pieces);
+        REQUIRE(refining.stats().merges > 0);
+      }
+    }
+  }
+  GIVEN("a generator with an uncertain phase, wider than its time advance") {
+    generator::state_t phase{};
+    phase.set_bounded(0, true, 40, true);
+    refining_t refining(policy_t{20, 8});
+    refining.init(phase, start);
+    WHEN("it runs its first event") {
+      refining.run_until(generator::time_t{1'010, true, 1'010, true});
+      THEN("the state is bisected instead of the exact initial time") {
+        REQUIRE(refining.stats().bisections > 0);
+        for (const auto &p : refining.pieces()) {
+          REQUIRE(p.get_sim_state().t_last.hull(generator::time_t{957, true, 1005, true})
+                      == generator::time_t{957, true, 1005, true});
+        }
+        REQUIRE(refining.pieces().size() <= 8);
+      }
+    }
+  }
+  GIVEN("a policy allowing no pieces") {
+    THEN("it is rejected") {
+      REQUIRE_THROWS_AS(refining_t(policy_t{10, 0}), std::invalid_argument);
+    }
+  }
+}
+
+SCENARIO("Refining simulator results do not depend on the threads", "[SIMULATOR]") {
+  GIVEN("the same refined generator simulated serially and on a pool") {
+    cadmium::iadevs::engine::thread_pool pool(4);
+    refining_t serial(policy_t{4, 32});
+    refining_t parallel(policy_t{4, 32});
+    parallel.set_thread_pool(&pool);
+    serial.init(generator::just_emitted, start);
+    parallel.init(generator::just_emitted, start);
+    WHEN("both run for 10 seconds") {
+      std::vector<generator::time_t> serial_trace;
+      std::vector<generator::time_t> parallel_trace;
+      serial.run_until(limit, [&](const generator::time_t &t, const generator::output_t &) { serial_trace.push_back(t); });
+      parallel.run_until(limit, [&](const generator::time_t &t, const generator::output_t &) { parallel_trace.push_back(t); });
+      THEN("pieces and outputs are the same, in the same order") {
+        REQUIRE(parallel_trace == serial_trace);
+        REQUIRE(parallel.pieces().size() == serial.pieces().size());
+        for (std::size_t k = 0; k < serial.pieces().size(); ++k) {
+          REQUIRE(parallel.pieces()[k].get_sim_state() == serial.pieces()[k].get_sim_state());
+        }
+      }
+    }
+  }
+}
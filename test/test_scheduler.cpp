@@ -0,0 +1,143 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cadmium/iadevs/engine/scheduler.h>
+
+#include <catch.hpp>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace {
+using sim_time_t = cadmium::iadevs::interval<int>;
+using scheduler_t = cadmium::iadevs::engine::scheduler<sim_time_t>;
+
+// Reference imminent set, a component is imminent if no other is certainly before it
+std::vector<scheduler_t::id_t> linear_imminent(const std::vector<sim_time_t> &t_next) {
+  std::vector<scheduler_t::id_t> ids;
+  for (std::size_t i = 0; i < t_next.size(); ++i) {
+    if (t_next[i].is_empty()) {
+      continue;
+    }
+    if (std::none_of(t_next.begin(), t_next.end(), [&](const sim_time_t &t) { return t.certainly_before(t_next[i]); })) {
+      ids.push_back(i);
+    }
+  }
+  return ids;
+}
+
+std::vector<scheduler_t::id_t> sorted_imminent(const scheduler_t &s) {
+  std::vector<scheduler_t::id_t> ids;
+  s.imminent(ids);
+  std::sort(ids.begin(), ids.end());
+  return ids;
+}
+
+sim_time_t random_time(std::mt19937 &random) {
+  std::uniform_int_distribution<int> value(0, 50);
+  std::uniform_int_distribution<int> shape(0, 9);
+  sim_time_t t{};
+  const int lower = value(random);
+  const int upper = lower + value(random) / 5;
+  switch (shape(random)) {
+    case 0:
+      t.set_right_unbounded_with_lower_endpoint_value(lower, true);
+      break;
+    case 1:
+      t.set_left_unbounded_with_upper_endpoint_value(upper + 20, true);
+      break;
+    case 2:
+      break;
+    default:
+      t.set_bounded(lower, lower == upper || shape(random) < 5, upper, lower == upper || shape(random) < 5);
+  }
+  return t;
+}
+}
+
+SCENARIO("Scheduler imminent set", "[SCHEDULER]") {
+  GIVEN("a scheduler with components at [3, 5], [4, 8], (5, 6] and [9, 10]") {
+    scheduler_t s;
+    s.schedule(0, sim_time_t{3, true, 5, true});
+    s.schedule(1, sim_time_t{4, true, 8, true});
+    sim_time_t open_end{};
+    open_end.set_bounded(5, false, 6, true);
+    s.schedule(2, open_end);
+    s.schedule(3, sim_time_t{9, true, 10, true});
+    THEN("the components overlapping the earliest one are imminent") {
+      REQUIRE(s.size() == 4);
+      REQUIRE(sorted_imminent(s) == std::vector<scheduler_t::id_t>{0, 1});
+      REQUIRE(s.t_next() == sim_time_t{3, true, 5, true});
+    }WHEN("the earliest component is rescheduled later") {
+      s.schedule(0, sim_time_t{20, true, 30, true});
+      THEN("the imminent set moves to the next earliest components") {
+        REQUIRE(sorted_imminent(s) == std::vector<scheduler_t::id_t>{1, 2});
+        REQUIRE(s.t_next() == sim_time_t{4, true, 6, true});
+      }
+    }WHEN("components are removed or become passive") {
+      s.remove(0);
+      s.schedule(1, sim_time_t{});
+      THEN("they are no longer scheduled") {
+        REQUIRE(s.size() == 2);
+        REQUIRE_FALSE(s.contains(0));
+        REQUIRE_FALSE(s.contains(1));
+        REQUIRE(sorted_imminent(s) == std::vector<scheduler_t::id_t>{2});
+      }
+    }
+  }GIVEN("an empty scheduler") {
+    scheduler_t s;
+    THEN("there is no imminent component and no next time") {
+      REQUIRE(sorted_imminent(s).empty());
+      REQUIRE(s.t_next().is_empty());
+    }
+  }
+}
+
+SCENARIO("Scheduler matches a linear scan", "[SCHEDULER]") {
+  GIVEN("a thousand components rescheduled at random") {
+    std::mt19937 random(42);
+    std::uniform_int_distribution<std::size_t> component(0, 999);
+    std::vector<sim_time_t> t_next(1000);
+    scheduler_t s;
+    s.reserve(t_next.size());
+    THEN("the imminent set and the next time match a linear scan after each change") {
+      for (int change = 0; change < 5000; ++change) {
+        const auto id = component(random);
+        t_next[id] = random_time(random);
+        s.schedule(id, t_next[id]);
+        if (change % 50 == 0) {
+          const auto expected = linear_imminent(t_next);
+          REQUIRE(sorted_imminent(s) == expected);
+          sim_time_t hull{};
+          for (auto i : expected) {
+            hull = hull.hull(t_next[i]);
+          }
+          REQUIRE(s.t_next().intersect(hull) == s.t_next());
+        }
+      }
+    }
+  }
+}
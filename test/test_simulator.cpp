@@ -23,11 +23,92 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <cadmium/iadevs/basic_models/counter.h>
 #include <cadmium/iadevs/basic_models/generator.h>
 #include <cadmium/iadevs/engine/simulator.h>
 
 #include <catch.hpp>
 
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+// Counts every heap allocation in the process, to check the simulator stepping allocates nothing
+std::atomic<std::size_t> allocations{0};
+}
+
+namespace {
+void *counted_allocate(std::size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void *p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void *counted_allocate(std::size_t size, std::align_val_t alignment) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  const auto align = static_cast<std::size_t>(alignment);
+  // aligned_alloc requires a non-zero size multiple of the alignment
+  const std::size_t rounded = size == 0 ? align : (size + align - 1) / align * align;
+  if (void *p = std::aligned_alloc(align, rounded)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+}
+
+// Every form is replaced, so each allocation is released by the matching deallocation function
+void *operator new(std::size_t size) {
+  return counted_allocate(size);
+}
+
+void *operator new[](std::size_t size) {
+  return counted_allocate(size);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment) {
+  return counted_allocate(size, alignment);
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment) {
+  return counted_allocate(size, alignment);
+}
+
+void operator delete(void *p) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void *p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept {
+  std::free(p);
+}
+
+void operator delete(void *p, std::align_val_t) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void *p, std::align_val_t) noexcept {
+  std::free(p);
+}
+
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept {
+  std::free(p);
+}
+
 SCENARIO("Generator is simulated", "[SIMULATOR]") {
   GIVEN("A simulator for a generator model") {
     WARN("Current test assumes time is in milliseconds, units are not yet implemented");
@@ -47,4 +128,93 @@ SCENARIO("Generator is simulated", "[SIMULATOR]") {
       }
     }
   }
-}
\ No newline at end of file
+}
+
+SCENARIO("Generator init is a constant expression", "[SIMULATOR]") {
+  GIVEN("A simulator for a generator model") {
+    using generator = cadmium::iadevs::basic_models::generator;
+    WHEN("init is called with constant [0,0] initial S and [0, 0] initial T") {
+      constexpr generator::time_t t{0, true, 0, true};
+      constexpr generator::state_t s{0, true, 0, true};
+      THEN("t_next [997, 1005] is computed at compile time") {
+        STATIC_REQUIRE(cadmium::iadevs::engine::simulator<generator>{}.init(s, t).t_next
+                           == generator::time_t{997, true, 1005, true});
+      }
+    }
+  }
+}
+
+SCENARIO("Generator is simulated through internal events", "[SIMULATOR]") {
+  GIVEN("A simulator for a generator model initialized at [0, 0]") {
+    using generator = cadmium::iadevs::basic_models::generator;
+    cadmium::iadevs::engine::simulator<generator> sg{};
+    sg.init(generator::state_t{0, true, 0, true}, generator::time_t{0, true, 0, true});
+    WHEN("step is called") {
+      const auto &o = sg.step();
+      THEN("[1, 2] is emitted, t_last is [997, 1005] and t_next is [1994, 2010]") {
+        REQUIRE(o == generator::output_values);
+        REQUIRE(sg.get_sim_state().state == generator::just_emitted);
+        REQUIRE(sg.get_sim_state().t_last == generator::time_t{997, true, 1005, true});
+        REQUIRE(sg.get_sim_state().t_next == generator::time_t{1994, true, 2010, true});
+      }
+    }WHEN("run_until is called with [5000, 5000]") {
+      auto events = sg.run_until(generator::time_t{5000, true, 5000, true});
+      THEN("only the 4 events certainly before 5000 are executed") {
+        REQUIRE(events == 4);
+        REQUIRE(sg.get_sim_state().t_last == generator::time_t{3988, true, 4020, true});
+        REQUIRE(sg.get_sim_state().t_next == generator::time_t{4985, true, 5025, true});
+      }
+    }
+  }
+}
+
+SCENARIO("Counter is simulated through external and confluent events", "[SIMULATOR]") {
+  GIVEN("A simulator for a counter model initialized at [0, 0]") {
+    using counter = cadmium::iadevs::basic_models::counter;
+    cadmium::iadevs::engine::simulator<counter> sc{};
+    sc.init(counter::state_t{counter::count_t{0, true, 0, true}, counter::no_time}, counter::no_time);
+    std::array<counter::input_t, 1> inputs{counter::input_t{1, true, 2, true}};
+    WHEN("an input is received at [400, 400]") {
+      sc.external_transition(counter::time_t{400, true, 400, true}, inputs);
+      THEN("it is counted and the report is still scheduled at [1000, 1000]") {
+        REQUIRE(sc.get_sim_state().state.count == counter::count_t{1, true, 1, true});
+        REQUIRE(sc.get_sim_state().t_last == counter::time_t{400, true, 400, true});
+        REQUIRE(sc.get_sim_state().t_next == counter::time_t{1000, true, 1000, true});
+      } AND_WHEN("another input is received at the report time") {
+        REQUIRE(sc.output() == counter::count_t{1, true, 1, true});
+        sc.confluent_transition(inputs);
+        THEN("it is counted after reporting and the next report is at [2000, 2000]") {
+          REQUIRE(sc.get_sim_state().state.count == counter::count_t{2, true, 2, true});
+          REQUIRE(sc.get_sim_state().t_last == counter::time_t{1000, true, 1000, true});
+          REQUIRE(sc.get_sim_state().t_next == counter::time_t{2000, true, 2000, true});
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("Simulators step without allocating", "[SIMULATOR]") {
+  GIVEN("Initialized simulators for a generator and a counter") {
+    using generator = cadmium::iadevs::basic_models::generator;
+    using counter = cadmium::iadevs::basic_models::counter;
+    cadmium::iadevs::engine::simulator<generator> sg{};
+    cadmium::iadevs::engine::simulator<counter> sc{};
+    sg.init(generator::state_t{0, true, 0, true}, generator::time_t{0, true, 0, true});
+    sc.init(counter::state_t{counter::count_t{0, true, 0, true}, counter::no_time}, counter::no_time);
+    std::array<counter::input_t, 1> inputs{counter::input_t{1, true, 2, true}};
+    WHEN("many events are simulated") {
+      const auto before = allocations.load();
+      std::size_t events = sg.run_until(generator::time_t{1000000, true, 1000000, true});
+      for (int i = 0; i < 1000; ++i) {
+        sc.output();
+        sc.confluent_transition(inputs);
+        ++events;
+      }
+      const auto after = allocations.load();
+      THEN("no heap allocation happened") {
+        REQUIRE(events > 1000);
+        REQUIRE(after == before);
+      }
+    }
+  }
+}
@@ -0,0 +1,206 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <cadmium/iadevs/basic_models/generator.h>
+#include <cadmium/iadevs/concepts.h>
+#include <cadmium/iadevs/engine/batch_functions.h>
+#include <cadmium/iadevs/engine/simulator.h>
+#include <cadmium/iadevs/engine/simulator_pool.h>
+
+#include <catch.hpp>
+
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+using generator = cadmium::iadevs::basic_models::generator;
+
+/**
+ * A generator declaring batch versions of its functions, counting the states they receive
+ */
+struct batch_generator : generator {
+  using generator::bounded_time_advance_i;
+  using generator::internal_transition_i;
+  using generator::output_i;
+
+  std::size_t *batched_states = nullptr;
+
+  void bounded_time_advance_i(std::span<const state_t> states, std::span<time_t> advances) const {
+    *batched_states += states.size();
+    for (std::size_t k = 0; k < states.size(); ++k) {
+      advances[k] = output_period - states[k];
+    }
+  }
+
+  void internal_transition_i(std::span<const state_t> states, std::span<state_t> next_states) const {
+    *batched_states += states.size();
+    for (auto &s : next_states) {
+      s = just_emitted;
+    }
+  }
+
+  void output_i(std::span<const state_t> states, std::span<output_t> outputs) const {
+    *batched_states += states.size();
+    for (auto &o : outputs) {
+      o = output_values;
+    }
+  }
+};
+
+// Generators that emitted between 0 and 99 ms before the start
+generator::state_t phase_of(std::size_t id) {
+  generator::state_t s{};
+  const int elapsed = static_cast<int>(id % 100);
+  s.set_bounded(elapsed, true, elapsed, true);
+  return s;
+}
+}
+
+SCENARIO("Simulator pool matches a simulator per instance", "[SIMULATOR_POOL]") {
+  GIVEN("a pool and separate simulators of a thousand generators with different phases") {
+    constexpr std::size_t instances = 1000;
+    const generator::time_t start{0, true, 0, true};
+    cadmium::iadevs::engine::simulator_pool<generator> pool;
+    pool.reserve(instances);
+    std::vector<cadmium::iadevs::engine::simulator<generator>> simulators(instances);
+    for (std::size_t id = 0; id < instances; ++id) {
+      REQUIRE(pool.add(phase_of(id), start) == id);
+      simulators[id].init(phase_of(id), start);
+    }
+    THEN("they start in the same state") {
+      REQUIRE(pool.size() == instances);
+      REQUIRE(pool.get_sim_state(7) == simulators[7].get_sim_state());
+    }WHEN("both run until 10 seconds") {
+      const generator::time_t until{10'000, true, 10'000, true};
+      std::size_t outputs = 0;
+      bool outputs_valid = true;
+      const auto events = pool.run_until(until, [&](std::size_t id, const generator::time_t &t,
+                                                    const generator::output_t &o) {
+        outputs_valid = outputs_valid && id < instances && t.get_upper_endpoint_value() <= 10'000
+            && o == generator::output_values;
+        ++outputs;
+      });
+      std::size_t simulator_events = 0;
+      for (auto &s : simulators) {
+        simulator_events += s.run_until(until);
+      }
+      THEN("every instance executes the same events as its simulator") {
+        REQUIRE(events == simulator_events);
+        REQUIRE(outputs == events);
+        REQUIRE(outputs_valid);
+        for (std::size_t id = 0; id < instances; ++id) {
+          REQUIRE(pool.get_sim_state(id) == simulators[id].get_sim_state());
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("Simulator pool calls the batch functions of the model", "[SIMULATOR_POOL]") {
+  GIVEN("a pool of generators declaring batch functions, half of them started later") {
+    std::size_t batched_states = 0;
+    batch_generator model{};
+    model.batched_states = &batched_states;
+    cadmium::iadevs::engine::simulator_pool<batch_generator> pool(model);
+    for (std::size_t id = 0; id < 10; ++id) {
+      generator::time_t start{};
+      start.set_bounded(id < 5 ? 0 : 5000, true, id < 5 ? 0 : 5000, true);
+      pool.add(generator::just_emitted, start);
+    }
+    WHEN("it runs until the first event of the later half") {
+      const auto events = pool.run_until(generator::time_t{5000, true, 5000, true});
+      THEN("only the due instances are passed to the batch output, transition and time advance") {
+        REQUIRE(events == 5 * 4);
+        REQUIRE(batched_states == 3 * events);
+        REQUIRE(pool.get_sim_state(0).t_next == generator::time_t{4985, true, 5025, true});
+        REQUIRE(pool.get_sim_state(9).t_next == generator::time_t{5997, true, 6005, true});
+      }
+    }
+  }
+}
+
+SCENARIO("Batch functions are detected by concept", "[SIMULATOR_POOL]") {
+  GIVEN("a model with batch functions and one without") {
+    THEN("only the batch versions declared are detected") {
+      STATIC_REQUIRE(cadmium::iadevs::has_batch_time_advance<batch_generator>);
+      STATIC_REQUIRE(cadmium::iadevs::has_batch_internal_transition<batch_generator>);
+      STATIC_REQUIRE(cadmium::iadevs::has_batch_output<batch_generator>);
+      STATIC_REQUIRE_FALSE(cadmium::iadevs::has_batch_time_advance<generator>);
+      STATIC_REQUIRE_FALSE(cadmium::iadevs::has_batch_output<generator>);
+    }WHEN("the time advance of many states is computed for both") {
+      std::size_t batched_states = 0;
+      batch_generator batched{};
+      batched.batched_states = &batched_states;
+      std::vector<generator::state_t> states(8, generator::just_emitted);
+      std::vector<generator::time_t> scalar(8), batch(8);
+      cadmium::iadevs::engine::batch_time_advance(generator{}, std::span<const generator::state_t>(states),
+                                                  std::span<generator::time_t>(scalar));
+      cadmium::iadevs::engine::batch_time_advance(batched, std::span<const generator::state_t>(states),
+                                                  std::span<generator::time_t>(batch));
+      THEN("the batch version is called once and both match") {
+        REQUIRE(batched_states == 8);
+        REQUIRE(batch == scalar);
+        REQUIRE(scalar.front() == generator::output_period);
+      }
+    }WHEN("the output span has a different size") {
+      std::vector<generator::state_t> states(2, generator::just_emitted);
+      std::vector<generator::output_t> outputs(1);
+      THEN("it is refused") {
+        REQUIRE_THROWS_AS(cadmium::iadevs::engine::batch_output(generator{},
+                                                                std::span<const generator::state_t>(states),
+                                                                std::span<generator::output_t>(outputs)),
+                          std::invalid_argument);
+      }
+    }
+  }
+}
+
+SCENARIO("Simulator pool adds instances in a batch", "[SIMULATOR_POOL]") {
+  GIVEN("a pool of generators declaring batch functions") {
+    std::size_t batched_states = 0;
+    batch_generator model{};
+    model.batched_states = &batched_states;
+    cadmium::iadevs::engine::simulator_pool<batch_generator> pool(model);
+    pool.add(generator::just_emitted, generator::time_t{0, true, 0, true});
+    WHEN("a hundred instances are added at once") {
+      std::vector<generator::state_t> states;
+      for (std::size_t id = 0; id < 100; ++id) {
+        states.push_back(phase_of(id));
+      }
+      const auto first = pool.add(std::span<const generator::state_t>(states), generator::time_t{0, true, 0, true});
+      THEN("their time advances are computed in a single batch, as adding them one by one") {
+        REQUIRE(first == 1);
+        REQUIRE(pool.size() == 101);
+        REQUIRE(batched_states == 100);
+        cadmium::iadevs::engine::simulator<generator> s;
+        s.init(phase_of(42), generator::time_t{0, true, 0, true});
+        REQUIRE(pool.get_sim_state(first + 42) == s.get_sim_state());
+      }
+    }
+  }
+}
@@ -0,0 +1,148 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <cadmium/iadevs/basic_models/counter.h>
+#include <cadmium/iadevs/basic_models/generator.h>
+#include <cadmium/iadevs/engine/coordinator.h>
+#include <cadmium/iadevs/engine/static_coordinator.h>
+
+#include <catch.hpp>
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace {
+using generator = cadmium::iadevs::basic_models::generator;
+using counter = cadmium::iadevs::basic_models::counter;
+using ia_time_t = generator::time_t;
+using coordinator_t = cadmium::iadevs::engine::coordinator<ia_time_t, cadmium::iadevs::interval<int>>;
+using cadmium::iadevs::engine::component_list;
+using cadmium::iadevs::engine::coupling_list;
+using cadmium::iadevs::engine::input_coupling;
+using cadmium::iadevs::engine::internal_coupling;
+using cadmium::iadevs::engine::output_coupling;
+using cadmium::iadevs::engine::static_coordinator;
+using cadmium::iadevs::engine::static_coupled;
+
+const counter::state_t counter_start{counter::no_time, counter::no_time};
+
+// Adds one to both endpoints of the values
+struct add_one {
+  cadmium::iadevs::interval<int> operator()(const cadmium::iadevs::interval<int> &value) const {
+    return value + cadmium::iadevs::interval<int>{1, true, 1, true};
+  }
+};
+
+// Keeps the upper endpoint of the values only
+struct upper_value {
+  int operator()(const cadmium::iadevs::interval<int> &value) const {
+    return value.packed_upper_value();
+  }
+};
+
+// A generator reporting to a counter, reporting its count out of the model
+using station = static_coupled<component_list<generator, counter>,
+                               coupling_list<internal_coupling<0, 1>, output_coupling<1>, output_coupling<0, add_one>>>;
+
+// Two stations whose counts and outputs are counted by a third counter
+using network = static_coupled<component_list<station, station, counter>,
+                               coupling_list<internal_coupling<0, 2>, internal_coupling<1, 2>,
+                                             input_coupling<2>, output_coupling<0, upper_value>>>;
+}
+
+SCENARIO("Static coordinator of a generator coupled to a counter", "[STATIC_COORDINATOR]") {
+  GIVEN("the same model in a static and a dynamic coordinator") {
+    static_coordinator<static_coupled<component_list<generator, counter>, coupling_list<internal_coupling<0, 1>>>> s;
+    s.init(ia_time_t{0, true, 0, true}, generator::just_emitted, counter_start);
+    coordinator_t c;
+    const auto g = c.add_component(generator{}, generator::just_emitted);
+    const auto n = c.add_component(counter{}, counter_start);
+    c.add_coupling(g, n);
+    c.init(ia_time_t{0, true, 0, true});
+    THEN("both schedule the same next event") {
+      REQUIRE(s.t_next() == c.t_next());
+      REQUIRE(s.t_next() == ia_time_t{997, true, 1000, true});
+    }WHEN("both run for ten seconds") {
+      const auto events = s.run_until(ia_time_t{10000, true, 10000, true});
+      REQUIRE(events == c.run_until(ia_time_t{10000, true, 10000, true}));
+      THEN("every atomic model reaches the same state and times") {
+        REQUIRE(s.get_simulator<0>().get_sim_state() == c.get_simulator<generator>(g).get_sim_state());
+        REQUIRE(s.get_simulator<1>().get_sim_state() == c.get_simulator<counter>(n).get_sim_state());
+        REQUIRE(s.t_next() == c.t_next());
+      }
+    }
+  }
+}
+
+SCENARIO("Static coordinator flattening nested coupled models", "[STATIC_COORDINATOR]") {
+  GIVEN("two nested stations counted by a counter, and the flat dynamic equivalent") {
+    static_coordinator<network> s;
+    s.init(ia_time_t{0, true, 0, true}, generator::just_emitted, counter_start, generator::state_t{100, true, 100, true},
+           counter_start, counter_start);
+    coordinator_t c;
+    const auto g0 = c.add_component(generator{}, generator::just_emitted);
+    const auto n0 = c.add_component(counter{}, counter_start);
+    const auto g1 = c.add_component(generator{}, generator::state_t{100, true, 100, true});
+    const auto n1 = c.add_component(counter{}, counter_start);
+    const auto total = c.add_component(counter{}, counter_start);
+    c.add_coupling(g0, n0);
+    c.add_coupling(g1, n1);
+    for (auto from : {g0, n0, g1, n1}) {
+      c.add_coupling(from, total);
+    }
+    c.add_output_coupling(g0);
+    c.add_output_coupling(n0);
+    c.init(ia_time_t{0, true, 0, true});
+    THEN("the atomic models are flattened in depth first order with their couplings") {
+      STATIC_REQUIRE(static_coordinator<network>::size == 5);
+      STATIC_REQUIRE(std::is_same_v<static_coordinator<network>::model_at<3>, counter>);
+    }WHEN("both run for ten seconds, collecting the outputs of the root") {
+      std::vector<std::size_t> from;
+      std::vector<int> values;
+      const auto events = s.run_until(ia_time_t{10000, true, 10000, true}, [&](auto index, const ia_time_t &, auto value) {
+        from.push_back(index);
+        STATIC_REQUIRE(std::is_same_v<decltype(value), int>);
+        values.push_back(value);
+      });
+      REQUIRE(events == c.run_until(ia_time_t{10000, true, 10000, true}));
+      THEN("every atomic model reaches the same state as in the flat model") {
+        REQUIRE(s.get_simulator<0>().get_sim_state() == c.get_simulator<generator>(g0).get_sim_state());
+        REQUIRE(s.get_simulator<1>().get_sim_state() == c.get_simulator<counter>(n0).get_sim_state());
+        REQUIRE(s.get_simulator<2>().get_sim_state() == c.get_simulator<generator>(g1).get_sim_state());
+        REQUIRE(s.get_simulator<3>().get_sim_state() == c.get_simulator<counter>(n1).get_sim_state());
+        REQUIRE(s.get_simulator<4>().get_sim_state() == c.get_simulator<counter>(total).get_sim_state());
+      }THEN("the root outputs come from the first station, translated by every coupling on the way") {
+        REQUIRE(from.size() == c.outputs().size());
+        for (std::size_t k = 0; k < from.size(); ++k) {
+          REQUIRE(from[k] == c.outputs()[k].from);
+          const int expected = c.outputs()[k].value.packed_upper_value() + (from[k] == g0 ? 1 : 0);
+          REQUIRE(values[k] == expected);
+        }
+      }
+    }
+  }
+}
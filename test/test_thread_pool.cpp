@@ -0,0 +1,87 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cadmium/iadevs/engine/thread_pool.h>
+
+#include <catch.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+SCENARIO("Thread pool parallel loops", "[THREAD_POOL]") {
+  GIVEN("a pool of four threads") {
+    cadmium::iadevs::engine::thread_pool pool(4);
+    REQUIRE(pool.size() == 4);
+    WHEN("running a loop over ten thousand indexes many times") {
+      std::vector<std::atomic<int>> visits(10'000);
+      for (int run = 0; run < 100; ++run) {
+        pool.parallel_for(visits.size(), [&](std::size_t index) { ++visits[index]; });
+      }
+      THEN("every index is visited once per loop") {
+        for (const auto &v : visits) {
+          REQUIRE(v == 100);
+        }
+      }
+    }WHEN("the loop body costs are uneven") {
+      std::atomic<long> total{0};
+      pool.parallel_for(64, [&](std::size_t index) {
+        if (index < 4) {
+          std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        total += static_cast<long>(index);
+      });
+      THEN("all the work is done before returning") {
+        REQUIRE(total == 64 * 63 / 2);
+      }
+    }WHEN("the loop body throws") {
+      std::atomic<int> visited{0};
+      auto loop = [&] {
+        pool.parallel_for(1000, [&](std::size_t index) {
+          ++visited;
+          if (index == 500) {
+            throw std::runtime_error("failure");
+          }
+        });
+      };
+      THEN("the exception reaches the caller after the loop, and the pool keeps working") {
+        REQUIRE_THROWS_AS(loop(), std::runtime_error);
+        std::atomic<int> after{0};
+        pool.parallel_for(100, [&](std::size_t) { ++after; });
+        REQUIRE(after == 100);
+      }
+    }
+  }GIVEN("a pool of a single thread") {
+    cadmium::iadevs::engine::thread_pool pool(1);
+    THEN("loops run on the calling thread") {
+      const auto caller = std::this_thread::get_id();
+      bool same_thread = true;
+      pool.parallel_for(100, [&](std::size_t) { same_thread = same_thread && std::this_thread::get_id() == caller; });
+      REQUIRE(same_thread);
+    }
+  }
+}
@@ -0,0 +1,166 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cadmium/iadevs/engine/simulator.h>
+#include <cadmium/iadevs/utils/ia_time.h>
+
+#include <catch.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace {
+using namespace cadmium::iadevs;
+using ms = sim_time<std::milli>;
+using seconds = sim_time<std::ratio<1>>;
+
+time_interval<std::milli> ms_interval(std::int64_t lower, bool lower_closed, std::int64_t upper, bool upper_closed) {
+  time_interval<std::milli> i{};
+  i.set_bounded(ms{lower}, lower_closed, ms{upper}, upper_closed);
+  return i;
+}
+
+// Emits every minute, with a few milliseconds of uncertainty, keeping time in 64 bits milliseconds
+struct minute_ticker {
+  using state_t = time_interval<std::milli>;
+  using time_t = time_interval<std::milli>;
+  using output_t = interval<int>;
+  static constexpr time_t period{ms{59'997}, true, ms{60'005}, true};
+  static constexpr state_t just_emitted{ms{0}, true, ms{0}, true};
+
+  constexpr time_t bounded_time_advance_i(const state_t &state) const {
+    return period - state;
+  }
+  constexpr state_t internal_transition_i(const state_t &) const {
+    return just_emitted;
+  }
+  constexpr output_t output_i(const state_t &) const {
+    return output_t{1, true, 1, true};
+  }
+  constexpr time_t time_bound_add(const time_t &t1, const time_t &t2) const {
+    return t1 + t2;
+  }
+};
+}
+
+SCENARIO("Simulation time with units", "[TIME]") {
+  GIVEN("times in seconds and milliseconds") {
+    constexpr seconds two_seconds{2};
+    THEN("lossless conversions are implicit and computed at compile time") {
+      constexpr ms converted = two_seconds;
+      STATIC_REQUIRE(converted.count() == 2000);
+      STATIC_REQUIRE(ms{5} + two_seconds == ms{2005});
+      STATIC_REQUIRE(ms{std::chrono::milliseconds{7}}.to_duration() == std::chrono::milliseconds{7});
+    } AND_THEN("lossy conversions round in the requested direction") {
+      REQUIRE(time_floor<std::ratio<1>>(ms{2500}) == seconds{2});
+      REQUIRE(time_ceil<std::ratio<1>>(ms{2500}) == seconds{3});
+      REQUIRE(time_floor<std::ratio<1>>(ms{-2500}) == seconds{-3});
+      REQUIRE(time_ceil<std::ratio<1>>(ms{-2500}) == seconds{-2});
+      REQUIRE(time_ceil<std::ratio<1>>(ms{3000}) == seconds{3});
+    }
+  }
+  GIVEN("the largest finite time") {
+    const ms max = ms::max();
+    THEN("sums beyond it saturate to infinity instead of wrapping around") {
+      REQUIRE((max + ms{1}) == ms::infinity());
+      REQUIRE_FALSE((max + ms{1}).is_finite());
+      REQUIRE((-max - ms{1}) == -ms::infinity());
+      REQUIRE((max - ms{1}).is_finite());
+      REQUIRE(ms::infinity() + ms{-5} == ms::infinity());
+      REQUIRE(ms{std::numeric_limits<std::int64_t>::min()} == -ms::infinity());
+    } AND_THEN("negative sums reaching the lowest count saturate to negative infinity") {
+      const auto sum = -max + ms{-2};
+      REQUIRE(sum == -ms::infinity());
+      REQUIRE_FALSE(sum.is_finite());
+      REQUIRE(-sum == ms::infinity());
+      REQUIRE(ms::add_finite(-max, ms{-2}) == -ms::infinity());
+      REQUIRE(ms::add_finite(-max, ms{-1}) == -ms::infinity());
+      REQUIRE(ms::add_finite(-max, ms{1}).is_finite());
+    } AND_THEN("conversions to a finer unit overflowing are infinite") {
+      const sim_time<std::nano> converted = seconds{std::numeric_limits<std::int64_t>::max() / 10};
+      REQUIRE(converted == sim_time<std::nano>::infinity());
+    }
+  }
+}
+
+SCENARIO("Intervals of simulation time", "[TIME]") {
+  GIVEN("an interval ending close to the largest finite time") {
+    const auto i = ms_interval(0, true, ms::max().count() - 10, true);
+    THEN("adding past the end makes the upper endpoint infinite") {
+      const auto sum = i + ms_interval(5, true, 20, false);
+      REQUIRE(sum.get_lower_endpoint_value() == ms{5});
+      REQUIRE(sum.is_right_unbounded());
+      REQUIRE_FALSE(sum.is_upper_endpoint_closed());
+      const auto difference = -sum - sum;
+      REQUIRE(difference.is_left_unbounded());
+    }
+  }
+  GIVEN("the interval (2500, 4000) in milliseconds") {
+    const auto i = ms_interval(2500, false, 4000, false);
+    THEN("converting it to seconds rounds outwards, closing the rounded endpoints") {
+      time_interval<std::ratio<1>> expected{};
+      expected.set_bounded(seconds{2}, true, seconds{4}, false);
+      REQUIRE(interval_cast<std::ratio<1>>(i) == expected);
+    } AND_THEN("converting it to microseconds is exact") {
+      time_interval<std::micro> expected{};
+      expected.set_bounded(sim_time<std::micro>{2'500'000}, false, sim_time<std::micro>{4'000'000}, false);
+      REQUIRE(interval_cast<std::micro>(i) == expected);
+    }
+  }
+  GIVEN("an interval of time encoded for the cache") {
+    const auto i = ms_interval(-3, false, 1'000'000'000'000, true);
+    THEN("it decodes back to the same interval and prints its tick counts") {
+      std::vector<std::byte> bytes;
+      interval_codec::encode(i, bytes);
+      REQUIRE(bytes.size() == interval_codec::encoded_size<ms>);
+      time_interval<std::milli> decoded{};
+      REQUIRE(interval_codec::decode(bytes, decoded));
+      REQUIRE(decoded == i);
+      REQUIRE(std::hash<time_interval<std::milli>>{}(decoded) == std::hash<time_interval<std::milli>>{}(i));
+      REQUIRE(interval_codec::to_debug_string(i) == "(-3, 1000000000000]");
+    }
+  }
+}
+
+SCENARIO("Year-long simulation in milliseconds", "[TIME]") {
+  GIVEN("a ticker emitting every minute, initialized at 0") {
+    cadmium::iadevs::engine::simulator<minute_ticker> simulator{};
+    simulator.init(minute_ticker::just_emitted, minute_ticker::just_emitted);
+    WHEN("it runs for a year") {
+      constexpr std::int64_t year = 365LL * 24 * 60 * 60 * 1000;
+      const auto events = simulator.run_until(ms_interval(year, true, year, true));
+      THEN("times go past the int range without wrapping around") {
+        const auto &t_last = simulator.get_sim_state().t_last;
+        const auto k = static_cast<std::int64_t>(events);
+        REQUIRE(t_last.get_upper_endpoint_value().count() > std::numeric_limits<std::int32_t>::max());
+        REQUIRE(t_last == ms_interval(k * 59'997, true, k * 60'005, true));
+        REQUIRE(t_last.get_upper_endpoint_value() <= ms{year});
+        REQUIRE(ms{year} < simulator.get_sim_state().t_next.get_upper_endpoint_value());
+      }
+    }
+  }
+}
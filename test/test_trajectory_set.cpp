@@ -0,0 +1,139 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cadmium/iadevs/basic_models/counter.h>
+#include <cadmium/iadevs/basic_models/generator.h>
+#include <cadmium/iadevs/engine/trajectory_set.h>
+
+#include <catch.hpp>
+
+namespace {
+using generator = cadmium::iadevs::basic_models::generator;
+using counter = cadmium::iadevs::basic_models::counter;
+using message_t = cadmium::iadevs::interval<int>;
+using set_t = cadmium::iadevs::engine::trajectory_set<generator::time_t, message_t, generator, counter>;
+
+const counter::state_t counter_start{counter::no_time, counter::no_time};
+const generator::time_t start{0, true, 0, true};
+
+generator::state_t elapsed(int ms) {
+  generator::state_t s{};
+  s.set_bounded(ms, true, ms, true);
+  return s;
+}
+}
+
+SCENARIO("Trajectory set follows every order of overlapping events", "[TRAJECTORIES]") {
+  GIVEN("two uncoupled generators starting together") {
+    set_t set;
+    const auto a = set.add_component(generator{}, generator::just_emitted);
+    const auto b = set.add_component(generator{}, generator::just_emitted);
+    set.init(start);
+    WHEN("they run until both emitted once") {
+      set.run_until(generator::time_t{1010, true, 1010, true});
+      THEN("firing in any order reaches the same states, kept once") {
+        REQUIRE(set.stats().branches == 2);
+        REQUIRE(set.stats().deduplicated == 2);
+        REQUIRE(set.trajectories().size() == 1);
+        REQUIRE(set.get_sim_state<generator>(0, a).t_next == generator::time_t{1994, true, 2010, true});
+        REQUIRE(set.get_sim_state<generator>(0, b).t_last == generator::time_t{997, true, 1005, true});
+      }
+    }
+  }
+  GIVEN("two generators with overlapping periods feeding a counter") {
+    set_t set;
+    const auto a = set.add_component(generator{}, generator::just_emitted);
+    const auto b = set.add_component(generator{}, elapsed(4));
+    const auto c = set.add_component(counter{}, counter_start);
+    set.add_coupling(a, c);
+    set.add_coupling(b, c);
+    set.init(start);
+    WHEN("they run until both emitted once") {
+      set.run_until(generator::time_t{1010, true, 1010, true});
+      THEN("the counter state of each order is kept, and their hull contains all of them") {
+        REQUIRE(set.trajectories().size() > 1);
+        const auto hull = set.hull<counter>(c);
+        for (std::size_t k = 0; k < set.trajectories().size(); ++k) {
+          const auto &s = set.get_sim_state<counter>(k, c);
+          REQUIRE(hull.state.count.hull(s.state.count) == hull.state.count);
+          REQUIRE(hull.t_last.hull(s.t_last) == hull.t_last);
+          REQUIRE(s.state.count == counter::count_t{2, true, 2, true});
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("Trajectory set merges trajectories to respect its budget", "[TRAJECTORIES]") {
+  GIVEN("eight generators with distinct phases feeding a counter") {
+    const auto build = [](set_t &set) {
+      const auto c = set.add_component(counter{}, counter_start);
+      for (int k = 0; k < 8; ++k) {
+        set.add_coupling(set.add_component(generator{}, elapsed(k)), c);
+      }
+      return c;
+    };
+    const generator::time_t limit{5'000, true, 5'000, true};
+    WHEN("it runs with a budget of 16 trajectories") {
+      set_t set;
+      const auto c = build(set);
+      set.set_budget(cadmium::iadevs::engine::trajectory_budget{16, 0});
+      set.init(start);
+      set.run_until(limit);
+      THEN("the trajectories never exceed the budget after a round, and merging keeps every count") {
+        REQUIRE(set.trajectories().size() <= 16);
+        REQUIRE(set.stats().merged > 0);
+        REQUIRE(set.stats().peak_trajectories > 16);
+        const auto hull = set.hull<counter>(c);
+        REQUIRE(hull.state.count.hull(counter::count_t{8, true, 8, true}) == hull.state.count);
+      }
+    }
+    WHEN("it runs with a byte budget of 4 trajectories") {
+      set_t set;
+      build(set);
+      set.set_budget(cadmium::iadevs::engine::trajectory_budget{1024, 4 * set.bytes_per_trajectory()});
+      set.init(start);
+      set.run_until(limit);
+      THEN("the byte budget bounds the trajectories") {
+        REQUIRE(set.trajectories().size() <= 4);
+      }
+    }
+    WHEN("the budget allows no trajectory") {
+      set_t set;
+      THEN("it is rejected") {
+        REQUIRE_THROWS_AS(set.set_budget(cadmium::iadevs::engine::trajectory_budget{0, 0}), std::invalid_argument);
+      }
+    }
+  }
+  GIVEN("a generator coupled to another generator") {
+    set_t set;
+    const auto a = set.add_component(generator{}, generator::just_emitted);
+    const auto b = set.add_component(generator{}, generator::just_emitted);
+    THEN("the coupling is refused") {
+      REQUIRE_THROWS_AS(set.add_coupling(a, b), std::invalid_argument);
+      REQUIRE_THROWS_AS(set.add_coupling(a, 7), std::out_of_range);
+    }
+  }
+}
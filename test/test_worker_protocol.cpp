@@ -0,0 +1,151 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cadmium/iadevs/basic_models/counter.h>
+#include <cadmium/iadevs/basic_models/generator.h>
+#include <cadmium/iadevs/engine/worker_protocol.h>
+#include <cadmium/iadevs/utils/ia_interval_codec.h>
+
+#include <catch.hpp>
+
+#include <vector>
+
+namespace {
+using generator = cadmium::iadevs::basic_models::generator;
+using counter = cadmium::iadevs::basic_models::counter;
+using cadmium::iadevs::engine::worker_batch;
+using cadmium::iadevs::engine::worker_status;
+
+// Counter states are two intervals encoded back to back
+struct counter_codec : cadmium::iadevs::interval_codec {
+  using interval_codec::encode;
+  using interval_codec::decode;
+  static void encode(const counter::state_t &s, std::vector<std::byte> &bytes) {
+    std::vector<std::byte> elapsed;
+    encode(s.count, bytes);
+    encode(s.elapsed, elapsed);
+    bytes.insert(bytes.end(), elapsed.begin(), elapsed.end());
+  }
+  static bool decode(std::span<const std::byte> bytes, counter::state_t &s) {
+    constexpr auto size = encoded_size<int>;
+    return bytes.size() == 2 * size && decode(bytes.first(size), s.count) && decode(bytes.subspan(size), s.elapsed);
+  }
+};
+}
+
+SCENARIO("Simulation worker answers batches of generator requests", "[WORKER]") {
+  GIVEN("a generator worker and a batch initializing and stepping three instances") {
+    using protocol = cadmium::iadevs::engine::worker_protocol<generator, cadmium::iadevs::interval_codec>;
+    cadmium::iadevs::engine::simulation_worker<generator, cadmium::iadevs::interval_codec> worker;
+    worker_batch requests;
+    for (std::uint32_t instance = 0; instance < 3; ++instance) {
+      protocol::add_init(requests, instance, generator::just_emitted, generator::time_t{0, true, 0, true});
+    }
+    for (std::uint32_t instance = 0; instance < 3; ++instance) {
+      protocol::add_step(requests, instance);
+    }
+    WHEN("the worker handles the batch") {
+      worker_batch responses;
+      for (std::size_t k = 0; k < requests.size(); ++k) {
+        worker.handle(requests.frame(k), responses);
+      }
+      THEN("each request gets its response in order, matching a local simulator") {
+        cadmium::iadevs::engine::simulator<generator> local{};
+        const auto init = local.init(generator::just_emitted, generator::time_t{0, true, 0, true});
+        const auto output = local.step();
+        REQUIRE(responses.size() == 6);
+        generator::time_t t_next{};
+        REQUIRE(protocol::read_t_next(responses.frame(0), t_next) == worker_status::ok);
+        REQUIRE(t_next == init.t_next);
+        generator::output_t value{};
+        REQUIRE(protocol::read_step(responses.frame(5), value, t_next) == worker_status::ok);
+        REQUIRE(value == output);
+        REQUIRE(t_next == local.get_sim_state().t_next);
+        REQUIRE(worker.get_simulator(2)->get_sim_state().t_next == local.get_sim_state().t_next);
+      }
+    }
+  }GIVEN("a generator worker and invalid requests") {
+    using protocol = cadmium::iadevs::engine::worker_protocol<generator, cadmium::iadevs::interval_codec>;
+    cadmium::iadevs::engine::simulation_worker<generator, cadmium::iadevs::interval_codec> worker;
+    worker_batch requests;
+    protocol::add_step(requests, 0);
+    requests.append_u8(99);
+    requests.append_u32(0);
+    requests.end_frame();
+    requests.append_u8(1);
+    requests.end_frame();
+    protocol::add_init(requests, 0xFFFFFFFF, generator::just_emitted, generator::time_t{0, true, 0, true});
+    WHEN("the worker handles them") {
+      worker_batch responses;
+      THEN("each one reports why it failed") {
+        REQUIRE(worker.handle(requests.frame(0), responses) == worker_status::unknown_instance);
+        REQUIRE(worker.handle(requests.frame(1), responses) == worker_status::unknown_operation);
+        REQUIRE(worker.handle(requests.frame(2), responses) == worker_status::malformed_request);
+        // Instance ids are dense, an init far past the instances in use is refused without allocating
+        REQUIRE(worker.handle(requests.frame(3), responses) == worker_status::malformed_request);
+        REQUIRE(worker.get_simulator(0xFFFFFFFF) == nullptr);
+        generator::time_t t_next{};
+        REQUIRE(protocol::read_t_next(responses.frame(0), t_next) == worker_status::unknown_instance);
+        REQUIRE(responses.frame(2).size() == 1);
+        REQUIRE_FALSE(worker.stopping());
+      }
+    }
+  }
+}
+
+SCENARIO("Simulation worker answers counter transitions", "[WORKER]") {
+  GIVEN("an initialized counter instance") {
+    using protocol = cadmium::iadevs::engine::worker_protocol<counter, counter_codec>;
+    cadmium::iadevs::engine::simulation_worker<counter, counter_codec> worker;
+    worker_batch requests;
+    worker_batch responses;
+    const counter::state_t initial{counter::no_time, counter::no_time};
+    protocol::add_init(requests, 0, initial, counter::time_t{0, true, 0, true});
+    WHEN("it receives inputs, reports, and is queried for its state in one batch") {
+      const std::vector<counter::input_t> inputs(3, counter::input_t{1, true, 1, true});
+      protocol::add_external_transition(requests, 0, counter::time_t{500, true, 500, true}, inputs);
+      protocol::add_confluent_transition(requests, 0, inputs);
+      protocol::add_output(requests, 0);
+      protocol::add_get_state(requests, 0);
+      protocol::add_shutdown(requests);
+      for (std::size_t k = 0; k < requests.size(); ++k) {
+        REQUIRE(worker.handle(requests.frame(k), responses) == worker_status::ok);
+      }
+      THEN("the results match a local simulator") {
+        cadmium::iadevs::engine::simulator<counter> local{};
+        local.init(initial, counter::time_t{0, true, 0, true});
+        local.external_transition(counter::time_t{500, true, 500, true}, inputs);
+        local.confluent_transition(inputs);
+        counter::output_t output{};
+        REQUIRE(protocol::read_output(responses.frame(3), output) == worker_status::ok);
+        REQUIRE(output == local.output());
+        counter::state_t state{};
+        REQUIRE(protocol::read_state(responses.frame(4), state) == worker_status::ok);
+        REQUIRE(state == local.get_sim_state().state);
+        REQUIRE(worker.stopping());
+      }
+    }
+  }
+}
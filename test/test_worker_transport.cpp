@@ -0,0 +1,81 @@
+/**
+ * Copyright (c) 2023, Damian Vicino
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cadmium/iadevs/basic_models/generator.h>
+#include <cadmium/iadevs/engine/worker_transport.h>
+#include <cadmium/iadevs/utils/ia_interval_codec.h>
+
+#include <catch.hpp>
+
+#include <thread>
+
+namespace {
+using generator = cadmium::iadevs::basic_models::generator;
+using protocol = cadmium::iadevs::engine::worker_protocol<generator, cadmium::iadevs::interval_codec>;
+}
+
+SCENARIO("Simulation worker served over ZeroMQ", "[WORKER]") {
+  GIVEN("a generator worker served on an inproc endpoint") {
+    zmq::context_t context;
+    zmq::socket_t socket(context, zmq::socket_type::router);
+    socket.bind("inproc://generator_worker");
+    cadmium::iadevs::engine::simulation_worker<generator, cadmium::iadevs::interval_codec> worker;
+    std::thread server([&] { cadmium::iadevs::engine::serve_worker(socket, worker); });
+    cadmium::iadevs::engine::worker_client client(context, "inproc://generator_worker");
+    WHEN("a hundred instances are initialized and stepped with two pipelined batches") {
+      cadmium::iadevs::engine::worker_batch requests;
+      for (std::uint32_t instance = 0; instance < 100; ++instance) {
+        protocol::add_init(requests, instance, generator::just_emitted, generator::time_t{0, true, 0, true});
+      }
+      client.send(requests);
+      for (std::uint32_t instance = 0; instance < 100; ++instance) {
+        protocol::add_step(requests, instance);
+      }
+      client.send(requests);
+      cadmium::iadevs::engine::worker_responses init_responses;
+      cadmium::iadevs::engine::worker_responses step_responses;
+      client.receive(init_responses);
+      client.receive(step_responses);
+      protocol::add_shutdown(requests);
+      client.send(requests);
+      cadmium::iadevs::engine::worker_responses shutdown_responses;
+      client.receive(shutdown_responses);
+      server.join();
+      THEN("every request is answered in order") {
+        REQUIRE(init_responses.size() == 100);
+        REQUIRE(step_responses.size() == 100);
+        REQUIRE(shutdown_responses.size() == 1);
+        generator::time_t t_next{};
+        REQUIRE(protocol::read_t_next(init_responses.frame(99), t_next) == cadmium::iadevs::engine::worker_status::ok);
+        REQUIRE(t_next == generator::time_t{997, true, 1005, true});
+        generator::output_t output{};
+        REQUIRE(protocol::read_step(step_responses.frame(42), output, t_next) == cadmium::iadevs::engine::worker_status::ok);
+        REQUIRE(output == generator::output_values);
+        REQUIRE(t_next == generator::time_t{1994, true, 2010, true});
+        REQUIRE(worker.stopping());
+      }
+    }
+  }
+}